@@ -61,7 +61,8 @@ enum InternalMessageCode {
 	InitiateConnection = CHANNELIZER_MSG_CODE_END,
 	DfbChannel,
 	InputPacket,
-	OutputVector
+	OutputVector,
+	InputPacketBatch
 };
 }
 
@@ -41,6 +41,7 @@
 
 #include "System.h"
 #include "Beam.h"
+#include "BeamPacketBatchList.h"
 #include "ChErr.h"
 #include "ChTypes.h"
 #include "InputQ.h"
@@ -80,12 +81,15 @@ private:
 
 	Beam *beam;
 	BeamPacketList *beamPktList;
+	BeamPacketBatchList *batchList;
 	MsgList *msgList;
 	PartitionSet *partitionSet;
 
 	// methods
 	void extractArgs();
 	void handleMsg(Msg *msg);
+	void handlePacket(BeamPacket *pkt);
+	void handlePacketBatch(BeamPacketBatch *batch);
 	void sendStart();
 };
 
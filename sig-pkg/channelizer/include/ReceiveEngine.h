@@ -0,0 +1,97 @@
+/*******************************************************************************
+
+ File:    ReceiveEngine.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Receive engine
+//
+// Receives beam packets into a ring of preallocated packets using
+// batched socket calls.
+//
+#ifndef _ReceiveEngineH
+#define _ReceiveEngineH
+
+#include "System.h"
+#include "BeamPacketBatchList.h"
+#include "BeamPacketList.h"
+#include "Udp.h"
+
+using namespace sonata_lib;
+
+namespace chan {
+
+struct ReceiveStats {
+	uint64_t batches;				// batches received
+	uint64_t packets;				// packets received
+	uint64_t calls;					// socket calls
+	uint64_t dropped;				// short datagrams dropped
+
+	ReceiveStats(): batches(0), packets(0), calls(0), dropped(0) {}
+};
+
+/**
+ * Beam packet receive engine.
+ *
+ * Description:\n
+ * 	Keeps a ring of packets allocated from the beam packet list and
+ * 	receives into it with a single socket call, which returns as
+ * 	soon as at least one packet is available.  The packets received
+ * 	are moved to the caller's batch in the order they arrived, and
+ * 	their slots in the ring are refilled from the free list, so the
+ * 	caller owns the packets and the ring is always full.
+ */
+class ReceiveEngine {
+public:
+	ReceiveEngine(Udp *udp_, int32_t batchSize_ = RECEIVER_BATCH);
+	~ReceiveEngine();
+
+	Error recv(BeamPacketBatch *batch);
+
+	int32_t getBatchSize() { return (batchSize); }
+	const ReceiveStats& getStats() { return (stats); }
+	void resetStats() { stats = ReceiveStats(); }
+
+private:
+	int32_t batchSize;				// packets per socket call
+	size_t pktSize;					// size of a beam packet
+	Udp *udp;						// input socket
+	BeamPacketList *beamPktList;	// free list of beam packets
+	BeamPacket *ring[MAX_UDP_BATCH];	// receive ring
+	void *buf[MAX_UDP_BATCH];		// ring packet buffers
+	size_t len[MAX_UDP_BATCH];		// received lengths
+	ReceiveStats stats;
+
+	// forbidden
+	ReceiveEngine(const ReceiveEngine&);
+	ReceiveEngine& operator=(const ReceiveEngine&);
+};
+
+}
+
+#endif
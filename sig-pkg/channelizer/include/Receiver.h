@@ -38,12 +38,14 @@
 #include "System.h"
 #include "Args.h"
 #include "Beam.h"
+#include "BeamPacketBatchList.h"
 #include "BeamPacketList.h"
 #include "ChTypes.h"
 #include "ChErr.h"
 #include "InputQ.h"
 #include "Lock.h"
 #include "Msg.h"
+#include "ReceiveEngine.h"
 #include "Task.h"
 #include "Udp.h"
 
@@ -52,6 +54,7 @@ using namespace sonata_lib;
 namespace chan {
 
 struct ReceiverTiming {
+	uint64_t batches;
 	uint64_t packets;
 	float recv;
 	float demarshall;
@@ -59,8 +62,8 @@ struct ReceiverTiming {
 	float send;
 	float total;
 
-	ReceiverTiming(): packets(0), recv(0), demarshall(0), alloc(0), send(0),
-			total(0) {}
+	ReceiverTiming(): batches(0), packets(0), recv(0), demarshall(0),
+			alloc(0), send(0), total(0) {}
 };
 
 class ReceiverTask: public Task {
@@ -77,11 +80,13 @@ private:
 	int32_t packets;					// # of packets received
 	InputBuffer *buf;					// input buffer
 	Udp *udp;							// receiver connection
+	ReceiveEngine *engine;				// batched packet input
 	ReceiverTiming timing;
 
 	Args *args;							// command-line args
 	Beam *beam;							// singleton beam
 	BeamPacketList *beamPktList;		// beam packet list
+	BeamPacketBatchList *batchList;		// beam packet batch list
 	MsgList *msgList;
 	Queue *inputQ;						// input queue for packets
 
@@ -111,6 +111,7 @@ const uint32_t DEFAULT_START_TIME = 0;
 const int32_t DEFAULT_WORKERS = 1;
 const int32_t DEFAULT_RECEIVERS = 1;
 const int32_t RECEIVER_DELAY = 500;
+const int32_t RECEIVER_BATCH = 32;		// max packets per receive call
 const int32_t CHANNELIZER_MESSAGES = 100000;
 const int32_t DEFAULT_WORKQ_SLOTS = 100000;
 const int32_t DEFAULT_INPUTQ_SLOTS = 100000;
@@ -0,0 +1,100 @@
+/*******************************************************************************
+
+ File:    TransmitEngine.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Transmit engine
+//
+// Sends a vector of channel packets to the per-channel multicast
+// destinations using batched socket calls.
+//
+#ifndef _TransmitEngineH
+#define _TransmitEngineH
+
+#include <vector>
+#include <netinet/in.h>
+#include "System.h"
+#include "ChannelPacketVector.h"
+#include "Struct.h"
+#include "Udp.h"
+
+using namespace sonata_lib;
+
+namespace chan {
+
+struct TransmitStats {
+	uint64_t vectors;				// vectors sent
+	uint64_t packets;				// packets sent
+	uint64_t calls;					// socket calls
+	uint64_t errors;				// packets dropped due to send errors
+
+	TransmitStats(): vectors(0), packets(0), calls(0), errors(0) {}
+};
+
+/**
+ * Channel packet transmit engine.
+ *
+ * Description:\n
+ * 	Channel n of the output is sent to address base.addr + n, port
+ * 	base.port + n.  The socket address of every channel is computed
+ * 	once by setup, so sending a vector requires no address
+ * 	conversion; the packets are then handed to the socket up to
+ * 	MAX_UDP_BATCH at a time.
+ */
+class TransmitEngine {
+public:
+	TransmitEngine(Udp *udp_);
+	~TransmitEngine();
+
+	void setup(const HostSpec& base, int32_t channels);
+	void send(ChannelPacketVector& vector);
+
+	int32_t getChannels() { return (dest.size()); }
+	const struct sockaddr_in& getDest(int32_t chan) { return (dest[chan]); }
+	const TransmitStats& getStats() { return (stats); }
+	void resetStats() { stats = TransmitStats(); }
+
+private:
+	Udp *udp;						// output socket
+	std::vector<struct sockaddr_in> dest;	// channel destinations
+	void *buf[MAX_UDP_BATCH];		// batch packet buffers
+	size_t len[MAX_UDP_BATCH];		// batch packet lengths
+	const struct sockaddr_in *addr[MAX_UDP_BATCH];	// batch destinations
+	TransmitStats stats;
+
+	int32_t sendBatch(int32_t n);
+
+	// forbidden
+	TransmitEngine(const TransmitEngine&);
+	TransmitEngine& operator=(const TransmitEngine&);
+};
+
+}
+
+#endif
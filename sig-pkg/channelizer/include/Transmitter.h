@@ -47,6 +47,7 @@
 #include "ChErr.h"
 #include "Msg.h"
 #include "QTask.h"
+#include "TransmitEngine.h"
 #include "TransmitterQ.h"
 #include "Udp.h"
 
@@ -90,6 +91,7 @@ private:
 	chan::Unit unit;
 	TransmitterTiming timing;
 	Udp *connection;
+	TransmitEngine *engine;
 	SampleStatistics outputStats;
 	SampleStatistics channelStats[MAX_TOTAL_CHANNELS];
 	TransmitList transmitList;
@@ -104,8 +106,6 @@ private:
 	void handleMsg(Msg *msg);
 	void transmit(Msg *msg);
 	void sendVector(ChannelPacketVector *vector);
-	Error send(ChannelPacket& pkt);
-	void convertChanToIp(IpAddress& ipAddr, int32_t chan);
 	void recordOutputStats(int32_t chan, const ComplexInt16 *s);
 
 	// hidden
@@ -43,7 +43,7 @@ Queue *InputQ::instance = 0;
 
 InputTask::InputTask(string name_): QTask(name_, INPUT_PRIO, true, false),
 		unit(UnitChannelize), inputQ(0), respQ(0), beam(0), beamPktList(0),
-		msgList(0), partitionSet(0)
+		batchList(0), msgList(0), partitionSet(0)
 {
 }
 
@@ -74,6 +74,8 @@ InputTask::extractArgs()
 	Assert(beam);
 	beamPktList = BeamPacketList::getInstance();
 	Assert(beamPktList);
+	batchList = BeamPacketBatchList::getInstance();
+	Assert(batchList);
 	inputQ = InputQ::getInstance();
 	Assert(inputQ);
 	setInputQueue(inputQ);
@@ -88,34 +90,10 @@ InputTask::handleMsg(Msg *msg)
 {
 	switch (msg->getCode()) {
 	case InputPacket:
-		{
-#if INPUT_TIMING
-		uint64_t t0 = getticks();
-#endif
-		BeamPacket *pkt = static_cast<BeamPacket *> (msg->getData());
-		bool startFlag = false;
-		Error err = beam->handlePacket(pkt, startFlag);
-		if (err == ERR_STAP)
-			LogError(err, -1, "channelizer not synchronized");
-		else if (err == ERR_IPV) {
-			cout << endl << "!!!!!!! Wrong packet version, should be " <<
-					ATADataPacketHeader::CURRENT_VERSION << " !!!!!!!!!" << endl
-					<< "!! STOPPING CHANNELIZATION !!" << endl << endl;
-			if (!Args::getInstance()->noSse()) {
-				Timer timer;
-				timer.sleep(4000);
-				LogError(err, -1, "should be  %0x",
-						ATADataPacketHeader::CURRENT_VERSION);
-			}
-		}
-		if (startFlag)
-			sendStart();
-#if INPUT_TIMING
-		uint64_t t1 = getticks();
-		++timing.packets;
-		timing.handlePacket += elapsed(t1, t0);
-#endif
-		}
+		handlePacket(static_cast<BeamPacket *> (msg->getData()));
+		break;
+	case InputPacketBatch:
+		handlePacketBatch(static_cast<BeamPacketBatch *> (msg->getData()));
 		break;
 	default:
 		Fatal(ERR_IMT);
@@ -123,6 +101,58 @@ InputTask::handleMsg(Msg *msg)
 	}
 }
 
+/**
+ * Pass a packet to the beam.
+ */
+void
+InputTask::handlePacket(BeamPacket *pkt)
+{
+#if INPUT_TIMING
+	uint64_t t0 = getticks();
+#endif
+	bool startFlag = false;
+	Error err = beam->handlePacket(pkt, startFlag);
+	if (err == ERR_STAP)
+		LogError(err, -1, "channelizer not synchronized");
+	else if (err == ERR_IPV) {
+		cout << endl << "!!!!!!! Wrong packet version, should be " <<
+				ATADataPacketHeader::CURRENT_VERSION << " !!!!!!!!!" << endl
+				<< "!! STOPPING CHANNELIZATION !!" << endl << endl;
+		if (!Args::getInstance()->noSse()) {
+			Timer timer;
+			timer.sleep(4000);
+			LogError(err, -1, "should be  %0x",
+					ATADataPacketHeader::CURRENT_VERSION);
+		}
+	}
+	if (startFlag)
+		sendStart();
+#if INPUT_TIMING
+	uint64_t t1 = getticks();
+	++timing.packets;
+	timing.handlePacket += elapsed(t1, t0);
+#endif
+}
+
+/**
+ * Pass a batch of packets to the beam.
+ *
+ * Description:\n
+ * 	Handles each packet of a batch received by the receiver task in a
+ * 	single system call, in arrival order, exactly as if it had arrived
+ * 	on its own, so sequence tracking and statistics are unchanged.
+ * 	The batch is then returned to the free list; the packets
+ * 	themselves are released by the beam.
+ */
+void
+InputTask::handlePacketBatch(BeamPacketBatch *batch)
+{
+	Assert(batch);
+	for (int32_t i = 0; i < batch->count; ++i)
+		handlePacket(batch->pkt[i]);
+	batchList->free(batch);
+}
+
 /**
  * Notify the SSE that the channelizer has started
  */
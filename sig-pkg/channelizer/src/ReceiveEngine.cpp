@@ -0,0 +1,111 @@
+/*******************************************************************************
+
+ File:    ReceiveEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Receive engine: batched input of beam packets
+//
+#include "ReceiveEngine.h"
+
+namespace chan {
+
+ReceiveEngine::ReceiveEngine(Udp *udp_, int32_t batchSize_):
+		batchSize(batchSize_), pktSize(0), udp(udp_), beamPktList(0)
+{
+	Assert(udp);
+	Assert(batchSize > 0 && batchSize <= MAX_UDP_BATCH);
+	beamPktList = BeamPacketList::getInstance();
+	Assert(beamPktList);
+	for (int32_t i = 0; i < batchSize; ++i) {
+		ring[i] = beamPktList->alloc();
+		Assert(ring[i]);
+		buf[i] = (void *) ring[i]->getPacket();
+	}
+	pktSize = ring[0]->getPacketSize();
+}
+
+/**
+ * Destroy the receive engine.
+ *
+ * Description:\n
+ * 	Returns the packets of the ring to the free list.
+ */
+ReceiveEngine::~ReceiveEngine()
+{
+	for (int32_t i = 0; i < batchSize; ++i)
+		beamPktList->free(ring[i]);
+}
+
+/**
+ * Receive a batch of packets.
+ *
+ * Description:\n
+ * 	Waits for at least one packet, then moves every full-size packet
+ * 	received by the same socket call to the batch, in arrival order.\n
+ * Notes:\n
+ * 	The packets are not demarshalled; the caller does that once it
+ * 	knows they are to be used.\n
+ * 	Short datagrams are dropped and counted, and their buffers are
+ * 	reused.\n
+ * 	On error the batch is empty and the error is returned; the ring
+ * 	is unchanged.
+ *
+ * @param		batch batch to be filled.
+ * @return		0 on success, otherwise the socket error.
+ */
+Error
+ReceiveEngine::recv(BeamPacketBatch *batch)
+{
+	Assert(batch);
+	batch->count = 0;
+	int32_t count = batchSize;
+	for (int32_t i = 0; i < batchSize; ++i)
+		len[i] = pktSize;
+	Error err = udp->recv(buf, len, count);
+	++stats.calls;
+	if (err)
+		return (err);
+	for (int32_t i = 0; i < count; ++i) {
+		if (len[i] != pktSize) {
+			++stats.dropped;
+			continue;
+		}
+		batch->pkt[batch->count++] = ring[i];
+		ring[i] = beamPktList->alloc();
+		Assert(ring[i]);
+		buf[i] = (void *) ring[i]->getPacket();
+	}
+	if (batch->count) {
+		++stats.batches;
+		stats.packets += batch->count;
+	}
+	return (0);
+}
+
+}
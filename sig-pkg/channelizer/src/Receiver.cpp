@@ -67,7 +67,7 @@ ReceiverTask::getInstance()
  * Create the receiver task.
 */
 ReceiverTask::ReceiverTask(string name_, int prio_): Task(name_, prio_),
-		packets(0)
+		packets(0), buf(0), udp(0), engine(0), beamPktList(0), batchList(0)
 {
 }
 
@@ -79,6 +79,7 @@ ReceiverTask::ReceiverTask(string name_, int prio_): Task(name_, prio_),
 */
 ReceiverTask::~ReceiverTask()
 {
+	delete engine;
 	delete buf;
 }
 
@@ -92,7 +93,12 @@ ReceiverTask::extractArgs()
  *
  * Description:\n
  * 	Processes packets from the Udp socket and passes them onto the
- *	beam object for processing.
+ *	beam object for processing.\n
+ * Notes:\n
+ *	Packets are received in batches of up to RECEIVER_BATCH with a
+ *	single system call and sent to the input task as a single message;
+ *	the input task hands them to the beam one at a time in arrival
+ *	order, so the sequence tracking is unchanged.
  */
 void *
 ReceiverTask::routine()
@@ -121,6 +127,8 @@ ReceiverTask::routine()
 	Assert(beam);
 	beamPktList = BeamPacketList::getInstance();
 	Assert(beamPktList);
+	batchList = BeamPacketBatchList::getInstance();
+	Assert(batchList);
 	inputQ = InputQ::getInstance();
 	Assert(inputQ);
 	msgList = MsgList::getInstance();
@@ -139,15 +147,19 @@ ReceiverTask::routine()
 	size_t size = DEFAULT_RCV_BUFSIZE;
 	udp->setRcvBufsize(size);
 
+	engine = new ReceiveEngine(udp);
+	Assert(engine);
+
 	// process incoming packets
 	while (1) {
 #if RECEIVER_TIMING
 		uint64_t t0 = getticks();
 #endif
-		BeamPacket *pkt = static_cast<BeamPacket *> (beamPktList->alloc());
-		Assert(pkt);
-		Error err = udp->recv((void *) pkt->getPacket(), pkt->getPacketSize());
+		BeamPacketBatch *batch = batchList->alloc();
+		Assert(batch);
+		Error err = engine->recv(batch);
 		if (err) {
+			batchList->free(batch);
 			switch (err) {
 			case EAGAIN:
 			case EINTR:
@@ -157,22 +169,25 @@ ReceiverTask::routine()
 				break;
 			}
 		}
-		// got a packet; route it unless we're idle, in which case the
-		// packet is freed without processing
-		if (beam->getState() == STATE_IDLE) {
-			beamPktList->free(pkt);
+		// got packets; route them unless we're idle, in which case the
+		// packets are freed without processing
+		if (!batch->count || beam->getState() == STATE_IDLE) {
+			for (int32_t i = 0; i < batch->count; ++i)
+				beamPktList->free(batch->pkt[i]);
+			batchList->free(batch);
 			continue;
 		}
 #if RECEIVER_TIMING
 		uint64_t t1 = getticks();
 #endif
-		++packets;
-		pkt->demarshall();
+		packets += batch->count;
+		for (int32_t i = 0; i < batch->count; ++i)
+			batch->pkt[i]->demarshall();
 #if RECEIVER_TIMING
 		uint64_t t2 = getticks();
 #endif
-		Msg *msg = msgList->alloc((DxMessageCode) InputPacket, 0, pkt,
-				sizeof(BeamPacket), 0, USER);
+		Msg *msg = msgList->alloc((DxMessageCode) InputPacketBatch, 0, batch,
+				sizeof(BeamPacketBatch), 0, USER);
 #if RECEIVER_TIMING
 		uint64_t t3 = getticks();
 #endif
@@ -180,7 +195,8 @@ ReceiverTask::routine()
 
 #if RECEIVER_TIMING
 		uint64_t t4 = getticks();
-		++timing.packets;
+		++timing.batches;
+		timing.packets += batch->count;
 		timing.recv += elapsed(t1, t0);
 		timing.demarshall += elapsed(t2, t1);
 		timing.alloc += elapsed(t3, t2);
@@ -190,4 +206,4 @@ ReceiverTask::routine()
 	}
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+
+ File:    TransmitEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Transmit engine: batched output of channel packet vectors
+//
+#include <errno.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include "TransmitEngine.h"
+
+namespace chan {
+
+TransmitEngine::TransmitEngine(Udp *udp_): udp(udp_)
+{
+	Assert(udp);
+}
+
+TransmitEngine::~TransmitEngine()
+{
+}
+
+/**
+ * Build the channel destination table.
+ *
+ * Description:\n
+ * 	Computes the socket address of each output channel from the base
+ * 	address and port.
+ *
+ * @param		base base output address and port; inaddr must be set.
+ * @param		channels number of output channels.
+ */
+void
+TransmitEngine::setup(const HostSpec& base, int32_t channels)
+{
+	Assert(channels > 0);
+	dest.resize(channels);
+	for (int32_t i = 0; i < channels; ++i) {
+		struct sockaddr_in& d = dest[i];
+		memset(&d, 0, sizeof(d));
+		d.sin_family = AF_INET;
+		d.sin_port = htons(base.port + i);
+		d.sin_addr.s_addr = htonl(ntohl(base.inaddr.s_addr) + i);
+	}
+}
+
+/**
+ * Send a vector of channel packets.
+ *
+ * Description:\n
+ * 	Sends every packet of the vector to the destination of its
+ * 	channel, in vector order.
+ * Notes:\n
+ * 	As with single packet sends, a packet which cannot be sent is
+ * 	dropped and counted as an error; transmission continues with the
+ * 	next packet.
+ */
+void
+TransmitEngine::send(ChannelPacketVector& vector)
+{
+	int32_t n = 0;
+	for (uint32_t i = 0; i < vector.size(); ++i) {
+		ChannelPacket& p = vector[i];
+		int32_t chan = p.getHeader().chan;
+		Assert(chan < (int32_t) vector.size());
+		Assert(chan < getChannels());
+		buf[n] = (void *) p.getPacket();
+		len[n] = p.getPacketSize();
+		addr[n] = &dest[chan];
+		if (++n == MAX_UDP_BATCH)
+			n = sendBatch(n);
+	}
+	while (n)
+		n = sendBatch(n);
+	++stats.vectors;
+}
+
+/**
+ * Send the pending batch.
+ *
+ * Description:\n
+ * 	Makes a single socket call for the pending packets, then moves any
+ * 	which were not accepted to the front of the batch.
+ *
+ * @param		n number of pending packets.
+ * @return		number of packets still pending.
+ */
+int32_t
+TransmitEngine::sendBatch(int32_t n)
+{
+	int32_t sent = n;
+	Error err = udp->send(buf, len, addr, sent);
+	++stats.calls;
+	if (err) {
+		if (err != EINTR) {
+			// drop the packet which could not be sent
+			++stats.errors;
+			sent = 1;
+		}
+	}
+	else
+		stats.packets += sent;
+	int32_t left = n - sent;
+	if (left) {
+		memmove(buf, buf + sent, left * sizeof(buf[0]));
+		memmove(len, len + sent, left * sizeof(len[0]));
+		memmove(addr, addr + sent, left * sizeof(addr[0]));
+	}
+	return (left);
+}
+
+}
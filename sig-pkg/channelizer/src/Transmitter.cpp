@@ -63,7 +63,7 @@ TransmitterTask::getInstance()
 TransmitterTask::TransmitterTask(string name_, int prio_):
 		QTask(name_, prio_, true, false), abort(false),
 		curSeq(0), code(ATADataPacketHeader::XLINEAR), unit(UnitTransmit),
-		connection(0), beam(0), vectorList(0), msgList(0),
+		connection(0), engine(0), beam(0), vectorList(0), msgList(0),
 		transmitterQ(0)
 {
 }
@@ -111,6 +111,11 @@ TransmitterTask::extractArgs()
 	// set the buffer size
 	size_t size = DEFAULT_SND_BUFSIZE;
 	connection->setSndBufsize(size);
+
+	// precompute the channel destinations
+	engine = new TransmitEngine(connection);
+	Assert(engine);
+	engine->setup(base, beam->getUsableChannels());
 }
 
 void
@@ -196,11 +201,7 @@ void
 TransmitterTask::sendVector(ChannelPacketVector *vector)
 {
 	// send all the packets
-	for (uint32_t i = 0; i < vector->size(); ++i) {
-		ChannelPacket& p = (*vector)[i];
-		Assert(p.getHeader().chan < vector->size());
-		send(p);
-	}
+	engine->send(*vector);
 #if TRANSMITTER_TIMING
 	uint64_t t0 = getticks();
 #endif
@@ -230,37 +231,6 @@ TransmitterTask::getWaits()
 	return (timing.waits);
 }
 
-/**
- * Send a data packet to a socket.
- *
- * Description:\n
- * 	Sends a set of multicast data packets.\n\n
- * Notes:\n
- * 	Assumes that the packets are completely constructed.
-*/
-Error
-TransmitterTask::send(ChannelPacket& pkt)
-{
-	// compute the IP address of the port
-	ChannelDataPacket *packet = static_cast<ChannelDataPacket *>
-			(pkt.getPacket());
-	int32_t chan = packet->hdr.chan;
-//	recordOutputStats(chan, (ComplexInt16 *) packet->data.samples);
-	IpAddress ipAddr;
-	convertChanToIp(ipAddr, chan);
-//	packet->hdr.chan = 0;
-	return (connection->send(packet, pkt.getPacketSize(), ipAddr,
-			base.port + chan));
-}
-
-void
-TransmitterTask::convertChanToIp(IpAddress& ipAddr, int32_t chan)
-{
-	in_addr tmp;
-	tmp.s_addr = htonl(ntohl(base.inaddr.s_addr) + chan);
-	strcpy(ipAddr, inet_ntoa(tmp));
-}
-
 void
 TransmitterTask::recordOutputStats(int32_t chan, const ComplexInt16 *s)
 {
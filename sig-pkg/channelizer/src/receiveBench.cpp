@@ -0,0 +1,332 @@
+/*******************************************************************************
+
+ File:    receiveBench
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Receiver benchmark: sends synthetic beam packets to a local socket
+// from a built-in generator and receives them first one packet at a
+// time (the original receiver path), then through the receive engine.
+// Reports packets per second and socket calls per packet.
+//
+// The generated sequence numbers contain gaps and late packets.  In
+// a second, shorter run the packets delivered by each path are passed
+// to the beam, one batch at a time for the engine as the input task
+// does, and the beam's network statistics are checked against each
+// other and against the gaps and late packets which were generated.
+//
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "System.h"
+#include "Args.h"
+#include "Beam.h"
+#include "BeamPacketBatchList.h"
+#include "BeamPacketList.h"
+#include "Partition.h"
+#include "ReceiveEngine.h"
+#include "WorkQ.h"
+
+using namespace chan;
+using std::cout;
+using std::endl;
+
+const int32_t BENCH_PORT = 52100;
+const int32_t BENCH_PACKETS = 100000;
+const int32_t CHECK_PACKETS = 8192;		// must fit in the beam buffer
+const int32_t BENCH_CHUNK = 32;			// packets sent before draining
+const int32_t GAP_INTERVAL = 97;		// packets between sequence gaps
+const int32_t LATE_INTERVAL = 131;		// packets between late packets
+const IpAddress BENCH_ADDR = "127.0.0.1";
+
+enum ReceivePath {
+	SinglePath,
+	EnginePath
+};
+
+// the generated stream and what the beam should make of it
+struct Stream {
+	std::vector<uint32_t> seq;		// sequence numbers in send order
+	int32_t missed;					// sequence numbers skipped
+	int32_t late;					// packets resent behind the sequence
+
+	Stream(): missed(0), late(0) {}
+};
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Generate the sequence numbers of the test stream.
+ *
+ * Description:\n
+ * 	Sequence numbers normally increase by one; periodically one to
+ * 	three are skipped, and periodically a packet from a few packets
+ * 	back is sent again.
+ */
+static void
+generate(Stream& stream, int32_t packets)
+{
+	stream.seq.resize(packets);
+	stream.missed = stream.late = 0;
+	uint32_t next = 1000;
+	for (int32_t i = 0; i < packets; ++i) {
+		if (i && !(i % LATE_INTERVAL)) {
+			stream.seq[i] = next - 1 - i % 5;
+			++stream.late;
+		}
+		else {
+			if (i && !(i % GAP_INTERVAL)) {
+				next += 1 + i % 3;
+				stream.missed += 1 + i % 3;
+			}
+			stream.seq[i] = next++;
+		}
+	}
+}
+
+/**
+ * Send one chunk of the test stream in a single call.
+ */
+static void
+sendChunk(Udp& udp, BeamPacket *pkt, const Stream& stream, int32_t first,
+		int32_t n, const sockaddr_in *dest)
+{
+	void *msg[BENCH_CHUNK];
+	size_t len[BENCH_CHUNK];
+	const sockaddr_in *to[BENCH_CHUNK];
+	for (int32_t i = 0; i < n; ++i) {
+		pkt[i].getHeader().seq = stream.seq[first+i];
+		msg[i] = pkt[i].getPacket();
+		len[i] = pkt[i].getPacketSize();
+		to[i] = dest;
+	}
+	int32_t sent = 0;
+	while (sent < n) {
+		int32_t count = n - sent;
+		Error err = udp.send(msg + sent, len + sent, to + sent, count);
+		Assert(!err || err == EAGAIN || err == EINTR);
+		sent += count;
+	}
+}
+
+/**
+ * Send a stream and receive it along one of the paths.
+ *
+ * Description:\n
+ * 	The stream is sent a chunk at a time, and each chunk is received
+ * 	before the next is sent, so that no packets are lost.  If a beam
+ * 	is given, the packets are handed to it in the order they were
+ * 	delivered; otherwise they are freed.  Returns the time spent
+ * 	receiving.
+ */
+static float64_t
+receive(ReceivePath path, Udp& snd, Udp& rcv, BeamPacket *gen,
+		const Stream& stream, const sockaddr_in *dest, Beam *beam,
+		int32_t& received, uint64_t& calls)
+{
+	BeamPacketList *beamPktList = BeamPacketList::getInstance();
+	BeamPacketBatchList *batchList = BeamPacketBatchList::getInstance();
+	ReceiveEngine *engine = 0;
+	if (path == EnginePath)
+		engine = new ReceiveEngine(&rcv);
+
+	int32_t packets = stream.seq.size();
+	float64_t t = 0;
+	received = 0;
+	calls = 0;
+	bool startFlag;
+	for (int32_t i = 0; i < packets; i += BENCH_CHUNK) {
+		int32_t n = std::min(BENCH_CHUNK, packets - i);
+		sendChunk(snd, gen, stream, i, n, dest);
+		for (int32_t got = 0; got < n; ) {
+			float64_t t0 = now();
+			if (path == SinglePath) {
+				BeamPacket *pkt = beamPktList->alloc();
+				Assert(pkt);
+				Error err = rcv.recv((void *) pkt->getPacket(),
+						pkt->getPacketSize());
+				Assert(!err);
+				++calls;
+				pkt->demarshall();
+				t += now() - t0;
+				++got;
+				if (beam)
+					beam->handlePacket(pkt, startFlag);
+				else
+					beamPktList->free(pkt);
+			}
+			else {
+				BeamPacketBatch *batch = batchList->alloc();
+				Assert(batch);
+				Error err = engine->recv(batch);
+				Assert(!err);
+				for (int32_t j = 0; j < batch->count; ++j)
+					batch->pkt[j]->demarshall();
+				t += now() - t0;
+				got += batch->count;
+				for (int32_t j = 0; j < batch->count; ++j) {
+					if (beam)
+						beam->handlePacket(batch->pkt[j], startFlag);
+					else
+						beamPktList->free(batch->pkt[j]);
+				}
+				batchList->free(batch);
+			}
+		}
+		received += n;
+	}
+	if (engine) {
+		calls = engine->getStats().calls;
+		delete engine;
+	}
+	return (t);
+}
+
+/**
+ * Run the stream through the beam along one of the paths and return
+ * the beam's network statistics.
+ *
+ * Description:\n
+ * 	The beam is left pending with a start time of zero, so the first
+ * 	packet arms it and the second starts it and resets the statistics.
+ * 	The DFB requests it schedules are discarded.
+ */
+static void
+check(ReceivePath path, Udp& snd, Udp& rcv, BeamPacket *gen,
+		const Stream& stream, const sockaddr_in *dest, sonata_lib::NetStatistics& ns)
+{
+	Beam *beam = Beam::getInstance();
+	beam->setup();
+	beam->setState(STATE_PENDING);
+	int32_t received;
+	uint64_t calls;
+	receive(path, snd, rcv, gen, stream, dest, beam, received, calls);
+	beam->getNetStats(ns);
+
+	Queue *workQ = WorkQ::getInstance();
+	MsgList *msgList = MsgList::getInstance();
+	Msg *msg;
+	while (!workQ->recv((void **) &msg, 0))
+		msgList->free(msg);
+}
+
+static bool
+report(const char *name, const sonata_lib::NetStatistics& ns, const Stream& stream,
+		const sonata_lib::NetStatistics& ref)
+{
+	bool ok = ns.total == stream.seq.size() - 2
+			&& ns.missed == (uint64_t) stream.missed
+			&& ns.late == (uint64_t) stream.late
+			&& !ns.wrong && !ns.invalid
+			&& ns.total == ref.total && ns.missed == ref.missed
+			&& ns.late == ref.late;
+	cout << name << "\t" << ns.total << "\t" << ns.missed << "\t" << ns.late
+			<< "\t" << (ok ? "ok" : "MISMATCH") << endl;
+	return (ok);
+}
+
+int
+main(int argc, char **argv)
+{
+	int32_t packets = BENCH_PACKETS;
+	if (argc > 1)
+		packets = atoi(argv[1]);
+
+	Args *args = Args::getInstance();
+	Assert(args);
+
+	// the beam takes a block for each DFB request it schedules
+	PartitionSet *partitionSet = PartitionSet::getInstance();
+	Assert(partitionSet);
+	partitionSet->addPartition(new Partition(PART1_SIZE, PART1_BLKS));
+
+	// receiving socket
+	Udp rcv(std::string("receive"), (sonata_lib::Unit) 0);
+	rcv.setAddress(BENCH_ADDR, BENCH_PORT, false, true);
+	size_t size = DEFAULT_RCV_BUFSIZE;
+	rcv.setRcvBufsize(size);
+
+	// generator
+	Udp snd(std::string("generate"), (sonata_lib::Unit) 0);
+	snd.setAddress(BENCH_ADDR, BENCH_PORT, false);
+	size = DEFAULT_SND_BUFSIZE;
+	snd.setSndBufsize(size);
+	sockaddr_in dest;
+	memset(&dest, 0, sizeof(dest));
+	dest.sin_family = AF_INET;
+	dest.sin_port = htons(BENCH_PORT);
+	inet_aton(BENCH_ADDR, &dest.sin_addr);
+	BeamPacket *gen = new BeamPacket[BENCH_CHUNK];
+	for (int32_t i = 0; i < BENCH_CHUNK; ++i) {
+		ATADataPacketHeader& hdr = gen[i].getHeader();
+		hdr.src = args->getBeamSrc();
+		hdr.polCode = args->getPol();
+		hdr.flags |= ATADataPacketHeader::DATA_VALID;
+		hdr.len = BEAM_SAMPLES;
+	}
+
+	// throughput
+	Stream stream;
+	generate(stream, packets);
+	cout << packets << " packets" << endl;
+	cout << "path\treceived\tpkts/s\tcalls/pkt" << endl;
+	const char *name[] = { "single", "engine" };
+	for (int32_t p = SinglePath; p <= EnginePath; ++p) {
+		int32_t received;
+		uint64_t calls;
+		float64_t t = receive((ReceivePath) p, snd, rcv, gen, stream, &dest,
+				0, received, calls);
+		cout << name[p] << "\t" << received << "\t"
+				<< (int64_t) (received / t) << "\t"
+				<< (float64_t) calls / received << endl;
+	}
+
+	// sequence accounting by the beam
+	generate(stream, CHECK_PACKETS);
+	cout << endl << CHECK_PACKETS << " packets to the beam, "
+			<< stream.missed << " missed, " << stream.late << " late" << endl;
+	cout << "path\ttotal\tmissed\tlate\tcheck" << endl;
+	sonata_lib::NetStatistics single, batched;
+	check(SinglePath, snd, rcv, gen, stream, &dest, single);
+	check(EnginePath, snd, rcv, gen, stream, &dest, batched);
+	bool ok = report(name[SinglePath], single, stream, single);
+	ok = report(name[EnginePath], batched, stream, single) && ok;
+
+	delete [] gen;
+	return (ok ? 0 : 1);
+}
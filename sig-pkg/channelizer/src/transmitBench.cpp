@@ -0,0 +1,168 @@
+/*******************************************************************************
+
+ File:    transmitBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Transmitter benchmark: sends synthetic channel packet vectors to
+// local receiving sockets, first one packet at a time with per-packet
+// address conversion (the original transmitter path), then through
+// the transmit engine.  Reports packets per second and socket calls
+// per vector.
+//
+#include <iostream>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "ChannelPacketVector.h"
+#include "TransmitEngine.h"
+
+using namespace chan;
+using std::cout;
+using std::endl;
+
+const int32_t BENCH_PORT = 52000;
+const int32_t BENCH_VECTORS = 500;
+const IpAddress BENCH_ADDR = "127.0.0.1";
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Drain the receiving sockets, returning the number of packets received.
+ */
+static int32_t
+drain(const std::vector<int>& rcv, void *buf, size_t len)
+{
+	int32_t n = 0;
+	for (uint32_t i = 0; i < rcv.size(); ++i) {
+		while (recv(rcv[i], buf, len, MSG_DONTWAIT) > 0)
+			++n;
+	}
+	return (n);
+}
+
+static void
+report(const char *name, int32_t vectors, int32_t channels, float64_t t,
+		uint64_t calls, int32_t received)
+{
+	int64_t packets = (int64_t) vectors * channels;
+	cout << name << "\t" << packets << "\t" << received << "\t"
+			<< (int64_t) (packets / t) << "\t"
+			<< (float64_t) calls / vectors << endl;
+}
+
+int
+main(int argc, char **argv)
+{
+	int32_t channels = DEFAULT_USABLE_CHANNELS;
+	int32_t vectors = BENCH_VECTORS;
+	if (argc > 1)
+		channels = atoi(argv[1]);
+	if (argc > 2)
+		vectors = atoi(argv[2]);
+
+	// one receiving socket per channel
+	std::vector<int> rcv(channels);
+	for (int32_t i = 0; i < channels; ++i) {
+		rcv[i] = socket(AF_INET, SOCK_DGRAM, 0);
+		int size = 4 * 1024 * 1024;
+		setsockopt(rcv[i], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+		sockaddr_in a;
+		memset(&a, 0, sizeof(a));
+		a.sin_family = AF_INET;
+		a.sin_port = htons(BENCH_PORT + i);
+		a.sin_addr.s_addr = htonl(INADDR_ANY);
+		if (bind(rcv[i], (sockaddr *) &a, sizeof(a)) < 0) {
+			cout << "can't bind port " << BENCH_PORT + i << endl;
+			return (1);
+		}
+	}
+
+	// synthetic output vector
+	ChannelPacketVector vector(channels);
+	for (int32_t i = 0; i < channels; ++i)
+		vector[i].getHeader().chan = i;
+	size_t pktSize = vector[0].getPacketSize();
+	char *buf = new char[pktSize];
+
+	HostSpec base(BENCH_ADDR, BENCH_PORT);
+	inet_aton(base.addr, &base.inaddr);
+	Udp udp(std::string("transmit"), (sonata_lib::Unit) 0);
+	udp.setAddress(base.addr, base.port);
+	size_t size = DEFAULT_SND_BUFSIZE;
+	udp.setSndBufsize(size);
+
+	cout << channels << " channels, " << vectors << " vectors" << endl;
+	cout << "path\tsent\treceived\tpkts/s\tcalls/vector" << endl;
+
+	// original path: address conversion and one send per packet
+	float64_t t = 0;
+	int32_t received = 0;
+	for (int32_t v = 0; v < vectors; ++v) {
+		float64_t t0 = now();
+		for (int32_t i = 0; i < channels; ++i) {
+			ChannelPacket& p = vector[i];
+			int32_t chan = p.getHeader().chan;
+			in_addr tmp;
+			tmp.s_addr = htonl(ntohl(base.inaddr.s_addr) + chan);
+			IpAddress ipAddr;
+			strcpy(ipAddr, inet_ntoa(tmp));
+			udp.send(p.getPacket(), pktSize, ipAddr, base.port + chan);
+		}
+		t += now() - t0;
+		received += drain(rcv, buf, pktSize);
+	}
+	report("single", vectors, channels, t, (uint64_t) vectors * channels,
+			received);
+
+	// transmit engine
+	TransmitEngine engine(&udp);
+	engine.setup(base, channels);
+	t = 0;
+	received = 0;
+	for (int32_t v = 0; v < vectors; ++v) {
+		float64_t t0 = now();
+		engine.send(vector);
+		t += now() - t0;
+		received += drain(rcv, buf, pktSize);
+	}
+	report("engine", vectors, channels, t, engine.getStats().calls,
+			received);
+
+	for (int32_t i = 0; i < channels; ++i)
+		close(rcv[i]);
+	delete [] buf;
+}
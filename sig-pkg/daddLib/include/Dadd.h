@@ -37,6 +37,7 @@
 #include <iostream>
 #include <stdint.h>
 #include <stdlib.h>
+#include <vector>
 #include <sseInterface.h>
 #include "cycle.h"
 #include "DaddVersion.h"
@@ -45,6 +46,7 @@ namespace dadd {
 
 class ReportHit;
 class ReportBadBand;
+struct DaddKernel;
 
 #define DADD_TIMING			(true)
 
@@ -52,10 +54,24 @@ class ReportBadBand;
 #define DaddAssert(exp)		assert(exp)
 #define DADD_ALIGNED(add)	((((uint64_t) addr) & 0xf) == 0)
 
-typedef uint16_t DaddAccum;			// dadd accumulator
+// the accumulator width is selected at build time; 32-bit accumulators
+// do not saturate on long observations, but double the memory bandwidth
+#ifndef DADD_ACC32
+#define DADD_ACC32			(0)
+#endif
 
-const int32_t VECTOR_LEN = 8;
+#if (DADD_ACC32)
+typedef uint32_t DaddAccum;			// dadd accumulator
+const int32_t DADD_ACC_BITS = 32;
+#else
+typedef uint16_t DaddAccum;			// dadd accumulator
 const int32_t DADD_ACC_BITS = 16;
+#endif
+const DaddAccum DADD_ACC_MAX = (DaddAccum) ~0;
+
+const int32_t VECTOR_LEN = 8;		// bin granularity of rows and slices
+const int32_t DADD_BLOCK_BYTES = 512 * 1024;	// plan block, all rows
+const int32_t DADD_MIN_BLOCK_BINS = 256;	// minimum plan block width
 const int32_t NPOLS = 3;
 
 /**
@@ -74,11 +90,54 @@ enum DaddType {
 	CEDadd
 };
 
+/**
+ * Pathsum and threshold kernels.  BestKernel selects the fastest one
+ * supported by the processor.
+ */
+enum DaddKernelType {
+	ScalarKernel,
+	Sse2Kernel,
+	Avx2Kernel,
+	BestKernel
+};
+
 enum DaddSlope {
 	Positive,
 	Negative
 };
 
+/**
+ * Pathsum operation of a DADD plan.
+ */
+struct DaddOp {
+	bool single;					// single sum instead of pair sum
+	int32_t drift;					// drift argument of the sum
+	int32_t lower;					// lower row
+	int32_t upper;					// upper row
+
+	DaddOp(bool single_, int32_t drift_, int32_t lower_, int32_t upper_):
+			single(single_), drift(drift_), lower(lower_), upper(upper_) {}
+};
+
+/**
+ * Stage of a DADD plan.
+ *
+ * Description:\n
+ * 	The operations of a stage combine disjoint rows, so they may be
+ * 	performed in any order once the previous stage is complete.  A
+ * 	stage reads bins up to reach bins past the bin being summed, so
+ * 	when the stages are run a block of bins at a time each stage runs
+ * 	lead bins ahead of the last one.
+ */
+struct DaddStage {
+	int32_t first;					// first operation of the stage
+	int32_t ops;					// # of operations in the stage
+	int32_t reach;					// bins read past the bin being summed
+	int32_t lead;					// bins ahead of the last stage
+
+	DaddStage(): first(0), ops(0), reach(0), lead(0) {}
+};
+
 /**
 * Dadd path structure
 */
@@ -201,24 +260,37 @@ public:
 			int32_t threshold_, int32_t bandBins_, int32_t badBandLimit_,
 			DaddType type_ = TDDadd, bool reportBinStats_ = false);
 	void reset();
+	void setSlice(int32_t base_, int32_t bins_, int32_t width_);
 	void execute(Polarization pol, DaddSlope slope, DaddAccum *data,
 			ReportHit *reportHit);
+	void detect(Polarization pol, DaddSlope slope, DaddAccum *data,
+			ReportHit *reportHit);
+	void recordHit(const DaddPath& path, ReportHit *reportHit);
+	void countHits(int32_t bin, int32_t hits);
 	void reportBadBands(ReportBadBand *reportBadBand);
 	const DaddStatistics& getStatistics() { return (stats); }
 	const DaddTiming& getTiming() { return (timing); }
 
 	void topDown(int32_t rows, int32_t bins, DaddAccum *data);
+	void executePlan(int32_t bins, DaddAccum *data);
+	int32_t getRow(int32_t drift) { return (driftRow[drift]); }
 	void pairSum(int32_t drift, int32_t bins, DaddAccum *lower,
 			DaddAccum *upper);
 	void singleSum(int32_t drift, int32_t bins, DaddAccum *lower,
 			DaddAccum *upper);
 	void thresholdData(DaddAccum *data);
+	bool setKernel(DaddKernelType type);
+	const char *getKernelName();
 
 private:
 	bool reportBinStats;
+	const DaddKernel *kernel;			// pathsum and threshold kernels
 	int32_t accumulatorSize;
 	int32_t spectrumBins;
 	int32_t totalBins;
+	int32_t sliceBase;					// first buffer bin of the slice
+	int32_t sliceBins;					// # of bins in the slice
+	int32_t sliceWidth;					// width of a slice row in bins
 	int32_t spectra;
 	int32_t threshold;
 	int32_t nBands;						// number of bands
@@ -228,10 +300,21 @@ private:
 	DaddBand *bands;					// bands
 	DaddStatistics stats;				// stats: one pol
 	DaddTiming timing;					// timing structure
+	int32_t blockBins;					// plan block width in bins
+	std::vector<DaddOp> planOps;		// plan operations, by stage
+	std::vector<DaddStage> planStages;	// plan stages
+	std::vector<int32_t> driftRow;		// row of each drift after DADD
+	std::vector<int32_t> hitIndex;		// non-zero bins of a row
 
 	void initBands();
+	void createPlan();
+	int32_t planBlock(int32_t rows, int32_t base,
+			std::vector<std::vector<DaddOp> >& stageOps);
+	void process(Polarization pol, DaddSlope slope, DaddAccum *data,
+			ReportHit *reportHit, bool recordBands);
 	void reportHits(Polarization pol, DaddSlope slope, DaddAccum *data,
-			ReportHit *reportHit);
+			ReportHit *reportHit, bool recordBands);
+	int32_t getSliceBins();
 	void computeBinStatistics(Polarization pol, DaddAccum *data);
 	void computeHitStatistics(Polarization pol);
 	void reportBinStatistics(Polarization pol, DaddSlope slope);
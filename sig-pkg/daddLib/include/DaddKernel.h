@@ -0,0 +1,83 @@
+/*******************************************************************************
+
+ File:    DaddKernel.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+/*
+ * DaddKernel.h
+ *
+ * Pathsum, threshold and hit scan kernels.  There is a portable scalar version of
+ * each kernel, which is the reference, plus vector versions which are
+ * selected at run time according to the capabilities of the processor.
+ * All versions produce identical results.
+ */
+#ifndef _DaddKernelH
+#define _DaddKernelH
+
+#include "Dadd.h"
+
+namespace dadd {
+
+typedef void (*DaddSumFunc)(int32_t drift, int32_t bins, DaddAccum *lower,
+		DaddAccum *upper);
+typedef void (*DaddBlockFunc)(int32_t drift, int32_t bins, int32_t start,
+		int32_t end, DaddAccum *lower, DaddAccum *upper);
+typedef void (*DaddThresholdFunc)(DaddAccum *data, int32_t rows,
+		int32_t rowBins, int32_t bins, DaddAccum threshold);
+typedef int32_t (*DaddScanFunc)(const DaddAccum *row, int32_t bins,
+		int32_t *index);
+
+/**
+ * Kernel function table.
+ *
+ * Description:\n
+ * 	pairSum and singleSum combine a pair of rows as described in
+ * 	DaddSum.cpp; pairSumBlock and singleSumBlock compute only bins
+ * 	start through end - 1 of the same sums, so that a row can be
+ * 	summed a block at a time in increasing order of bin; threshold
+ * 	subtracts the threshold (with unsigned saturation) from the first
+ * 	bins of each of rows rows of rowBins bins; scan stores the index of
+ * 	each non-zero bin among the first bins of a thresholded row, in
+ * 	increasing order, and returns the number stored.
+ */
+struct DaddKernel {
+	DaddKernelType type;
+	const char *name;
+	DaddSumFunc pairSum;
+	DaddSumFunc singleSum;
+	DaddBlockFunc pairSumBlock;
+	DaddBlockFunc singleSumBlock;
+	DaddThresholdFunc threshold;
+	DaddScanFunc scan;
+};
+
+const DaddKernel *getDaddKernel(DaddKernelType type = BestKernel);
+
+}
+
+#endif
@@ -33,15 +33,17 @@
 //
 #include <fftw3.h>
 #include "Dadd.h"
+#include "DaddKernel.h"
 #include "Report.h"
 
 using std::endl;
 
 namespace dadd {
 
-Dadd::Dadd(): spectrumBins(0), totalBins(0), spectra(0),
+Dadd::Dadd(): kernel(getDaddKernel()), spectrumBins(0), totalBins(0),
+		sliceBase(0), sliceBins(0), sliceWidth(0), spectra(0),
 		threshold(0), nBands(0), bandBins(0), badBandLimit(0), type(TDDadd),
-		bands(0)
+		bands(0), blockBins(0)
 {
 }
 
@@ -49,12 +51,38 @@ Dadd::~Dadd()
 {
 }
 
+/**
+ * Select the pathsum and threshold kernels.
+ *
+ * Description:\n
+ * 	By default the fastest kernels supported by the processor are used;
+ * 	this allows a specific set of kernels to be used for testing.
+ *
+ * @param	type the type of kernel.
+ * @return	false if the kernels are not supported.
+ */
+bool
+Dadd::setKernel(DaddKernelType type)
+{
+	const DaddKernel *k = getDaddKernel(type);
+	if (!k)
+		return (false);
+	kernel = k;
+	return (true);
+}
+
+const char *
+Dadd::getKernelName()
+{
+	return (kernel->name);
+}
+
 /**
 * Set up the library for specific DADD parameters
 *
 * Description:\n
-*	Records the operating parameters and initializes recording of
-*	statistics.\n\n
+*	Records the operating parameters, creates the DADD plan for the
+*	number of spectra and initializes recording of statistics.\n\n
 * Notes:\n
 *	Must be called before initiating DADD processing for a given
 *	activity.
@@ -81,10 +109,41 @@ Dadd::setup(int32_t spectra_, int32_t spectrumBins_, int32_t totalBins_,
 	badBandLimit = badBandLimit_;
 	type = type_;
 	reportBinStats = reportBinStats_;
+	setSlice(0, spectrumBins, totalBins);
 	initBands();
+	createPlan();
 	stats.reset();
 }
 
+/**
+ * Set the slice of the spectrum contained in the detection buffer.
+ *
+ * Description:\n
+ * 	By default (after setup) the detection buffer holds the full
+ * 	spectrum.  A slice buffer holds only the buffer bins starting at
+ * 	base_, in rows width_ bins wide, and hits are searched for only in
+ * 	the first bins_ bins of each row.\n\n
+ * Notes:\n
+ * 	Bins are buffer bins, so for negative slopes the slice is taken
+ * 	from the mirror-imaged buffer.  Reported bins and band accounting
+ * 	are always relative to the full spectrum.\n
+ * 	The row width must include enough bins past the slice to hold
+ * 	the widest path starting in the slice.
+ *
+ * @param	base_ the first buffer bin of the slice.
+ * @param	bins_ the number of bins to be searched for hits.
+ * @param	width_ the width of each row of the slice buffer.
+ */
+void
+Dadd::setSlice(int32_t base_, int32_t bins_, int32_t width_)
+{
+	DaddAssert(base_ >= 0 && bins_ > 0 && width_ >= bins_);
+	DaddAssert(!(base_ % VECTOR_LEN) && !(width_ % VECTOR_LEN));
+	sliceBase = base_;
+	sliceBins = bins_;
+	sliceWidth = width_;
+}
+
 /**
  * Reset the dadd.
  *
@@ -107,7 +166,9 @@ Dadd::reset()
  * Notes:\n
  * 	There is one band array consisting of n DaddBand structures,
  * 	where n is computed by
- * 	dividing the total bandwidth in bins by the band bandwidth in bins.  The
+ * 	dividing the total bandwidth in bins by the band bandwidth in bins.
+ * 	The total bandwidth includes the overlap bins, since negative-slope
+ * 	paths can be reported there.  The
  * 	array is used to record the total number of hits for each band as well
  * 	as the maximum power path in the band.  If the number of hits in a single
  * 	band exceeds the limit, the band will be recorded as bad.\n
@@ -119,8 +180,8 @@ Dadd::reset()
 void
 Dadd::initBands()
 {
-	int32_t n = spectrumBins / bandBins;
-	if (spectrumBins % bandBins)
+	int32_t n = totalBins / bandBins;
+	if (totalBins % bandBins)
 		++n;
 	if (nBands < n && bands) {
 		fftwf_free(bands);
@@ -162,6 +223,89 @@ Dadd::initBands()
 void
 Dadd::execute(Polarization pol, DaddSlope slope, DaddAccum *data,
 		ReportHit *reportHit)
+{
+	process(pol, slope, data, reportHit, true);
+}
+
+/**
+ * Detect over-threshold paths in a buffer of data.
+ *
+ * Description:\n
+ * 	Identical to execute, except that hits are reported in the order
+ * 	they are found without any band accounting.  Used to run several
+ * 	slices in parallel; the hits are then passed to recordHit in the
+ * 	same order execute would have found them.
+ *
+ * @param	pol, the polarization of the buffer data.
+ * @param	slope, the sign of the slope.  Positive or negative.
+ * @param	data, the buffer containing the bin data.
+ * @param	reportHit, called for every over-threshold path.
+ * @see		recordHit
+ */
+void
+Dadd::detect(Polarization pol, DaddSlope slope, DaddAccum *data,
+		ReportHit *reportHit)
+{
+	process(pol, slope, data, reportHit, false);
+}
+
+/**
+ * Record a hit in its band and report it.
+ *
+ * Description:\n
+ * 	Keeps track of the maximum power path in the band of the hit and
+ * 	the number of hits in the band.  The hit is reported only if the
+ * 	band has not passed the bad band limit.
+ *
+ * @param	path, the over-threshold path.
+ * @param	reportHit, a callback called if the hit is to be reported.
+ */
+void
+Dadd::recordHit(const DaddPath& path, ReportHit *reportHit)
+{
+	int32_t i = path.bin / bandBins;
+	DaddAssert(i < nBands);
+	DaddBand& b = bands[i];
+	// keep track of the maximum power in this band; reported
+	// only if it is a bad band
+	if (path.power > b.maxPath.power)
+		b.maxPath = path;
+	// if we just passed the bad band limit, record this
+	// slice as a bad band
+	if (b.hits++ > b.limit)
+		b.bad = true;
+	else if (reportHit)
+		reportHit->report(path);
+}
+
+/**
+ * Count hits in a band without reporting them.
+ *
+ * Description:\n
+ * 	Used for hits which were dropped before being recorded, because
+ * 	they could not have been reported.  They are not considered for
+ * 	the maximum power path of the band.
+ *
+ * @param	bin, a bin in the band.
+ * @param	hits, the number of hits.
+ */
+void
+Dadd::countHits(int32_t bin, int32_t hits)
+{
+	int32_t i = bin / bandBins;
+	DaddAssert(i < nBands);
+	DaddBand& b = bands[i];
+	b.hits += hits;
+	if (b.hits > b.limit + 1)
+		b.bad = true;
+}
+
+/**
+ * Run DADD on the current slice and report the hits.
+ */
+void
+Dadd::process(Polarization pol, DaddSlope slope, DaddAccum *data,
+		ReportHit *reportHit, bool recordBands)
 {
 #if (DADD_TIMING)
 	uint64_t t0 = getticks();
@@ -172,7 +316,7 @@ Dadd::execute(Polarization pol, DaddSlope slope, DaddAccum *data,
 #if (DADD_TIMING)
 	uint64_t t1 = getticks();
 #endif
-	topDown(spectra, totalBins, data);
+	executePlan(sliceWidth, data);
 #if (DADD_TIMING)
 	uint64_t t2 = getticks();
 #endif
@@ -180,7 +324,7 @@ Dadd::execute(Polarization pol, DaddSlope slope, DaddAccum *data,
 #if (DADD_TIMING)
 	uint64_t t3 = getticks();
 #endif
-	reportHits(pol, slope, data, reportHit);
+	reportHits(pol, slope, data, reportHit, recordBands);
 #if (DADD_TIMING)
 	uint64_t t4 = getticks();
 	++timing.dadd.dadds;
@@ -192,6 +336,16 @@ Dadd::execute(Polarization pol, DaddSlope slope, DaddAccum *data,
 #endif
 }
 
+/**
+ * Get the number of bins to be searched in each row of the slice.
+ */
+int32_t
+Dadd::getSliceBins()
+{
+	int32_t bins = spectrumBins - sliceBase;
+	return (sliceBins < bins ? sliceBins : bins);
+}
+
 /**
  * Report over-threshold paths.
  *
@@ -204,58 +358,49 @@ Dadd::execute(Polarization pol, DaddSlope slope, DaddAccum *data,
  * 	band.\n
  * 	For negative-slope paths, the calculation must take into account
  * 	the fact that the data has been loaded into the buffer in mirror
- * 	image order.
- *
+ * 	image order.\n
+ * 	The non-zero bins of each row are found by the scan kernel, which
+ * 	skips blocks of bins with no hits; they are reported in the same
+ * 	order as a bin by bin search of the rows in order of drift.
  */
 void
 Dadd::reportHits(Polarization pol, DaddSlope slope, DaddAccum *data,
-		ReportHit *reportHit)
+		ReportHit *reportHit, bool recordBands)
 {
 	// scan each row
-	DaddPath maxPath;
-	for (int32_t drift = 0; drift < spectra; ++drift) {
-		int32_t row = getPosition(drift, spectra);
-
-		DaddAccum *dp = data + row * totalBins;
-		for (int32_t bin = 0; bin < spectrumBins; ++bin) {
-			if (dp[bin] && (bin + drift) < spectrumBins) {
-				int32_t power = dp[bin] + threshold;
-				// adjust bin and negate the drift
-				int32_t actualBin = 0;
-				int32_t actualDrift = 0;
-				if (slope != Negative) {
-					actualBin = bin;
-					actualDrift = drift;
-				}
-				else if (drift) {
-					// report only non-zero drift hits for negative slope
-					// bins are mirror-imaged in buffer
-					actualBin = (totalBins - 1) - bin;
-					actualDrift = -drift;
-				}
-				else
-					continue;
+	int32_t bins = getSliceBins();
+	if ((int32_t) hitIndex.size() < bins)
+		hitIndex.resize(bins);
+	// report only non-zero drift hits for negative slope
+	int32_t drift = (slope == Negative) ? 1 : 0;
+	for (; drift < spectra; ++drift) {
+		// paths must end within the spectrum
+		int32_t n = spectrumBins - sliceBase - drift;
+		if (n > bins)
+			n = bins;
+		if (n <= 0)
+			break;
+		DaddAccum *dp = data + driftRow[drift] * sliceWidth;
+		int32_t hits = kernel->scan(dp, n, &hitIndex[0]);
+		for (int32_t j = 0; j < hits; ++j) {
+			int32_t i = hitIndex[j];
+			int32_t bin = sliceBase + i;
+			int32_t power = dp[i] + threshold;
+			// adjust bin and negate the drift
+			int32_t actualBin = bin;
+			int32_t actualDrift = drift;
+			if (slope == Negative) {
+				// bins are mirror-imaged in buffer
+				actualBin = (totalBins - 1) - bin;
+				actualDrift = -drift;
+			}
 
-				if (actualBin >= 0) {
-					// keep track of the maximum power in this band; reported
-					// only if it is a bad band
-					int32_t i = actualBin / bandBins;
-					DaddBand& b = bands[i];
-					if (power > b.maxPath.power) {
-						b.maxPath.pol = pol;
-						b.maxPath.bin = actualBin;
-						b.maxPath.drift = actualDrift;
-						b.maxPath.power = power;
-					}
-					// if we just passed the bad band limit, record this
-					// slice as a bad band
-					if (b.hits++ > b.limit)
-						b.bad = true;
-					else if (reportHit) {
-						DaddPath path(pol, actualBin, actualDrift, power);
-						reportHit->report(path);
-					}
-				}
+			if (actualBin >= 0) {
+				DaddPath path(pol, actualBin, actualDrift, power);
+				if (recordBands)
+					recordHit(path, reportHit);
+				else if (reportHit)
+					reportHit->report(path);
 			}
 		}
 	}
@@ -309,9 +454,10 @@ Dadd::computeBinStatistics(Polarization pol, DaddAccum *data)
 {
 	DaddBinStatistics& b = stats.binStats;
 	b.reset();
+	int32_t bins = getSliceBins();
 	for (int32_t i = 0; i < spectra; ++i) {
-		DaddAccum *spectrum = data + i * totalBins;
-		for (int32_t j = 0; j < spectrumBins; ++j)
+		DaddAccum *spectrum = data + i * sliceWidth;
+		for (int32_t j = 0; j < bins; ++j)
 			++b.bins[spectrum[j]];
 	}
 }
@@ -0,0 +1,584 @@
+/*******************************************************************************
+
+ File:    DaddKernel.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+/*
+ * DaddKernel.cpp
+ *
+ * Pathsum, threshold and hit scan kernels.
+ *
+ * The scalar kernels define the results; the vector kernels process the
+ * bulk of each row and use the scalar kernels for the end of the row,
+ * so that all versions produce bit-identical pathsums and hits.  The
+ * scan kernels test blocks of vectors at a time, so that the bins of a
+ * quiet row cost little more than a load.  The SSE2 kernels
+ * are only available with 16-bit accumulators, since SSE2 has no
+ * saturating 32-bit add.
+ */
+#include <string.h>
+#include <immintrin.h>
+#include "DaddKernel.h"
+
+namespace dadd {
+
+namespace {
+
+#define AVX2_TARGET		__attribute__ ((target("avx2")))
+
+inline DaddAccum
+addSat(DaddAccum a, DaddAccum b)
+{
+	DaddAccum s = (DaddAccum) (a + b);
+	return (s < a ? DADD_ACC_MAX : s);
+}
+
+inline DaddAccum
+subSat(DaddAccum a, DaddAccum b)
+{
+	return (a > b ? (DaddAccum) (a - b) : 0);
+}
+
+/**
+ * Compute the start of the last vector of a pair sum.
+ *
+ * Description:\n
+ * 	The pair sum adds bin n + 1 of the upper row to bin n of the
+ * 	lower row for all vectors except the last, in which the last bin
+ * 	of the upper row is taken as zero.  The remainder of the upper row
+ * 	is a copy of the lower row.
+ */
+inline int32_t
+getPairSumLast(int32_t drift, int32_t bins)
+{
+	int32_t last = ((bins - (drift + 1)) / VECTOR_LEN) * VECTOR_LEN;
+	return (last > 0 ? last : 0);
+}
+
+/**
+ * Compute the end of the summed bins of a single sum.
+ *
+ * Description:\n
+ * 	The single sum adds the upper and lower rows up to the end of the
+ * 	last full vector, leaves the next vector of the upper row unchanged,
+ * 	and copies the lower row into the remainder of the upper row.
+ */
+inline int32_t
+getSingleSumLast(int32_t drift, int32_t bins)
+{
+	int32_t last = ((bins - drift) / VECTOR_LEN) * VECTOR_LEN;
+	return (last > 0 ? last : 0);
+}
+
+/**
+ * Scalar pair sum of bins start through end - 1.
+ */
+void
+pairSumBins(int32_t drift, int32_t bins, DaddAccum *lower, DaddAccum *upper,
+		int32_t start, int32_t end)
+{
+	int32_t rowBins = (bins / VECTOR_LEN) * VECTOR_LEN;
+	int32_t last = getPairSumLast(drift, bins) + VECTOR_LEN - 1;
+	DaddAccum *u = upper + drift;
+
+	// bins are always read before the upper row is written
+	int32_t n;
+	int32_t sumEnd = last < end ? last : end;
+	for (n = start; n < sumEnd; ++n) {
+		DaddAccum l = lower[n];
+		DaddAccum u0 = u[n];
+		DaddAccum u1 = u[n+1];
+		lower[n] = addSat(l, u0);
+		upper[n] = addSat(l, u1);
+	}
+	if (n == last && n < end) {
+		DaddAccum l = lower[n];
+		lower[n] = addSat(l, u[n]);
+		upper[n] = l;
+		++n;
+	}
+	if (end < rowBins)
+		rowBins = end;
+	if (n < rowBins)
+		memcpy(upper + n, lower + n, (rowBins - n) * sizeof(DaddAccum));
+}
+
+/**
+ * Scalar single sum of bins start through end - 1.
+ */
+void
+singleSumBins(int32_t drift, int32_t bins, DaddAccum *lower,
+		DaddAccum *upper, int32_t start, int32_t end)
+{
+	int32_t rowBins = (bins / VECTOR_LEN) * VECTOR_LEN;
+	int32_t last = getSingleSumLast(drift, bins);
+
+	int32_t n;
+	int32_t sumEnd = last < end ? last : end;
+	for (n = start; n < sumEnd; ++n)
+		upper[n] = addSat(lower[n], upper[drift+n]);
+	n = last + VECTOR_LEN;
+	if (n < start)
+		n = start;
+	if (end < rowBins)
+		rowBins = end;
+	if (n < rowBins)
+		memcpy(upper + n, lower + n, (rowBins - n) * sizeof(DaddAccum));
+}
+
+void
+thresholdBins(DaddAccum *row, int32_t start, int32_t bins,
+		DaddAccum threshold)
+{
+	for (int32_t n = start; n < bins; ++n)
+		row[n] = subSat(row[n], threshold);
+}
+
+/**
+ * Scalar scan of bins start through bins - 1, appending the non-zero
+ * bins to the hit index.
+ */
+int32_t
+scanBins(const DaddAccum *row, int32_t start, int32_t bins, int32_t *index,
+		int32_t hits)
+{
+	for (int32_t n = start; n < bins; ++n) {
+		if (row[n])
+			index[hits++] = n;
+	}
+	return (hits);
+}
+
+/**
+ * Append the non-zero bins of a vector of lanes bins to the hit index,
+ * given the byte mask of its non-zero bytes.
+ *
+ * Description:\n
+ * 	A vector with few hits is handled a hit at a time; in one with many
+ * 	hits, which is common in RFI, every bin is stored and the index
+ * 	advanced only for the hits, which avoids unpredictable branches.
+ */
+inline int32_t
+scanMask(uint32_t mask, int32_t lanes, int32_t n, int32_t *index,
+		int32_t hits)
+{
+	const uint32_t binMask = (1 << sizeof(DaddAccum)) - 1;
+	if (__builtin_popcount(mask) > 4 * (int32_t) sizeof(DaddAccum)) {
+		for (int32_t j = 0; j < lanes; ++j) {
+			index[hits] = n + j;
+			hits += (mask >> (j * sizeof(DaddAccum))) & 1;
+		}
+		return (hits);
+	}
+	while (mask) {
+		int32_t j = __builtin_ctz(mask) / sizeof(DaddAccum);
+		index[hits++] = n + j;
+		mask &= ~(binMask << (j * sizeof(DaddAccum)));
+	}
+	return (hits);
+}
+
+//
+// scalar kernels
+//
+void
+scalarPairSumBlock(int32_t drift, int32_t bins, int32_t start, int32_t end,
+		DaddAccum *lower, DaddAccum *upper)
+{
+	pairSumBins(drift, bins, lower, upper, start, end);
+}
+
+void
+scalarSingleSumBlock(int32_t drift, int32_t bins, int32_t start,
+		int32_t end, DaddAccum *lower, DaddAccum *upper)
+{
+	--drift;
+	singleSumBins(drift, bins, lower, upper, start, end);
+}
+
+void
+scalarPairSum(int32_t drift, int32_t bins, DaddAccum *lower,
+		DaddAccum *upper)
+{
+	scalarPairSumBlock(drift, bins, 0, bins, lower, upper);
+}
+
+void
+scalarSingleSum(int32_t drift, int32_t bins, DaddAccum *lower,
+		DaddAccum *upper)
+{
+	scalarSingleSumBlock(drift, bins, 0, bins, lower, upper);
+}
+
+void
+scalarThreshold(DaddAccum *data, int32_t rows, int32_t rowBins,
+		int32_t bins, DaddAccum threshold)
+{
+	for (int32_t i = 0; i < rows; ++i, data += rowBins)
+		thresholdBins(data, 0, bins, threshold);
+}
+
+int32_t
+scalarScan(const DaddAccum *row, int32_t bins, int32_t *index)
+{
+	return (scanBins(row, 0, bins, index, 0));
+}
+
+#if (!DADD_ACC32)
+//
+// SSE2 kernels: 8 16-bit bins per vector
+//
+const int32_t SSE2_LANES = 8;
+
+void
+sse2PairSumBlock(int32_t drift, int32_t bins, int32_t start, int32_t end,
+		DaddAccum *lower, DaddAccum *upper)
+{
+	int32_t last = getPairSumLast(drift, bins);
+	if (last > end)
+		last = end;
+	DaddAccum *u = upper + drift;
+
+	int32_t n;
+	for (n = start; n + SSE2_LANES <= last; n += SSE2_LANES) {
+		__m128i l = _mm_loadu_si128((const __m128i *) (lower + n));
+		__m128i u0 = _mm_loadu_si128((const __m128i *) (u + n));
+		__m128i u1 = _mm_loadu_si128((const __m128i *) (u + n + 1));
+		_mm_storeu_si128((__m128i *) (lower + n), _mm_adds_epu16(l, u0));
+		_mm_storeu_si128((__m128i *) (upper + n), _mm_adds_epu16(l, u1));
+	}
+	pairSumBins(drift, bins, lower, upper, n, end);
+}
+
+void
+sse2PairSum(int32_t drift, int32_t bins, DaddAccum *lower, DaddAccum *upper)
+{
+	sse2PairSumBlock(drift, bins, 0, bins, lower, upper);
+}
+
+void
+sse2SingleSumBlock(int32_t drift, int32_t bins, int32_t start, int32_t end,
+		DaddAccum *lower, DaddAccum *upper)
+{
+	--drift;
+	int32_t last = getSingleSumLast(drift, bins);
+	if (last > end)
+		last = end;
+	DaddAccum *u = upper + drift;
+
+	int32_t n;
+	for (n = start; n + SSE2_LANES <= last; n += SSE2_LANES) {
+		__m128i l = _mm_loadu_si128((const __m128i *) (lower + n));
+		__m128i u0 = _mm_loadu_si128((const __m128i *) (u + n));
+		_mm_storeu_si128((__m128i *) (upper + n), _mm_adds_epu16(l, u0));
+	}
+	singleSumBins(drift, bins, lower, upper, n, end);
+}
+
+void
+sse2SingleSum(int32_t drift, int32_t bins, DaddAccum *lower,
+		DaddAccum *upper)
+{
+	sse2SingleSumBlock(drift, bins, 0, bins, lower, upper);
+}
+
+void
+sse2Threshold(DaddAccum *data, int32_t rows, int32_t rowBins, int32_t bins,
+		DaddAccum threshold)
+{
+	__m128i t = _mm_set1_epi16((int16_t) threshold);
+	for (int32_t i = 0; i < rows; ++i, data += rowBins) {
+		int32_t n;
+		for (n = 0; n + SSE2_LANES <= bins; n += SSE2_LANES) {
+			__m128i *p = (__m128i *) (data + n);
+			_mm_storeu_si128(p, _mm_subs_epu16(_mm_loadu_si128(p), t));
+		}
+		thresholdBins(data, n, bins, threshold);
+	}
+}
+
+inline uint32_t
+sse2NonZero(__m128i v)
+{
+	return (~_mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_setzero_si128()))
+			& 0xffff);
+}
+
+inline int32_t
+sse2ScanVector(__m128i v, int32_t n, int32_t *index, int32_t hits)
+{
+	return (scanMask(sse2NonZero(v), SSE2_LANES, n, index, hits));
+}
+
+int32_t
+sse2Scan(const DaddAccum *row, int32_t bins, int32_t *index)
+{
+	const __m128i *p = (const __m128i *) row;
+	int32_t hits = 0;
+	int32_t n;
+	// skip blocks of 4 vectors which have no hits
+	for (n = 0; n + 4 * SSE2_LANES <= bins; n += 4 * SSE2_LANES, p += 4) {
+		__m128i v0 = _mm_loadu_si128(p);
+		__m128i v1 = _mm_loadu_si128(p + 1);
+		__m128i v2 = _mm_loadu_si128(p + 2);
+		__m128i v3 = _mm_loadu_si128(p + 3);
+		if (!sse2NonZero(_mm_or_si128(_mm_or_si128(v0, v1),
+				_mm_or_si128(v2, v3))))
+			continue;
+		hits = sse2ScanVector(v0, n, index, hits);
+		hits = sse2ScanVector(v1, n + SSE2_LANES, index, hits);
+		hits = sse2ScanVector(v2, n + 2 * SSE2_LANES, index, hits);
+		hits = sse2ScanVector(v3, n + 3 * SSE2_LANES, index, hits);
+	}
+	for (; n + SSE2_LANES <= bins; n += SSE2_LANES, ++p)
+		hits = sse2ScanVector(_mm_loadu_si128(p), n, index, hits);
+	return (scanBins(row, n, bins, index, hits));
+}
+#endif
+
+//
+// AVX2 kernels: 16 16-bit or 8 32-bit bins per vector
+//
+#if (DADD_ACC32)
+const int32_t AVX2_LANES = 8;
+
+AVX2_TARGET inline __m256i
+avx2AddSat(__m256i a, __m256i b)
+{
+	// the sum overflowed if it is less than an operand
+	__m256i s = _mm256_add_epi32(a, b);
+	__m256i ok = _mm256_cmpeq_epi32(_mm256_max_epu32(s, a), s);
+	return (_mm256_or_si256(s,
+			_mm256_xor_si256(ok, _mm256_set1_epi32(-1))));
+}
+
+AVX2_TARGET inline __m256i
+avx2SubSat(__m256i a, __m256i b)
+{
+	return (_mm256_sub_epi32(_mm256_max_epu32(a, b), b));
+}
+
+AVX2_TARGET inline __m256i
+avx2Set(DaddAccum val)
+{
+	return (_mm256_set1_epi32((int32_t) val));
+}
+
+AVX2_TARGET inline __m256i
+avx2IsZero(__m256i a)
+{
+	return (_mm256_cmpeq_epi32(a, _mm256_setzero_si256()));
+}
+#else
+const int32_t AVX2_LANES = 16;
+
+AVX2_TARGET inline __m256i
+avx2AddSat(__m256i a, __m256i b)
+{
+	return (_mm256_adds_epu16(a, b));
+}
+
+AVX2_TARGET inline __m256i
+avx2SubSat(__m256i a, __m256i b)
+{
+	return (_mm256_subs_epu16(a, b));
+}
+
+AVX2_TARGET inline __m256i
+avx2Set(DaddAccum val)
+{
+	return (_mm256_set1_epi16((int16_t) val));
+}
+
+AVX2_TARGET inline __m256i
+avx2IsZero(__m256i a)
+{
+	return (_mm256_cmpeq_epi16(a, _mm256_setzero_si256()));
+}
+#endif
+
+AVX2_TARGET void
+avx2PairSumBlock(int32_t drift, int32_t bins, int32_t start, int32_t end,
+		DaddAccum *lower, DaddAccum *upper)
+{
+	int32_t last = getPairSumLast(drift, bins);
+	if (last > end)
+		last = end;
+	DaddAccum *u = upper + drift;
+
+	int32_t n;
+	for (n = start; n + AVX2_LANES <= last; n += AVX2_LANES) {
+		__m256i l = _mm256_loadu_si256((const __m256i *) (lower + n));
+		__m256i u0 = _mm256_loadu_si256((const __m256i *) (u + n));
+		__m256i u1 = _mm256_loadu_si256((const __m256i *) (u + n + 1));
+		_mm256_storeu_si256((__m256i *) (lower + n), avx2AddSat(l, u0));
+		_mm256_storeu_si256((__m256i *) (upper + n), avx2AddSat(l, u1));
+	}
+	pairSumBins(drift, bins, lower, upper, n, end);
+}
+
+AVX2_TARGET void
+avx2PairSum(int32_t drift, int32_t bins, DaddAccum *lower, DaddAccum *upper)
+{
+	avx2PairSumBlock(drift, bins, 0, bins, lower, upper);
+}
+
+AVX2_TARGET void
+avx2SingleSumBlock(int32_t drift, int32_t bins, int32_t start, int32_t end,
+		DaddAccum *lower, DaddAccum *upper)
+{
+	--drift;
+	int32_t last = getSingleSumLast(drift, bins);
+	if (last > end)
+		last = end;
+	DaddAccum *u = upper + drift;
+
+	int32_t n;
+	for (n = start; n + AVX2_LANES <= last; n += AVX2_LANES) {
+		__m256i l = _mm256_loadu_si256((const __m256i *) (lower + n));
+		__m256i u0 = _mm256_loadu_si256((const __m256i *) (u + n));
+		_mm256_storeu_si256((__m256i *) (upper + n), avx2AddSat(l, u0));
+	}
+	singleSumBins(drift, bins, lower, upper, n, end);
+}
+
+AVX2_TARGET void
+avx2SingleSum(int32_t drift, int32_t bins, DaddAccum *lower,
+		DaddAccum *upper)
+{
+	avx2SingleSumBlock(drift, bins, 0, bins, lower, upper);
+}
+
+AVX2_TARGET void
+avx2Threshold(DaddAccum *data, int32_t rows, int32_t rowBins, int32_t bins,
+		DaddAccum threshold)
+{
+	__m256i t = avx2Set(threshold);
+	for (int32_t i = 0; i < rows; ++i, data += rowBins) {
+		int32_t n;
+		for (n = 0; n + AVX2_LANES <= bins; n += AVX2_LANES) {
+			__m256i *p = (__m256i *) (data + n);
+			_mm256_storeu_si256(p, avx2SubSat(_mm256_loadu_si256(p), t));
+		}
+		thresholdBins(data, n, bins, threshold);
+	}
+}
+
+AVX2_TARGET inline uint32_t
+avx2NonZero(__m256i v)
+{
+	return (~_mm256_movemask_epi8(avx2IsZero(v)));
+}
+
+AVX2_TARGET inline int32_t
+avx2ScanVector(__m256i v, int32_t n, int32_t *index, int32_t hits)
+{
+	return (scanMask(avx2NonZero(v), AVX2_LANES, n, index, hits));
+}
+
+AVX2_TARGET int32_t
+avx2Scan(const DaddAccum *row, int32_t bins, int32_t *index)
+{
+	const __m256i *p = (const __m256i *) row;
+	int32_t hits = 0;
+	int32_t n;
+	// skip blocks of 4 vectors which have no hits
+	for (n = 0; n + 4 * AVX2_LANES <= bins; n += 4 * AVX2_LANES, p += 4) {
+		__m256i v0 = _mm256_loadu_si256(p);
+		__m256i v1 = _mm256_loadu_si256(p + 1);
+		__m256i v2 = _mm256_loadu_si256(p + 2);
+		__m256i v3 = _mm256_loadu_si256(p + 3);
+		__m256i any = _mm256_or_si256(_mm256_or_si256(v0, v1),
+				_mm256_or_si256(v2, v3));
+		if (_mm256_testz_si256(any, any))
+			continue;
+		hits = avx2ScanVector(v0, n, index, hits);
+		hits = avx2ScanVector(v1, n + AVX2_LANES, index, hits);
+		hits = avx2ScanVector(v2, n + 2 * AVX2_LANES, index, hits);
+		hits = avx2ScanVector(v3, n + 3 * AVX2_LANES, index, hits);
+	}
+	for (; n + AVX2_LANES <= bins; n += AVX2_LANES, ++p)
+		hits = avx2ScanVector(_mm256_loadu_si256(p), n, index, hits);
+	return (scanBins(row, n, bins, index, hits));
+}
+
+// kernels in order of increasing preference
+const DaddKernel kernels[] = {
+	{ ScalarKernel, "scalar", scalarPairSum, scalarSingleSum,
+			scalarPairSumBlock, scalarSingleSumBlock, scalarThreshold,
+			scalarScan },
+#if (!DADD_ACC32)
+	{ Sse2Kernel, "sse2", sse2PairSum, sse2SingleSum, sse2PairSumBlock,
+			sse2SingleSumBlock, sse2Threshold, sse2Scan },
+#endif
+	{ Avx2Kernel, "avx2", avx2PairSum, avx2SingleSum, avx2PairSumBlock,
+			avx2SingleSumBlock, avx2Threshold, avx2Scan }
+};
+
+const int32_t KERNELS = sizeof(kernels) / sizeof(kernels[0]);
+
+bool
+isSupported(DaddKernelType type)
+{
+	__builtin_cpu_init();
+	switch (type) {
+	case Sse2Kernel:
+		return (__builtin_cpu_supports("sse2"));
+	case Avx2Kernel:
+		return (__builtin_cpu_supports("avx2"));
+	default:
+		return (true);
+	}
+}
+
+}
+
+/**
+ * Get a set of kernels.
+ *
+ * Description:\n
+ * 	Returns the kernels of the specified type, or the fastest kernels
+ * 	supported by the processor if type is BestKernel.\n\n
+ * Notes:\n
+ * 	Returns 0 if the kernels are not supported by the processor or are
+ * 	not available for the accumulator size.
+ *
+ * @param	type the type of kernel.
+ */
+const DaddKernel *
+getDaddKernel(DaddKernelType type)
+{
+	for (int32_t i = KERNELS - 1; i >= 0; --i) {
+		const DaddKernel *k = &kernels[i];
+		if ((type == BestKernel || k->type == type) && isSupported(k->type))
+			return (k);
+	}
+	return (0);
+}
+
+}
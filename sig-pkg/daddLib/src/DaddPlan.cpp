@@ -0,0 +1,182 @@
+/*******************************************************************************
+
+ File:    DaddPlan.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+//
+// DADD execution plan
+//
+// The top down DADD is a tree of pathsum operations which depends only
+// upon the number of spectra.  The plan flattens the tree at setup into
+// a list of operations, grouped into stages by their height in the tree,
+// so that executing DADD needs neither recursion nor the row position
+// calculation.  The stages are then run a block of bins at a time, so
+// that the rows of a block stay in the cache from one stage to the next
+// instead of every stage streaming the whole buffer through memory.
+//
+#include <algorithm>
+#include "Dadd.h"
+#include "DaddKernel.h"
+
+using std::vector;
+
+namespace dadd {
+
+/**
+ * Create the DADD plan for the current number of spectra.
+ *
+ * Description:\n
+ * 	Builds the list of operations performed by topDown for the number
+ * 	of spectra, grouped into stages, and records the row which holds
+ * 	the paths of each drift after DADD.\n\n
+ * Notes:\n
+ * 	The lead of each stage is the sum of the reaches of the stages
+ * 	after it, rounded up to a whole vector, so that a stage never
+ * 	reads a bin the previous stage has not yet summed.  The block
+ * 	width is chosen so that a block of all the rows fits in the
+ * 	second-level cache.
+ */
+void
+Dadd::createPlan()
+{
+	vector<vector<DaddOp> > stageOps;
+	planBlock(spectra, 0, stageOps);
+
+	planOps.clear();
+	planStages.resize(stageOps.size());
+	for (uint32_t i = 0; i < stageOps.size(); ++i) {
+		DaddStage& stage = planStages[i];
+		stage.first = planOps.size();
+		stage.ops = stageOps[i].size();
+		stage.reach = 0;
+		for (int32_t j = 0; j < stage.ops; ++j) {
+			const DaddOp& op = stageOps[i][j];
+			int32_t reach = op.single ? op.drift - 1 : op.drift + 1;
+			stage.reach = std::max(stage.reach, reach);
+			planOps.push_back(op);
+		}
+	}
+	int32_t lead = 0;
+	for (int32_t i = (int32_t) planStages.size() - 1; i >= 0; --i) {
+		planStages[i].lead = lead;
+		lead += planStages[i].reach + VECTOR_LEN - 1;
+		lead -= lead % VECTOR_LEN;
+	}
+
+	driftRow.resize(spectra);
+	for (int32_t i = 0; i < spectra; ++i)
+		driftRow[i] = getPosition(i, spectra);
+
+	blockBins = 0;
+	if (spectra)
+		blockBins = DADD_BLOCK_BYTES / (spectra * sizeof(DaddAccum));
+	blockBins -= blockBins % VECTOR_LEN;
+	blockBins = std::max(blockBins, DADD_MIN_BLOCK_BINS);
+}
+
+/**
+ * Add the operations of a block of rows to the plan.
+ *
+ * Description:\n
+ * 	Mirrors the recursion of topDown: the subblocks are planned first,
+ * 	then the operations which combine them are added to the stage
+ * 	above the higher of the two subblocks, in the order topDown
+ * 	performs them.
+ *
+ * @param	rows the number of rows in the block.
+ * @param	base the first row of the block.
+ * @param	stageOps the operations of each stage.
+ * @return	the height of the block, which is the number of stages
+ * 			needed to complete it.
+ */
+int32_t
+Dadd::planBlock(int32_t rows, int32_t base, vector<vector<DaddOp> >& stageOps)
+{
+	if (rows <= 1)
+		return (0);
+
+	// if blocks are unequal, upper one is bigger
+	int32_t lowerRows = rows / 2;
+	int32_t upperRows = rows - lowerRows;
+	int32_t height = std::max(planBlock(lowerRows, base, stageOps),
+			planBlock(upperRows, base + lowerRows, stageOps)) + 1;
+	if ((int32_t) stageOps.size() < height)
+		stageOps.resize(height);
+
+	vector<DaddOp>& ops = stageOps[height-1];
+	if (upperRows > lowerRows) {
+		ops.push_back(DaddOp(true, upperRows, base + lowerRows - 1,
+				base + rows - 1));
+	}
+	for (int32_t i = 0; i < lowerRows; ++i) {
+		ops.push_back(DaddOp(false, i, base + getPosition(i, lowerRows),
+				base + lowerRows + getPosition(i, upperRows)));
+	}
+	return (height);
+}
+
+/**
+ * Compute DADD on an array of power bins using the plan.
+ *
+ * Description:\n
+ * 	Produces exactly the same pathsums as topDown for the number of
+ * 	spectra specified at setup.  The bins of each row are processed
+ * 	in blocks; for each block every stage is run in turn over its
+ * 	range of bins, which is offset from the block by the lead of the
+ * 	stage.
+ *
+ * @param	bins the width of each spectrum; includes any overlap region.
+ * @param	data the array (2D) containing the data.
+ */
+void
+Dadd::executePlan(int32_t bins, DaddAccum *data)
+{
+	int32_t stages = planStages.size();
+	if (!stages)
+		return;
+
+	for (int32_t block = 0; ; block += blockBins) {
+		for (int32_t i = 0; i < stages; ++i) {
+			const DaddStage& stage = planStages[i];
+			int32_t start = block ? std::min(block + stage.lead, bins) : 0;
+			int32_t end = std::min(block + blockBins + stage.lead, bins);
+			if (start >= end)
+				continue;
+			const DaddOp *op = &planOps[stage.first];
+			for (int32_t j = 0; j < stage.ops; ++j, ++op) {
+				DaddBlockFunc sum = op->single ? kernel->singleSumBlock
+						: kernel->pairSumBlock;
+				sum(op->drift, bins, start, end, data + op->lower * bins,
+						data + op->upper * bins);
+			}
+		}
+		if (block + blockBins >= bins)
+			break;
+	}
+}
+
+}
@@ -35,6 +35,7 @@
  *      Author: kes
  */
 #include "Dadd.h"
+#include "DaddKernel.h"
 
 namespace dadd {
 
@@ -46,7 +47,8 @@ namespace dadd {
  * 	drift 2k sum is stored in the lower block, while the drift 2k+1 sum
  *  is stored in the upper block, shifted by one bin.\n
  * Notes:\n
- * 	The adds are performed using vector operations, 4 bins at a time.\n
+ * 	The adds are performed by the selected kernel, using unsigned
+ * 	saturating adds.\n
  *
  * @param	drift the number of bins of accumulated drift for the two rows.
  * @param	bins the number of bins in a row.
@@ -59,45 +61,7 @@ Dadd::pairSum(int32_t drift, int32_t bins, DaddAccum *lower, DaddAccum *upper)
 #if (DADD_TIMING)
 	uint64_t t0 = getticks();
 #endif
-	int32_t rowLen = bins / VECTOR_LEN;
-	int32_t usableLen = (bins - (drift + 1)) / VECTOR_LEN;
-
-	// pointers to the row data
-	v8wu *lrw = (v8wu *) lower;
-	v8wu *uw = (v8wu *) upper;
-	v8wu *ur = (v8wu*) (upper + drift);
-
-	// load upper(n) before entering the loop
-	register v8wu l, ul, uh, u1;
-	ul = (v8wu) __builtin_ia32_loaddqu((const char *) &ur[0]);
-
-	// main loop
-	int32_t i;
-	for (i = 0; i < usableLen; ++i) {
-		// get lower[n]
-		l = lrw[i];
-		// get drift 2k
-		lrw[i] = (v8wu) __builtin_ia32_paddusw128((v8wi) l, (v8wi) ul);
-
-		u1 = uh = (v8wu) __builtin_ia32_loaddqu((const char *) &ur[i+1]);
-		ul = (v8wu) __builtin_ia32_psrldqi128((v2di) ul, 2 * 8);
-		u1 = (v8wu) __builtin_ia32_pslldqi128((v2di) u1, 14 * 8);
-		ul = (v8wu) __builtin_ia32_paddusw128((v8wi) ul, (v8wi) u1);
-		uw[i] = (v8wu) __builtin_ia32_paddusw128((v8wi) l, (v8wi) ul);
-
-		// upper[n+1] becomes upper[n] for next iteration
-		ul = uh;
-	}
-	// do last pair of adds; upper(n+1) = 0 since it lies outside the array.
-	l = lrw[i];
-	lrw[i] = (v8wu) __builtin_ia32_paddusw128((v8wi) l, (v8wi) ul);
-	ul = (v8wu) __builtin_ia32_psrldqi128((v2di) ul, 2 * 8);
-	uw[i] = (v8wu) __builtin_ia32_paddusw128((v8wi) l, (v8wi) ul);
-
-	// now just copy the remainder of lower row to empty bins in
-	// upper row
-	while (++i < rowLen)
-		uw[i] = lrw[i];
+	kernel->pairSum(drift, bins, lower, upper);
 #if (DADD_TIMING)
 	uint64_t t1 = getticks();
 	++timing.sum.pairSums;
@@ -127,26 +91,7 @@ void
 Dadd::singleSum(int32_t drift, int32_t bins, DaddAccum *lower,
         DaddAccum *upper)
 {
-	--drift;
-	int32_t rowLen = bins / VECTOR_LEN;
-	int32_t usableLen = (bins - drift) / VECTOR_LEN;
-
-	v8wu *lrw = (v8wu *) lower;
-	v8wu *uw = (v8wu *) upper;
-	v8wu *ur = (v8wu *) (upper + drift);
-
-	// load upper [n] before entering loop
-	register v8wu ul;
-	ul = (v8wu) __builtin_ia32_loaddqu((const char *) &ur[0]);
-
-	int32_t i;
-	for (i = 0; i < usableLen; ++i)
-		uw[i] = (v8wu) __builtin_ia32_paddusw128((v8wi) lrw[i], (v8wi) ur[i]);
-
-	// now just copy the remainder of lower row to empty bins in
-	// upper row
-	while (++i < rowLen)
-		uw[i] = lrw[i];
+	kernel->singleSum(drift, bins, lower, upper);
 }
 
 }
\ No newline at end of file
@@ -36,6 +36,7 @@
  */
 
 #include "Dadd.h"
+#include "DaddKernel.h"
 
 namespace dadd {
 
@@ -52,17 +53,11 @@ namespace dadd {
 void
 Dadd::thresholdData(DaddAccum *data)
 {
-	uint16_t thr = (uint16_t) threshold;
-	v8wu tv = (v8wu) { thr, thr, thr, thr, thr, thr, thr, thr};
-	DaddAssert(!(spectrumBins % VECTOR_LEN));
-	DaddAssert(!(totalBins % VECTOR_LEN));
-	int32_t rowLen = totalBins / VECTOR_LEN;
-	int32_t usableLen = spectrumBins / VECTOR_LEN;
-	v8wu *dp = (v8wu *) data;
-	for (int32_t i = 0; i < spectra; ++i, dp += rowLen) {
-		for (int32_t j = 0; j < usableLen; ++j)
-			dp[j] = (v8wu) __builtin_ia32_psubusw128((v8wi) dp[j], (v8wi) tv);
-	}
+	DaddAccum thr = (DaddAccum) threshold;
+	int32_t bins = getSliceBins();
+	DaddAssert(!(bins % VECTOR_LEN));
+	DaddAssert(!(sliceWidth % VECTOR_LEN));
+	kernel->threshold(data, spectra, sliceWidth, bins, thr);
 }
 
 }
\ No newline at end of file
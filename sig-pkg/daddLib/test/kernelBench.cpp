@@ -0,0 +1,132 @@
+/*******************************************************************************
+
+ File:    kernelBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Kernel benchmark: reports the cost of each pathsum and threshold
+// kernel supported by the processor, in cycles per bin per row.
+//
+#include <fftw3.h>
+#include <iostream>
+#include <string.h>
+#include "Dadd.h"
+#include "DaddKernel.h"
+
+using namespace dadd;
+using std::cout;
+using std::endl;
+
+const int32_t TEST_ROWS = 128;
+const int32_t TEST_BINS = 65536;
+const int32_t TOTAL_BINS = TEST_BINS + TEST_ROWS;
+const int32_t THRESHOLD = 200;
+const int32_t BAND_BINS = 768;
+const int32_t BAD_BAND_LIMIT = 100;
+const int32_t PASSES = 4;
+
+void
+initArray(DaddAccum *data)
+{
+	for (int32_t i = 0; i < TEST_ROWS; ++i) {
+		DaddAccum *dp = data + i * TOTAL_BINS;
+		int32_t j;
+		for (j = 0; j < TEST_BINS; ++j)
+			dp[j] = (DaddAccum) ((j * 7 + i) & 3);
+		memset(dp + j, 0, TEST_ROWS * sizeof(DaddAccum));
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	size_t size = (TEST_ROWS * TOTAL_BINS + 2 * VECTOR_LEN)
+			* sizeof(DaddAccum);
+	DaddAccum *array = static_cast<DaddAccum *> (fftwf_malloc(size));
+	memset(array, 0, size);
+	float64_t rowBins = (float64_t) TEST_ROWS * TOTAL_BINS;
+
+	cout << DADD_ACC_BITS << "-bit accumulators, " << TEST_ROWS
+			<< " rows, " << TOTAL_BINS << " bins, cycles per bin per row"
+			<< endl;
+	cout << "kernel\tpairSum\tsingleSum\tthreshold\ttopDown\tDADD" << endl;
+
+	DaddKernelType types[] = { ScalarKernel, Sse2Kernel, Avx2Kernel };
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const DaddKernel *k = getDaddKernel(types[t]);
+		if (!k)
+			continue;
+		Dadd dadd;
+		dadd.setKernel(types[t]);
+		dadd.setup(TEST_ROWS, TEST_BINS, TOTAL_BINS, THRESHOLD, BAND_BINS,
+				BAD_BAND_LIMIT);
+
+		float64_t pair = 0, single = 0, thresh = 0, topDown = 0, full = 0;
+		for (int32_t p = 0; p < PASSES; ++p) {
+			// pair and single sums of every row pair
+			initArray(array);
+			uint64_t t0 = getticks();
+			for (int32_t i = 0; i < TEST_ROWS / 2; ++i) {
+				k->pairSum(i, TOTAL_BINS, array + 2 * i * TOTAL_BINS,
+						array + (2 * i + 1) * TOTAL_BINS);
+			}
+			uint64_t t1 = getticks();
+			pair += elapsed(t1, t0) / rowBins;
+
+			initArray(array);
+			t0 = getticks();
+			for (int32_t i = 0; i < TEST_ROWS / 2; ++i) {
+				k->singleSum(i + 1, TOTAL_BINS, array + 2 * i * TOTAL_BINS,
+						array + (2 * i + 1) * TOTAL_BINS);
+			}
+			t1 = getticks();
+			single += elapsed(t1, t0) / rowBins;
+
+			t0 = getticks();
+			k->threshold(array, TEST_ROWS, TOTAL_BINS, TEST_BINS, THRESHOLD);
+			t1 = getticks();
+			thresh += elapsed(t1, t0) / rowBins;
+
+			initArray(array);
+			t0 = getticks();
+			dadd.topDown(TEST_ROWS, TOTAL_BINS, array);
+			t1 = getticks();
+			topDown += elapsed(t1, t0) / rowBins;
+
+			initArray(array);
+			t0 = getticks();
+			dadd.execute(POL_RIGHTCIRCULAR, Positive, array, 0);
+			t1 = getticks();
+			full += elapsed(t1, t0) / rowBins;
+		}
+		cout << k->name << "\t" << pair / PASSES << "\t" << single / PASSES
+				<< "\t" << thresh / PASSES << "\t" << topDown / PASSES
+				<< "\t" << full / PASSES << endl;
+	}
+	fftwf_free(array);
+}
@@ -0,0 +1,193 @@
+/*******************************************************************************
+
+ File:    kernelTest.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Kernel test: checks that every pathsum and threshold kernel supported
+// by the processor produces exactly the same results as the scalar
+// reference kernels, including saturation and the ends of the rows.
+// Returns a non-zero exit status on failure.
+//
+#include <fftw3.h>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include "Dadd.h"
+#include "DaddKernel.h"
+#include "Report.h"
+
+using namespace dadd;
+using std::cout;
+using std::endl;
+
+const int32_t MAX_BINS = 1024;
+const int32_t SLACK = 64;					// bins read past the last row
+const int32_t ROWS = 64;
+const int32_t DADD_BINS = 1536;
+const int32_t SEED = 1;
+
+/**
+ * Collect the hits of a full DADD.
+ */
+class HitSum: public ReportHit {
+public:
+	HitSum(): hits(0), sum(0) {}
+	virtual void report(const DaddPath& path) {
+		++hits;
+		sum = sum * 31 + path.bin * 7 + path.drift * 3 + path.power;
+	}
+
+	int32_t hits;
+	uint64_t sum;
+};
+
+void
+fillRandom(DaddAccum *data, int32_t n, bool saturate)
+{
+	for (int32_t i = 0; i < n; ++i) {
+		if (saturate)
+			data[i] = (DaddAccum) (DADD_ACC_MAX - (rand() & 0xff));
+		else
+			data[i] = (DaddAccum) (rand() & 0x3ff);
+	}
+}
+
+/**
+ * Compare a pair of kernels on a pair of rows.
+ */
+bool
+testSum(const DaddKernel *ref, const DaddKernel *k, bool single,
+		int32_t drift, int32_t bins, bool saturate)
+{
+	int32_t n = 2 * bins + SLACK;
+	DaddAccum *a = new DaddAccum[n];
+	DaddAccum *b = new DaddAccum[n];
+	fillRandom(a, n, saturate);
+	memcpy(b, a, n * sizeof(DaddAccum));
+	if (single) {
+		ref->singleSum(drift, bins, a, a + bins);
+		k->singleSum(drift, bins, b, b + bins);
+	}
+	else {
+		ref->pairSum(drift, bins, a, a + bins);
+		k->pairSum(drift, bins, b, b + bins);
+	}
+	bool ok = !memcmp(a, b, n * sizeof(DaddAccum));
+	if (!ok) {
+		cout << k->name << (single ? " singleSum" : " pairSum")
+				<< " mismatch, drift " << drift << ", bins " << bins
+				<< (saturate ? ", saturated" : "") << endl;
+	}
+	delete [] a;
+	delete [] b;
+	return (ok);
+}
+
+bool
+testThreshold(const DaddKernel *ref, const DaddKernel *k, int32_t bins)
+{
+	int32_t rows = 4, rowBins = bins + 2 * VECTOR_LEN;
+	int32_t n = rows * rowBins;
+	DaddAccum *a = new DaddAccum[n];
+	DaddAccum *b = new DaddAccum[n];
+	fillRandom(a, n, false);
+	memcpy(b, a, n * sizeof(DaddAccum));
+	ref->threshold(a, rows, rowBins, bins, 500);
+	k->threshold(b, rows, rowBins, bins, 500);
+	bool ok = !memcmp(a, b, n * sizeof(DaddAccum));
+	if (!ok)
+		cout << k->name << " threshold mismatch, bins " << bins << endl;
+	delete [] a;
+	delete [] b;
+	return (ok);
+}
+
+/**
+ * Run a full DADD with a kernel, returning the hits.
+ */
+HitSum
+runDadd(DaddKernelType type, const DaddAccum *input, int32_t rowBins)
+{
+	size_t size = (ROWS * rowBins + SLACK) * sizeof(DaddAccum);
+	DaddAccum *data = static_cast<DaddAccum *> (fftwf_malloc(size));
+	memcpy(data, input, size);
+	Dadd dadd;
+	dadd.setKernel(type);
+	dadd.setup(ROWS, DADD_BINS, rowBins, ROWS * 7 / 4, 256, 1000000);
+	HitSum hitSum;
+	dadd.execute(POL_RIGHTCIRCULAR, Positive, data, &hitSum);
+	fftwf_free(data);
+	return (hitSum);
+}
+
+int
+main(int argc, char **argv)
+{
+	const DaddKernel *ref = getDaddKernel(ScalarKernel);
+	DaddKernelType types[] = { Sse2Kernel, Avx2Kernel };
+	int32_t failures = 0;
+
+	srand(SEED);
+	int32_t rowBins = DADD_BINS + ROWS;
+	size_t size = ROWS * rowBins + SLACK;
+	DaddAccum *input = new DaddAccum[size];
+	for (size_t i = 0; i < size; ++i)
+		input[i] = (DaddAccum) (rand() & 3);
+	HitSum refHits = runDadd(ScalarKernel, input, rowBins);
+
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const DaddKernel *k = getDaddKernel(types[t]);
+		if (!k) {
+			cout << "kernel type " << types[t] << " not supported" << endl;
+			continue;
+		}
+		int32_t errors = 0;
+		for (int32_t bins = VECTOR_LEN; bins <= MAX_BINS; bins += 3 * VECTOR_LEN) {
+			for (int32_t drift = 0; drift < bins + VECTOR_LEN; ++drift) {
+				for (int32_t s = 0; s < 2; ++s) {
+					errors += !testSum(ref, k, false, drift, bins, s);
+					if (drift)
+						errors += !testSum(ref, k, true, drift, bins, s);
+				}
+			}
+			errors += !testThreshold(ref, k, bins);
+		}
+		HitSum hits = runDadd(types[t], input, rowBins);
+		if (hits.hits != refHits.hits || hits.sum != refHits.sum) {
+			cout << k->name << " DADD hits differ" << endl;
+			++errors;
+		}
+		cout << k->name << ": " << (errors ? "FAILED" : "OK") << ", "
+				<< DADD_ACC_BITS << "-bit accumulators, " << hits.hits
+				<< " DADD hits" << endl;
+		failures += errors;
+	}
+	delete [] input;
+	return (failures ? 1 : 0);
+}
@@ -0,0 +1,98 @@
+/*******************************************************************************
+
+ File:    planBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+//
+// Plan benchmark: compares the recursive top down DADD with the DADD
+// plan for power of 2 and non-power of 2 numbers of spectra, in cycles
+// per bin per row, using the fastest kernel supported by the processor.
+//
+#include <fftw3.h>
+#include <iostream>
+#include <string.h>
+#include "Dadd.h"
+
+using namespace dadd;
+using std::cout;
+using std::endl;
+
+const int32_t TEST_BINS = 65536;
+const int32_t THRESHOLD = 200;
+const int32_t BAND_BINS = 768;
+const int32_t BAD_BAND_LIMIT = 100;
+const int32_t PASSES = 4;
+
+void
+initArray(DaddAccum *data, int32_t rows, int32_t rowBins)
+{
+	for (int32_t i = 0; i < rows; ++i) {
+		DaddAccum *dp = data + i * rowBins;
+		for (int32_t j = 0; j < rowBins; ++j)
+			dp[j] = (DaddAccum) ((j * 7 + i) & 3);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	const int32_t spectra[] = { 16, 48, 64, 96, 100, 128, 192, 255, 256 };
+
+	cout << DADD_ACC_BITS << "-bit accumulators, " << TEST_BINS
+			<< " bins, cycles per bin per row" << endl;
+	cout << "spectra\ttopDown\tplan" << endl;
+	for (uint32_t s = 0; s < sizeof(spectra) / sizeof(spectra[0]); ++s) {
+		int32_t rows = spectra[s];
+		int32_t rowBins = TEST_BINS + rows + VECTOR_LEN - 1;
+		rowBins -= rowBins % VECTOR_LEN;
+		size_t size = (rows * rowBins + 2 * VECTOR_LEN) * sizeof(DaddAccum);
+		DaddAccum *array = static_cast<DaddAccum *> (fftwf_malloc(size));
+		memset(array, 0, size);
+		float64_t rowBinCount = (float64_t) rows * rowBins;
+
+		Dadd dadd;
+		dadd.setup(rows, TEST_BINS, rowBins, THRESHOLD, BAND_BINS,
+				BAD_BAND_LIMIT);
+		float64_t topDown = 0, plan = 0;
+		for (int32_t p = 0; p < PASSES; ++p) {
+			initArray(array, rows, rowBins);
+			uint64_t t0 = getticks();
+			dadd.topDown(rows, rowBins, array);
+			uint64_t t1 = getticks();
+			topDown += elapsed(t1, t0) / rowBinCount;
+
+			initArray(array, rows, rowBins);
+			t0 = getticks();
+			dadd.executePlan(rowBins, array);
+			t1 = getticks();
+			plan += elapsed(t1, t0) / rowBinCount;
+		}
+		cout << rows << "\t" << topDown / PASSES << "\t" << plan / PASSES
+				<< endl;
+		fftwf_free(array);
+	}
+}
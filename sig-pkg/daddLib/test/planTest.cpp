@@ -0,0 +1,133 @@
+/*******************************************************************************
+
+ File:    planTest.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+//
+// Plan test: checks that the DADD plan produces exactly the same pathsums
+// as the recursive top down DADD, for power of 2 and non-power of 2
+// numbers of spectra, with every kernel supported by the processor and
+// rows both narrower and much wider than a plan block.
+// Returns a non-zero exit status on failure.
+//
+#include <fftw3.h>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include "Dadd.h"
+#include "DaddKernel.h"
+
+using namespace dadd;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t SLACK = 64;					// bins read past the last row
+const int32_t THRESHOLD = 100;
+const int32_t BAND_BINS = 256;
+const int32_t BAD_BAND_LIMIT = 1000000;
+const int32_t SEED = 1;
+
+/**
+ * Compare the plan with topDown.
+ *
+ * Description:\n
+ * 	Only the bins whose paths lie entirely within the row are compared;
+ * 	the bins at the end of a row include bins read from the next row,
+ * 	which the plan may read at a different stage.
+ */
+bool
+testPlan(DaddKernelType type, int32_t spectra, int32_t bins, bool saturate)
+{
+	int32_t rowBins = bins + spectra + VECTOR_LEN - 1;
+	rowBins -= rowBins % VECTOR_LEN;
+	size_t n = (size_t) spectra * rowBins + SLACK;
+	size_t size = n * sizeof(DaddAccum);
+	DaddAccum *a = static_cast<DaddAccum *> (fftwf_malloc(size));
+	DaddAccum *b = static_cast<DaddAccum *> (fftwf_malloc(size));
+	for (size_t i = 0; i < n; ++i) {
+		if (saturate)
+			a[i] = (DaddAccum) (DADD_ACC_MAX / spectra * 2 - (rand() & 0xff));
+		else
+			a[i] = (DaddAccum) (rand() & 3);
+	}
+	memcpy(b, a, size);
+
+	Dadd dadd;
+	dadd.setKernel(type);
+	dadd.setup(spectra, bins, rowBins, THRESHOLD, BAND_BINS, BAD_BAND_LIMIT);
+	dadd.topDown(spectra, rowBins, a);
+	dadd.executePlan(rowBins, b);
+
+	bool ok = true;
+	vector<bool> used(spectra, false);
+	for (int32_t drift = 0; drift < spectra && ok; ++drift) {
+		int32_t row = dadd.getRow(drift);
+		ok = row >= 0 && row < spectra && !used[row];
+		if (!ok)
+			break;
+		used[row] = true;
+		size_t ofs = (size_t) row * rowBins;
+		ok = !memcmp(a + ofs, b + ofs,
+				(rowBins - drift) * sizeof(DaddAccum));
+	}
+	if (!ok) {
+		cout << dadd.getKernelName() << " mismatch, " << spectra
+				<< " spectra, " << rowBins << " bins"
+				<< (saturate ? ", saturated" : "") << endl;
+	}
+	fftwf_free(a);
+	fftwf_free(b);
+	return (ok);
+}
+
+int
+main(int argc, char **argv)
+{
+	const DaddKernelType types[] = { ScalarKernel, Sse2Kernel, Avx2Kernel };
+	const int32_t spectra[] = { 1, 2, 3, 5, 7, 16, 33, 48, 63, 64, 100, 128,
+			255 };
+	const int32_t bins[] = { 8, 200, 1536, 10000 };
+	int32_t failures = 0;
+
+	srand(SEED);
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		if (!getDaddKernel(types[t]))
+			continue;
+		int32_t errors = 0;
+		for (uint32_t i = 0; i < sizeof(spectra) / sizeof(spectra[0]); ++i) {
+			for (uint32_t j = 0; j < sizeof(bins) / sizeof(bins[0]); ++j) {
+				for (int32_t s = 0; s < 2; ++s)
+					errors += !testPlan(types[t], spectra[i], bins[j], s);
+			}
+		}
+		cout << getDaddKernel(types[t])->name << ": "
+				<< (errors ? "FAILED" : "OK") << endl;
+		failures += errors;
+	}
+	return (failures ? 1 : 0);
+}
@@ -0,0 +1,125 @@
+/*******************************************************************************
+
+ File:    reportBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+//
+// Report benchmark: reports the cost of finding and reporting the hits
+// of a DADD with each kernel supported by the processor, in cycles per
+// bin per row, for a quiet plane, a plane with RFI in a fraction of
+// the bins and a plane dense with hits.
+//
+#include <fftw3.h>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include "Dadd.h"
+#include "DaddKernel.h"
+#include "Report.h"
+
+using namespace dadd;
+using std::cout;
+using std::endl;
+
+const int32_t TEST_ROWS = 128;
+const int32_t TEST_BINS = 65536;
+const int32_t TOTAL_BINS = TEST_BINS + TEST_ROWS;
+const int32_t BAND_BINS = 768;
+const int32_t BAD_BAND_LIMIT = 1000000;
+const int32_t PASSES = 4;
+
+/**
+ * Count the hits.
+ */
+class HitCount: public ReportHit {
+public:
+	HitCount(): hits(0) {}
+	virtual void report(const DaddPath& path) { ++hits; }
+
+	int32_t hits;
+};
+
+struct Plane {
+	const char *name;
+	int32_t rfi;						// % of bins with RFI
+	int32_t threshold;
+};
+
+void
+initArray(DaddAccum *data, int32_t rfi)
+{
+	srand(1);
+	for (int32_t i = 0; i < TEST_ROWS * TOTAL_BINS; ++i) {
+		data[i] = (DaddAccum) (rand() & 3);
+		if (rand() % 100 < rfi)
+			data[i] = 3;
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	const Plane planes[] = {
+		{ "quiet", 0, TEST_ROWS * 2 },
+		{ "rfi", 10, TEST_ROWS * 2 },
+		{ "dense", 50, TEST_ROWS * 2 }
+	};
+	size_t size = (TEST_ROWS * TOTAL_BINS + 2 * VECTOR_LEN)
+			* sizeof(DaddAccum);
+	DaddAccum *array = static_cast<DaddAccum *> (fftwf_malloc(size));
+	DaddAccum *input = static_cast<DaddAccum *> (fftwf_malloc(size));
+	memset(input, 0, size);
+	float64_t rowBins = (float64_t) TEST_ROWS * TEST_BINS;
+
+	cout << DADD_ACC_BITS << "-bit accumulators, " << TEST_ROWS
+			<< " rows, " << TEST_BINS << " bins, cycles per bin per row"
+			<< endl;
+	cout << "plane\thits\tkernel\treportHits" << endl;
+	DaddKernelType types[] = { ScalarKernel, Sse2Kernel, Avx2Kernel };
+	for (uint32_t p = 0; p < sizeof(planes) / sizeof(planes[0]); ++p) {
+		initArray(input, planes[p].rfi);
+		for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+			if (!getDaddKernel(types[t]))
+				continue;
+			Dadd dadd;
+			dadd.setKernel(types[t]);
+			dadd.setup(TEST_ROWS, TEST_BINS, TOTAL_BINS, planes[p].threshold,
+					BAND_BINS, BAD_BAND_LIMIT);
+			HitCount count;
+			for (int32_t i = 0; i < PASSES; ++i) {
+				memcpy(array, input, size);
+				dadd.detect(POL_RIGHTCIRCULAR, Positive, array, &count);
+			}
+			cout << planes[p].name << "\t" << count.hits / PASSES << "\t"
+					<< dadd.getKernelName() << "\t"
+					<< dadd.getTiming().dadd.reportHits / PASSES / rowBins
+					<< endl;
+		}
+	}
+	fftwf_free(array);
+	fftwf_free(input);
+}
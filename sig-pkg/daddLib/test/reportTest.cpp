@@ -0,0 +1,198 @@
+/*******************************************************************************
+
+ File:    reportTest.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+//
+// Report test: checks that the hits reported by DADD are exactly those
+// found by a bin by bin search of the thresholded pathsums, in the same
+// order, for quiet and RFI-dense data, both slopes, full spectra and
+// slices, with every kernel supported by the processor.
+// Returns a non-zero exit status on failure.
+//
+#include <fftw3.h>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Dadd.h"
+#include "DaddKernel.h"
+#include "Report.h"
+
+using namespace dadd;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t SPECTRA = 100;
+const int32_t SPECTRUM_BINS = 4096;
+const int32_t SLICE_BINS = 1024;
+const int32_t SLACK = 64;					// bins read past the last row
+const int32_t BAND_BINS = 256;
+const int32_t BAD_BAND_LIMIT = 1000000;
+const int32_t SEED = 1;
+
+/**
+ * Collect the hits.
+ */
+class HitList: public ReportHit {
+public:
+	virtual void report(const DaddPath& path) { hits.push_back(path); }
+
+	vector<DaddPath> hits;
+};
+
+/**
+ * Create the input data: random bins, with RFI in a fraction of the
+ * bins of every spectrum.
+ */
+void
+createData(DaddAccum *data, size_t n, int32_t rowBins, int32_t rfi)
+{
+	for (size_t i = 0; i < n; ++i)
+		data[i] = (DaddAccum) (rand() & 3);
+	for (size_t i = 0; i < n; ++i) {
+		if ((int32_t) (i % rowBins) < SPECTRUM_BINS && rand() % 100 < rfi)
+			data[i] = 3;
+	}
+}
+
+/**
+ * Find the hits in the thresholded pathsums bin by bin, in order of
+ * drift.
+ */
+void
+findHits(Dadd& dadd, DaddSlope slope, const DaddAccum *data, int32_t base,
+		int32_t bins, int32_t rowBins, int32_t totalBins, int32_t threshold,
+		vector<DaddPath>& hits)
+{
+	for (int32_t drift = 0; drift < SPECTRA; ++drift) {
+		const DaddAccum *dp = data + dadd.getRow(drift) * rowBins;
+		for (int32_t i = 0; i < bins; ++i) {
+			int32_t bin = base + i;
+			if (!dp[i] || bin + drift >= SPECTRUM_BINS)
+				continue;
+			int32_t power = dp[i] + threshold;
+			if (slope == Positive)
+				hits.push_back(DaddPath(POL_RIGHTCIRCULAR, bin, drift, power));
+			else if (drift) {
+				int32_t actualBin = (totalBins - 1) - bin;
+				if (actualBin >= 0) {
+					hits.push_back(DaddPath(POL_RIGHTCIRCULAR, actualBin,
+							-drift, power));
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Run DADD on a slice and compare the reported hits with the search.
+ */
+bool
+testReport(DaddKernelType type, DaddSlope slope, int32_t base,
+		int32_t sliceBins, int32_t rfi, int32_t threshold)
+{
+	int32_t rowBins = sliceBins + SPECTRA + VECTOR_LEN - 1;
+	rowBins -= rowBins % VECTOR_LEN;
+	int32_t spectrumRowBins = SPECTRUM_BINS + SPECTRA + VECTOR_LEN - 1;
+	spectrumRowBins -= spectrumRowBins % VECTOR_LEN;
+	size_t n = (size_t) SPECTRA * rowBins + SLACK;
+	size_t size = n * sizeof(DaddAccum);
+	DaddAccum *a = static_cast<DaddAccum *> (fftwf_malloc(size));
+	DaddAccum *b = static_cast<DaddAccum *> (fftwf_malloc(size));
+	createData(a, n, rowBins, rfi);
+	memcpy(b, a, size);
+
+	Dadd dadd;
+	dadd.setKernel(type);
+	dadd.setup(SPECTRA, SPECTRUM_BINS, spectrumRowBins, threshold, BAND_BINS,
+			BAD_BAND_LIMIT);
+	dadd.setSlice(base, sliceBins, rowBins);
+	HitList list;
+	dadd.detect(POL_RIGHTCIRCULAR, slope, a, &list);
+
+	vector<DaddPath> expected;
+	dadd.topDown(SPECTRA, rowBins, b);
+	dadd.thresholdData(b);
+	int32_t bins = std::min(sliceBins, SPECTRUM_BINS - base);
+	findHits(dadd, slope, b, base, bins, rowBins, spectrumRowBins,
+			threshold, expected);
+
+	bool ok = list.hits.size() == expected.size();
+	for (uint32_t i = 0; ok && i < expected.size(); ++i) {
+		const DaddPath& p = list.hits[i];
+		const DaddPath& e = expected[i];
+		ok = p.bin == e.bin && p.drift == e.drift && p.power == e.power;
+	}
+	if (!ok) {
+		cout << dadd.getKernelName() << " mismatch, "
+				<< (slope == Positive ? "positive" : "negative")
+				<< " slope, base " << base << ", rfi " << rfi << "%, "
+				<< list.hits.size() << " hits, " << expected.size()
+				<< " expected" << endl;
+	}
+	fftwf_free(a);
+	fftwf_free(b);
+	return (ok);
+}
+
+int
+main(int argc, char **argv)
+{
+	const DaddKernelType types[] = { ScalarKernel, Sse2Kernel, Avx2Kernel };
+	const DaddSlope slopes[] = { Positive, Negative };
+	// quiet and RFI-dense data
+	const int32_t rfi[] = { 0, 0, 10, 50 };
+	const int32_t thresholds[] = { SPECTRA * 2, SPECTRA * 3 / 2, SPECTRA * 2,
+			SPECTRA * 2 };
+	const int32_t bases[] = { 0, SPECTRUM_BINS - SLICE_BINS,
+			SPECTRUM_BINS - SLICE_BINS / 2 };
+	int32_t failures = 0;
+
+	srand(SEED);
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		if (!getDaddKernel(types[t]))
+			continue;
+		int32_t errors = 0;
+		for (uint32_t s = 0; s < sizeof(slopes) / sizeof(slopes[0]); ++s) {
+			for (uint32_t r = 0; r < sizeof(rfi) / sizeof(rfi[0]); ++r) {
+				errors += !testReport(types[t], slopes[s], 0, SPECTRUM_BINS,
+						rfi[r], thresholds[r]);
+				for (uint32_t i = 0; i < sizeof(bases) / sizeof(bases[0]);
+						++i) {
+					errors += !testReport(types[t], slopes[s], bases[i],
+							SLICE_BINS, rfi[r], thresholds[r]);
+				}
+			}
+		}
+		cout << getDaddKernel(types[t])->name << ": "
+				<< (errors ? "FAILED" : "OK") << endl;
+		failures += errors;
+	}
+	return (failures ? 1 : 0);
+}
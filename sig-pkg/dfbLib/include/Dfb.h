@@ -58,6 +58,33 @@ namespace dfb {
 const int DFB_OVERLAP = (DFB_FFTLEN / 4);
 const int DFB_DEF_SAMPLES = 512;
 
+// # of consecutive DFB outputs staged in a tile in blocked and
+// batched modes
+const int DFB_TILE_SAMPLES = 8;
+
+/**
+* Output modes of iterate().
+*
+* In scatter mode, each DFB output is stored directly into the channel
+* output buffers, one sample per channel.  In blocked mode, up to
+* DFB_TILE_SAMPLES consecutive outputs are transformed into a staging
+* tile, which is then corner-turned into the channel output buffers a
+* block of samples per channel at a time.  Both modes produce identical
+* output.  Batched mode is blocked mode with the filter outputs for the
+* whole tile computed first, already rotated, and transformed by a
+* single multiple-transform FFT; its output agrees with the other modes
+* to within rounding error.
+*
+* Notes:
+*	Blocked and batched modes require a multiple of 8 channels; for
+*	smaller numbers of channels scatter mode is used.
+*/
+enum DfbMode {
+	DFB_SCATTER,
+	DFB_BLOCKED,
+	DFB_BATCHED
+};
+
 /**
 * vector of four single-precision floating point values or two complex
 * single-precision floating point values; allows compiler-generated
@@ -167,6 +194,9 @@ public:
 	int iterate(const complex<float> **inBuf_, int nBufs_, int inLen_,
 			complex<float> **outBuf_);
 	void polyphase(const complex<float> *in, complex<float> **out, int ofs);
+	void setMode(DfbMode mode_);
+	/** Return the output mode. */
+	DfbMode getMode() { return (mode); }
 	const DfbTiming& getTiming() { return (timing); }
 
 private:
@@ -185,14 +215,26 @@ private:
 	complex<float> *work;				// WOLA working data array
 	complex<float> *fftIn;				// FFT input data array
 	complex<float> *fftOut;				// FFT output data array
+	complex<float> *tile;				// blocked mode staging tile
+	complex<float> *batchIn;			// batched mode FFT input array
+	DfbMode mode;						// output mode
 	DfbTiming timing;					// timing statistics
 
 	fftwf_plan plan;					// FFTW plan
+	fftwf_plan batchPlan;				// batched mode FFTW plan
 
 	void createPlan();
+	void createTile();
 	void makeCoeff();
 	bool powerOf2(int val);
 
+	void transform(const complex<float> *in, complex<float> *out);
+	void polyphaseBlk(const complex<float> *in, complex<float> **out,
+			int ofs, int n);
+	void polyphaseBatch(const complex<float> *in, complex<float> **out,
+			int ofs, int n);
+	void cornerTurn(complex<float> **out, int ofs, int n);
+	void wolaRotate(const complex<float> *in, complex<float> *out);
 	void wola(const complex<float> *in, complex<float> *out);
 	void rotate(complex<float> *src, complex<float> *dest);
 };
@@ -42,7 +42,8 @@ namespace dfb {
 Dfb::Dfb(): rawFftLen(DFB_FFTLEN), fftLen(DFB_FFTLEN), overlap(DFB_OVERLAP),
 		start(0), samplesPerChan(DFB_DEF_SAMPLES), dataLen(0),
 		blks(DFB_FOLDINGS), nRawCoeff(0), nCoeff(0), rawCoeff(0), coeff(0),
-		work(0), fftIn(0), fftOut(0), plan(0)
+		work(0), fftIn(0), fftOut(0), tile(0), batchIn(0), mode(DFB_BLOCKED),
+		plan(0), batchPlan(0)
 {
 	setCoeff(dfbCoeff, DFB_FFTLEN, DFB_FOLDINGS);
 	setup(DFB_FFTLEN, DFB_OVERLAP, DFB_FOLDINGS, DFB_DEF_SAMPLES);
@@ -50,6 +51,8 @@ Dfb::Dfb(): rawFftLen(DFB_FFTLEN), fftLen(DFB_FFTLEN), overlap(DFB_OVERLAP),
 
 Dfb::~Dfb()
 {
+	if (batchPlan)
+		fftwf_destroy_plan(batchPlan);
 	if (plan)
 		fftwf_destroy_plan(plan);
 	if (rawCoeff)
@@ -62,6 +65,10 @@ Dfb::~Dfb()
 		fftwf_free(fftOut);
 	if (work)
 		fftwf_free(work);
+	if (tile)
+		fftwf_free(tile);
+	if (batchIn)
+		fftwf_free(batchIn);
 }
 
 /**
@@ -172,6 +179,26 @@ Dfb::setup(int nChan_, int overlap_, int foldings_, int samplesPerChan_)
 	DfbAssert(plan);
 }
 
+/**
+* Set the output mode.
+*
+* Description:\n
+*	Selects scatter, blocked or batched output for subsequent
+*	iterate() calls.  Blocked mode is the default.\n\n
+* Notes:\n
+*	Selecting batched mode creates a new FFTW plan, so this should
+*	not be called while iterating.
+*
+* @param	mode_ the output mode.
+* @see		DfbMode
+*/
+void
+Dfb::setMode(DfbMode mode_)
+{
+	mode = mode_;
+	createTile();
+}
+
 /**
 * Return the current configuration of the DFB.
 *
@@ -267,7 +294,10 @@ Dfb::getRawCoeff(float *rCoeff_, int nRawCoeff_)
 *	number of channel-samples specified.
 *	This function has no way of determining whether or not the
 *	output buffer is full, so that is the responsibility of the
-*	caller.
+*	caller.\n
+*	In blocked and batched modes the samples are produced
+*	DFB_TILE_SAMPLES at a time by polyphaseBlk() or polyphaseBatch()
+*	rather than one at a time by polyphase().
 *
 * @param	inBuf_ array of pointers to input sample buffers.  Currently, only
 *			the first pointer is used.
@@ -297,8 +327,22 @@ Dfb::iterate(const complex<float> **inBuf_, int nBufs_, int inLen_,
 	uint64_t t0 = getticks();
 #endif
 #ifndef NO_POLYPHASE
-	for (int i = 0; i < samplesPerChan; ++i, in += istride, ++ofs)
-		polyphase(in, out, ofs);
+	if (tile) {
+		for (; ofs < samplesPerChan; ofs += DFB_TILE_SAMPLES) {
+			int n = samplesPerChan - ofs;
+			if (n > DFB_TILE_SAMPLES)
+				n = DFB_TILE_SAMPLES;
+			if (batchPlan)
+				polyphaseBatch(in, out, ofs, n);
+			else
+				polyphaseBlk(in, out, ofs, n);
+			in += n * istride;
+		}
+	}
+	else {
+		for (int i = 0; i < samplesPerChan; ++i, in += istride, ++ofs)
+			polyphase(in, out, ofs);
+	}
 #endif
 #if (DFB_TIMING)
 	uint64_t t1 = getticks();
@@ -341,6 +385,50 @@ Dfb::createPlan()
 
 	plan = fftwf_plan_dft_1d(fftLen, (fftwf_complex *) work,
 			(fftwf_complex *) fftOut, FFTW_FORWARD, FFTW_PATIENT);
+	createTile();
+}
+
+/**
+* Create the staging tile for blocked and batched modes.
+*
+* Description:\n
+*	Frees any existing tile, then allocates a tile of DFB_TILE_SAMPLES
+*	rows of fftLen channels if blocked or batched mode is selected.
+*	For batched mode, also allocates a matching array of FFT inputs
+*	and creates a plan which transforms all the rows at once.\n\n
+* Notes:\n
+*	The FFT is performed directly into the rows of the tile, so each
+*	row must have the same alignment as the output array of the plan;
+*	rows of a multiple of 8 channels are a multiple of 64 bytes long.
+*	Otherwise no tile is allocated and scatter mode is used.
+*/
+void
+Dfb::createTile()
+{
+	if (batchPlan)
+		fftwf_destroy_plan(batchPlan);
+	batchPlan = 0;
+	if (batchIn)
+		fftwf_free(batchIn);
+	batchIn = 0;
+	if (tile)
+		fftwf_free(tile);
+	tile = 0;
+	if (mode == DFB_SCATTER || !plan || fftLen % 8)
+		return;
+
+	size_t size = DFB_TILE_SAMPLES * fftLen * sizeof(complex<float>);
+	tile = (complex<float> *) fftwf_malloc(size);
+	DfbAssert(DFB_ALIGNED(tile));
+	if (mode == DFB_BATCHED) {
+		batchIn = (complex<float> *) fftwf_malloc(size);
+		DfbAssert(DFB_ALIGNED(batchIn));
+		batchPlan = fftwf_plan_many_dft(1, &fftLen, DFB_TILE_SAMPLES,
+				(fftwf_complex *) batchIn, 0, 1, fftLen,
+				(fftwf_complex *) tile, 0, 1, fftLen, FFTW_FORWARD,
+				FFTW_PATIENT);
+		DfbAssert(batchPlan);
+	}
 }
 
 /**
@@ -405,6 +493,9 @@ Dfb::makeCoeff()
 			double d = (double) (nRawCoeff - 1) / (nCoeff - 1);
 			for (int i = 0; i < nCoeff; ++i) {
 				int idx = (int) (i * d);
+				// the last point lies on the last raw coefficient
+				if (idx > nRawCoeff - 2)
+					idx = nRawCoeff - 2;
 				double dv = i * d - idx;
 				dv *= (rawCoeff[idx+1] - rawCoeff[idx]);
 				float v = rawCoeff[idx] + dv;
@@ -437,6 +528,9 @@ Dfb::makeCoeff()
 			// iterate across the set of raw coefficients
 			for (int i = 0; i < nCoeff; ++i) {
 				int idx = (int) (i * d);
+				// the last point lies on the last raw coefficient
+				if (idx > nRawCoeff - 2)
+					idx = nRawCoeff - 2;
 				double dv = i * d - idx;
 				dv *= (rawCoeff[idx+1] - rawCoeff[idx]);
 				float v = rawCoeff[idx] + dv;
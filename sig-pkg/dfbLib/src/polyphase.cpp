@@ -30,6 +30,7 @@
 
 // SonATA DFB core library: polyphase filter
 
+#include <xmmintrin.h>
 #include "cycle.h"
 #include "Dfb.h"
 
@@ -68,16 +69,7 @@ Dfb::polyphase(const complex<float> *in, complex<float> **out, int ofs)
 #if (DFB_TIMING)
 	uint64_t t0 = getticks();
 #endif
-#ifdef ROTATE_DATA
-	wola(in, work);
-	rotate(work, fftIn);
-#else
-	wola(in, fftIn);
-#endif
-#if (DFB_TIMING)
-	uint64_t t1 = getticks();
-#endif
-	fftwf_execute_dft(plan, (fftwf_complex *) fftIn, (fftwf_complex *) fftOut);
+	transform(in, fftOut);
 #if (DFB_TIMING)
 	uint64_t t2 = getticks();
 #endif
@@ -102,8 +94,6 @@ Dfb::polyphase(const complex<float> *in, complex<float> **out, int ofs)
 #if (DFB_TIMING)
 	uint64_t t3 = getticks();
 	++timing.dfbs;
-	timing.wola += elapsed(t1, t0);
-	timing.fft += elapsed(t2, t1);
 	timing.store += elapsed(t3, t2);
 	timing.dfb += elapsed(t3, t0);
 #endif
@@ -132,6 +122,177 @@ Dfb::polyphase(const complex<float> *in, complex<float> **out, int ofs)
 #endif
 }
 
+/**
+* Perform a block of polyphase filter/channelization operations.
+*
+* Description:\n
+*	Performs n consecutive iterations of the DFB into the rows of the
+*	staging tile, then corner-turns the tile into the output buffers,
+*	so that each channel's samples are stored together instead of
+*	touching every channel buffer for each iteration.  The output is
+*	identical to n calls to polyphase().
+*
+* @param	in pointer to input sample array.
+* @param	out array of pointers to output buffers.
+* @param	ofs offset into each output buffer.
+* @param	n number of iterations; at most DFB_TILE_SAMPLES.
+*/
+void
+Dfb::polyphaseBlk(const complex<float> *in, complex<float> **out, int ofs,
+		int n)
+{
+	DfbAssert(n <= DFB_TILE_SAMPLES);
+#if (DFB_TIMING)
+	uint64_t t0 = getticks();
+#endif
+	int istride = fftLen - overlap;
+	for (int i = 0; i < n; ++i, in += istride)
+		transform(in, tile + i * fftLen);
+#if (DFB_TIMING)
+	uint64_t t1 = getticks();
+#endif
+#ifndef NO_OUTPUT
+	cornerTurn(out, ofs, n);
+#endif
+#if (DFB_TIMING)
+	uint64_t t2 = getticks();
+	timing.dfbs += n;
+	timing.store += elapsed(t2, t1);
+	timing.dfb += elapsed(t2, t0);
+#endif
+}
+
+/**
+* Perform a block of polyphase filter/channelization operations with
+* a single multiple-transform FFT.
+*
+* Description:\n
+*	Performs the rotated WOLA for n consecutive iterations of the DFB
+*	into the rows of the batch input array, transforms all the rows
+*	into the staging tile, then corner-turns the tile into the output
+*	buffers.  A full tile is transformed by one execution of the
+*	batched plan; a partial tile at the end of the half frame is
+*	transformed a row at a time with the single-step plan.\n\n
+* Notes:\n
+*	Only the default configuration (ROTATE_DATA) is supported; the
+*	test configurations are handled by polyphase().
+*
+* @param	in pointer to input sample array.
+* @param	out array of pointers to output buffers.
+* @param	ofs offset into each output buffer.
+* @param	n number of iterations; at most DFB_TILE_SAMPLES.
+*/
+void
+Dfb::polyphaseBatch(const complex<float> *in, complex<float> **out, int ofs,
+		int n)
+{
+	DfbAssert(n <= DFB_TILE_SAMPLES);
+#if (DFB_TIMING)
+	uint64_t t0 = getticks();
+#endif
+	int istride = fftLen - overlap;
+	for (int i = 0; i < n; ++i, in += istride)
+		wolaRotate(in, batchIn + i * fftLen);
+#if (DFB_TIMING)
+	uint64_t t1 = getticks();
+#endif
+	if (n == DFB_TILE_SAMPLES) {
+		fftwf_execute_dft(batchPlan, (fftwf_complex *) batchIn,
+				(fftwf_complex *) tile);
+	}
+	else {
+		for (int i = 0; i < n; ++i) {
+			fftwf_execute_dft(plan, (fftwf_complex *) (batchIn + i * fftLen),
+					(fftwf_complex *) (tile + i * fftLen));
+		}
+	}
+#if (DFB_TIMING)
+	uint64_t t2 = getticks();
+#endif
+#ifndef NO_OUTPUT
+	cornerTurn(out, ofs, n);
+#endif
+#if (DFB_TIMING)
+	uint64_t t3 = getticks();
+	timing.dfbs += n;
+	timing.wola += elapsed(t1, t0);
+	timing.fft += elapsed(t2, t1);
+	timing.store += elapsed(t3, t2);
+	timing.dfb += elapsed(t3, t0);
+#endif
+}
+
+/**
+* Filter and transform a block of input data.
+*
+* Description:\n
+*	Performs the WOLA and (optionally) the rotation, then the FFT,
+*	storing the channel outputs in the specified array.\n\n
+* Notes:\n
+*	The output array must have the same alignment as the output
+*	array used to create the plan.
+*
+* @param	in pointer to input sample array.
+* @param	out output channel array.
+*/
+void
+Dfb::transform(const complex<float> *in, complex<float> *out)
+{
+#if (DFB_TIMING)
+	uint64_t t0 = getticks();
+#endif
+#ifdef ROTATE_DATA
+	wola(in, work);
+	rotate(work, fftIn);
+#else
+	wola(in, fftIn);
+#endif
+#if (DFB_TIMING)
+	uint64_t t1 = getticks();
+#endif
+	fftwf_execute_dft(plan, (fftwf_complex *) fftIn, (fftwf_complex *) out);
+#if (DFB_TIMING)
+	uint64_t t2 = getticks();
+	timing.wola += elapsed(t1, t0);
+	timing.fft += elapsed(t2, t1);
+#endif
+}
+
+/**
+* Corner turn the staging tile into the output buffers.
+*
+* Description:\n
+*	Transfers the first n rows of the tile, one row per iteration,
+*	into the channel output buffers.  Pairs of channels and pairs of
+*	rows are transposed as 2x2 blocks of complex values in vector
+*	registers, so each channel's samples are written contiguously.
+*
+* @param	out array of pointers to output buffers.
+* @param	ofs offset into each output buffer.
+* @param	n number of rows.
+*/
+void
+Dfb::cornerTurn(complex<float> **out, int ofs, int n)
+{
+	int rowLen = 2 * fftLen;
+	for (int chan = 0; chan < fftLen; chan += 2) {
+		const float *t = (const float *) (tile + chan);
+		float *o0 = (float *) (out[chan] + ofs);
+		float *o1 = (float *) (out[chan+1] + ofs);
+		int i;
+		for (i = 0; i + 2 <= n; i += 2, t += 2 * rowLen) {
+			__m128 r0 = _mm_load_ps(t);
+			__m128 r1 = _mm_load_ps(t + rowLen);
+			_mm_storeu_ps(o0 + 2 * i, _mm_movelh_ps(r0, r1));
+			_mm_storeu_ps(o1 + 2 * i, _mm_movehl_ps(r1, r0));
+		}
+		if (i < n) {
+			out[chan][ofs+i] = tile[i*fftLen+chan];
+			out[chan+1][ofs+i] = tile[i*fftLen+chan+1];
+		}
+	}
+}
+
 /**
  * Weighted overlap and add.
  *
@@ -227,4 +388,64 @@ Dfb::rotate(complex<float> *src, complex<float> *dest)
 #endif
 }
 
-}
\ No newline at end of file
+/**
+ * Fold a segment of the filter.
+ *
+ * Description:\n
+ * 	Computes len filter outputs, each the sum over all blocks of the
+ * 	input samples times the filter coefficients.  The sums are kept in
+ * 	registers across the blocks, and are stored once.
+ *
+ * @param	in first input sample of the segment in the first block.
+ * @param	cd first coefficient of the segment in the first block.
+ * @param	out first output of the segment.
+ * @param	len number of outputs in the segment.
+ * @param	blks number of blocks.
+ * @param	blkLen length of each block.
+ */
+static inline void
+fold(const complex<float> *in, const scalar *cd, complex<float> *out, int len,
+		int blks, int blkLen)
+{
+	const float *id = (const float *) in;
+	const float *c = (const float *) cd;
+	float *od = (float *) out;
+	int n = 2 * len;
+	int stride = 2 * blkLen;
+	int j;
+	for (j = 0; j + 4 <= n; j += 4) {
+		__m128 acc = _mm_mul_ps(_mm_loadu_ps(id + j), _mm_loadu_ps(c + j));
+		for (int blk = 1, k = j + stride; blk < blks; ++blk, k += stride) {
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(id + k),
+					_mm_loadu_ps(c + k)));
+		}
+		_mm_storeu_ps(od + j, acc);
+	}
+	for (; j < n; ++j) {
+		float acc = id[j] * c[j];
+		for (int blk = 1, k = j + stride; blk < blks; ++blk, k += stride)
+			acc += id[k] * c[k];
+		od[j] = acc;
+	}
+}
+
+/**
+ * Weighted overlap and add with rotation.
+ *
+ * Description:\n
+ * 	Equivalent to wola() followed by rotate(), but stores each filter
+ * 	output directly in its rotated position, so that neither the
+ * 	clearing of the output array nor the copies of the rotation are
+ * 	required.
+ */
+void
+Dfb::wolaRotate(const complex<float> *in, complex<float> *out)
+{
+	start %= fftLen;
+	int end = fftLen - start;
+	fold(in + start, coeff + start, out, end, blks, fftLen);
+	fold(in, coeff, out + end, start, blks, fftLen);
+	start += overlap;
+}
+
+}
@@ -81,6 +81,8 @@ DfbTest::test()
 
 	setup1024(dfb);
 	testTiming(dfb);
+
+	testModes();
 }
 
 void
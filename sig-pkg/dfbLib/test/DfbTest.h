@@ -70,6 +70,9 @@ private:
 	void testOverallResp(Dfb& dfb);
 	void testIteration(Dfb& dfb);
 	void testTiming(Dfb& dfb);
+	void testModes();
+	bool compareModes(DfbMode mode, int fftLen, int samplesPerChan,
+			float tol);
 
 	// utility functions
 	void generateSignal(double freq, double amp, int fftLen, int len,
@@ -29,6 +29,7 @@
 *******************************************************************************/
 
 // test the polyphase filter
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -375,6 +376,103 @@ DfbTest::testTiming(Dfb& dfb)
 //	delete [] fd;
 }
 
+/**
+* Test that blocked and scatter output modes produce identical output.
+*
+* Description:\n
+*	Compares blocked and batched mode output with scatter mode output
+*	for a range of channel counts, with both a full half frame and a
+*	number of samples per channel which is not a multiple of the tile
+*	size.  Blocked mode must be bit-identical; batched mode uses a
+*	different FFT plan and must agree to within rounding error.
+*/
+void
+DfbTest::testModes()
+{
+	OUTL("test output modes");
+	int chans[] = { 128, 256, 512, 1024, 2048, 4096 };
+	for (uint32_t i = 0; i < sizeof(chans) / sizeof(chans[0]); ++i) {
+		CONFIRM(compareModes(DFB_BLOCKED, chans[i], DFB_DEF_SAMPLES, 0));
+		CONFIRM(compareModes(DFB_BLOCKED, chans[i], DFB_DEF_SAMPLES - 3, 0));
+		CONFIRM(compareModes(DFB_BATCHED, chans[i], DFB_DEF_SAMPLES, 1e-5));
+		CONFIRM(compareModes(DFB_BATCHED, chans[i], DFB_DEF_SAMPLES - 3,
+				1e-5));
+	}
+}
+
+/**
+* Compare the output of a mode with scatter mode for a single
+* configuration.
+*
+* Description:\n
+*	Two identically configured DFBs, one in each mode, are each
+*	iterated twice over random input, since the WOLA rotation carries
+*	over from one iteration to the next.  Returns true if the outputs
+*	are bit-identical, or if a tolerance is given, if no output differs
+*	by more than the tolerance relative to the largest scatter output.
+*
+* @param	mode the mode to compare with scatter mode.
+* @param	fftLen the number of channels.
+* @param	samplesPerChan the number of samples per channel.
+* @param	tol relative tolerance; zero requires identical output.
+*/
+bool
+DfbTest::compareModes(DfbMode mode, int fftLen, int samplesPerChan,
+		float tol)
+{
+	Dfb scatter, blocked;
+	scatter.setMode(DFB_SCATTER);
+	scatter.setup(fftLen, fftLen / 4, DFB_FOLDINGS, samplesPerChan);
+	blocked.setMode(mode);
+	blocked.setup(fftLen, fftLen / 4, DFB_FOLDINGS, samplesPerChan);
+
+	DfbInfo info;
+	scatter.getInfo(&info);
+	int tdLen = info.dataLen;
+	complex<float> *tdData = (complex<float> *) fftwf_malloc(
+			sizeof(complex<float>) * tdLen);
+	srand(fftLen + samplesPerChan);
+	for (int i = 0; i < tdLen; ++i) {
+		tdData[i] = complex<float>(rand() / (float) RAND_MAX - .5,
+				rand() / (float) RAND_MAX - .5);
+	}
+
+	// offset the outputs so that they are not all aligned
+	int fdLen = fftLen * (samplesPerChan + 1);
+	size_t size = sizeof(complex<float>) * fdLen;
+	complex<float> *sData = (complex<float> *) fftwf_malloc(size);
+	complex<float> *bData = (complex<float> *) fftwf_malloc(size);
+	memset(sData, 0, size);
+	memset(bData, 0, size);
+	complex<float> *sFd[fftLen], *bFd[fftLen];
+	for (int i = 0; i < fftLen; ++i) {
+		sFd[i] = &sData[i*(samplesPerChan+1)+(i&1)];
+		bFd[i] = &bData[i*(samplesPerChan+1)+(i&1)];
+	}
+
+	bool same = true;
+	for (int i = 0; i < 2; ++i) {
+		const complex<float> *td = tdData;
+		scatter.iterate(&td, 1, tdLen, sFd);
+		td = tdData;
+		blocked.iterate(&td, 1, tdLen, bFd);
+		if (!tol)
+			same = same && !memcmp(sData, bData, size);
+		else {
+			float maxVal = 0, maxErr = 0;
+			for (int j = 0; j < fdLen; ++j) {
+				maxVal = std::max(maxVal, abs(sData[j]));
+				maxErr = std::max(maxErr, abs(sData[j] - bData[j]));
+			}
+			same = same && maxErr <= tol * maxVal;
+		}
+	}
+	fftwf_free(tdData);
+	fftwf_free(sData);
+	fftwf_free(bData);
+	return (same);
+}
+
 /**
 * Generate a test signal consisting of a sine wave of a specified
 * frequency and amplitude.
@@ -0,0 +1,146 @@
+/*******************************************************************************
+
+ File:    dfbBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Output mode benchmark: times Dfb::iterate in scatter, blocked and
+// batched output modes over a sweep of channel counts and fold factors,
+// reporting input samples per second for each mode.  Fold factors other
+// than that of the standard filter use a windowed sinc filter.
+//
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include "Dfb.h"
+
+using namespace dfb;
+using std::cout;
+using std::endl;
+
+const int BENCH_PASSES = 20;
+
+static double
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+* Create a Hamming-windowed sinc filter for a number of channels and
+* foldings.
+*/
+static float *
+makeFilter(int fftLen, int foldings)
+{
+	int len = fftLen * foldings;
+	float *coeff = new float[len];
+	for (int i = 0; i < len; ++i) {
+		double x = (i - (len - 1) / 2.0) / fftLen;
+		double sinc = x ? sin(M_PI * x) / (M_PI * x) : 1;
+		coeff[i] = sinc * (0.54 - 0.46 * cos(2 * M_PI * i / (len - 1)));
+	}
+	return (coeff);
+}
+
+/**
+* Time a number of iterations of a single configuration.
+*
+* @param	mode output mode.
+* @param	fftLen the number of channels.
+* @param	foldings the number of foldings.
+* @param	passes the number of iterations.
+* @return	input samples per second.
+*/
+static double
+run(DfbMode mode, int fftLen, int foldings, int passes)
+{
+	Dfb dfb;
+	if (foldings != DFB_FOLDINGS) {
+		float *coeff = makeFilter(fftLen, foldings);
+		dfb.setCoeff(coeff, fftLen, foldings);
+		delete [] coeff;
+	}
+	dfb.setMode(mode);
+	dfb.setup(fftLen, fftLen / 4, foldings, DFB_DEF_SAMPLES);
+
+	DfbInfo info;
+	dfb.getInfo(&info);
+	int tdLen = info.dataLen;
+	complex<float> *td = (complex<float> *) fftwf_malloc(
+			sizeof(complex<float>) * tdLen);
+	for (int i = 0; i < tdLen; ++i) {
+		td[i] = complex<float>(rand() / (float) RAND_MAX - .5,
+				rand() / (float) RAND_MAX - .5);
+	}
+	int fdLen = fftLen * DFB_DEF_SAMPLES;
+	complex<float> *fdData = (complex<float> *) fftwf_malloc(
+			sizeof(complex<float>) * fdLen);
+	complex<float> *fd[fftLen];
+	for (int i = 0; i < fftLen; ++i)
+		fd[i] = &fdData[i*DFB_DEF_SAMPLES];
+
+	// one iteration to warm the caches
+	const complex<float> *in = td;
+	dfb.iterate(&in, 1, tdLen, fd);
+	double t0 = now();
+	for (int i = 0; i < passes; ++i) {
+		in = td;
+		dfb.iterate(&in, 1, tdLen, fd);
+	}
+	double t = now() - t0;
+	fftwf_free(td);
+	fftwf_free(fdData);
+	return (t > 0 ? (double) passes * info.dataLen / t : 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	int passes = BENCH_PASSES;
+	if (argc > 1)
+		passes = atoi(argv[1]);
+
+	cout << DFB_DEF_SAMPLES << " samples per channel, " << passes
+			<< " passes, Msamples/s" << endl;
+	cout << "chans\tfolds\tscatter\tblocked\tbatched\tspeedup" << endl;
+	int folds[] = { 4, 8, DFB_FOLDINGS, 16 };
+	for (int fftLen = 128; fftLen <= 4096; fftLen *= 2) {
+		for (uint32_t f = 0; f < sizeof(folds) / sizeof(folds[0]); ++f) {
+			double scatter = run(DFB_SCATTER, fftLen, folds[f], passes);
+			double blocked = run(DFB_BLOCKED, fftLen, folds[f], passes);
+			double batched = run(DFB_BATCHED, fftLen, folds[f], passes);
+			cout << fftLen << "\t" << folds[f] << "\t" << scatter / 1e6
+					<< "\t" << blocked / 1e6 << "\t" << batched / 1e6
+					<< "\t" << (scatter > 0 ? batched / scatter : 0) << endl;
+		}
+	}
+}
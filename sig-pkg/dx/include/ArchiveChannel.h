@@ -38,6 +38,7 @@
 #include <fftw3.h>
 #include <sseInterface.h>
 #include "System.h"
+#include "DedriftKernel.h"
 #include "DxStruct.h"
 
 namespace dx {
@@ -78,6 +79,7 @@ public:
 			bool overlap);
 	void dedrift(ComplexFloat32 *iData, ComplexFloat32 *oData,
 			float64_t fMHz, float64_t driftHz);
+	void setDedriftKernel(DedriftKernelType type);
 	void rescale(ComplexFloat32 *td, int32_t fftLen, int32_t nSamples);
 private:
 	struct s {
@@ -114,6 +116,7 @@ private:
 	float64_t freqMHz;					// center frequency of the channel
 	ComplexFloat32 *spectrum;			// subchannel spectrum buffer
 	ComplexFloat32 *driftBuf; 			// dedrift buffer
+	const DedriftKernel *dedriftKernel;	// dedrift kernel
 
 	float32_t createChannel(bool baseline);
 	void baselineChannel(float32_t base);
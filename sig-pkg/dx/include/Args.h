@@ -106,6 +106,9 @@ public:
 	int32_t getCacheRows() {
 		return (dadd.cacheRows);
 	}
+	int32_t getDaddThreads() {
+		return (dadd.threads);
+	}
 	string getDxName() {
 		return (dxName);
 	}
@@ -129,6 +132,12 @@ public:
 	int32_t getFoldings() {
 		return (foldings);
 	}
+	int32_t getSpectrometerThreads() {
+		return (spectrometerThreads);
+	}
+	int32_t getConfirmationThreads() {
+		return (confirmationThreads);
+	}
 	float64_t getOversampling() {
 		return (oversampling);
 	}
@@ -181,8 +190,10 @@ private:
 	struct Dadd {
 		bool cacheEfficient;			// use divide and conquer DADD
 		int32_t cacheRows;				// # of DADD rows to cache
+		int32_t threads;				// # of DADD worker threads
 
-		Dadd(): cacheEfficient(true), cacheRows(DADD_CACHE_ROWS) {}
+		Dadd(): cacheEfficient(true), cacheRows(DADD_CACHE_ROWS),
+				threads(DEFAULT_DADD_THREADS) {}
 	} dadd;
 
 	string dxName;						// name of this dx
@@ -196,6 +207,8 @@ private:
 	int32_t usableSubchannels;			// # of usable subchannels
 	int32_t maxFrames;					// max # of frames in an activity
 	int32_t foldings;					// # of foldings in DFB filter
+	int32_t spectrometerThreads;		// # of spectrometer workers
+	int32_t confirmationThreads;		// # of CW confirmation workers
 	float64_t oversampling;				// percentage of oversampling
 	float64_t chanOversampling;			// percentage of channel oversampling
 	float64_t chanBandwidth;			// nominal channel bandwidth
@@ -88,6 +88,7 @@
 #include "Partition.h"
 #include "Queue.h"
 #include "ReadFilter.h"
+#include "SampleKernel.h"
 //#include "Spectra.h"
 //#include "State.h"
 #include "WorkQ.h"
@@ -338,6 +339,7 @@ public:
 private:
 	bool initialized;					// channel has been initialized
 	bool swap;							// swap real and imaginary
+	const SampleKernel *sampleKernel;	// input sample conversion
 //	bool scheduled;						// scheduled for worker task?
 	bool singlePol;						// running a single polarization?
 	bool armed;							// armed to start activity
@@ -445,10 +447,6 @@ private:
 	void addPacket(ChannelPacket *pkt);
 	int32_t dfbPol(uint64_t sample, InputBuffer *inBuf,
 			ComplexFloat32 *sampleBuf, ComplexFloat32 **obuf);
-	void getSamples(ComplexFloat32 *sampleBuf, ComplexInt16 *samples,
-			int32_t len);
-	void getSwappedSamples(ComplexFloat32 *sampleBuf, ComplexInt16 *samples,
-			int32_t len);
 
 	void lock() { cLock.lock(); }
 	void unlock() { cLock.unlock(); }
@@ -36,12 +36,11 @@
 #ifndef _CwClustererH
 #define _CwClustererH
 
-#include <map>
+#include <pthread.h>
 #include <vector>
 #include <sseDxInterface.h>
 #include "ChildClusterer.h"
 
-using std::multimap;
 using std::pair;
 using std::vector;
 using namespace sonata_lib;
@@ -85,7 +84,17 @@ private:
 		HitReport(int startBin_, int drift_, int power_): startBin(startBin_),
 				drift(drift_), power(power_) {}
 	};
-	typedef multimap<float,HitReport> HitList;
+	// hit keyed by mid-bin
+	typedef pair<float,HitReport> Hit;
+	typedef vector<Hit> HitList;
+	// hits recorded by a single thread
+	struct HitBuffer
+	{
+		pthread_t thread;
+		HitList hits;
+
+		HitBuffer(pthread_t thread_): thread(thread_) {}
+	};
 	struct Cluster
 	{
 		HitReport hr;
@@ -100,7 +109,9 @@ private:
 	CwClusterer& operator=(CwClusterer&);
 
 	// service routines
-	bool absorb(Cluster &, const pair<float,HitReport>&);
+	HitList *getBuffer();
+	void sortHits();
+	bool absorb(Cluster &, const Hit&);
 	void clusterDone(Cluster &);
 
 	// clustering configuration data
@@ -109,8 +120,12 @@ private:
 	// observation data
 	Polarization pole;
 
-	// hits to be clustered
+	// hits to be clustered: each thread records into its own buffer,
+	// which are merged and sorted by mid-bin when all hits are loaded
+	uint64_t id;
+	vector<HitBuffer *> buffers;
 	HitList hitList;
+	HitList sortList;
 
 	// results
 	ClusterList clusterList;
@@ -0,0 +1,161 @@
+/*******************************************************************************
+
+ File:    CwCoherentEngine.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW coherent search engine class
+//
+// Finds the microdrift and coherent bandwidth which best describe a
+// confirmation signal, trying each drift hypothesis as an independent
+// item on a pool of workers.
+//
+#ifndef _CwCoherentEngineH
+#define _CwCoherentEngineH
+
+#include <iostream>
+#include <vector>
+#include <fftw3.h>
+#include "System.h"
+#include "DedriftKernel.h"
+#include "WorkerPool.h"
+
+using std::ostream;
+using std::endl;
+using std::vector;
+using namespace sonata_lib;
+
+namespace dx {
+
+struct ChiReport {
+	int32_t bins;						// # of bins per spectrum
+	float64_t power;					// total power
+	float64_t chiSq;
+	int32_t clusterWidth;
+	int32_t clusterIndex;
+
+	ChiReport(): bins(0), power(0), chiSq(0), clusterWidth(0),
+			clusterIndex(0) {}
+
+	friend ostream& operator << (ostream &strm, const ChiReport& pchir)
+	{
+		strm << "ChiReport: "
+			<< "bins: " << pchir.bins
+			<< ", power: " << pchir.power
+			<< ", chiSq: " << pchir.chiSq
+			<< ", clusterWidth: " << pchir.clusterWidth
+			<< ", clusterIndex: " << pchir.clusterIndex << endl;
+		return (strm);
+	}
+
+};
+
+struct CoherentReport {
+	int32_t microDrift;					// # of microbins of drift
+	float64_t signif;					// significance
+	ChiReport chi;					// chi-squared report
+
+	CoherentReport(): microDrift(0), signif(0) {}
+
+	friend ostream& operator << (ostream &strm, const CoherentReport &pcohr)
+	{
+		strm << "CoherentReport: "
+			<< "microdrift: " << pcohr.microDrift
+			<< ", signif: " << pcohr.signif << endl
+			<< pcohr.chi;
+		return (strm);
+	}
+};
+
+/**
+ * CW coherent search engine.
+ *
+ * Description:\n
+ * 	Each of the 2 * samples - 1 drifts from -(samples - 1) to
+ * 	samples - 1 microbins is an independent item: the worker dedrifts
+ * 	the time samples into its own buffer, transforms them with its own
+ * 	FFTW plan and finds the most significant coherent width for the
+ * 	drift.  The chi-square report of each drift is recorded, and the
+ * 	best drift is selected in increasing drift order after all items
+ * 	are done, so the result is the same for any number of workers.\n
+ * Notes:\n
+ * 	The plans are created with FFTW_MEASURE by setup() and are reused
+ * 	for every candidate until the number of samples changes.\n
+ * 	With a single worker no tasks are created and all processing is
+ * 	done by the caller.
+ */
+class CwCoherentEngine: public PoolJob {
+public:
+	CwCoherentEngine(int32_t workers_, int prio_ = CWD_CONFIRMATION_PRIO,
+			bool realtime_ = true);
+	~CwCoherentEngine();
+
+	int32_t getWorkers() { return (pool->getWorkers()); }
+	int32_t getSamples() { return (samples); }
+	void setDedriftKernel(DedriftKernelType type);
+	void setup(int32_t samples_);
+	CoherentReport search(const ComplexFloat32 *td_);
+
+	static ChiReport checkCoherence(ComplexFloat32 *data, float64_t avgPower,
+			int32_t bins, int32_t drift, int32_t fSearch, int32_t wSearch);
+
+	// PoolJob
+	void execute(int32_t worker, int32_t item);
+
+private:
+	/**
+	 * Per-worker state.
+	 */
+	struct CwCoherentWorker {
+		int32_t samples;				// # of samples
+		ComplexFloat32 *dd;				// dedrifted time-domain samples
+		ComplexFloat32 *fd;				// spectrum of dedrifted samples
+		fftwf_plan plan;				// fftw plan
+
+		CwCoherentWorker(): samples(0), dd(0), fd(0), plan(0) {}
+		~CwCoherentWorker();
+
+		void setup(int32_t samples_);
+		void release();
+	};
+
+	int32_t samples;					// # of time samples
+	const ComplexFloat32 *td;			// time samples being searched
+	vector<ChiReport> items;			// chi-square report, by drift
+	vector<CwCoherentWorker *> workers;	// per-worker state
+	WorkerPool *pool;
+	const DedriftKernel *dedriftKernel;	// dedrift kernel
+
+	// forbidden
+	CwCoherentEngine(const CwCoherentEngine&);
+	CwCoherentEngine& operator=(const CwCoherentEngine&);
+};
+
+}
+
+#endif
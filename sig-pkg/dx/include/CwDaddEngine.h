@@ -0,0 +1,217 @@
+/*******************************************************************************
+
+ File:    CwDaddEngine.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW DADD engine class
+//
+// Performs DADD CW detection on both slopes of one or more polarizations,
+// dividing the spectrum into slices and handing each (polarization,
+// slope, slice) to a pool of workers.
+//
+#ifndef _CwDaddEngineH
+#define _CwDaddEngineH
+
+#include <vector>
+#include "System.h"
+#include "CwUnpacker.h"
+#include "Dadd.h"
+#include "Report.h"
+#include "WorkerPool.h"
+
+using std::vector;
+using namespace dadd;
+using namespace sonata_lib;
+
+namespace dx {
+
+/**
+ * CW DADD engine parameters.
+ *
+ * Description:\n
+ * 	The DADD parameters for an activity.  The spectrum is divided into
+ * 	slices bins-wide chunks which are processed independently.\n
+ * Notes:\n
+ * 	spectrumBins and totalBins must be multiples of 8.
+ */
+struct CwDaddParams {
+	int32_t spectra;					// # of spectra
+	int32_t spectrumBins;				// # of bins in a spectrum
+	int32_t totalBins;					// total bins (includes overlap)
+	int32_t threshold;					// single polarization threshold
+	int32_t bandBins;					// # of bins in a band
+	int32_t badBandLimit;				// bad band path limit
+	int32_t slices;						// # of slices per spectrum
+
+	CwDaddParams(): spectra(0), spectrumBins(0), totalBins(0), threshold(0),
+			bandBins(0), badBandLimit(0), slices(1) {}
+};
+
+/**
+ * Polarization to be processed.
+ */
+struct CwDaddPol {
+	Polarization pol;					// polarization
+	uint8_t *data;						// packed CW data
+	ReportHit *reportHit;				// hit callback
+	ReportBadBand *reportBadBand;		// bad band callback
+
+	CwDaddPol(): pol(POL_UNINIT), data(0), reportHit(0), reportBadBand(0) {}
+	CwDaddPol(Polarization pol_, uint8_t *data_, ReportHit *reportHit_,
+			ReportBadBand *reportBadBand_): pol(pol_), data(data_),
+			reportHit(reportHit_), reportBadBand(reportBadBand_) {}
+};
+
+/**
+ * CW DADD engine.
+ *
+ * Description:\n
+ * 	Each (polarization, slope, slice) is an independent item: the worker
+ * 	unpacks the slice (plus the bins needed for the widest path) into
+ * 	its own detection buffer, runs DADD on it and records the
+ * 	over-threshold paths.\n
+ * Notes:\n
+ * 	Paths are merged by polarization, slope and drift, in increasing
+ * 	buffer bin order, which is the order in which a single DADD of the
+ * 	entire spectrum finds them.  The band accounting is done during the
+ * 	merge, so the hits and bad bands reported are the same for any
+ * 	number of workers and slices.  Each item keeps at most
+ * 	badBandLimit + 1 paths per band, so the memory used by an item is
+ * 	bounded even when the data is full of RFI.\n
+ * 	Bins in the buffers which are not loaded with data are zeroed.\n
+ * 	With a single worker no tasks are created and all processing is
+ * 	done by the caller.
+ */
+class CwDaddEngine: public PoolJob {
+public:
+	CwDaddEngine(int32_t workers_, int prio_ = CWD_PRIO,
+			bool realtime_ = true);
+	~CwDaddEngine();
+
+	int32_t getWorkers() { return (pool->getWorkers()); }
+	int32_t getSlices() { return (slices); }
+	int32_t getSliceBins() { return (sliceBins); }
+	int32_t getSliceWidth() { return (sliceWidth); }
+	size_t getStoredPaths();
+	void setup(const CwDaddParams& params_, void *buf = 0, size_t size = 0);
+	void detect(const CwDaddPol *pols_, int32_t nPols_);
+	const DaddStatistics& getStatistics() {
+		return (bandDadd.getStatistics());
+	}
+
+	// PoolJob
+	void execute(int32_t worker, int32_t item);
+
+private:
+	/**
+	 * Paths of a band which an item did not keep.
+	 */
+	struct BandOverflow {
+		int32_t hits;					// # of paths not kept
+		DaddPath maxPath;				// first maximum power path
+
+		BandOverflow(const DaddPath& path): hits(1), maxPath(path) {}
+	};
+
+	/**
+	 * Paths found by an item.
+	 */
+	struct CwDaddItem {
+		vector<DaddPath> paths;			// paths kept, in detection order
+		vector<BandOverflow> overflow;	// paths not kept, by drift
+	};
+
+	/**
+	 * Collects the paths found by a worker.
+	 *
+	 * Description:\n
+	 * 	Keeps the first keep paths of each band; only those can be
+	 * 	reported once the items are merged.  The remaining paths of a
+	 * 	band are only counted, along with the first of them with the
+	 * 	maximum power, which may still be the maximum path of the band.
+	 */
+	class PathList: public ReportHit {
+	public:
+		PathList(): keep(0), bandBins(0), item(0) {}
+		void start(CwDaddItem *item_, int32_t keep_, int32_t bandBins_,
+				int32_t bands);
+		void finish();
+		virtual void report(const DaddPath& path);
+
+	private:
+		int32_t keep;					// # of paths kept per band
+		int32_t bandBins;				// # of bins in a band
+		CwDaddItem *item;				// item being collected
+		vector<int32_t> bandPaths;		// # of paths found, by band
+		vector<int32_t> bandOverflow;	// overflow index, by band
+	};
+
+	/**
+	 * Per-worker state.
+	 */
+	struct CwDaddWorker {
+		bool allocated;					// buffer allocated by worker
+		size_t size;					// size of buffer in bytes
+		DaddAccum *buf;					// detection buffer
+		CwUnpacker unpacker;			// unpacker
+		Dadd dadd;						// DADD processor
+		PathList pathList;				// paths found
+
+		CwDaddWorker(): allocated(false), size(0), buf(0) {}
+		~CwDaddWorker();
+
+		void setBuffer(void *buf_, size_t size_);
+		void release();
+	};
+
+	int32_t nPols;						// # of polarizations
+	int32_t slices;						// # of slices
+	int32_t sliceBins;					// # of bins in a slice
+	int32_t sliceWidth;					// width of a slice row in bins
+	const CwDaddPol *pols;				// polarizations being processed
+	CwDaddParams params;				// activity parameters
+	Dadd bandDadd;						// band accounting
+	vector<CwDaddItem> items;			// paths found, by item
+	vector<CwDaddWorker *> workers;		// per-worker state
+	WorkerPool *pool;
+
+	void unpack(CwDaddWorker *w, uint8_t *data, DaddSlope slope,
+			int32_t base);
+	void zeroBins(DaddAccum *buf, int32_t bin, int32_t bins);
+	void mergePol(int32_t p);
+	static bool lessDrift(const BandOverflow& a, const BandOverflow& b);
+
+	// forbidden
+	CwDaddEngine(const CwDaddEngine&);
+	CwDaddEngine& operator=(const CwDaddEngine&);
+};
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*******************************************************************************
+
+ File:    CwKernel.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW power kernels
+//
+// Convert a spectrum to CW data: optionally apply a Hanning window,
+// compute the power of each bin, and pack the power as a 2-bit value,
+// 32 bins per 64-bit word.  There is a portable scalar version of each
+// kernel, which is the reference, plus vector versions which are selected
+// at run time according to the capabilities of the processor.  All
+// versions produce identical results.
+//
+#ifndef _CwKernelH
+#define _CwKernelH
+
+#include "System.h"
+
+namespace dx {
+
+// # of bins packed into each word of CW data
+const int32_t CW_BINS_PER_WORD = sizeof(uint64_t) * CWD_BINS_PER_BYTE;
+
+/**
+ * CW kernels.  BestCwKernel selects the fastest one supported by the
+ * processor.
+ */
+enum CwKernelType {
+	ScalarCwKernel,
+	Sse2CwKernel,
+	Avx2CwKernel,
+	BestCwKernel
+};
+
+typedef void (*CwPackFunc)(uint64_t *out, const ComplexFloat32 *data,
+		int32_t words);
+
+/**
+ * Kernel function table.
+ *
+ * Description:\n
+ * 	pack stores the 2-bit power of CW_BINS_PER_WORD * words bins
+ * 	starting at data, with the first bin in the least significant bits
+ * 	of the first word; the power is truncated to an integer and limited
+ * 	to 3.  packHanning does the same, but first applies a Hanning window
+ * 	scaled by the inverse of its power gain, so it also reads the bins
+ * 	before and after the block.
+ */
+struct CwKernel {
+	CwKernelType type;
+	const char *name;
+	CwPackFunc pack;
+	CwPackFunc packHanning;
+};
+
+const CwKernel *getCwKernel(CwKernelType type = BestCwKernel);
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+/*******************************************************************************
+
+ File:    CwPathSearch.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW power path search class
+//
+// Finds the strongest straight drift path through the power plane of a
+// confirmation signal channel, computing the sums of a block of start
+// bins for one drift at a time instead of one path at a time.
+//
+#ifndef _CwPathSearchH
+#define _CwPathSearchH
+
+#include <vector>
+#include "System.h"
+
+using std::vector;
+
+namespace dx {
+
+// # of start bins summed at once, at most and at least
+const int32_t PATH_BLOCK_BINS = 32;
+const int32_t PATH_MIN_BLOCK_BINS = 8;
+// # of spectra summed between checks for pruning a block
+const int32_t PATH_PRUNE_SPECTRA = 16;
+
+/**
+ * A drift path through the power plane.
+ */
+struct CwPath {
+	int32_t bin;						// start bin
+	int32_t drift;						// drift over the plane (bins)
+	float32_t power;					// total power on the path
+
+	CwPath(): bin(0), drift(0), power(0) {}
+	CwPath(int32_t bin_, int32_t drift_, float32_t power_): bin(bin_),
+			drift(drift_), power(power_) {}
+};
+
+/**
+ * CW power path search.
+ *
+ * Description:\n
+ * 	The power plane has spectra rows of bins powers.  A path starts
+ * 	at a bin of the first spectrum and drifts by drift bins over the
+ * 	plane; its power is the sum of the bins on the path, spectrum by
+ * 	spectrum.  searchAll() sums every path separately.  search()
+ * 	computes the bin offsets of a drift once, then sums a whole block
+ * 	of start bins with unit-stride vector adds, in the same order, so
+ * 	the sums are identical.  Drifts are tried in order of increasing
+ * 	magnitude, so a dedrifted signal is found early, and a block is
+ * 	abandoned as soon as its largest partial sum plus the largest
+ * 	power in each remaining spectrum cannot reach the best path.  Both
+ * 	return the same path: the strongest one, or the one with the
+ * 	lowest start bin, then the lowest drift, if several are equal.\n
+ * Notes:\n
+ * 	Powers must not be negative.\n
+ * 	Only paths which remain inside the plane are considered: a drift
+ * 	d may not exceed the # of spectra, and a path starting at bin b
+ * 	must have -b <= d < bins - b.
+ */
+class CwPathSearch {
+public:
+	CwPathSearch();
+	~CwPathSearch();
+
+	CwPath search(const float32_t *power, int32_t spectra, int32_t bins);
+	CwPath searchAll(const float32_t *power, int32_t spectra,
+			int32_t bins);
+
+	static int32_t getOffset(int32_t spectrum, int32_t spectra,
+			int32_t drift);
+
+	int64_t getBlocks() { return (blocks); }
+	int64_t getPruned() { return (pruned); }
+
+private:
+	int64_t blocks;						// # of blocks in the last search
+	int64_t pruned;						// # of blocks pruned
+	int32_t blockBins;					// # of start bins per block
+	int32_t pad;						// # of zeros on each side of a spectrum
+	int32_t stride;						// # of bins per padded spectrum
+	vector<float32_t> plane;			// padded power plane
+	vector<int32_t> offset;				// offset of the path in each spectrum
+	vector<float64_t> remainMax;		// sum of the largest power in each
+										// spectrum from this one on
+	vector<float32_t> sum;				// path sums of a block
+
+	void computeOffsets(int32_t spectra, int32_t drift);
+	bool sumBlock(const float32_t *base, int32_t spectra,
+			float32_t minPower);
+
+	// forbidden
+	CwPathSearch(const CwPathSearch&);
+	CwPathSearch& operator=(const CwPathSearch&);
+};
+
+}
+
+#endif
@@ -46,24 +46,31 @@ using namespace sonata_lib;
 
 namespace dx {
 
+/**
+ * Unpacked equivalent of a byte of packed data.
+ */
+struct CwUnpackedByte {
+	DaddAccum bin[CWD_BINS_PER_BYTE];
+};
+
 class CwUnpacker {
 public:
 	CwUnpacker();
 	virtual ~CwUnpacker();
 
-	void unpack(DaddSlope slope, uint8_t *packed, uint64_t *unpacked,
+	void unpack(DaddSlope slope, uint8_t *packed, DaddAccum *unpacked,
 			int32_t packedOfs, int32_t unpackedOfs, int32_t spectra,
 			int32_t bins, int32_t packedStride, int32_t unpackedStride);
 
 private:
-	uint64_t *xlatPos, *xlatNeg;
+	CwUnpackedByte *xlatPos, *xlatNeg;
 
 	Args *cmdArgs;
 
-	uint64_t *buildUnpackArray(DaddSlope slope);
-	void unpackPos(uint8_t *packed, uint64_t *unpacked, int32_t spectra,
+	CwUnpackedByte *buildUnpackArray(DaddSlope slope);
+	void unpackPos(uint8_t *packed, CwUnpackedByte *unpacked, int32_t spectra,
 			int32_t bins, int32_t packedStride, int32_t unpackedStride);
-	void unpackNeg(uint8_t *packed, uint64_t *unpacked, int32_t spectra,
+	void unpackNeg(uint8_t *packed, CwUnpackedByte *unpacked, int32_t spectra,
 			int32_t bins, int32_t packedStride, int32_t unpackedStride);
 
 	// forbidden
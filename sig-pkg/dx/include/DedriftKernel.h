@@ -0,0 +1,89 @@
+/*******************************************************************************
+
+ File:    DedriftKernel.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Dedrift kernels
+//
+// Remove a linear frequency drift from a block of complex time samples
+// by multiplying each sample by a unit phasor whose phase is quadratic
+// in the sample number.  The scalar kernel is the extended precision
+// phase recurrence, which is the reference.  The vector kernels compute
+// the phasors in single precision from a double precision anchor which
+// is recomputed every DEDRIFT_ANCHOR_SAMPLES samples, so their error does
+// not grow with the length of the block.  They are selected at run time
+// according to the capabilities of the processor.
+//
+#ifndef _DedriftKernelH
+#define _DedriftKernelH
+
+#include "System.h"
+
+namespace dx {
+
+// # of samples between double precision anchors in the vector kernels
+const int32_t DEDRIFT_ANCHOR_SAMPLES = 64;
+
+/**
+ * Dedrift kernels.  BestDedriftKernel selects the fastest one supported
+ * by the processor.
+ */
+enum DedriftKernelType {
+	ScalarDedriftKernel,
+	Sse2DedriftKernel,
+	Avx2DedriftKernel,
+	BestDedriftKernel
+};
+
+typedef void (*DedriftFunc)(ComplexFloat32 *out, const ComplexFloat32 *in,
+		int32_t n, float64_t freq, float64_t drift);
+
+/**
+ * Kernel function table.
+ *
+ * Description:\n
+ * 	dedrift computes out[i] = in[i] * exp(j * (freq * i + drift * i * i))
+ * 	for n samples, where freq is in radians per sample and drift is in
+ * 	radians per sample squared.  out may be the same as in.\n
+ * Notes:\n
+ * 	The phasors of the vector kernels differ from the exact phasors by
+ * 	a few single precision roundings, regardless of n.
+ */
+struct DedriftKernel {
+	DedriftKernelType type;
+	const char *name;
+	DedriftFunc dedrift;
+};
+
+const DedriftKernel *getDedriftKernel(
+		DedriftKernelType type = BestDedriftKernel);
+
+}
+
+#endif
@@ -103,6 +103,7 @@ enum ConnectionType {
 enum InternalMessageCode {
 	InitiateConnection = DX_MESSAGE_CODE_END,
 	InputPacket,
+	InputPacketBatch,
 	Tune,
 	StartCollection,
 	DspCollectionComplete,
@@ -54,6 +54,12 @@ namespace dx {
 //		Because a birdie mask may be shared by more than one
 //		activity, each activity must keep track of where it
 //		is in processing the mask.
+//		The bands of a mask never change after construction; a new
+//		mask replaces the old one in State, and activities holding
+//		the old mask keep it alive through the use count.  The
+//		interval index used by isMasked is built once in the
+//		constructor and is read-only thereafter, so lookups take no
+//		lock.
 
 class FrequencyMask {
 public:
@@ -69,6 +75,10 @@ public:
 	FrequencyBand *getNext();				// return next frequency band
 	FrequencyBand *getBand(int32_t idx_);	// return frequency band at idx_
 	bool isMasked(float64_t frequency_, float64_t width_);
+	void isMasked(const float64_t *frequency_, int32_t n_,
+			float64_t width_, bool *masked_);
+	void isMasked(const float64_t *frequency_, const float64_t *width_,
+			int32_t n_, bool *masked_);
 
 	int incrementUseCount();
 	int decrementUseCount();
@@ -80,11 +90,17 @@ private:
 	FrequencyBand bandCovered;			// total coverage of the mask
 	FrequencyBand *mask;				// array containing the mask
 	NssDate versionDate;				// date of the mask
+	int32_t nIntervals;					// number of merged intervals
+	float64_t *loIndex;					// sorted low edges of intervals
+	float64_t *hiIndex;					// sorted high edges of intervals
     Lock mLock;                      // mutual exclusion lock
 
 	void lock() { mLock.lock(); }
 	void unlock() { mLock.unlock(); }
 
+	void buildIndex();
+	int32_t findInterval(float64_t loFreq_);
+
 	// forbidden
 	FrequencyMask(const FrequencyMask&);
 	FrequencyMask& operator=(const FrequencyMask&);
@@ -0,0 +1,82 @@
+/*******************************************************************************
+
+ File:    PulseKernel.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Pulse threshold kernels
+//
+// Compute the power of each bin of a spectrum and return the bins whose
+// power exceeds the pulse threshold as dense arrays of bin numbers and
+// powers.  There is a portable scalar version of the kernel, which is the
+// reference, plus vector versions which are selected at run time
+// according to the capabilities of the processor.  All versions produce
+// identical results.
+//
+#ifndef _PulseKernelH
+#define _PulseKernelH
+
+#include "System.h"
+
+namespace dx {
+
+/**
+ * Pulse kernels.  BestPulseKernel selects the fastest one supported by
+ * the processor.
+ */
+enum PulseKernelType {
+	ScalarPulseKernel,
+	Sse2PulseKernel,
+	Avx2PulseKernel,
+	BestPulseKernel
+};
+
+typedef int32_t (*PulseThresholdFunc)(const ComplexFloat32 *data, int32_t n,
+		float32_t threshold, int32_t *bin, float32_t *power);
+
+/**
+ * Kernel function table.
+ *
+ * Description:\n
+ * 	threshold stores the index and power of each of the n bins starting
+ * 	at data whose power is greater than the threshold, in order of
+ * 	increasing index, and returns the number stored.  The output arrays
+ * 	must have room for n entries; entries past the number returned may
+ * 	be overwritten.
+ */
+struct PulseKernel {
+	PulseKernelType type;
+	const char *name;
+	PulseThresholdFunc threshold;
+};
+
+const PulseKernel *getPulseKernel(PulseKernelType type = BestPulseKernel);
+
+}
+
+#endif
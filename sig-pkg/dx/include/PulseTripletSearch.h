@@ -0,0 +1,116 @@
+/*******************************************************************************
+
+ File:    PulseTripletSearch.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Pulse triplet search class
+//
+// Finds sets of three pulses within a frequency slice which are evenly
+// spaced in time and frequency, using an index of the pulses by
+// (spectrum, bin) instead of testing every combination.
+//
+#ifndef _PulseTripletSearchH
+#define _PulseTripletSearchH
+
+#include <vector>
+#include "System.h"
+#include "DxStruct.h"
+
+using std::vector;
+
+namespace dx {
+
+typedef vector<dx::Pulse> PulseVector;
+
+/**
+ * A pulse triplet, as indices into the searched pulse vector.
+ */
+struct PulseTriplet {
+	int32_t p0;
+	int32_t p1;
+	int32_t p2;
+
+	PulseTriplet(): p0(0), p1(0), p2(0) {}
+	PulseTriplet(int32_t p0_, int32_t p1_, int32_t p2_): p0(p0_), p1(p1_),
+			p2(p2_) {}
+};
+
+typedef vector<PulseTriplet> PulseTripletList;
+
+/**
+ * Pulse triplet search.
+ *
+ * Description:\n
+ * 	A triplet is three pulses p0, p1, p2, where p0 is in the slice,
+ * 	p2 lies within the drift cone of p0, and the (spectrum, bin)
+ * 	steps from p0 to p1 and from p1 to p2 are about equal.  search()
+ * 	indexes the pulses by (spectrum, bin); for each p0 it visits only
+ * 	the pulses p1 inside the drift cone, then looks up p2 directly at
+ * 	the position predicted by the p0-p1 step.  The triplets are
+ * 	returned in exactly the order produced by searchAll(), which
+ * 	tests every combination of pulses.\n
+ * Notes:\n
+ * 	The pulses must be sorted by spectrum, with no two pulses at the
+ * 	same (spectrum, bin).
+ */
+class PulseTripletSearch {
+public:
+	PulseTripletSearch();
+	~PulseTripletSearch();
+
+	void search(const PulseVector& pulses, int32_t startBin,
+			int32_t endBin, float32_t maxDrift_, PulseTripletList& triplets);
+	void searchAll(const PulseVector& pulses, int32_t startBin,
+			int32_t endBin, float32_t maxDrift_, PulseTripletList& triplets);
+
+	bool insideDriftCone(const dx::Pulse& p0, const dx::Pulse& p2);
+	bool tripletCheck(const dx::Pulse& p0, const dx::Pulse& p1,
+			const dx::Pulse& p2);
+	bool aboutEqual(const PulseDiff& d0, const PulseDiff& d1);
+
+private:
+	float32_t maxDrift;					// max # of bins drift / spectrum
+	int32_t minSpectrum;				// first spectrum in the index
+	int32_t maxSpectrum;				// last spectrum in the index
+	vector<int32_t> rowStart;			// start of each spectrum in index
+	vector<int32_t> bins;				// bins of the pulses, by (spectrum, bin)
+	vector<int32_t> order;				// pulse numbers, by (spectrum, bin)
+	vector<PulseTriplet> found;			// triplets for the current p0
+
+	void buildIndex(const PulseVector& pulses);
+	int32_t findRow(int32_t spectrum, int32_t bin, int32_t& end);
+
+	// forbidden
+	PulseTripletSearch(const PulseTripletSearch&);
+	PulseTripletSearch& operator=(const PulseTripletSearch&);
+};
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*******************************************************************************
+
+ File:    SampleKernel.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Input sample conversion kernels
+//
+// Convert 16-bit complex input samples to single precision for the DFB,
+// optionally swapping real and imaginary.  There is a portable scalar
+// version of each kernel, which is the reference, plus vector versions
+// which are selected at run time according to the capabilities of the
+// processor.  All versions produce identical results.
+//
+#ifndef _SampleKernelH
+#define _SampleKernelH
+
+#include "System.h"
+#include "InputBuffer.h"
+
+namespace dx {
+
+/**
+ * Sample conversion kernels.  BestSampleKernel selects the fastest one
+ * supported by the processor.
+ */
+enum SampleKernelType {
+	ScalarSampleKernel,
+	Sse41SampleKernel,
+	Avx2SampleKernel,
+	BestSampleKernel
+};
+
+typedef void (*SampleConvertFunc)(ComplexFloat32 *out,
+		const ComplexInt16 *in, int32_t n);
+
+/**
+ * Kernel function table.
+ *
+ * Description:\n
+ * 	convert widens n samples to single precision; convertSwapped does
+ * 	the same, but exchanges the real and imaginary parts.
+ */
+struct SampleKernel {
+	SampleKernelType type;
+	const char *name;
+	SampleConvertFunc convert;
+	SampleConvertFunc convertSwapped;
+};
+
+const SampleKernel *getSampleKernel(SampleKernelType type = BestSampleKernel);
+void convertSamples(SampleConvertFunc convert, InputBuffer *inBuf,
+		uint64_t sample, int32_t n, ComplexFloat32 *out);
+
+}
+
+#endif
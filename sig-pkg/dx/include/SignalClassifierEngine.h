@@ -0,0 +1,105 @@
+/*******************************************************************************
+
+ File:    SignalClassifierEngine.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Signal classifier engine class
+//
+// Tests all the signals of an activity against the recent RFI and test
+// signal masks and the bad band lists at once, by sorting the signals
+// by frequency and merging them with the sorted masks and bands.  The
+// results are identical to testing each signal on its own.
+//
+#ifndef _SignalClassifierEngineH
+#define _SignalClassifierEngineH
+
+#include <utility>
+#include <vector>
+#include <sseDxInterface.h>
+#include "System.h"
+#include "FrequencyMask.h"
+
+using std::pair;
+using std::vector;
+using namespace sonata_lib;
+
+namespace dx {
+
+class SignalClassifierEngine {
+public:
+	SignalClassifierEngine();
+	~SignalClassifierEngine();
+
+	void clear();
+	void addSignal(const SignalDescription *sig_);
+	void addBadBand(const FrequencyBand& band_);
+	void classify(FrequencyMask *recentRfi_, FrequencyMask *testSignal_,
+			float64_t obsLen_);
+
+	int32_t getCount() { return (sigs.size()); }
+	bool isRecentRfi(int32_t idx_) { return (flags[idx_] & RecentRfiFlag); }
+	bool isTestSignal(int32_t idx_)
+	{
+		return (flags[idx_] & TestSignalFlag);
+	}
+	bool isInBadBand(int32_t idx_) { return (flags[idx_] & BadBandFlag); }
+
+	static bool match(const SignalDescription& sig_,
+			const FrequencyBand& band_, float64_t obsLen_);
+
+private:
+	enum {
+		RecentRfiFlag = 1,
+		TestSignalFlag = 2,
+		BadBandFlag = 4
+	};
+
+	vector<const SignalDescription *> sigs;	// signals in arrival order
+	vector<FrequencyBand> badBands;		// bad bands in arrival order
+	vector<uint8_t> flags;				// results, in arrival order
+
+	// work areas, in frequency order
+	vector<pair<float64_t, int32_t> > order;	// signal freq and index
+	vector<float64_t> freq;				// signal frequency (MHz)
+	vector<float64_t> width;			// signal width (MHz)
+	vector<pair<float64_t, float64_t> > bands;	// bad band edges
+	vector<float64_t> bandLo;			// bad band low edges
+	vector<float64_t> maxBandHi;		// running maximum high edge
+
+	void applyMask(FrequencyMask *mask, uint8_t flag);
+	void applyBadBands(float64_t obsLen);
+
+	// forbidden
+	SignalClassifierEngine(const SignalClassifierEngine&);
+	SignalClassifierEngine& operator=(const SignalClassifierEngine&);
+};
+
+}
+
+#endif
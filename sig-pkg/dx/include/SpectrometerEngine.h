@@ -0,0 +1,257 @@
+/*******************************************************************************
+
+ File:    SpectrometerEngine.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Spectrometer engine class
+//
+// Performs baselining, spectrometry, CD/CW data creation and pulse
+// thresholding for all subchannels of a half frame, dividing the
+// subchannels among a pool of workers.
+//
+#ifndef _SpectrometerEngineH
+#define _SpectrometerEngineH
+
+#include <vector>
+#include "System.h"
+#include "Channel.h"
+#include "CwKernel.h"
+#include "PulseKernel.h"
+#include "DxStruct.h"
+#include "Spectra.h"
+#include "WorkerPool.h"
+
+using std::vector;
+using namespace sonata_lib;
+using spectra::ResData;
+using spectra::ResInfo;
+
+namespace dx {
+
+/**
+ * Spectrometer engine parameters.
+ *
+ * Description:\n
+ * 	Describes the activity being processed: the number of subchannels,
+ * 	the resolutions to be created and the geometry of the CD and CW
+ * 	buffers.  Filled in by the spectrometer when an activity is set up.\n
+ * Notes:\n
+ * 	The bin counts are indexed by resolution, not by resolution index.
+ */
+struct SpecEngineParams {
+	bool hanning;						// use Hanning window for CW
+	int32_t subchannels;				// usable subchannels
+	int32_t samples;					// samples per subchannel half frame
+	int32_t spectraHalfFrames;			// # of half frames passed to Spectra
+	int32_t resolutions;				// resolutions being created
+	int32_t hfBytesPerSubchannel;		// subchannel stride in hf buffer
+	int32_t cdBytesPerSubchannelHalfFrame;
+	int32_t cdBytesPerSubchannel;		// subchannel stride in CD buffer
+	int32_t cwBytesPerSubchannel;		// subchannel stride in CW buffer
+	int32_t cwBytesPerSpectrum;			// spectrum stride in CW buffer
+	int32_t cwBufSize;					// size of CW temp buffer
+	int32_t totalBins[MAX_RESOLUTIONS];	// total bins per subchannel
+	int32_t usableBins[MAX_RESOLUTIONS];	// usable bins per subchannel
+	ResData resData[MAX_RESOLUTIONS];	// resolutions to create
+	ObsData obs;						// observation parameters
+	vector<bool> masked;				// subchannel mask
+
+	SpecEngineParams(): hanning(true), subchannels(0), samples(0),
+			spectraHalfFrames(DEFAULT_SPECTRA_HALF_FRAMES), resolutions(0),
+			hfBytesPerSubchannel(0), cdBytesPerSubchannelHalfFrame(0),
+			cdBytesPerSubchannel(0), cwBytesPerSubchannel(0),
+			cwBytesPerSpectrum(0), cwBufSize(0) {
+		for (int32_t i = 0; i < MAX_RESOLUTIONS; ++i)
+			totalBins[i] = usableBins[i] = 0;
+	}
+};
+
+/**
+ * Buffers for one polarization of a half frame.
+ */
+struct SpecPolData {
+	Polarization pol;					// polarization
+	ComplexFloat32 *hfData[HALF_FRAME_BUFFERS];	// hf buffers, oldest first
+	float32_t *blData;					// baseline array
+	void *cdData;						// CD buffer (entire observation)
+	void *cwData;						// CW buffer (entire observation)
+
+	SpecPolData(): pol(POL_UNINIT), blData(0), cdData(0), cwData(0) {
+		for (int32_t i = 0; i < HALF_FRAME_BUFFERS; ++i)
+			hfData[i] = 0;
+	}
+};
+
+/**
+ * Half frame to be processed.
+ *
+ * Description:\n
+ * 	The most recent half frame buffer is hfData[hfBufs-1]; spectra are
+ * 	computed only when hfBufs has reached the number of half frames
+ * 	passed to Spectra.
+ */
+struct SpecHalfFrame {
+	int32_t hf;							// half frame # (< 0 is baselining)
+	int32_t seed;						// CD test pattern seed
+	int32_t baselineHf;					// # of half frames baselined so far
+	int32_t hfBufs;						// # of valid hf buffers
+	int32_t spectrum[MAX_RESOLUTIONS];	// first spectrum, by res index
+	SpecPolData pol[POLARIZATIONS];		// right, then left
+
+	SpecHalfFrame(): hf(0), seed(0), baselineHf(0), hfBufs(0) {
+		for (int32_t i = 0; i < MAX_RESOLUTIONS; ++i)
+			spectrum[i] = 0;
+	}
+};
+
+/**
+ * Spectrometer engine.
+ *
+ * Description:\n
+ * 	Processes each (polarization, subchannel) pair of a half frame as an
+ * 	independent work item.  Each worker has its own Spectra instance
+ * 	(and hence its own FFTW plans and buffers), CD/CW temp buffers and
+ * 	pulse list, so items never share writable state.\n
+ * Notes:\n
+ * 	Pulses are merged in (polarization, subchannel) order after all
+ * 	items are done, and the per-half-frame pulse limit is applied
+ * 	during the merge, so the pulse list is identical for any number of
+ * 	workers.\n
+ * 	With a single worker no tasks are created and all processing is
+ * 	done by the caller.
+ */
+class SpectrometerEngine: public PoolJob {
+public:
+	SpectrometerEngine(int32_t workers_, int prio_ = WORKER_PRIO,
+			bool realtime_ = true);
+	~SpectrometerEngine();
+
+	int32_t getWorkers() { return (pool->getWorkers()); }
+	void setup(const SpecEngineParams& params_, ResInfo *resInfo_);
+	int32_t processHalfFrame(const SpecHalfFrame& frame_,
+			PulseList& pulseList);
+
+	// PoolJob
+	void execute(int32_t worker, int32_t item);
+
+private:
+	/**
+	 * Pulse detected by a worker; hit is the ordinal of the pulse
+	 * among all over-threshold bins of its item, starting at 1.
+	 */
+	struct SpecPulse {
+		int32_t hit;
+		Pulse pulse;
+
+		SpecPulse(int32_t hit_, const Pulse& pulse_): hit(hit_),
+				pulse(pulse_) {}
+	};
+
+	/**
+	 * Result of a work item.
+	 */
+	struct SpecItem {
+		int32_t worker;					// worker which did the item
+		int32_t first;					// first pulse in worker list
+		int32_t pulses;					// # of pulses stored
+		int32_t hits;					// # of over-threshold bins
+
+		SpecItem(): worker(0), first(0), pulses(0), hits(0) {}
+	};
+
+	/**
+	 * Per-worker state.
+	 */
+	struct SpecWorker {
+		ComplexPair *cdData;			// temp buffer for converted CD data
+		uint64_t *cwData;				// temp buffer for CW power data
+		int32_t *hitBin;				// over-threshold bins of a spectrum
+		float32_t *hitPower;			// powers of the over-threshold bins
+		ComplexFloat32 *buf[MAX_RESOLUTIONS];	// spectra, by res index
+		spectra::Spectra spectra;		// spectra library
+		vector<SpecPulse> pulses;		// pulses detected
+
+		SpecWorker();
+		~SpecWorker();
+
+		void setup(const SpecEngineParams& params, ResInfo *resInfo);
+		void release();
+	};
+
+	const SpecHalfFrame *frame;			// half frame being processed
+	SpecEngineParams params;			// activity parameters
+	ResInfo resInfo[MAX_RESOLUTIONS];
+	vector<SpecItem> items;				// results, by item
+	vector<SpecWorker *> workers;		// per-worker state
+	WorkerPool *pool;
+	const CwKernel *cwKernel;			// CW power kernels
+	const PulseKernel *pulseKernel;		// pulse threshold kernel
+
+	void processSubchannel(SpecWorker *w, const SpecPolData& pd,
+			int32_t subchannel, SpecItem& item);
+
+	// confirmation data functions
+	void zeroCdData(SpecWorker *w);
+	void loadCdPattern(SpecWorker *w, int32_t subchannel);
+	void computeCdData(SpecWorker *w, const ComplexFloat32 *data);
+	void storeCdData(SpecWorker *w, const SpecPolData& pd,
+			int32_t subchannel);
+
+	// CW data functions
+	void zeroCwData(SpecWorker *w);
+	void loadCwPattern(SpecWorker *w, Resolution res, int32_t subchannel,
+			int32_t spectrum);
+	void computeCwData(SpecWorker *w, Resolution res,
+			const ComplexFloat32 *data);
+	void storeCwData(SpecWorker *w, const SpecPolData& pd, Resolution res,
+			int32_t subchannel, int32_t spectrum);
+
+	// baseline functions
+	void computeBaseline(const SpecPolData& pd, int32_t subchannel,
+			ComplexFloat32 *hfData, float32_t weighting);
+
+	// pulse data functions
+	void storePulseData(SpecWorker *w, Polarization pol, Resolution res,
+			int32_t subchannel, int32_t spectrum, float32_t threshold,
+			const ComplexFloat32 *data, SpecItem& item);
+
+	ComplexFloat32 *getHfData(ComplexFloat32 *hfBuf, int32_t subchannel) {
+		return (reinterpret_cast<ComplexFloat32 *>
+				(reinterpret_cast<uint8_t *> (hfBuf)
+				+ (size_t) subchannel * params.hfBytesPerSubchannel));
+	}
+
+	// forbidden
+	SpectrometerEngine(const SpectrometerEngine&);
+	SpectrometerEngine& operator=(const SpectrometerEngine&);
+};
+
+}
+
+#endif
@@ -143,6 +143,9 @@ const int32_t DEFAULT_MESSAGES = 1000;
 const int32_t DEFAULT_QSLOTS = 50;
 const int32_t DEFAULT_PACKETS = 1000;
 const int32_t DEFAULT_SPECTRA_HALF_FRAMES = 3;
+const int32_t DEFAULT_SPECTROMETER_THREADS = 1;
+const int32_t DEFAULT_DADD_THREADS = 1;
+const int32_t DEFAULT_CONFIRMATION_THREADS = 1;
 const int32_t DEFAULT_FREQ = 1420;
 const float64_t DEFAULT_CHANNEL_WIDTH_MHZ = (104.8576 / 256);
 const float64_t DEFAULT_CHANNEL_OVERSAMPLING = .25;
@@ -153,6 +156,8 @@ const float64_t DEFAULT_BIN_OVERSAMPLING = .50;
 const int32_t MAX_DEDRIFT_SAMPLES = 64;
 const int32_t DEFAULT_MSGS = 1000;
 const int32_t CHANNEL_PACKETS = 1000;
+const int32_t CHANNEL_PACKET_BATCHES = CHANNEL_PACKETS;
+const int32_t RECEIVER_BATCH = 32;		// max packets per receive call
 const int32_t INPUT_BUFFERS = 2;
 
 const int32_t DADD_CACHE_ROWS = 16;
@@ -38,7 +38,8 @@
 namespace dx {
 
 ArchiveChannel::ArchiveChannel(): nSubchan(0), hf(0), samplesPerHf(0),
-		oversampling(0), freqMHz(0), spectrum(0), driftBuf(0)
+		oversampling(0), freqMHz(0), spectrum(0), driftBuf(0),
+		dedriftKernel(getDedriftKernel())
 {
 }
 
@@ -686,19 +687,24 @@ void
 ArchiveChannel::dedrift(ComplexFloat32 *iData, ComplexFloat32 *oData,
 		float64_t fMHz, float64_t driftHz)
 {
-	float96_t dTheta = -2 * M_PI * (fMHz - freqMHz) / ac.widthMHz;
-	float96_t widthHz = MHZ_TO_HZ(ac.widthMHz);
-	float96_t d2Theta = -M_PI * driftHz / (widthHz * widthHz);
-	ComplexFloat96 vector(1, 0);
-	ComplexFloat96 omega(cosl(dTheta + d2Theta), sinl(dTheta + d2Theta));
-	ComplexFloat96 dOmega(cosl(2 * d2Theta), sinl(2 * d2Theta));
-
-	for (int32_t i = 0; i < ac.samples; ++i) {
-		ComplexFloat96 data = iData[i];
-		oData[i] = data * vector;
-		vector *= omega;
-		omega *= dOmega;
-	}
+	float64_t dTheta = -2 * M_PI * (fMHz - freqMHz) / ac.widthMHz;
+	float64_t widthHz = MHZ_TO_HZ(ac.widthMHz);
+	float64_t d2Theta = -M_PI * driftHz / (widthHz * widthHz);
+	dedriftKernel->dedrift(oData, iData, ac.samples, dTheta, d2Theta);
+}
+
+/**
+ * Select the dedrift kernel.
+ *
+ * Description:\n
+ * 	The fastest kernel supported by the processor is used by default;
+ * 	ScalarDedriftKernel selects the extended precision recurrence.
+ */
+void
+ArchiveChannel::setDedriftKernel(DedriftKernelType type)
+{
+	dedriftKernel = getDedriftKernel(type);
+	Assert(dedriftKernel);
 }
 
 }
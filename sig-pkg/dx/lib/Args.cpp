@@ -47,6 +47,7 @@ namespace dx {
 
 static string usageString = "sudo dx [-H host] [-h port] [-r] [-j dadd_device ] [-(s|z|g)] [-n noise] [-t] [-x ip.file] [ -o output_dir] [-b board number] -f [ddc bit file; - to skip download] [-w port]\n\
 	-c cacheRows: use cacheRows for cache efficient DADD\n\
+	-D threads: # of DADD worker threads\n\
 	-E: suppress reporting of baselines \n\
 	-e: run timing tests at startup\n\
 	-F frames: set maximum number of frames\n\
@@ -56,6 +57,7 @@ static string usageString = "sudo dx [-H host] [-h port] [-r] [-j dadd_device ]
 	-I: initialize buffers during allocation\n\
 	-J addr: multicast base address\n\
 	-j port: multicast port\n\
+	-K threads: # of CW confirmation coherent search threads\n\
 	-k oversampling: subchannel DFB oversampling\n\
 	-L: log hits\n\
 	-l: linear polarization\n\
@@ -67,6 +69,7 @@ static string usageString = "sudo dx [-H host] [-h port] [-r] [-j dadd_device ]
 	-Q dxName: name of this dx\n\
 	-R: report CWD bin statistics\n\
 	-r: use tagged data\n\
+	-S threads: # of spectrometer worker threads\n\
 	-T subchannels: total # of subchannels to create\n\
 	-t: run top-down DADD\n\
 	-u: swap real and imaginary\n\
@@ -106,6 +109,8 @@ Args::Args(int argc, char **argv): dxName(""), host(DEFAULT_HOST),
 		src(DEFAULT_SRC), subchannels(DEFAULT_SUBCHANNELS),
 		usableSubchannels(DEFAULT_SUBCHANNELS), maxFrames(DEFAULT_MAX_FRAMES),
 		foldings(DEFAULT_SUBCHANNEL_FOLDINGS),
+		spectrometerThreads(DEFAULT_SPECTROMETER_THREADS),
+		confirmationThreads(DEFAULT_CONFIRMATION_THREADS),
 		oversampling(DEFAULT_SUBCHANNEL_OVERSAMPLING),
 		chanOversampling(DEFAULT_CHANNEL_OVERSAMPLING),
 		chanBandwidth(DEFAULT_CHANNEL_WIDTH_MHZ), polarization(POL_BOTHLINEAR)
@@ -127,7 +132,7 @@ void
 Args::parse(int argc, char **argv)
 {
 	bool done = false;
-	const char *optstring = "eEILMmNRstuVZa1:B:C:c:D:d:f:F:H:h:i:J:j:n:o:P:p:Q:S:T:U:v:W:w:X:x:Y:y:z:";
+	const char *optstring = "eEILMmNRstuVZa1:B:C:c:D:d:f:F:H:h:i:J:j:K:n:o:P:p:Q:S:T:U:v:W:w:X:x:Y:y:z:";
 
 	opterr= 0;
 	while (!done) {
@@ -140,6 +145,11 @@ Args::parse(int argc, char **argv)
 			dadd.cacheRows = atoi(optarg);
 			dadd.cacheEfficient = true;
 			break;
+		case 'D':
+			dadd.threads = atoi(optarg);
+			if (dadd.threads < 1)
+				usage();
+			break;
 		case 'e':
 			flags.test = true;
 			break;
@@ -167,6 +177,11 @@ Args::parse(int argc, char **argv)
 		case 'J':
 			mcAddr = string(optarg);
 			break;
+		case 'K':
+			confirmationThreads = atoi(optarg);
+			if (confirmationThreads < 1)
+				usage();
+			break;
 		case 'L':
 			flags.logHits = true;
 			break;
@@ -219,6 +234,11 @@ Args::parse(int argc, char **argv)
 		case 'r':
 			flags.taggedData = true;
 			break;
+		case 'S':
+			spectrometerThreads = atoi(optarg);
+			if (spectrometerThreads < 1)
+				usage();
+			break;
 		case 'T':
 			subchannels = atoi(optarg);
 			break;
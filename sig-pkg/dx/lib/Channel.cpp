@@ -57,7 +57,8 @@ namespace dx {
 * released as soon as
 */
 Channel::Channel(State *state_, Activity *activity_): initialized(false), swap(false),
-		singlePol(false), armed(false), abortCollection(false),
+		sampleKernel(getSampleKernel()), singlePol(false), armed(false),
+		abortCollection(false),
 		inactivePol(ATADataPacketHeader::NONE),
 		rPol(ATADataPacketHeader::RCIRC), lPol(ATADataPacketHeader::LCIRC),
 		subchannels(0), schedules(0), flushes(0), dones(0), consumed(0),
@@ -1509,7 +1510,8 @@ Channel::dfbFlush(uint64_t sample)
  * 	the total number of samples consumed; this should be the same as threshold.\n\n
  * Notes:\n
  * 	Since the input data is in a circular buffer, it may be necessary to
- * 	wrap past the end of the buffer and do the copy in two parts.
+ * 	wrap past the end of the buffer and do the conversion in two parts.\n
+ * 	The conversion uses the fastest kernel supported by the processor.
  */
 int32_t
 Channel::dfbPol(uint64_t sample, InputBuffer *inBuf,
@@ -1519,25 +1521,10 @@ Channel::dfbPol(uint64_t sample, InputBuffer *inBuf,
 	uint64_t t0 = getticks();
 #endif
 
-	// copy the input data to the DFB buffer.  Since the input buffer
-	// is circular, it may be necessary to wrap around to the beginning
-	// during the copy, so we have two loops.
-	int32_t len = threshold;
-	ComplexInt16 *samples = static_cast<ComplexInt16 *>
-			(inBuf->getSampleBlk(sample, len));
-	if (swap)
-			getSwappedSamples(sampleBuf, samples, len);
-	else
-			getSamples(sampleBuf, samples, len);
-	uint64_t s = sample + len;
-	int32_t len2 = threshold - len;
-	if (len2) {
-		samples = static_cast<ComplexInt16 *> (inBuf->getSampleBlk(s, len2));
-		if (swap)
-			getSwappedSamples(sampleBuf + len, samples, len2);
-		else
-			getSamples(sampleBuf + len, samples, len2);
-	}
+	// convert the input data into the DFB buffer.  Since the input
+	// buffer is circular, this may be done in two parts.
+	convertSamples(swap ? sampleKernel->convertSwapped
+			: sampleKernel->convert, inBuf, sample, threshold, sampleBuf);
 #if CHANNEL_TIMING
 	uint64_t t1 = getticks();
 	timing.dfb.list += elapsed(t1, t0);
@@ -1551,20 +1538,4 @@ Channel::dfbPol(uint64_t sample, InputBuffer *inBuf,
 	return (n);
 }
 
-void
-Channel::getSamples(ComplexFloat32 *sampleBuf, ComplexInt16 *samples,
-		int32_t len)
-{
-	for (int32_t i = 0; i < len; ++i)
-		sampleBuf[i] = samples[i];
-}
-
-void
-Channel::getSwappedSamples(ComplexFloat32 *sampleBuf, ComplexInt16 *samples,
-		int32_t len)
-{
-	for (int32_t i = 0; i < len; ++i)
-		sampleBuf[i] = ComplexFloat32(samples[i].imag(), samples[i].real());
-}
-
 }
@@ -31,9 +31,15 @@
 //
 // CWD Clustering object
 //
+// Hits are appended without locking to a buffer owned by the recording
+// thread.  When all hits have been loaded the buffers are concatenated
+// and sorted by mid-bin with a radix sort, then swept in order to form
+// the clusters.
+//
 // $Header: /home/cvs/nss/sonata-pkg/dx/lib/CwClusterer.cpp,v 1.2 2009/05/24 23:41:29 kes Exp $
 //
 #include <iostream>
+#include <string.h>
 #include "CwClusterer.h"
 #include "SuperClusterer.h"
 #include "DxErr.h"
@@ -48,15 +54,47 @@ namespace dx {
 
 TR_DECLARE(detail);
 
+namespace {
+
+// clusterer ids are never reused, so the buffer cached by a thread can
+// never belong to a clusterer which has been deleted
+uint64_t nextId = 0;
+
+// buffer of the clusterer to which the thread last recorded a hit
+__thread uint64_t cacheId = 0;
+__thread void *cacheBuffer = 0;
+
+const int32_t RADIX_BITS = 8;
+const int32_t RADIX = 1 << RADIX_BITS;
+const int32_t KEY_BITS = 32;
+
+/**
+ * Map a mid-bin to an unsigned key with the same ordering.
+ */
+inline uint32_t
+sortKey(float midBin)
+{
+	uint32_t key;
+	if (midBin == 0)
+		midBin = 0;
+	memcpy(&key, &midBin, sizeof(key));
+	return ((key & 0x80000000) ? ~key : (key | 0x80000000));
+}
+
+}
+
 CwClusterer::CwClusterer( SuperClusterer *parent, Polarization p  )
 	: ChildClusterer( parent )
 	, clusterRange(3)
 	, pole(p)
+	, id(__sync_add_and_fetch(&nextId, 1))
 {
 }
 
 CwClusterer::~CwClusterer()
 {
+	for (uint32_t i = 0; i < buffers.size(); ++i)
+		delete buffers[i];
 }
 
 //-------------------------
@@ -134,22 +172,21 @@ CwClusterer::recordHit(int startBin, int drift, int power)
 		Fatal(666);
 	// compute mid-bin
 	float midBin = startBin + (drift + 0.5)/2;
-	// insert into multi-map indexed by mid-bin
+	// append to the buffer of this thread
 	HitReport report(startBin, drift, power);
-	lock();
-	hitList.insert(pair<float,HitReport>(midBin,report));
-	unlock();
+	getBuffer()->push_back(Hit(midBin, report));
 }
 
 void
 CwClusterer::allHitsLoaded()
 {
 	if (!isComplete()) {
-		// scan multi-map in mid-bin order
+		// scan the hits in mid-bin order
 		Cluster cluster;
 		bool first = true;
 		HitList::iterator i;
 		lock();
+		sortHits();
 		for (i = hitList.begin(); i!= hitList.end(); i++)
 		{
 			bool switchClusters = false;
@@ -183,7 +220,12 @@ CwClusterer::allHitsLoaded()
 int
 CwClusterer::getHits()
 {
-	return (hitList.size());
+	lock();
+	int hits = hitList.size();
+	for (uint32_t i = 0; i < buffers.size(); ++i)
+		hits += buffers[i]->hits.size();
+	unlock();
+	return (hits);
 }
 
 void
@@ -191,6 +233,8 @@ CwClusterer::clearHits()
 {
 	lock();
 	ChildClusterer::clearHits();
+	for (uint32_t i = 0; i < buffers.size(); ++i)
+		buffers[i]->hits.clear();
 	hitList.clear();
 	clusterList.clear();
 	unlock();
@@ -199,8 +243,95 @@ CwClusterer::clearHits()
 //----------------------
 // private
 //----------------------
+/**
+ * Get the hit buffer of the calling thread.
+ *
+ * Description:\n
+ * 	The lock is needed only the first time a thread records a hit, or
+ * 	when it records a hit after recording one to another clusterer.
+ */
+CwClusterer::HitList *
+CwClusterer::getBuffer()
+{
+	if (cacheId == id)
+		return (static_cast<HitList *> (cacheBuffer));
+
+	pthread_t self = pthread_self();
+	HitBuffer *buf = 0;
+	lock();
+	for (uint32_t i = 0; i < buffers.size() && !buf; ++i) {
+		if (pthread_equal(buffers[i]->thread, self))
+			buf = buffers[i];
+	}
+	if (!buf) {
+		buf = new HitBuffer(self);
+		buffers.push_back(buf);
+	}
+	unlock();
+	cacheId = id;
+	cacheBuffer = &buf->hits;
+	return (&buf->hits);
+}
+
+/**
+ * Move the hits of all the threads to the hit list, sorted by mid-bin.
+ *
+ * Description:\n
+ * 	The sort is a least significant digit radix sort, which is stable,
+ * 	so hits with the same mid-bin remain in the order they were
+ * 	recorded, as they would in a multimap.  The digits of every pass
+ * 	are counted in a single scan of the hits, and passes for which all
+ * 	the hits have the same digit are skipped.\n\n
+ * Notes:\n
+ * 	Must be called with the lock held.
+ */
+void
+CwClusterer::sortHits()
+{
+	size_t n = hitList.size();
+	for (uint32_t i = 0; i < buffers.size(); ++i)
+		n += buffers[i]->hits.size();
+	hitList.reserve(n);
+	for (uint32_t i = 0; i < buffers.size(); ++i) {
+		HitList& hits = buffers[i]->hits;
+		hitList.insert(hitList.end(), hits.begin(), hits.end());
+		hits.clear();
+	}
+
+	// count the digits for every pass at once
+	const int32_t passes = KEY_BITS / RADIX_BITS;
+	size_t count[passes][RADIX];
+	memset(count, 0, sizeof(count));
+	for (size_t i = 0; i < n; ++i) {
+		uint32_t key = sortKey(hitList[i].first);
+		for (int32_t p = 0; p < passes; ++p)
+			++count[p][(key >> (p * RADIX_BITS)) & (RADIX - 1)];
+	}
+
+	sortList.resize(n);
+	for (int32_t p = 0; p < passes; ++p) {
+		size_t ofs = 0;
+		bool skip = false;
+		for (int32_t d = 0; d < RADIX; ++d) {
+			skip = skip || count[p][d] == n;
+			size_t c = count[p][d];
+			count[p][d] = ofs;
+			ofs += c;
+		}
+		if (skip)
+			continue;
+		int32_t shift = p * RADIX_BITS;
+		for (size_t i = 0; i < n; ++i) {
+			const Hit& hit = hitList[i];
+			sortList[count[p][(sortKey(hit.first) >> shift) & (RADIX - 1)]++]
+					= hit;
+		}
+		hitList.swap(sortList);
+	}
+}
+
 bool
-CwClusterer::absorb(Cluster &cluster, const pair<float, HitReport>&i)
+CwClusterer::absorb(Cluster &cluster, const Hit &i)
 {
 	if (i.first > cluster.hiBin + clusterRange)
 		return false;
@@ -0,0 +1,301 @@
+/*******************************************************************************
+
+ File:    CwCoherentEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW coherent search engine class
+//
+// The coherent search of a confirmation signal is divided into one item
+// per drift hypothesis.  Items are handed out dynamically to the workers
+// of a worker pool; each item writes only its own chi-square report.
+//
+#include <math.h>
+#include "CwCoherentEngine.h"
+#include "Statistics.h"
+
+namespace dx {
+
+CwCoherentEngine::CwCoherentWorker::~CwCoherentWorker()
+{
+	release();
+}
+
+/**
+ * Set up a worker for a number of samples.
+ *
+ * Description:\n
+ * 	Allocates the worker's buffers and creates its FFT plan.\n
+ * Notes:\n
+ * 	FFTW planning is not thread-safe, so this must be called from a
+ * 	single task.  Since the plan of the first worker is recorded as
+ * 	wisdom, all workers execute identical plans.
+ */
+void
+CwCoherentEngine::CwCoherentWorker::setup(int32_t samples_)
+{
+	release();
+
+	size_t size = samples_ * sizeof(ComplexFloat32);
+	dd = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
+	Assert(dd);
+	fd = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
+	Assert(fd);
+	plan = fftwf_plan_dft_1d(samples_, (fftwf_complex *) dd,
+			(fftwf_complex *) fd, FFTW_FORWARD, FFTW_MEASURE);
+	Assert(plan);
+	samples = samples_;
+}
+
+void
+CwCoherentEngine::CwCoherentWorker::release()
+{
+	if (plan)
+		fftwf_destroy_plan(plan);
+	plan = 0;
+	if (dd)
+		fftwf_free(dd);
+	dd = 0;
+	if (fd)
+		fftwf_free(fd);
+	fd = 0;
+	samples = 0;
+}
+
+/**
+ * Create the engine.
+ *
+ * @param	workers_ number of workers (including the calling task).
+ * @param	prio_ priority of the worker tasks.
+ * @param	realtime_ whether the worker tasks are realtime.
+ */
+CwCoherentEngine::CwCoherentEngine(int32_t workers_, int prio_,
+		bool realtime_): samples(0), td(0), pool(0),
+		dedriftKernel(getDedriftKernel())
+{
+	pool = new WorkerPool("cwCoherent", workers_, prio_, realtime_);
+	Assert(pool);
+	for (int32_t i = 0; i < pool->getWorkers(); ++i) {
+		CwCoherentWorker *w = new CwCoherentWorker();
+		Assert(w);
+		workers.push_back(w);
+	}
+}
+
+CwCoherentEngine::~CwCoherentEngine()
+{
+	delete pool;
+	for (uint32_t i = 0; i < workers.size(); ++i)
+		delete workers[i];
+}
+
+/**
+ * Select the dedrift kernel.
+ *
+ * Description:\n
+ * 	The fastest kernel supported by the processor is used by default.
+ */
+void
+CwCoherentEngine::setDedriftKernel(DedriftKernelType type)
+{
+	dedriftKernel = getDedriftKernel(type);
+	Assert(dedriftKernel);
+}
+
+/**
+ * Set up the engine for a number of samples.
+ *
+ * Description:\n
+ * 	Creates the worker plans and buffers for the number of samples.
+ * 	If the number of samples is unchanged the existing plans are kept.
+ *
+ * @param	samples_ # of time samples in a signal; must be a power of 2.
+ */
+void
+CwCoherentEngine::setup(int32_t samples_)
+{
+	Assert(samples_ > 1 && !(samples_ & (samples_ - 1)));
+	if (samples_ == samples)
+		return;
+	samples = samples_;
+	for (uint32_t i = 0; i < workers.size(); ++i)
+		workers[i]->setup(samples);
+	items.resize(2 * samples - 1);
+}
+
+/**
+ * Perform a coherent search for the best description of the signal.
+ *
+ * Description:\n
+ * 	Runs all the drifts on the worker pool, then selects the drift with
+ * 	the most significant coherent width.  Ties go to the lowest drift.
+ *
+ * @param	td_ time samples of the signal.
+ */
+CoherentReport
+CwCoherentEngine::search(const ComplexFloat32 *td_)
+{
+	Assert(samples);
+	td = td_;
+	pool->run(this, items.size());
+	td = 0;
+
+	CoherentReport best;
+	for (int32_t i = 0; i < (int32_t) items.size(); ++i) {
+		if (items[i].chiSq < best.chi.chiSq) {
+			best.chi = items[i];
+			best.microDrift = i - (samples - 1);
+		}
+	}
+	best.chi.chiSq = ChiSquare(2 * best.chi.clusterWidth,
+			2 * best.chi.power);
+	best.signif = best.chi.chiSq;
+	return (best);
+}
+
+/**
+ * Process a single drift.
+ *
+ * Description:\n
+ * 	Dedrifts the signal, computes its spectrum and records the most
+ * 	significant coherent width for the drift.\n
+ * Notes:\n
+ * 	The spectrum is rescaled and rearranged so that DC is in the middle
+ * 	in a single pass, leaving it in the dedrift buffer.
+ */
+void
+CwCoherentEngine::execute(int32_t worker, int32_t item)
+{
+	CwCoherentWorker *w = workers[worker];
+	int32_t drift = item - (samples - 1);
+
+	dedriftKernel->dedrift(w->dd, td, samples, 0,
+			-M_PI * drift / ((float64_t) samples * samples));
+	fftwf_execute(w->plan);
+
+	int32_t middle = samples / 2;
+	float32_t factor = 1 / sqrt((float64_t) samples);
+	for (int32_t i = 0; i < middle; ++i) {
+		w->dd[i] = w->fd[middle+i] * factor;
+		w->dd[middle+i] = w->fd[i] * factor;
+	}
+	items[item] = checkCoherence(w->dd, 1.0, samples, drift, samples / 2,
+			samples);
+}
+
+//
+// checkCoherence: find the best coherence width for this drift
+//
+// Notes:
+//		coherenceCheck examines a complex spectrum, under the assumption
+//		that the spectrum contains a coherent signal.    It estimates
+//		the bandwidth of the signal. Power is summed in the bins
+//		taken one at a time, then two at a time, then four at a time,
+//		etc., looking for the (width, power) which is least likely
+//		to have been produced by noise; i.e. the width and power
+//		which are furthest in the tail of the appropriate Chi-squared
+//		distribution.
+//		The code here assumes binsPerSpectrum is a power of 2.
+ChiReport
+CwCoherentEngine::checkCoherence(ComplexFloat32 *data,
+		float64_t avgPower, int32_t bins, int32_t drift, int32_t fSearch,
+		int32_t wSearch)
+{
+	// normalize the power to average for the channel
+	float64_t avgBinPower = 0;
+	float64_t binPower[bins];
+	for (int32_t bin = 0; bin < bins; bin++) {
+		binPower[bin] = norm(data[bin]) / avgPower;
+		avgBinPower += binPower[bin];
+	}
+	avgBinPower /= bins;
+
+	// renormalize the power for the coherent band
+	for (int32_t bin = 0; bin < bins; bin++)
+		binPower[bin] /= avgBinPower;
+
+	ChiReport best;
+
+	// restrict the search to valid frequencies and widths for
+	// the current drift.
+	int32_t middle = bins / 2;
+	int32_t minWidth = 1;
+	int32_t maxWidth = wSearch;
+	for (int32_t width = minWidth; width <= maxWidth; width *= 2) {
+		int32_t halfWidth = width / 2;
+		int32_t fsrch = fSearch;
+
+		// maximum search range is from beginning to end, with
+		// middle as reference
+		if (fsrch > bins / 2)
+			fsrch = bins / 2;
+
+		// if the frequency search range is less than half the
+		// current width, don't search this width;
+		if (fsrch < halfWidth)
+			break;
+
+		// the actual frequency range can be restricted by the
+		// drift and width.  For negative drifts, some lower
+		// frequencies will be restricted, while for positive
+		// drifts upper frequencies will be restricted.
+		int32_t minFreq = middle - fsrch;
+		int32_t maxFreq = middle + fsrch;
+
+		if (drift < 0) {
+			if (minFreq + drift < 0)
+				minFreq = -drift;
+		}
+		else if (maxFreq > bins - drift)
+			maxFreq = bins - drift;
+
+		int32_t delta = halfWidth;
+		if (!delta)
+			delta = 1;
+
+		for (int32_t i = minFreq; i + width <= maxFreq; i += delta) {
+			float64_t power = 0;
+			for (int32_t j = 0; j < width; j++)
+				power += binPower[i+j];
+			float64_t chiSq = ChiSquare(2 * width, 2 * power);
+			if (chiSq < best.chiSq) {
+				best.power = power;
+				best.chiSq = chiSq;
+				best.clusterWidth = width;
+				best.clusterIndex = i;
+			}
+		}
+	}
+
+	best.power *= avgBinPower;
+	best.clusterIndex = (best.clusterIndex + best.clusterWidth / 2) - middle;
+	best.bins = bins;
+	return (best);
+}
+
+}
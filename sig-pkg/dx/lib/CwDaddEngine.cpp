@@ -0,0 +1,400 @@
+/*******************************************************************************
+
+ File:    CwDaddEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW DADD engine class
+//
+// DADD detection for an activity is divided into nPols * 2 * slices
+// independent items, one for each polarization, slope and slice of the
+// spectrum.  Items are handed out dynamically to the workers of a
+// worker pool.
+//
+#include <algorithm>
+#include <fftw3.h>
+#include <string.h>
+#include "CwDaddEngine.h"
+
+namespace dx {
+
+/**
+ * Start collecting the paths of an item.
+ *
+ * @param	item_ the item.
+ * @param	keep_ # of paths to keep per band.
+ * @param	bandBins_ # of bins in a band.
+ * @param	bands # of bands.
+ */
+void
+CwDaddEngine::PathList::start(CwDaddItem *item_, int32_t keep_,
+		int32_t bandBins_, int32_t bands)
+{
+	item = item_;
+	keep = keep_;
+	bandBins = bandBins_;
+	item->paths.clear();
+	item->overflow.clear();
+	bandPaths.assign(bands, 0);
+	bandOverflow.assign(bands, -1);
+}
+
+/**
+ * Finish collecting the paths of an item.
+ *
+ * Description:\n
+ * 	Sorts the overflow of the bands into the drift order of the paths.
+ */
+void
+CwDaddEngine::PathList::finish()
+{
+	std::stable_sort(item->overflow.begin(), item->overflow.end(),
+			lessDrift);
+	item = 0;
+}
+
+/**
+ * Record a path found by the item.
+ */
+void
+CwDaddEngine::PathList::report(const DaddPath& path)
+{
+	int32_t band = path.bin / bandBins;
+	Assert(band < (int32_t) bandPaths.size());
+	if (bandPaths[band]++ < keep) {
+		item->paths.push_back(path);
+		return;
+	}
+	int32_t& i = bandOverflow[band];
+	if (i < 0) {
+		i = item->overflow.size();
+		item->overflow.push_back(BandOverflow(path));
+		return;
+	}
+	BandOverflow& o = item->overflow[i];
+	++o.hits;
+	if (path.power > o.maxPath.power)
+		o.maxPath = path;
+}
+
+CwDaddEngine::CwDaddWorker::~CwDaddWorker()
+{
+	release();
+}
+
+/**
+ * Set the detection buffer of a worker.
+ *
+ * Description:\n
+ * 	If a buffer is supplied it is used, otherwise a buffer of the
+ * 	specified size is allocated (or the current buffer is kept if it
+ * 	is big enough).
+ */
+void
+CwDaddEngine::CwDaddWorker::setBuffer(void *buf_, size_t size_)
+{
+	if (buf_) {
+		release();
+		buf = static_cast<DaddAccum *> (buf_);
+		size = size_;
+		return;
+	}
+	if (allocated && size >= size_)
+		return;
+	release();
+	buf = static_cast<DaddAccum *> (fftwf_malloc(size_));
+	Assert(buf);
+	size = size_;
+	allocated = true;
+}
+
+void
+CwDaddEngine::CwDaddWorker::release()
+{
+	if (allocated && buf)
+		fftwf_free(buf);
+	buf = 0;
+	size = 0;
+	allocated = false;
+}
+
+/**
+ * Create the engine.
+ *
+ * @param	workers_ number of workers (including the calling task).
+ * @param	prio_ priority of the worker tasks.
+ * @param	realtime_ whether the worker tasks are realtime.
+ */
+CwDaddEngine::CwDaddEngine(int32_t workers_, int prio_, bool realtime_):
+		nPols(0), slices(0), sliceBins(0), sliceWidth(0), pols(0), pool(0)
+{
+	pool = new WorkerPool("cwDadd", workers_, prio_, realtime_);
+	Assert(pool);
+	for (int32_t i = 0; i < pool->getWorkers(); ++i) {
+		CwDaddWorker *w = new CwDaddWorker();
+		Assert(w);
+		workers.push_back(w);
+	}
+}
+
+CwDaddEngine::~CwDaddEngine()
+{
+	delete pool;
+	for (uint32_t i = 0; i < workers.size(); ++i)
+		delete workers[i];
+}
+
+/**
+ * Get the number of paths stored by the items of the last detection.
+ */
+size_t
+CwDaddEngine::getStoredPaths()
+{
+	size_t n = 0;
+	for (uint32_t i = 0; i < items.size(); ++i)
+		n += items[i].paths.size() + items[i].overflow.size();
+	return (n);
+}
+
+/**
+ * Set up the engine for an activity.
+ *
+ * Description:\n
+ * 	Computes the slice geometry and sets up the worker buffers.  Each
+ * 	slice row holds the slice bins plus enough bins to the right of the
+ * 	slice to contain the widest path, plus the same overlap as a full
+ * 	spectrum, up to the total width of the spectrum.\n
+ * Notes:\n
+ * 	If a buffer is supplied and is large enough, the first worker uses
+ * 	it as its detection buffer; otherwise the worker allocates its own.
+ *
+ * @param	params_ activity parameters.
+ * @param	buf optional detection buffer for the first worker.
+ * @param	size size of buf in bytes.
+ */
+void
+CwDaddEngine::setup(const CwDaddParams& params_, void *buf, size_t size)
+{
+	params = params_;
+	Assert(params.spectra > 0 && params.slices > 0);
+	Assert(params.spectrumBins > 0 && !(params.spectrumBins % VECTOR_LEN));
+	Assert(params.totalBins >= params.spectrumBins
+			&& !(params.totalBins % VECTOR_LEN));
+
+	// slices are a multiple of the DADD vector length, which is also
+	// the unpacker granularity
+	int32_t align = VECTOR_LEN;
+	int32_t n = (params.spectrumBins + params.slices - 1) / params.slices;
+	sliceBins = ((n + align - 1) / align) * align;
+	slices = (params.spectrumBins + sliceBins - 1) / sliceBins;
+	int32_t pad = ((params.spectra + align - 1) / align) * align
+			+ (params.totalBins - params.spectrumBins);
+	sliceWidth = sliceBins + pad;
+	if (sliceWidth > params.totalBins)
+		sliceWidth = params.totalBins;
+
+	// add slack for the unaligned vector reads past the end of a row
+	size_t bufSize = ((size_t) params.spectra * sliceWidth + align)
+			* sizeof(DaddAccum);
+	if (size < bufSize)
+		buf = 0;
+	for (uint32_t i = 0; i < workers.size(); ++i) {
+		CwDaddWorker *w = workers[i];
+		w->setBuffer(i ? 0 : buf, bufSize);
+		w->dadd.setup(params.spectra, params.spectrumBins, params.totalBins,
+				params.threshold, params.bandBins, params.badBandLimit);
+	}
+	bandDadd.setup(params.spectra, params.spectrumBins, params.totalBins,
+			params.threshold, params.bandBins, params.badBandLimit);
+}
+
+/**
+ * Perform detection.
+ *
+ * Description:\n
+ * 	Runs all items on the worker pool, then merges the hits of each
+ * 	polarization, reporting the hits and bad bands through the
+ * 	polarization's callbacks.
+ *
+ * @param	pols_ array of polarizations to process.
+ * @param	nPols_ # of polarizations.
+ */
+void
+CwDaddEngine::detect(const CwDaddPol *pols_, int32_t nPols_)
+{
+	Assert(slices);
+	pols = pols_;
+	nPols = nPols_;
+	items.resize(nPols * 2 * slices);
+	pool->run(this, items.size());
+	for (int32_t p = 0; p < nPols; ++p)
+		mergePol(p);
+	pols = 0;
+}
+
+/**
+ * Process a single item.
+ *
+ * Description:\n
+ * 	Unpacks the slice into the worker's buffer and runs DADD on it,
+ * 	recording the over-threshold paths.  Only the first
+ * 	badBandLimit + 1 paths of a band can be reported, so the rest are
+ * 	just counted.
+ */
+void
+CwDaddEngine::execute(int32_t worker, int32_t item)
+{
+	CwDaddWorker *w = workers[worker];
+	const CwDaddPol& pd = pols[item / (2 * slices)];
+	DaddSlope slope = ((item / slices) & 1) ? Negative : Positive;
+	int32_t base = (item % slices) * sliceBins;
+
+	unpack(w, pd.data, slope, base);
+	w->dadd.setSlice(base, sliceBins, sliceWidth);
+	int32_t bands = (params.totalBins + params.bandBins - 1)
+			/ params.bandBins;
+	w->pathList.start(&items[item], params.badBandLimit + 1,
+			params.bandBins, bands);
+	w->dadd.detect(pd.pol, slope, w->buf, &w->pathList);
+	w->pathList.finish();
+}
+
+/**
+ * Unpack a slice of the packed data.
+ *
+ * Description:\n
+ * 	Unpacks the bins which fall into the slice buffer, zeroing the
+ * 	remainder of each row.  For positive slopes, buffer bin i of the
+ * 	slice holds bin base + i; for negative slopes the buffer is a mirror
+ * 	image of the spectrum, so buffer bin i holds bin
+ * 	totalBins - 1 - (base + i).
+ *
+ * @param	w the worker.
+ * @param	data the packed data.
+ * @param	slope the slope being processed.
+ * @param	base the first buffer bin of the slice.
+ */
+void
+CwDaddEngine::unpack(CwDaddWorker *w, uint8_t *data, DaddSlope slope,
+		int32_t base)
+{
+	DaddAccum *buf = w->buf;
+	if (slope == Positive) {
+		int32_t bins = params.spectrumBins - base;
+		if (bins > sliceWidth)
+			bins = sliceWidth;
+		zeroBins(w->buf, bins, sliceWidth - bins);
+		w->unpacker.unpack(Positive, data, buf, base, 0, params.spectra,
+				bins, params.spectrumBins, sliceWidth);
+	}
+	else {
+		// bins [lo, hi) of the spectrum fall into the slice buffer
+		int32_t top = params.totalBins - base;
+		int32_t lo = top - sliceWidth;
+		if (lo < 0)
+			lo = 0;
+		int32_t hi = top;
+		if (hi > params.spectrumBins)
+			hi = params.spectrumBins;
+		zeroBins(w->buf, 0, top - hi);
+		zeroBins(w->buf, top - lo, sliceWidth - (top - lo));
+		if (hi > lo) {
+			w->unpacker.unpack(Negative, data, buf, lo, top - lo,
+					params.spectra, hi - lo, params.spectrumBins, sliceWidth);
+		}
+	}
+}
+
+/**
+ * Zero a range of bins in every row of a slice buffer.
+ */
+void
+CwDaddEngine::zeroBins(DaddAccum *buf, int32_t bin, int32_t bins)
+{
+	if (bins <= 0)
+		return;
+	for (int32_t i = 0; i < params.spectra; ++i)
+		memset(buf + (size_t) i * sliceWidth + bin, 0,
+				bins * sizeof(DaddAccum));
+}
+
+/**
+ * Merge the hits of a polarization.
+ *
+ * Description:\n
+ * 	Passes the paths of each slope to the band accounting in the order
+ * 	a DADD of the entire spectrum reports them: by drift, then by
+ * 	buffer bin.  Within a slice the paths are already in this order, and
+ * 	the slices are in increasing buffer bin order, so for each drift
+ * 	the slices are simply visited in turn.  The overflow of a band
+ * 	follows the paths the slice kept for that drift; the band has
+ * 	passed the limit by then, so its maximum path is recorded but not
+ * 	reported.  The bad bands are reported after both slopes have been
+ * 	merged.
+ */
+void
+CwDaddEngine::mergePol(int32_t p)
+{
+	const CwDaddPol& pd = pols[p];
+	vector<uint32_t> cursor(slices), overflowCursor(slices);
+
+	bandDadd.reset();
+	for (int32_t s = 0; s < 2; ++s) {
+		const CwDaddItem *item = &items[(p * 2 + s) * slices];
+		cursor.assign(slices, 0);
+		overflowCursor.assign(slices, 0);
+		for (int32_t drift = 0; drift < params.spectra; ++drift) {
+			for (int32_t i = 0; i < slices; ++i) {
+				const vector<DaddPath>& paths = item[i].paths;
+				uint32_t& j = cursor[i];
+				while (j < paths.size() && abs(paths[j].drift) == drift)
+					bandDadd.recordHit(paths[j++], pd.reportHit);
+				const vector<BandOverflow>& overflow = item[i].overflow;
+				uint32_t& k = overflowCursor[i];
+				for (; k < overflow.size()
+						&& abs(overflow[k].maxPath.drift) == drift; ++k) {
+					const BandOverflow& o = overflow[k];
+					bandDadd.recordHit(o.maxPath, pd.reportHit);
+					bandDadd.countHits(o.maxPath.bin, o.hits - 1);
+				}
+			}
+		}
+	}
+	bandDadd.reportBadBands(pd.reportBadBand);
+}
+
+/**
+ * Order band overflows by drift.
+ */
+bool
+CwDaddEngine::lessDrift(const BandOverflow& a, const BandOverflow& b)
+{
+	return (abs(a.maxPath.drift) < abs(b.maxPath.drift));
+}
+
+}
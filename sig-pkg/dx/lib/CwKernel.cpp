@@ -0,0 +1,316 @@
+/*******************************************************************************
+
+ File:    CwKernel.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW power kernels.
+//
+// The vector kernels compare the power of each bin with the three
+// quantization thresholds, then build the 2-bit values from the
+// comparison masks: the high bit of a value is set if the power is at
+// least 2, and the low bit if it is at least 3 or in [1, 2).  The scalar
+// kernels use the same thresholds.
+//
+// Rounding of the power must be the same in every kernel, so the
+// products and sums must not be fused into multiply-adds.
+//
+#include <math.h>
+#include <immintrin.h>
+#include "CwKernel.h"
+
+#pragma GCC optimize ("fp-contract=off")
+
+namespace dx {
+
+namespace {
+
+#define AVX2_TARGET		__attribute__ ((target("avx2,bmi2")))
+
+// scale by the inverse of the Hanning power gain, which is .375
+const float32_t HANNING_SCALE = sqrt(8.0 / 3.0) / 2;
+
+//
+// scalar kernels
+//
+inline uint64_t
+scalarLevel(const ComplexFloat32& bin)
+{
+	float32_t power = bin.real() * bin.real() + bin.imag() * bin.imag();
+	return ((power >= 1) + (power >= 2) + (power >= 3));
+}
+
+void
+scalarPack(uint64_t *out, const ComplexFloat32 *data, int32_t words)
+{
+	for (int32_t i = 0; i < words; ++i, data += CW_BINS_PER_WORD) {
+		uint64_t val = 0;
+		for (int32_t j = 0; j < CW_BINS_PER_WORD; ++j)
+			val |= scalarLevel(data[j]) << (j * CWD_BITS_PER_BIN);
+		out[i] = val;
+	}
+}
+
+void
+scalarPackHanning(uint64_t *out, const ComplexFloat32 *data, int32_t words)
+{
+	for (int32_t i = 0; i < words; ++i, data += CW_BINS_PER_WORD) {
+		uint64_t val = 0;
+		for (int32_t j = 0; j < CW_BINS_PER_WORD; ++j) {
+			ComplexFloat32 adj = data[j-1] + data[j+1];
+			adj *= .5;
+			ComplexFloat32 bin = data[j] + adj;
+			bin *= HANNING_SCALE;
+			val |= scalarLevel(bin) << (j * CWD_BITS_PER_BIN);
+		}
+		out[i] = val;
+	}
+}
+
+/**
+ * Interleave the low and high bits of 32 2-bit values.
+ */
+inline uint64_t
+interleave(uint32_t lo, uint32_t hi)
+{
+	uint64_t x = lo | ((uint64_t) hi << 32);
+	// move bit i of each half to bit 2i (low) or 2i + 1 (high)
+	uint64_t t;
+	t = (x ^ (x >> 16)) & 0x00000000ffff0000ULL; x ^= t ^ (t << 16);
+	t = (x ^ (x >> 8)) & 0x0000ff000000ff00ULL; x ^= t ^ (t << 8);
+	t = (x ^ (x >> 4)) & 0x00f000f000f000f0ULL; x ^= t ^ (t << 4);
+	t = (x ^ (x >> 2)) & 0x0c0c0c0c0c0c0c0cULL; x ^= t ^ (t << 2);
+	t = (x ^ (x >> 1)) & 0x2222222222222222ULL; x ^= t ^ (t << 1);
+	return (x);
+}
+
+//
+// SSE2 kernels: 4 bins per step
+//
+const int32_t SSE2_BINS = 4;
+
+/**
+ * Compute the power of 4 bins, given as 2 vectors of 2 complex values.
+ */
+inline __m128
+sse2Power(__m128 a, __m128 b)
+{
+	a = _mm_mul_ps(a, a);
+	b = _mm_mul_ps(b, b);
+	return (_mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+			_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+}
+
+/**
+ * Get the low and high bit masks of the 2-bit values of 4 bins.
+ */
+inline void
+sse2Levels(__m128 power, uint32_t& lo, uint32_t& hi)
+{
+	__m128 ge1 = _mm_cmpge_ps(power, _mm_set1_ps(1));
+	__m128 ge2 = _mm_cmpge_ps(power, _mm_set1_ps(2));
+	__m128 ge3 = _mm_cmpge_ps(power, _mm_set1_ps(3));
+	lo = _mm_movemask_ps(_mm_or_ps(_mm_andnot_ps(ge2, ge1), ge3));
+	hi = _mm_movemask_ps(ge2);
+}
+
+void
+sse2Pack(uint64_t *out, const ComplexFloat32 *data, int32_t words)
+{
+	const float32_t *d = reinterpret_cast<const float32_t *> (data);
+	for (int32_t i = 0; i < words; ++i) {
+		uint32_t lo = 0, hi = 0;
+		for (int32_t j = 0; j < CW_BINS_PER_WORD; j += SSE2_BINS, d += 8) {
+			__m128 power = sse2Power(_mm_loadu_ps(d), _mm_loadu_ps(d + 4));
+			uint32_t l, h;
+			sse2Levels(power, l, h);
+			lo |= l << j;
+			hi |= h << j;
+		}
+		out[i] = interleave(lo, hi);
+	}
+}
+
+/**
+ * Apply the scaled Hanning window to 2 bins, given the data of the
+ * first bin.
+ */
+inline __m128
+sse2Hanning(const float32_t *d)
+{
+	__m128 adj = _mm_add_ps(_mm_loadu_ps(d - 2), _mm_loadu_ps(d + 2));
+	adj = _mm_mul_ps(adj, _mm_set1_ps(.5));
+	__m128 bin = _mm_add_ps(_mm_loadu_ps(d), adj);
+	return (_mm_mul_ps(bin, _mm_set1_ps(HANNING_SCALE)));
+}
+
+void
+sse2PackHanning(uint64_t *out, const ComplexFloat32 *data, int32_t words)
+{
+	const float32_t *d = reinterpret_cast<const float32_t *> (data);
+	for (int32_t i = 0; i < words; ++i) {
+		uint32_t lo = 0, hi = 0;
+		for (int32_t j = 0; j < CW_BINS_PER_WORD; j += SSE2_BINS, d += 8) {
+			__m128 power = sse2Power(sse2Hanning(d), sse2Hanning(d + 4));
+			uint32_t l, h;
+			sse2Levels(power, l, h);
+			lo |= l << j;
+			hi |= h << j;
+		}
+		out[i] = interleave(lo, hi);
+	}
+}
+
+//
+// AVX2 kernels: 8 bins per step, interleaving the bits with pdep
+//
+const int32_t AVX2_BINS = 8;
+const uint64_t LOW_BITS = 0x5555555555555555ULL;
+const uint64_t HIGH_BITS = 0xaaaaaaaaaaaaaaaaULL;
+
+/**
+ * Compute the power of 8 bins, given as 2 vectors of 4 complex values.
+ */
+AVX2_TARGET inline __m256
+avx2Power(__m256 a, __m256 b)
+{
+	a = _mm256_mul_ps(a, a);
+	b = _mm256_mul_ps(b, b);
+	// the shuffles work within 128-bit lanes, so the powers are in the
+	// order 0 1 4 5 2 3 6 7
+	__m256 p = _mm256_add_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+			_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+	return (_mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(p),
+			_MM_SHUFFLE(3, 1, 2, 0))));
+}
+
+AVX2_TARGET inline void
+avx2Levels(__m256 power, uint32_t& lo, uint32_t& hi)
+{
+	__m256 ge1 = _mm256_cmp_ps(power, _mm256_set1_ps(1), _CMP_GE_OQ);
+	__m256 ge2 = _mm256_cmp_ps(power, _mm256_set1_ps(2), _CMP_GE_OQ);
+	__m256 ge3 = _mm256_cmp_ps(power, _mm256_set1_ps(3), _CMP_GE_OQ);
+	lo = _mm256_movemask_ps(_mm256_or_ps(_mm256_andnot_ps(ge2, ge1), ge3));
+	hi = _mm256_movemask_ps(ge2);
+}
+
+AVX2_TARGET void
+avx2Pack(uint64_t *out, const ComplexFloat32 *data, int32_t words)
+{
+	const float32_t *d = reinterpret_cast<const float32_t *> (data);
+	for (int32_t i = 0; i < words; ++i) {
+		uint32_t lo = 0, hi = 0;
+		for (int32_t j = 0; j < CW_BINS_PER_WORD; j += AVX2_BINS, d += 16) {
+			__m256 power = avx2Power(_mm256_loadu_ps(d),
+					_mm256_loadu_ps(d + 8));
+			uint32_t l, h;
+			avx2Levels(power, l, h);
+			lo |= l << j;
+			hi |= h << j;
+		}
+		out[i] = _pdep_u64(lo, LOW_BITS) | _pdep_u64(hi, HIGH_BITS);
+	}
+}
+
+AVX2_TARGET inline __m256
+avx2Hanning(const float32_t *d)
+{
+	__m256 adj = _mm256_add_ps(_mm256_loadu_ps(d - 2),
+			_mm256_loadu_ps(d + 2));
+	adj = _mm256_mul_ps(adj, _mm256_set1_ps(.5));
+	__m256 bin = _mm256_add_ps(_mm256_loadu_ps(d), adj);
+	return (_mm256_mul_ps(bin, _mm256_set1_ps(HANNING_SCALE)));
+}
+
+AVX2_TARGET void
+avx2PackHanning(uint64_t *out, const ComplexFloat32 *data, int32_t words)
+{
+	const float32_t *d = reinterpret_cast<const float32_t *> (data);
+	for (int32_t i = 0; i < words; ++i) {
+		uint32_t lo = 0, hi = 0;
+		for (int32_t j = 0; j < CW_BINS_PER_WORD; j += AVX2_BINS, d += 16) {
+			__m256 power = avx2Power(avx2Hanning(d), avx2Hanning(d + 8));
+			uint32_t l, h;
+			avx2Levels(power, l, h);
+			lo |= l << j;
+			hi |= h << j;
+		}
+		out[i] = _pdep_u64(lo, LOW_BITS) | _pdep_u64(hi, HIGH_BITS);
+	}
+}
+
+// kernels in order of increasing preference
+const CwKernel kernels[] = {
+	{ ScalarCwKernel, "scalar", scalarPack, scalarPackHanning },
+	{ Sse2CwKernel, "sse2", sse2Pack, sse2PackHanning },
+	{ Avx2CwKernel, "avx2", avx2Pack, avx2PackHanning }
+};
+
+const int32_t KERNELS = sizeof(kernels) / sizeof(kernels[0]);
+
+bool
+isSupported(CwKernelType type)
+{
+	__builtin_cpu_init();
+	switch (type) {
+	case Sse2CwKernel:
+		return (__builtin_cpu_supports("sse2"));
+	case Avx2CwKernel:
+		return (__builtin_cpu_supports("avx2")
+				&& __builtin_cpu_supports("bmi2"));
+	default:
+		return (true);
+	}
+}
+
+}
+
+/**
+ * Get a set of kernels.
+ *
+ * Description:\n
+ * 	Returns the kernels of the specified type, or the fastest kernels
+ * 	supported by the processor if type is BestCwKernel.\n\n
+ * Notes:\n
+ * 	Returns 0 if the kernels are not supported by the processor.
+ *
+ * @param	type the type of kernel.
+ */
+const CwKernel *
+getCwKernel(CwKernelType type)
+{
+	for (int32_t i = KERNELS - 1; i >= 0; --i) {
+		const CwKernel *k = &kernels[i];
+		if ((type == BestCwKernel || k->type == type)
+				&& isSupported(k->type))
+			return (k);
+	}
+	return (0);
+}
+
+}
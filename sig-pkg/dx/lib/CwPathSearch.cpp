@@ -0,0 +1,268 @@
+/*******************************************************************************
+
+ File:    CwPathSearch.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW power path search class
+//
+// The path sums of a block are kept in SSE registers, four start bins
+// per register.  Vector and scalar single precision additions round
+// identically, so the sums are the same as those of the path by path
+// search.  The path offsets must also be the same, so the products and
+// sums which compute them must not be fused into multiply-adds.
+//
+#include <algorithm>
+#include <float.h>
+#include <stdlib.h>
+#include <xmmintrin.h>
+#include "CwPathSearch.h"
+
+#pragma GCC optimize ("fp-contract=off")
+
+namespace dx {
+
+namespace {
+
+const int32_t FLOATS_PER_VECTOR = sizeof(__m128) / sizeof(float32_t);
+
+/**
+ * Determine whether a path is better than the best one so far.
+ *
+ * Notes:\n
+ * 	Equal paths are resolved as the bin by bin, drift by drift search
+ * 	would resolve them.
+ */
+inline bool
+isBetter(float32_t power, int32_t bin, int32_t drift, const CwPath& best)
+{
+	if (power != best.power)
+		return (power > best.power);
+	return (bin < best.bin || (bin == best.bin && drift < best.drift));
+}
+
+/**
+ * Determine whether none of the paths of a block can reach minPower.
+ *
+ * Description:\n
+ * 	No final sum can exceed the largest partial sum plus the largest
+ * 	power of each remaining spectrum, except by the rounding of the
+ * 	remaining single precision additions, each of which is no more
+ * 	than FLT_EPSILON / 2 of the sum; the bound allows for all of them.
+ */
+template<int32_t V>
+inline bool
+isPruned(const __m128 *acc, int32_t spectrum, int32_t spectra,
+		const float64_t *remainMax, float32_t minPower)
+{
+	__m128 m = acc[0];
+	for (int32_t v = 1; v < V; ++v)
+		m = _mm_max_ps(m, acc[v]);
+	float32_t lane[FLOATS_PER_VECTOR];
+	_mm_storeu_ps(lane, m);
+	float32_t partial = *std::max_element(lane, lane + FLOATS_PER_VECTOR);
+	float64_t bound = (partial + remainMax[spectrum])
+			* (1 + (spectra - spectrum) * FLT_EPSILON);
+	return (bound < minPower);
+}
+
+/**
+ * Sum the paths of a block of V vectors of start bins.
+ *
+ * Description:\n
+ * 	Returns false if the block was abandoned because none of its
+ * 	paths can reach minPower.
+ */
+template<int32_t V>
+bool
+sumVectors(const float32_t *base, const int32_t *offset, int32_t spectra,
+		const float64_t *remainMax, float32_t minPower, float32_t *sum)
+{
+	__m128 acc[V];
+	for (int32_t v = 0; v < V; ++v)
+		acc[v] = _mm_setzero_ps();
+	for (int32_t s0 = 0; s0 < spectra; s0 += PATH_PRUNE_SPECTRA) {
+		int32_t s1 = std::min(s0 + PATH_PRUNE_SPECTRA, spectra);
+		for (int32_t s = s0; s < s1; ++s) {
+			const float32_t *row = base + offset[s];
+			for (int32_t v = 0; v < V; ++v) {
+				acc[v] = _mm_add_ps(acc[v],
+						_mm_loadu_ps(row + v * FLOATS_PER_VECTOR));
+			}
+		}
+		if (s1 < spectra && isPruned<V>(acc, s1, spectra, remainMax,
+				minPower))
+			return (false);
+	}
+	for (int32_t v = 0; v < V; ++v)
+		_mm_storeu_ps(sum + v * FLOATS_PER_VECTOR, acc[v]);
+	return (true);
+}
+
+}
+
+CwPathSearch::CwPathSearch(): blocks(0), pruned(0), blockBins(0), pad(0),
+		stride(0), sum(PATH_BLOCK_BINS)
+{
+}
+
+CwPathSearch::~CwPathSearch()
+{
+}
+
+/**
+ * Find the strongest path, a block of start bins at a time.
+ *
+ * Notes:\n
+ * 	The block is as narrow as the plane allows.  The plane is copied
+ * 	with zeros on either side of each spectrum, so that every block
+ * 	can be summed at full width whatever the drift; the sums of start
+ * 	bins outside the plane, or whose paths leave it, are ignored.
+ */
+CwPath
+CwPathSearch::search(const float32_t *power, int32_t spectra, int32_t bins)
+{
+	CwPath best;
+	blocks = pruned = 0;
+	if (spectra <= 0 || bins <= 0)
+		return (best);
+
+	blockBins = PATH_BLOCK_BINS;
+	while (blockBins / 2 >= bins && blockBins > PATH_MIN_BLOCK_BINS)
+		blockBins /= 2;
+	int32_t maxDrift = std::min(spectra, bins - 1);
+	int32_t blockCount = (bins + blockBins - 1) / blockBins;
+	pad = maxDrift;
+	stride = blockCount * blockBins + 2 * pad;
+	plane.assign(spectra * stride, 0);
+	offset.resize(spectra);
+	remainMax.resize(spectra + 1);
+	remainMax[spectra] = 0;
+	for (int32_t s = spectra - 1; s >= 0; --s) {
+		const float32_t *row = power + s * bins;
+		std::copy(row, row + bins, &plane[s*stride+pad]);
+		// largest power in this spectrum and all following ones
+		remainMax[s] = remainMax[s+1] + *std::max_element(row, row + bins);
+	}
+
+	// drifts 0, 1, -1, 2, -2, ...
+	for (int32_t i = 0; i <= 2 * maxDrift; ++i) {
+		int32_t drift = (i & 1) ? (i + 1) / 2 : -(i / 2);
+		computeOffsets(spectra, drift);
+		int32_t lo = drift < 0 ? -drift : 0;
+		int32_t hi = drift < 0 ? bins : bins - drift;
+		for (int32_t b = lo - lo % blockBins; b < hi; b += blockBins) {
+			++blocks;
+			if (!sumBlock(&plane[b], spectra, best.power)) {
+				++pruned;
+				continue;
+			}
+			int32_t first = std::max(lo - b, 0);
+			int32_t last = std::min(hi - b, blockBins);
+			for (int32_t j = first; j < last; ++j) {
+				if (isBetter(sum[j], b + j, drift, best))
+					best = CwPath(b + j, drift, sum[j]);
+			}
+		}
+	}
+	return (best);
+}
+
+/**
+ * Find the strongest path, one path at a time.
+ */
+CwPath
+CwPathSearch::searchAll(const float32_t *power, int32_t spectra,
+		int32_t bins)
+{
+	CwPath best;
+	for (int32_t bin = 0; bin < bins; ++bin) {
+		int32_t startDrift = -std::min(bin, spectra);
+		int32_t endDrift = std::min(bins - bin - 1, spectra);
+		for (int32_t drift = startDrift; drift <= endDrift; ++drift) {
+			float32_t p = 0;
+			for (int32_t s = 0; s < spectra; ++s)
+				p += power[s * bins + bin + getOffset(s, spectra, drift)];
+			if (p > best.power)
+				best = CwPath(bin, drift, p);
+		}
+	}
+	return (best);
+}
+
+/**
+ * Compute the offset of a path from its start bin in a spectrum.
+ */
+int32_t
+CwPathSearch::getOffset(int32_t spectrum, int32_t spectra, int32_t drift)
+{
+	float32_t slope = (float32_t) abs(drift) / (float32_t) spectra;
+	int32_t x = (int32_t) (slope * ((float32_t) spectrum + 0.5) + 0.5);
+	return (drift < 0 ? -x : x);
+}
+
+/**
+ * Compute the offset of the path in each spectrum of the padded plane,
+ * as getOffset() does, for a path starting at bin 0.
+ */
+void
+CwPathSearch::computeOffsets(int32_t spectra, int32_t drift)
+{
+	float32_t slope = (float32_t) abs(drift) / (float32_t) spectra;
+	int32_t sign = drift < 0 ? -1 : 1;
+	int32_t *ofs = &offset[0];
+	for (int32_t s = 0; s < spectra; ++s) {
+		int32_t x = (int32_t) (slope * ((float32_t) s + 0.5) + 0.5);
+		ofs[s] = s * stride + pad + sign * x;
+	}
+}
+
+/**
+ * Sum the paths of a block of start bins for the current drift.
+ *
+ * Description:\n
+ * 	Returns false if the block was abandoned because none of its
+ * 	paths can reach minPower.
+ */
+bool
+CwPathSearch::sumBlock(const float32_t *base, int32_t spectra,
+		float32_t minPower)
+{
+	const int32_t *ofs = &offset[0];
+	const float64_t *remain = &remainMax[0];
+	switch (blockBins / FLOATS_PER_VECTOR) {
+	case 2:
+		return (sumVectors<2>(base, ofs, spectra, remain, minPower, &sum[0]));
+	case 4:
+		return (sumVectors<4>(base, ofs, spectra, remain, minPower, &sum[0]));
+	default:
+		return (sumVectors<8>(base, ofs, spectra, remain, minPower, &sum[0]));
+	}
+}
+
+}
@@ -34,10 +34,24 @@
 // $Header: /home/cvs/nss/sonata-pkg/dx/src/CwUnpacker.cpp,v 1.4 2009/03/06 22:10:38 kes Exp $
 //
 #include <fftw3.h>
+#include <string.h>
 #include "CwUnpacker.h"
 
 namespace dx {
 
+/**
+ * Store a packed byte in the first bin of an unpacked byte, zeroing
+ * the other bins.
+ */
+static inline CwUnpackedByte
+getRawByte(uint8_t val)
+{
+	CwUnpackedByte raw;
+	memset(&raw, 0, sizeof(raw));
+	raw.bin[0] = val;
+	return (raw);
+}
+
 CwUnpacker::CwUnpacker()
 {
 	cmdArgs = Args::getInstance();
@@ -49,15 +63,17 @@ CwUnpacker::CwUnpacker()
 
 CwUnpacker::~CwUnpacker()
 {
-	delete xlatPos;
-	delete xlatNeg;
+	fftwf_free(xlatPos);
+	fftwf_free(xlatNeg);
 }
 
 void
-CwUnpacker::unpack(DaddSlope slope, uint8_t *packed, uint64_t *unpacked,
+CwUnpacker::unpack(DaddSlope slope, uint8_t *packed, DaddAccum *unpackedBins,
 		int32_t packedOfs, int32_t unpackedOfs, int32_t spectra,
 		int32_t bins, int32_t packedStride, int32_t unpackedStride)
 {
+	CwUnpackedByte *unpacked =
+			reinterpret_cast<CwUnpackedByte *> (unpackedBins);
 	int32_t binsPerXfer, xfersPerSpectrum;
 
 	binsPerXfer = (int32_t) (sizeof(*packed) / CWD_BYTES_PER_BIN);
@@ -89,40 +105,39 @@ CwUnpacker::unpack(DaddSlope slope, uint8_t *packed, uint64_t *unpacked,
  * 	Builds an array of DaddAccum-sized values which correspond to the
  * 	expanded equivalent of a block of
  */
-uint64_t *
+CwUnpackedByte *
 CwUnpacker::buildUnpackArray(DaddSlope slope)
 {
-	DaddAccum val[4];
-	uint64_t *xlat;
+	CwUnpackedByte *xlat;
 
 	// allocate the array
-	size_t size = CWD_XLAT_SIZE * sizeof(uint64_t);
-	xlat = static_cast<uint64_t *> (fftwf_malloc(size));
+	size_t size = CWD_XLAT_SIZE * sizeof(CwUnpackedByte);
+	xlat = static_cast<CwUnpackedByte *> (fftwf_malloc(size));
 
 	// initialize the array
 	if (slope == Positive) {
 		for (int32_t i = 0; i < CWD_XLAT_SIZE; ++i) {
+			DaddAccum *val = xlat[i].bin;
 			val[0] = i & 3;
 			val[1] = (i >> 2) & 3;
 			val[2] = (i >> 4) & 3;
 			val[3] = (i >> 6) & 3;
-			xlat[i] = *((uint64_t *) val);
 		}
 	}
 	else {
 		for (int32_t i = 0; i < CWD_XLAT_SIZE; ++i) {
+			DaddAccum *val = xlat[i].bin;
 			val[3] = i & 3;
 			val[2] = (i >> 2) & 3;
 			val[1] = (i >> 4) & 3;
 			val[0] = (i >> 6) & 3;
-			xlat[i] = *((uint64_t *) val);
 		}
 	}
 	return (xlat);
 }
 
 void
-CwUnpacker::unpackPos(uint8_t *packed, uint64_t *unpacked,
+CwUnpacker::unpackPos(uint8_t *packed, CwUnpackedByte *unpacked,
 		int32_t spectra, int32_t xfersPerSpectrum, int32_t packedStride,
 		int32_t unpackedStride)
 {
@@ -140,7 +155,7 @@ CwUnpacker::unpackPos(uint8_t *packed, uint64_t *unpacked,
 		// don't really unpack
 		for (int i = 0; i < spectra; i++) {
 			for (int j = 0; j < xfersPerSpectrum; j++)
-				unpacked[j] = packed[j];
+				unpacked[j] = getRawByte(packed[j]);
 			packed += packedStride;
 			unpacked += unpackedStride;
 		}
@@ -148,7 +163,7 @@ CwUnpacker::unpackPos(uint8_t *packed, uint64_t *unpacked,
 }
 
 void
-CwUnpacker::unpackNeg(uint8_t *packed, uint64_t *unpacked,
+CwUnpacker::unpackNeg(uint8_t *packed, CwUnpackedByte *unpacked,
 		int32_t spectra, int32_t xfersPerSpectrum, int32_t packedStride,
 		int32_t unpackedStride)
 {
@@ -167,7 +182,7 @@ CwUnpacker::unpackNeg(uint8_t *packed, uint64_t *unpacked,
 	else {
 		for (int i = 0; i < spectra; i++) {
 			for (int j = 0; j < xfersPerSpectrum; j++)
-				unpacked[-j] = packed[j];
+				unpacked[-j] = getRawByte(packed[j]);
 			packed += packedStride;
 			unpacked += unpackedStride;
 		}
@@ -0,0 +1,331 @@
+/*******************************************************************************
+
+ File:    DedriftKernel.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Dedrift kernels.
+//
+// The vector kernels split the block into anchors of
+// DEDRIFT_ANCHOR_SAMPLES samples.  At each anchor n0 the phase of
+// sample n0 + j is
+//
+//		phase(n0) + (freq + 2 * drift * n0) * j + drift * j * j
+//
+// The anchor and linear phasors are computed in double precision for
+// eight consecutive samples, then advanced eight samples at a time in
+// single precision; the quadratic phasors are the same for every anchor
+// and are tabulated once per call.  Both vector kernels process eight
+// samples per step, as independent phasor chains to hide the latency of
+// the multiplies, with the same sequence of single precision
+// operations, so they produce identical results.
+//
+#include <algorithm>
+#include <immintrin.h>
+#include <math.h>
+#include "DedriftKernel.h"
+
+#pragma GCC optimize ("fp-contract=off")
+
+namespace dx {
+
+namespace {
+
+#define AVX2_TARGET		__attribute__ ((target("avx2")))
+
+const int32_t ANCHOR_SAMPLES = DEDRIFT_ANCHOR_SAMPLES;
+// # of samples advanced per step
+const int32_t STEP_SAMPLES = 8;
+
+//
+// scalar kernel
+//
+void
+scalarDedrift(ComplexFloat32 *out, const ComplexFloat32 *in, int32_t n,
+		float64_t freq, float64_t drift)
+{
+	ComplexFloat96 vector(1, 0);
+	ComplexFloat96 omega(cosl(freq + drift), sinl(freq + drift));
+	ComplexFloat96 dOmega(cosl(2 * drift), sinl(2 * drift));
+
+	for (int32_t i = 0; i < n; ++i) {
+		ComplexFloat96 data = in[i];
+		out[i] = data * vector;
+		vector *= omega;
+		omega *= dOmega;
+	}
+}
+
+//
+// common code for the vector kernels
+//
+
+// complex multiply without the library checks for infinities
+inline ComplexFloat64
+mul(const ComplexFloat64& x, const ComplexFloat64& y)
+{
+	return (ComplexFloat64(x.real() * y.real() - x.imag() * y.imag(),
+			x.real() * y.imag() + x.imag() * y.real()));
+}
+
+inline ComplexFloat64
+phasor(float64_t theta)
+{
+	float64_t s, c;
+	sincos(theta, &s, &c);
+	return (ComplexFloat64(c, s));
+}
+
+/**
+ * Tabulate the quadratic phasors exp(j * drift * i * i) of an anchor.
+ */
+void
+quadTable(float32_t *q, float64_t drift)
+{
+	ComplexFloat64 p(1, 0);
+	ComplexFloat64 d = phasor(drift);
+	ComplexFloat64 dd = phasor(2 * drift);
+	for (int32_t i = 0; i < ANCHOR_SAMPLES; ++i) {
+		q[2*i] = p.real();
+		q[2*i+1] = p.imag();
+		p = mul(p, d);
+		d = mul(d, dd);
+	}
+}
+
+/**
+ * Compute the phasors of the first step of the anchor at sample n0 and
+ * the phasor which advances them by one step.
+ */
+void
+anchor(float32_t *p, float32_t *s, int32_t n0, float64_t freq,
+		float64_t drift)
+{
+	float64_t t = n0;
+	ComplexFloat64 a = phasor(freq * t + drift * t * t);
+	ComplexFloat64 e = phasor(freq + 2 * drift * t);
+	for (int32_t i = 0; i < STEP_SAMPLES; ++i) {
+		p[2*i] = a.real();
+		p[2*i+1] = a.imag();
+		a = mul(a, e);
+	}
+	ComplexFloat64 e2 = mul(e, e);
+	ComplexFloat64 e4 = mul(e2, e2);
+	ComplexFloat64 e8 = mul(e4, e4);
+	s[0] = e8.real();
+	s[1] = e8.imag();
+}
+
+// single precision complex multiply, in the same order as the vectors
+inline void
+mul(float32_t *z, const float32_t *x, const float32_t *y)
+{
+	float32_t re = x[0] * y[0] - x[1] * y[1];
+	float32_t im = x[1] * y[0] + x[0] * y[1];
+	z[0] = re;
+	z[1] = im;
+}
+
+/**
+ * Dedrift the last samples of a block, which are fewer than a step.
+ */
+void
+dedriftTail(float32_t *out, const float32_t *in, int32_t n,
+		const float32_t *p, const float32_t *q)
+{
+	for (int32_t i = 0; i < n; ++i) {
+		float32_t z[2];
+		mul(z, in + 2 * i, p + 2 * i);
+		mul(out + 2 * i, z, q + 2 * i);
+	}
+}
+
+//
+// SSE2 kernel: two samples per register, four registers per step
+//
+inline __m128
+sse2Mul(__m128 x, __m128 y)
+{
+	const __m128 sign = _mm_set_ps(0.0, -0.0, 0.0, -0.0);
+	__m128 yr = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0));
+	__m128 yi = _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 1, 1));
+	__m128 xs = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+	return (_mm_add_ps(_mm_mul_ps(x, yr),
+			_mm_xor_ps(_mm_mul_ps(xs, yi), sign)));
+}
+
+void
+sse2Dedrift(ComplexFloat32 *out, const ComplexFloat32 *in, int32_t n,
+		float64_t freq, float64_t drift)
+{
+	float32_t q[2*ANCHOR_SAMPLES] __attribute__ ((aligned (32)));
+	quadTable(q, drift);
+
+	const float32_t *ip = reinterpret_cast<const float32_t *> (in);
+	float32_t *op = reinterpret_cast<float32_t *> (out);
+	for (int32_t n0 = 0; n0 < n; n0 += ANCHOR_SAMPLES) {
+		int32_t len = std::min(ANCHOR_SAMPLES, n - n0);
+		float32_t p[2*STEP_SAMPLES] __attribute__ ((aligned (16)));
+		float32_t s[2];
+		anchor(p, s, n0, freq, drift);
+		__m128 p0 = _mm_load_ps(p);
+		__m128 p1 = _mm_load_ps(p + 4);
+		__m128 p2 = _mm_load_ps(p + 8);
+		__m128 p3 = _mm_load_ps(p + 12);
+		__m128 step = _mm_set_ps(s[1], s[0], s[1], s[0]);
+		const float32_t *x = ip + 2 * n0;
+		float32_t *y = op + 2 * n0;
+		int32_t j;
+		for (j = 0; j + STEP_SAMPLES <= len; j += STEP_SAMPLES) {
+			const float32_t *xj = x + 2 * j;
+			const float32_t *qj = q + 2 * j;
+			float32_t *yj = y + 2 * j;
+			_mm_storeu_ps(yj, sse2Mul(sse2Mul(_mm_loadu_ps(xj), p0),
+					_mm_load_ps(qj)));
+			_mm_storeu_ps(yj + 4, sse2Mul(sse2Mul(_mm_loadu_ps(xj + 4), p1),
+					_mm_load_ps(qj + 4)));
+			_mm_storeu_ps(yj + 8, sse2Mul(sse2Mul(_mm_loadu_ps(xj + 8), p2),
+					_mm_load_ps(qj + 8)));
+			_mm_storeu_ps(yj + 12, sse2Mul(sse2Mul(_mm_loadu_ps(xj + 12), p3),
+					_mm_load_ps(qj + 12)));
+			p0 = sse2Mul(p0, step);
+			p1 = sse2Mul(p1, step);
+			p2 = sse2Mul(p2, step);
+			p3 = sse2Mul(p3, step);
+		}
+		if (j < len) {
+			_mm_store_ps(p, p0);
+			_mm_store_ps(p + 4, p1);
+			_mm_store_ps(p + 8, p2);
+			_mm_store_ps(p + 12, p3);
+			dedriftTail(y + 2 * j, x + 2 * j, len - j, p, q + 2 * j);
+		}
+	}
+}
+
+//
+// AVX2 kernel: four samples per register, two registers per step
+//
+AVX2_TARGET inline __m256
+avx2Mul(__m256 x, __m256 y)
+{
+	__m256 yr = _mm256_moveldup_ps(y);
+	__m256 yi = _mm256_movehdup_ps(y);
+	__m256 xs = _mm256_permute_ps(x, _MM_SHUFFLE(2, 3, 0, 1));
+	return (_mm256_addsub_ps(_mm256_mul_ps(x, yr), _mm256_mul_ps(xs, yi)));
+}
+
+AVX2_TARGET void
+avx2Dedrift(ComplexFloat32 *out, const ComplexFloat32 *in, int32_t n,
+		float64_t freq, float64_t drift)
+{
+	float32_t q[2*ANCHOR_SAMPLES] __attribute__ ((aligned (32)));
+	quadTable(q, drift);
+
+	const float32_t *ip = reinterpret_cast<const float32_t *> (in);
+	float32_t *op = reinterpret_cast<float32_t *> (out);
+	for (int32_t n0 = 0; n0 < n; n0 += ANCHOR_SAMPLES) {
+		int32_t len = std::min(ANCHOR_SAMPLES, n - n0);
+		float32_t p[2*STEP_SAMPLES] __attribute__ ((aligned (32)));
+		float32_t s[2];
+		anchor(p, s, n0, freq, drift);
+		__m256 p0 = _mm256_load_ps(p);
+		__m256 p1 = _mm256_load_ps(p + 8);
+		__m256 step = _mm256_set_ps(s[1], s[0], s[1], s[0], s[1], s[0],
+				s[1], s[0]);
+		const float32_t *x = ip + 2 * n0;
+		float32_t *y = op + 2 * n0;
+		int32_t j;
+		for (j = 0; j + STEP_SAMPLES <= len; j += STEP_SAMPLES) {
+			const float32_t *xj = x + 2 * j;
+			const float32_t *qj = q + 2 * j;
+			float32_t *yj = y + 2 * j;
+			_mm256_storeu_ps(yj, avx2Mul(avx2Mul(_mm256_loadu_ps(xj), p0),
+					_mm256_load_ps(qj)));
+			_mm256_storeu_ps(yj + 8, avx2Mul(avx2Mul(_mm256_loadu_ps(xj + 8),
+					p1), _mm256_load_ps(qj + 8)));
+			p0 = avx2Mul(p0, step);
+			p1 = avx2Mul(p1, step);
+		}
+		if (j < len) {
+			_mm256_store_ps(p, p0);
+			_mm256_store_ps(p + 8, p1);
+			dedriftTail(y + 2 * j, x + 2 * j, len - j, p, q + 2 * j);
+		}
+	}
+}
+
+// kernels in order of increasing preference
+const DedriftKernel kernels[] = {
+	{ ScalarDedriftKernel, "scalar", scalarDedrift },
+	{ Sse2DedriftKernel, "sse2", sse2Dedrift },
+	{ Avx2DedriftKernel, "avx2", avx2Dedrift }
+};
+
+const int32_t KERNELS = sizeof(kernels) / sizeof(kernels[0]);
+
+bool
+isSupported(DedriftKernelType type)
+{
+	__builtin_cpu_init();
+	switch (type) {
+	case Sse2DedriftKernel:
+		return (__builtin_cpu_supports("sse2"));
+	case Avx2DedriftKernel:
+		return (__builtin_cpu_supports("avx2"));
+	default:
+		return (true);
+	}
+}
+
+}
+
+/**
+ * Get a dedrift kernel.
+ *
+ * Description:\n
+ * 	Returns the kernel of the specified type, or the fastest kernel
+ * 	supported by the processor if type is BestDedriftKernel.\n\n
+ * Notes:\n
+ * 	Returns 0 if the kernel is not supported by the processor.
+ *
+ * @param	type the type of kernel.
+ */
+const DedriftKernel *
+getDedriftKernel(DedriftKernelType type)
+{
+	for (int32_t i = KERNELS - 1; i >= 0; --i) {
+		const DedriftKernel *k = &kernels[i];
+		if ((type == BestDedriftKernel || k->type == type)
+				&& isSupported(k->type))
+			return (k);
+	}
+	return (0);
+}
+
+}
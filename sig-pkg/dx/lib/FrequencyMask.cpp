@@ -33,15 +33,22 @@
 //
 // $Header: /home/cvs/nss/sonata-pkg/dx/lib/FrequencyMask.cpp,v 1.4 2009/05/24 23:41:53 kes Exp $
 //
+#include <algorithm>
+#include <utility>
+#include <vector>
 #include "Err.h"
 #include "FrequencyMask.h"
 
+using std::pair;
+using std::sort;
+using std::vector;
+
 namespace dx {
 
 FrequencyMask::FrequencyMask(int32_t nBands_, const FrequencyBand *mask_,
 		const FrequencyBand& bandCovered_, const NssDate *versionDate_):
 		useCount(1), current(-1), nBands(nBands_), bandCovered(bandCovered_),
-		mask(0), mLock("fmask")
+		mask(0), nIntervals(0), loIndex(0), hiIndex(0), mLock("fmask")
 {
 	int i;
 
@@ -56,10 +63,13 @@ FrequencyMask::FrequencyMask(int32_t nBands_, const FrequencyBand *mask_,
 		Debug(DEBUG_FREQ_MASK, mask[i].centerFreq, "mask cf");
 		Debug(DEBUG_FREQ_MASK, mask[i].bandwidth, "mask bw");
 	}
+	buildIndex();
 }
 
 FrequencyMask::~FrequencyMask()
 {
+	delete [] hiIndex;
+	delete [] loIndex;
 	delete [] mask;
 }
 
@@ -88,43 +98,164 @@ FrequencyMask::getBand(int32_t cur_)
 	return band;
 }
 
-//
-// Notes:
-//		This function assumes that the mask is ordered by
-//		ascending frequency, and that there are no overlaps.
-//		A binary search would be much faster.
-//
+/**
+ * Build the interval index used by isMasked.
+ *
+ * Description:\n
+ * 	Converts the bands to closed [lo, hi] intervals, sorts them by
+ * 	low edge and merges any which overlap or touch.  The resulting
+ * 	intervals are disjoint and ascending, so both the low and high
+ * 	edges are sorted and a single binary search on the high edges
+ * 	finds the only interval which can overlap a signal.\n
+ * Notes:\n
+ * 	The mask is not required to be ordered or free of overlaps.\n
+ * 	Bands with negative bandwidth cover no frequencies and are
+ * 	dropped.\n
+ * 	The index is built once, before the mask is published, and is
+ * 	never modified, so it needs no lock.
+ */
+void
+FrequencyMask::buildIndex()
+{
+	vector<pair<float64_t, float64_t> > intervals;
+	intervals.reserve(nBands);
+	for (int32_t i = 0; i < nBands; ++i) {
+		float64_t loMask = mask[i].centerFreq - mask[i].bandwidth / 2;
+		float64_t hiMask = mask[i].centerFreq + mask[i].bandwidth / 2;
+		if (loMask <= hiMask)
+			intervals.push_back(pair<float64_t, float64_t>(loMask, hiMask));
+	}
+	sort(intervals.begin(), intervals.end());
+
+	loIndex = new float64_t[intervals.size() + 1];
+	hiIndex = new float64_t[intervals.size() + 1];
+	nIntervals = 0;
+	for (size_t i = 0; i < intervals.size(); ++i) {
+		if (nIntervals && intervals[i].first <= hiIndex[nIntervals-1]) {
+			if (intervals[i].second > hiIndex[nIntervals-1])
+				hiIndex[nIntervals-1] = intervals[i].second;
+		}
+		else {
+			loIndex[nIntervals] = intervals[i].first;
+			hiIndex[nIntervals] = intervals[i].second;
+			++nIntervals;
+		}
+	}
+	Debug(DEBUG_FREQ_MASK, nIntervals, "mask intervals");
+}
+
+/**
+ * Find the first interval whose high edge is at or above a frequency.
+ *
+ * Notes:\n
+ * 	Returns nIntervals if there is no such interval.\n
+ * 	The search halves the range with arithmetic rather than
+ * 	a branch, since the signals arrive in no particular order and
+ * 	the branches of an ordinary binary search are unpredictable.
+ */
+inline int32_t
+FrequencyMask::findInterval(float64_t loFreq_)
+{
+	if (!nIntervals)
+		return (0);
+	const float64_t *base = hiIndex;
+	int32_t len = nIntervals;
+	while (len > 1) {
+		int32_t half = len / 2;
+		base += (base[half-1] < loFreq_) * half;
+		len -= half;
+	}
+	return ((base - hiIndex) + (*base < loFreq_));
+}
+
+/**
+ * Test whether a signal overlaps any band of the mask.
+ *
+ * Description:\n
+ * 	The signal covers the closed interval frequency_ +/- width_ / 2;
+ * 	it is masked if it overlaps or touches any band.  Only the
+ * 	first interval ending at or above the low edge of the signal
+ * 	can overlap it, so a binary search replaces the scan of the
+ * 	entire mask.\n
+ * Notes:\n
+ * 	Takes no lock; the index is immutable.\n
+ * 	Called for every candidate signal, so it does not trace its
+ * 	arguments; the bands are traced as the mask is built.
+ */
 bool
 FrequencyMask::isMasked(float64_t frequency_, float64_t width_)
 {
-	bool rval = false;
-	int i;
-	float64_t loFreq, hiFreq, loMask, hiMask;
+	float64_t loFreq = frequency_ - width_ / 2;
+	float64_t hiFreq = frequency_ + width_ / 2;
 
-	loFreq = frequency_ - width_ / 2;
-	hiFreq = frequency_ + width_ / 2;
-	Debug(DEBUG_FREQ_MASK, frequency_, "signal freq");
-	Debug(DEBUG_FREQ_MASK, loFreq, "low signal freq");
-	Debug(DEBUG_FREQ_MASK, hiFreq, "high signal freq");
+	int32_t k = findInterval(loFreq);
+	return (k < nIntervals && loIndex[k] <= hiFreq);
+}
 
-	lock();
-	for (i = 0; i < nBands; i++) {
-		loMask = mask[i].centerFreq - mask[i].bandwidth / 2;
-		hiMask = mask[i].centerFreq + mask[i].bandwidth / 2;
-		Debug(DEBUG_FREQ_MASK, loMask, "low mask freq");
-		Debug(DEBUG_FREQ_MASK, hiMask, "high mask freq");
-
-		// if we've passed it in the list, it's not there
-		if (hiFreq < loMask)
-			break;
-		if (loFreq <= hiMask && hiFreq >= loMask) {
-			rval = true;
-			break;
+/**
+ * Test a set of signals of the same width against the mask.
+ *
+ * Description:\n
+ * 	Sets masked_[i] to the result of isMasked(frequency_[i], width_).
+ * 	The frequencies are expected in ascending order, in which case
+ * 	the signals and the intervals are merged in a single pass.\n
+ * Notes:\n
+ * 	A frequency below its predecessor restarts the merge with a
+ * 	binary search, so unordered input gives correct, if slower,
+ * 	results.
+ */
+void
+FrequencyMask::isMasked(const float64_t *frequency_, int32_t n_,
+		float64_t width_, bool *masked_)
+{
+	float64_t halfWidth = width_ / 2;
+	float64_t lastLo = 0;
+	int32_t k = 0;
+	for (int32_t i = 0; i < n_; ++i) {
+		float64_t loFreq = frequency_[i] - halfWidth;
+		float64_t hiFreq = frequency_[i] + halfWidth;
+		if (i && loFreq < lastLo)
+			k = findInterval(loFreq);
+		else {
+			while (k < nIntervals && hiIndex[k] < loFreq)
+				++k;
 		}
+		lastLo = loFreq;
+		masked_[i] = (k < nIntervals && loIndex[k] <= hiFreq);
+	}
+}
 
+/**
+ * Test a set of signals of differing widths against the mask.
+ *
+ * Description:\n
+ * 	Sets masked_[i] to the result of isMasked(frequency_[i],
+ * 	width_[i]).  The merge advances with the low edges of the
+ * 	signals, so it is a single pass when they are ascending; signals
+ * 	sorted by frequency whose widths are small compared to their
+ * 	spacing are almost always in that order.\n
+ * Notes:\n
+ * 	A low edge below its predecessor restarts the merge with a
+ * 	binary search.
+ */
+void
+FrequencyMask::isMasked(const float64_t *frequency_, const float64_t *width_,
+		int32_t n_, bool *masked_)
+{
+	float64_t lastLo = 0;
+	int32_t k = 0;
+	for (int32_t i = 0; i < n_; ++i) {
+		float64_t loFreq = frequency_[i] - width_[i] / 2;
+		float64_t hiFreq = frequency_[i] + width_[i] / 2;
+		if (i && loFreq < lastLo)
+			k = findInterval(loFreq);
+		else {
+			while (k < nIntervals && hiIndex[k] < loFreq)
+				++k;
+		}
+		lastLo = loFreq;
+		masked_[i] = (k < nIntervals && loIndex[k] <= hiFreq);
 	}
-	unlock();
-	return (rval);
 }
 
 int
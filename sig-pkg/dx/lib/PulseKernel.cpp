@@ -0,0 +1,236 @@
+/*******************************************************************************
+
+ File:    PulseKernel.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Pulse threshold kernels.
+//
+// The SSE2 kernel extracts the over-threshold bins of each comparison
+// mask one at a time, which is cheap when hits are rare.  The AVX2
+// kernel compacts each group of 8 bins with a table-driven permutation
+// and stores all of them, advancing the output by the number of hits, so
+// its cost does not depend upon the hit density.  Since there can be no
+// more hits than bins already examined, the extra entries stored never
+// go past the end of the output arrays.
+//
+// Rounding of the power must be the same in every kernel, so the
+// products and sums must not be fused into multiply-adds.
+//
+#include <immintrin.h>
+#include "PulseKernel.h"
+
+#pragma GCC optimize ("fp-contract=off")
+
+namespace dx {
+
+namespace {
+
+#define AVX2_TARGET		__attribute__ ((target("avx2,popcnt")))
+
+//
+// scalar kernel
+//
+int32_t
+scalarThreshold(const ComplexFloat32 *data, int32_t n, float32_t threshold,
+		int32_t *bin, float32_t *power)
+{
+	int32_t hits = 0;
+	for (int32_t i = 0; i < n; ++i) {
+		float32_t p = data[i].real() * data[i].real()
+				+ data[i].imag() * data[i].imag();
+		if (p > threshold) {
+			bin[hits] = i;
+			power[hits++] = p;
+		}
+	}
+	return (hits);
+}
+
+/**
+ * Threshold the bins which remain after the vector loop, starting at
+ * bin i.
+ */
+inline int32_t
+finish(const ComplexFloat32 *data, int32_t i, int32_t n, float32_t threshold,
+		int32_t *bin, float32_t *power, int32_t hits)
+{
+	int32_t rem = scalarThreshold(data + i, n - i, threshold, bin + hits,
+			power + hits);
+	for (int32_t j = hits; j < hits + rem; ++j)
+		bin[j] += i;
+	return (hits + rem);
+}
+
+//
+// SSE2 kernel: 4 bins per step
+//
+const int32_t SSE2_BINS = 4;
+
+int32_t
+sse2Threshold(const ComplexFloat32 *data, int32_t n, float32_t threshold,
+		int32_t *bin, float32_t *power)
+{
+	const float32_t *d = reinterpret_cast<const float32_t *> (data);
+	__m128 t = _mm_set1_ps(threshold);
+	float32_t p[SSE2_BINS] __attribute__ ((aligned (16)));
+	int32_t hits = 0;
+	int32_t i;
+	for (i = 0; i + SSE2_BINS <= n; i += SSE2_BINS, d += 2 * SSE2_BINS) {
+		__m128 a = _mm_loadu_ps(d);
+		__m128 b = _mm_loadu_ps(d + 4);
+		a = _mm_mul_ps(a, a);
+		b = _mm_mul_ps(b, b);
+		__m128 pw = _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+				_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		uint32_t mask = _mm_movemask_ps(_mm_cmpgt_ps(pw, t));
+		if (!mask)
+			continue;
+		_mm_store_ps(p, pw);
+		for (; mask; mask &= mask - 1) {
+			int32_t j = __builtin_ctz(mask);
+			bin[hits] = i + j;
+			power[hits++] = p[j];
+		}
+	}
+	return (finish(data, i, n, threshold, bin, power, hits));
+}
+
+//
+// AVX2 kernel: 8 bins per step
+//
+const int32_t AVX2_BINS = 8;
+
+/**
+ * Permutations which move the selected elements of a group of 8 to the
+ * front, indexed by the comparison mask.
+ */
+struct CompactTable {
+	int32_t perm[1 << AVX2_BINS][AVX2_BINS];
+
+	CompactTable() {
+		for (int32_t m = 0; m < (1 << AVX2_BINS); ++m) {
+			int32_t k = 0;
+			for (int32_t j = 0; j < AVX2_BINS; ++j) {
+				if (m & (1 << j))
+					perm[m][k++] = j;
+			}
+			while (k < AVX2_BINS)
+				perm[m][k++] = 0;
+		}
+	}
+} compactTable;
+
+AVX2_TARGET int32_t
+avx2Threshold(const ComplexFloat32 *data, int32_t n, float32_t threshold,
+		int32_t *bin, float32_t *power)
+{
+	const float32_t *d = reinterpret_cast<const float32_t *> (data);
+	__m256 t = _mm256_set1_ps(threshold);
+	__m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i step = _mm256_set1_epi32(AVX2_BINS);
+	int32_t hits = 0;
+	int32_t i;
+	for (i = 0; i + AVX2_BINS <= n; i += AVX2_BINS, d += 2 * AVX2_BINS) {
+		__m256 a = _mm256_loadu_ps(d);
+		__m256 b = _mm256_loadu_ps(d + 8);
+		a = _mm256_mul_ps(a, a);
+		b = _mm256_mul_ps(b, b);
+		// the shuffles work within 128-bit lanes, so the powers are in
+		// the order 0 1 4 5 2 3 6 7
+		__m256 pw = _mm256_add_ps(
+				_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+				_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		pw = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(pw),
+				_MM_SHUFFLE(3, 1, 2, 0)));
+		uint32_t mask = _mm256_movemask_ps(_mm256_cmp_ps(pw, t,
+				_CMP_GT_OQ));
+		if (mask) {
+			__m256i perm = _mm256_loadu_si256(
+					(const __m256i *) compactTable.perm[mask]);
+			_mm256_storeu_ps(power + hits,
+					_mm256_permutevar8x32_ps(pw, perm));
+			_mm256_storeu_si256((__m256i *) (bin + hits),
+					_mm256_permutevar8x32_epi32(idx, perm));
+			hits += _mm_popcnt_u32(mask);
+		}
+		idx = _mm256_add_epi32(idx, step);
+	}
+	return (finish(data, i, n, threshold, bin, power, hits));
+}
+
+// kernels in order of increasing preference
+const PulseKernel kernels[] = {
+	{ ScalarPulseKernel, "scalar", scalarThreshold },
+	{ Sse2PulseKernel, "sse2", sse2Threshold },
+	{ Avx2PulseKernel, "avx2", avx2Threshold }
+};
+
+const int32_t KERNELS = sizeof(kernels) / sizeof(kernels[0]);
+
+bool
+isSupported(PulseKernelType type)
+{
+	__builtin_cpu_init();
+	switch (type) {
+	case Sse2PulseKernel:
+		return (__builtin_cpu_supports("sse2"));
+	case Avx2PulseKernel:
+		return (__builtin_cpu_supports("avx2")
+				&& __builtin_cpu_supports("popcnt"));
+	default:
+		return (true);
+	}
+}
+
+}
+
+/**
+ * Get a kernel.
+ *
+ * Description:\n
+ * 	Returns the kernel of the specified type, or the fastest kernel
+ * 	supported by the processor if type is BestPulseKernel.\n\n
+ * Notes:\n
+ * 	Returns 0 if the kernel is not supported by the processor.
+ *
+ * @param	type the type of kernel.
+ */
+const PulseKernel *
+getPulseKernel(PulseKernelType type)
+{
+	for (int32_t i = KERNELS - 1; i >= 0; --i) {
+		const PulseKernel *k = &kernels[i];
+		if ((type == BestPulseKernel || k->type == type)
+				&& isSupported(k->type))
+			return (k);
+	}
+	return (0);
+}
+
+}
@@ -0,0 +1,262 @@
+/*******************************************************************************
+
+ File:    PulseTripletSearch.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Pulse triplet search class
+//
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include "PulseTripletSearch.h"
+
+using std::pair;
+
+namespace dx {
+
+namespace {
+
+// order triplets for the same first pulse by third, then second pulse
+bool
+compareTriplets(const PulseTriplet& t0, const PulseTriplet& t1)
+{
+	if (t0.p2 != t1.p2)
+		return (t0.p2 < t1.p2);
+	return (t0.p1 < t1.p1);
+}
+
+}
+
+PulseTripletSearch::PulseTripletSearch(): maxDrift(1), minSpectrum(0),
+		maxSpectrum(-1)
+{
+}
+
+PulseTripletSearch::~PulseTripletSearch()
+{
+}
+
+/**
+ * Find the triplets in a slice using the (spectrum, bin) index.
+ *
+ * Description:\n
+ * 	For each pulse p0 in [startBin, endBin), the candidates for p1 are
+ * 	the pulses at least MIN_DELTA_SPECTRA later which lie close enough
+ * 	to the drift cone that a matching p2 could be inside it.  Given
+ * 	the p0-p1 step, p2 must be within MAX_DIFF_SPECTRA spectra and
+ * 	MAX_DIFF_BINS bins of p1 plus the same step, so it is looked up
+ * 	directly.  Every candidate is then checked with the same tests as
+ * 	the exhaustive search.
+ * Notes:\n
+ * 	The triplets for each p0 are sorted by (p2, p1) to match the
+ * 	order of the exhaustive search, so that triplet limits affect the
+ * 	same triplets.
+ *
+ * @param		pulses pulses sorted by spectrum.
+ * @param		startBin first bin of the slice.
+ * @param		endBin end bin of the slice (exclusive).
+ * @param		maxDrift_ maximum drift in bins per spectrum.
+ * @param		triplets list of triplets found.
+ */
+void
+PulseTripletSearch::search(const PulseVector& pulses, int32_t startBin,
+		int32_t endBin, float32_t maxDrift_, PulseTripletList& triplets)
+{
+	triplets.clear();
+	maxDrift = maxDrift_;
+	if (pulses.size() < 3)
+		return;
+	buildIndex(pulses);
+
+	for (uint32_t i = 0; i < pulses.size(); ++i) {
+		const dx::Pulse& p0 = pulses[i];
+		if (p0.bin < startBin || p0.bin >= endBin)
+			continue;
+		found.clear();
+		for (int32_t s1 = p0.spectrum + MIN_DELTA_SPECTRA; ; ++s1) {
+			int32_t ds = s1 - p0.spectrum;
+			// the earliest possible third pulse
+			int32_t s2Min = s1 + std::max(ds - MAX_DIFF_SPECTRA,
+					MIN_DELTA_SPECTRA);
+			if (s2Min > maxSpectrum)
+				break;
+			// p0-p2 spans at most 2 * ds + MAX_DIFF_SPECTRA spectra and
+			// 2 * db + MAX_DIFF_BINS bins, and must be inside the cone
+			int32_t w = (int32_t) ((maxDrift * (2 * ds + MAX_DIFF_SPECTRA)
+					+ MAX_DIFF_BINS) / 2) + 1;
+			int32_t end;
+			for (int32_t n = findRow(s1, p0.bin - w, end);
+					n < end && bins[n] <= p0.bin + w; ++n) {
+				int32_t j = order[n];
+				const dx::Pulse& p1 = pulses[j];
+				int32_t b2 = p1.bin + (p1.bin - p0.bin);
+				for (int32_t s2 = s1 + ds - MAX_DIFF_SPECTRA;
+						s2 <= s1 + ds + MAX_DIFF_SPECTRA; ++s2) {
+					int32_t end2;
+					for (int32_t m = findRow(s2, b2 - MAX_DIFF_BINS, end2);
+							m < end2 && bins[m] <= b2 + MAX_DIFF_BINS; ++m) {
+						int32_t k = order[m];
+						const dx::Pulse& p2 = pulses[k];
+						if (insideDriftCone(p0, p2)
+								&& tripletCheck(p0, p1, p2))
+							found.push_back(PulseTriplet(i, j, k));
+					}
+				}
+			}
+		}
+		std::sort(found.begin(), found.end(), compareTriplets);
+		triplets.insert(triplets.end(), found.begin(), found.end());
+	}
+}
+
+/**
+ * Find the triplets in a slice by testing every combination of pulses.
+ *
+ * Description:\n
+ * 	This is the original search, which is cubic in the number of
+ * 	pulses.  It is retained as the reference for search().
+ */
+void
+PulseTripletSearch::searchAll(const PulseVector& pulses, int32_t startBin,
+		int32_t endBin, float32_t maxDrift_, PulseTripletList& triplets)
+{
+	triplets.clear();
+	maxDrift = maxDrift_;
+	for (uint32_t i = 0; i < pulses.size(); ++i) {
+		const dx::Pulse& p0 = pulses[i];
+		if (p0.bin >= startBin && p0.bin < endBin) {
+			for (uint32_t k = i + 2; k < pulses.size(); ++k) {
+				const dx::Pulse& p2 = pulses[k];
+				if (insideDriftCone(p0, p2)) {
+					for (uint32_t j = i + 1; j < k; ++j) {
+						if (tripletCheck(p0, pulses[j], p2))
+							triplets.push_back(PulseTriplet(i, j, k));
+					}
+				}
+			}
+		}
+	}
+}
+
+bool
+PulseTripletSearch::insideDriftCone(const dx::Pulse& p0, const dx::Pulse& p2)
+{
+	PulseDiff d(p0, p2);
+	if (d.spectra < 2 * MIN_DELTA_SPECTRA)
+		return (false);
+
+	float32_t drift = (float32_t) d.bins / d.spectra;
+	return (fabs(drift) < maxDrift);
+}
+
+bool
+PulseTripletSearch::tripletCheck(const dx::Pulse& p0, const dx::Pulse& p1,
+		const dx::Pulse& p2)
+{
+	PulseDiff d0(p0, p1);
+	PulseDiff d1(p1, p2);
+
+	return (aboutEqual(d0, d1));
+}
+
+bool
+PulseTripletSearch::aboutEqual(const PulseDiff& d0, const PulseDiff& d1)
+{
+	if (d0.spectra <= 0 || d1.spectra <= 0)
+		return (false);
+	if (d0.spectra < MIN_DELTA_SPECTRA || d1.spectra < MIN_DELTA_SPECTRA)
+		return (false);
+
+	int32_t dBins = abs(d0.bins - d1.bins);
+	int32_t dSpectra = abs(d0.spectra - d1.spectra);
+	return (dBins <= MAX_DIFF_BINS && dSpectra <= MAX_DIFF_SPECTRA);
+}
+
+/**
+ * Index the pulses by (spectrum, bin).
+ *
+ * Description:\n
+ * 	Builds a compressed row table: the pulses of spectrum s occupy
+ * 	[rowStart[s - minSpectrum], rowStart[s - minSpectrum + 1]) of
+ * 	bins and order, sorted by bin.
+ */
+void
+PulseTripletSearch::buildIndex(const PulseVector& pulses)
+{
+	int32_t n = pulses.size();
+	minSpectrum = pulses[0].spectrum;
+	maxSpectrum = pulses[n-1].spectrum;
+	int32_t rows = maxSpectrum - minSpectrum + 1;
+
+	rowStart.assign(rows + 1, 0);
+	for (int32_t i = 0; i < n; ++i) {
+		Assert(!i || pulses[i].spectrum >= pulses[i-1].spectrum);
+		++rowStart[pulses[i].spectrum - minSpectrum + 1];
+	}
+	for (int32_t r = 0; r < rows; ++r)
+		rowStart[r+1] += rowStart[r];
+
+	// the pulses are already grouped by spectrum; sort each row by bin
+	vector<pair<int32_t, int32_t> > row;
+	bins.resize(n);
+	order.resize(n);
+	for (int32_t r = 0; r < rows; ++r) {
+		row.clear();
+		for (int32_t i = rowStart[r]; i < rowStart[r+1]; ++i)
+			row.push_back(std::make_pair(pulses[i].bin, i));
+		std::sort(row.begin(), row.end());
+		for (uint32_t i = 0; i < row.size(); ++i) {
+			bins[rowStart[r]+i] = row[i].first;
+			order[rowStart[r]+i] = row[i].second;
+		}
+	}
+}
+
+/**
+ * Find the first indexed pulse in a spectrum at or above a bin.
+ *
+ * @param		spectrum spectrum.
+ * @param		bin lowest bin.
+ * @param		end returns the end of the spectrum row.
+ * @return		index position of the pulse; equal to end if there is none.
+ */
+int32_t
+PulseTripletSearch::findRow(int32_t spectrum, int32_t bin, int32_t& end)
+{
+	if (spectrum < minSpectrum || spectrum > maxSpectrum) {
+		end = 0;
+		return (0);
+	}
+	int32_t r = spectrum - minSpectrum;
+	end = rowStart[r+1];
+	return (std::lower_bound(bins.begin() + rowStart[r], bins.begin() + end,
+			bin) - bins.begin());
+}
+
+}
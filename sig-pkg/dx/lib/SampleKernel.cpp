@@ -0,0 +1,220 @@
+/*******************************************************************************
+
+ File:    SampleKernel.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Input sample conversion kernels.
+//
+// The vector kernels convert the bulk of a block and use the scalar
+// kernels for the remainder.  Since every 16-bit integer is exactly
+// representable in single precision, all versions are bit-identical.
+//
+#include <immintrin.h>
+#include "SampleKernel.h"
+
+namespace dx {
+
+namespace {
+
+#define SSE41_TARGET	__attribute__ ((target("sse4.1")))
+#define AVX2_TARGET		__attribute__ ((target("avx2")))
+
+// exchange the 16-bit halves of each 32-bit sample
+#define SWAP_HALVES		_MM_SHUFFLE(2, 3, 0, 1)
+
+//
+// scalar kernels
+//
+void
+scalarConvert(ComplexFloat32 *out, const ComplexInt16 *in, int32_t n)
+{
+	for (int32_t i = 0; i < n; ++i)
+		out[i] = ComplexFloat32(in[i].real(), in[i].imag());
+}
+
+void
+scalarConvertSwapped(ComplexFloat32 *out, const ComplexInt16 *in, int32_t n)
+{
+	for (int32_t i = 0; i < n; ++i)
+		out[i] = ComplexFloat32(in[i].imag(), in[i].real());
+}
+
+//
+// SSE4.1 kernels: 4 samples per iteration
+//
+const int32_t SSE41_SAMPLES = 4;
+
+SSE41_TARGET inline void
+sse41Store(float32_t *out, __m128i v)
+{
+	_mm_storeu_ps(out, _mm_cvtepi32_ps(_mm_cvtepi16_epi32(v)));
+	_mm_storeu_ps(out + 4,
+			_mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(v, 8))));
+}
+
+SSE41_TARGET void
+sse41Convert(ComplexFloat32 *out, const ComplexInt16 *in, int32_t n)
+{
+	float32_t *o = reinterpret_cast<float32_t *> (out);
+	int32_t i;
+	for (i = 0; i + SSE41_SAMPLES <= n; i += SSE41_SAMPLES, o += 8)
+		sse41Store(o, _mm_loadu_si128((const __m128i *) (in + i)));
+	scalarConvert(out + i, in + i, n - i);
+}
+
+SSE41_TARGET void
+sse41ConvertSwapped(ComplexFloat32 *out, const ComplexInt16 *in, int32_t n)
+{
+	float32_t *o = reinterpret_cast<float32_t *> (out);
+	int32_t i;
+	for (i = 0; i + SSE41_SAMPLES <= n; i += SSE41_SAMPLES, o += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *) (in + i));
+		v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, SWAP_HALVES),
+				SWAP_HALVES);
+		sse41Store(o, v);
+	}
+	scalarConvertSwapped(out + i, in + i, n - i);
+}
+
+//
+// AVX2 kernels: 8 samples per iteration
+//
+const int32_t AVX2_SAMPLES = 8;
+
+AVX2_TARGET inline void
+avx2Store(float32_t *out, __m256i v)
+{
+	_mm256_storeu_ps(out, _mm256_cvtepi32_ps(
+			_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v))));
+	_mm256_storeu_ps(out + 8, _mm256_cvtepi32_ps(
+			_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1))));
+}
+
+AVX2_TARGET void
+avx2Convert(ComplexFloat32 *out, const ComplexInt16 *in, int32_t n)
+{
+	float32_t *o = reinterpret_cast<float32_t *> (out);
+	int32_t i;
+	for (i = 0; i + AVX2_SAMPLES <= n; i += AVX2_SAMPLES, o += 16)
+		avx2Store(o, _mm256_loadu_si256((const __m256i *) (in + i)));
+	sse41Convert(out + i, in + i, n - i);
+}
+
+AVX2_TARGET void
+avx2ConvertSwapped(ComplexFloat32 *out, const ComplexInt16 *in, int32_t n)
+{
+	float32_t *o = reinterpret_cast<float32_t *> (out);
+	int32_t i;
+	for (i = 0; i + AVX2_SAMPLES <= n; i += AVX2_SAMPLES, o += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i *) (in + i));
+		v = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, SWAP_HALVES),
+				SWAP_HALVES);
+		avx2Store(o, v);
+	}
+	sse41ConvertSwapped(out + i, in + i, n - i);
+}
+
+// kernels in order of increasing preference
+const SampleKernel kernels[] = {
+	{ ScalarSampleKernel, "scalar", scalarConvert, scalarConvertSwapped },
+	{ Sse41SampleKernel, "sse4.1", sse41Convert, sse41ConvertSwapped },
+	{ Avx2SampleKernel, "avx2", avx2Convert, avx2ConvertSwapped }
+};
+
+const int32_t KERNELS = sizeof(kernels) / sizeof(kernels[0]);
+
+bool
+isSupported(SampleKernelType type)
+{
+	__builtin_cpu_init();
+	switch (type) {
+	case Sse41SampleKernel:
+		return (__builtin_cpu_supports("sse4.1"));
+	case Avx2SampleKernel:
+		// the AVX2 kernels finish with the SSE4.1 kernels
+		return (__builtin_cpu_supports("avx2")
+				&& __builtin_cpu_supports("sse4.1"));
+	default:
+		return (true);
+	}
+}
+
+}
+
+/**
+ * Get a set of kernels.
+ *
+ * Description:\n
+ * 	Returns the kernels of the specified type, or the fastest kernels
+ * 	supported by the processor if type is BestSampleKernel.\n\n
+ * Notes:\n
+ * 	Returns 0 if the kernels are not supported by the processor.
+ *
+ * @param	type the type of kernel.
+ */
+const SampleKernel *
+getSampleKernel(SampleKernelType type)
+{
+	for (int32_t i = KERNELS - 1; i >= 0; --i) {
+		const SampleKernel *k = &kernels[i];
+		if ((type == BestSampleKernel || k->type == type)
+				&& isSupported(k->type))
+			return (k);
+	}
+	return (0);
+}
+
+/**
+ * Convert a block of samples from a circular input buffer.
+ *
+ * Description:\n
+ * 	Converts n samples starting at the specified sample number.  Since
+ * 	the input buffer is circular, the block may wrap past the end of
+ * 	the buffer, in which case it is converted in two parts.
+ *
+ * @param	convert the conversion kernel.
+ * @param	inBuf the input buffer.
+ * @param	sample the first sample to convert.
+ * @param	n the number of samples.
+ * @param	out the output buffer.
+ */
+void
+convertSamples(SampleConvertFunc convert, InputBuffer *inBuf,
+		uint64_t sample, int32_t n, ComplexFloat32 *out)
+{
+	for (int32_t ofs = 0; ofs < n; ) {
+		int32_t len = n - ofs;
+		const ComplexInt16 *samples = static_cast<const ComplexInt16 *>
+				(inBuf->getSampleBlk(sample + ofs, len));
+		convert(out + ofs, samples, len);
+		ofs += len;
+	}
+}
+
+}
@@ -0,0 +1,215 @@
+/*******************************************************************************
+
+ File:    SignalClassifierEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Signal classifier engine
+//
+#include <algorithm>
+#include "SignalClassifierEngine.h"
+
+using std::lower_bound;
+using std::sort;
+
+namespace dx {
+
+SignalClassifierEngine::SignalClassifierEngine()
+{
+}
+
+SignalClassifierEngine::~SignalClassifierEngine()
+{
+}
+
+void
+SignalClassifierEngine::clear()
+{
+	sigs.clear();
+	badBands.clear();
+	flags.clear();
+}
+
+/**
+ * Add a signal to be classified.
+ *
+ * Notes:\n
+ * 	The signal must remain valid until it has been classified.
+ */
+void
+SignalClassifierEngine::addSignal(const SignalDescription *sig_)
+{
+	sigs.push_back(sig_);
+}
+
+void
+SignalClassifierEngine::addBadBand(const FrequencyBand& band_)
+{
+	badBands.push_back(band_);
+}
+
+/**
+ * Classify all the signals.
+ *
+ * Description:\n
+ * 	Sorts the signals by frequency, then tests them against each
+ * 	mask and the bad bands in a merge pass.  Either mask may be
+ * 	null, in which case no signal is flagged by it.\n
+ * Notes:\n
+ * 	obsLen_ is the data collection time in seconds, over which a
+ * 	drifting signal extends its band.
+ */
+void
+SignalClassifierEngine::classify(FrequencyMask *recentRfi_,
+		FrequencyMask *testSignal_, float64_t obsLen_)
+{
+	int32_t n = sigs.size();
+	flags.assign(n, 0);
+	if (!n)
+		return;
+
+	order.resize(n);
+	for (int32_t i = 0; i < n; ++i)
+		order[i] = pair<float64_t, int32_t>(sigs[i]->path.rfFreq, i);
+	sort(order.begin(), order.end());
+
+	freq.resize(n);
+	width.resize(n);
+	for (int32_t i = 0; i < n; ++i) {
+		const SignalDescription *sig = sigs[order[i].second];
+		freq[i] = sig->path.rfFreq;
+		width[i] = HZ_TO_MHZ(sig->path.width);
+	}
+	if (recentRfi_)
+		applyMask(recentRfi_, RecentRfiFlag);
+	if (testSignal_)
+		applyMask(testSignal_, TestSignalFlag);
+	applyBadBands(obsLen_);
+}
+
+void
+SignalClassifierEngine::applyMask(FrequencyMask *mask, uint8_t flag)
+{
+	int32_t n = order.size();
+	bool *masked = new bool[n];
+	mask->isMasked(&freq[0], &width[0], n, masked);
+	for (int32_t i = 0; i < n; ++i) {
+		if (masked[i])
+			flags[order[i].second] |= flag;
+	}
+	delete [] masked;
+}
+
+/**
+ * Test the signals against the bad bands.
+ *
+ * Description:\n
+ * 	A signal lies in a bad band when the open intervals of the two
+ * 	overlap, as in match.  The bands are sorted by low edge, so the
+ * 	bands starting below the high edge of a signal are a prefix of
+ * 	the list, and the signal lies in one of them if the highest high
+ * 	edge in that prefix is above its low edge.\n
+ * Notes:\n
+ * 	Bands are neither merged nor required to be disjoint, which
+ * 	keeps the test exact for drifting signals whose low edge has
+ * 	been moved above their high edge.\n
+ * 	A high edge below that of the previous signal restarts the merge
+ * 	with a binary search.
+ */
+void
+SignalClassifierEngine::applyBadBands(float64_t obsLen)
+{
+	int32_t m = badBands.size();
+	if (!m)
+		return;
+	bands.resize(m);
+	for (int32_t j = 0; j < m; ++j) {
+		const FrequencyBand& band = badBands[j];
+		bands[j].first = band.centerFreq - band.bandwidth / 2;
+		bands[j].second = band.centerFreq + band.bandwidth / 2;
+	}
+	sort(bands.begin(), bands.end());
+	bandLo.resize(m);
+	maxBandHi.resize(m);
+	for (int32_t j = 0; j < m; ++j) {
+		bandLo[j] = bands[j].first;
+		maxBandHi[j] = j ? std::max(maxBandHi[j-1], bands[j].second)
+				: bands[j].second;
+	}
+
+	int32_t n = order.size();
+	int32_t p = 0;
+	float64_t lastHi = 0;
+	for (int32_t i = 0; i < n; ++i) {
+		const SignalDescription& sig = *sigs[order[i].second];
+		float64_t sigLo = sig.path.rfFreq - (HZ_TO_MHZ(sig.path.width / 2));
+		float64_t sigHi = sig.path.rfFreq + (HZ_TO_MHZ(sig.path.width / 2));
+		if (sig.path.drift >= 0)
+			sigHi += HZ_TO_MHZ(sig.path.drift * obsLen);
+		else
+			sigLo -= HZ_TO_MHZ(sig.path.drift * obsLen);
+		if (i && sigHi < lastHi)
+			p = lower_bound(bandLo.begin(), bandLo.end(), sigHi)
+					- bandLo.begin();
+		else {
+			while (p < m && bandLo[p] < sigHi)
+				++p;
+		}
+		lastHi = sigHi;
+		if (p && maxBandHi[p-1] > sigLo)
+			flags[order[i].second] |= BadBandFlag;
+	}
+}
+
+/**
+ * Test whether a signal lies in a bad band.
+ *
+ * Description:\n
+ * 	The signal occupies its width, extended by its drift over the
+ * 	observation in the direction of the drift.\n
+ * Notes:\n
+ * 	For a negative drift the low edge is moved up rather than down,
+ * 	as the classifier always has; the engine reproduces this.
+ */
+bool
+SignalClassifierEngine::match(const SignalDescription& sig_,
+		const FrequencyBand& band_, float64_t obsLen_)
+{
+	float64_t sigLo = sig_.path.rfFreq - (HZ_TO_MHZ(sig_.path.width / 2));
+	float64_t sigHi = sig_.path.rfFreq + (HZ_TO_MHZ(sig_.path.width / 2));
+	float64_t bandLo = band_.centerFreq - band_.bandwidth / 2;
+	float64_t bandHi = band_.centerFreq + band_.bandwidth / 2;
+
+	if (sig_.path.drift >= 0)
+		sigHi += HZ_TO_MHZ(sig_.path.drift * obsLen_);
+	else
+		sigLo -= HZ_TO_MHZ(sig_.path.drift * obsLen_);
+	return (sigLo < bandHi && sigHi > bandLo);
+}
+
+}
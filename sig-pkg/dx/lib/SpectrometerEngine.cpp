@@ -0,0 +1,602 @@
+/*******************************************************************************
+
+ File:    SpectrometerEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Spectrometer engine class
+//
+// The spectrometry for a half frame is divided into 2 * subchannels
+// independent items, one for each polarization and subchannel.  Items
+// are handed out dynamically to the workers of a worker pool.
+//
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include "SpectrometerEngine.h"
+#include "SmallTypes.h"
+
+namespace dx {
+
+SpectrometerEngine::SpecWorker::SpecWorker(): cdData(0), cwData(0),
+		hitBin(0), hitPower(0)
+{
+	for (int32_t i = 0; i < MAX_RESOLUTIONS; ++i)
+		buf[i] = 0;
+}
+
+SpectrometerEngine::SpecWorker::~SpecWorker()
+{
+	release();
+}
+
+/**
+ * Set up a worker for an activity.
+ *
+ * Description:\n
+ * 	Sets up the worker's private spectrometry library and allocates its
+ * 	temp buffers and spectrum buffers.  The pulse list is reserved for
+ * 	the largest number of pulses which can survive the half frame
+ * 	limit, or the total number of bins if that is smaller, so that it
+ * 	seldom has to grow while processing.\n
+ * Notes:\n
+ * 	FFTW planning is not thread-safe, so this must be called from a
+ * 	single task.  Since the plans of the first worker are recorded as
+ * 	wisdom, all workers execute identical plans.
+ */
+void
+SpectrometerEngine::SpecWorker::setup(const SpecEngineParams& params,
+		ResInfo *resInfo)
+{
+	release();
+
+	cdData = static_cast<ComplexPair *>
+			(fftwf_malloc(params.cdBytesPerSubchannelHalfFrame));
+	Assert(cdData);
+	cwData = static_cast<uint64_t *> (fftwf_malloc(params.cwBufSize));
+	Assert(cwData);
+
+	spectra.setup(params.resData, params.resolutions,
+			params.spectraHalfFrames, params.samples, resInfo);
+	// Spectra produces contiguous output spectra for a given resolution
+	int32_t maxBins = 0;
+	int64_t totalBins = 0;
+	for (int32_t i = 0; i < params.resolutions; ++i) {
+		size_t size = resInfo[i].specLen * resInfo[i].nSpectra
+				* sizeof(ComplexFloat32);
+		buf[i] = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
+		Assert(buf[i]);
+		int32_t bins = params.usableBins[resInfo[i].res];
+		maxBins = std::max(maxBins, bins);
+		totalBins += (int64_t) bins * resInfo[i].nSpectra;
+	}
+	hitBin = new int32_t[maxBins];
+	hitPower = new float32_t[maxBins];
+
+	totalBins *= (int64_t) POLARIZATIONS * params.subchannels;
+	int64_t maxPulses = (int64_t) POLARIZATIONS
+			* params.obs.maxPulsesPerHalfFrame;
+	pulses.clear();
+	pulses.reserve(std::min(totalBins, maxPulses));
+}
+
+void
+SpectrometerEngine::SpecWorker::release()
+{
+	if (cdData)
+		fftwf_free(cdData);
+	cdData = 0;
+	if (cwData)
+		fftwf_free(cwData);
+	cwData = 0;
+	delete [] hitBin;
+	hitBin = 0;
+	delete [] hitPower;
+	hitPower = 0;
+	for (int32_t i = 0; i < MAX_RESOLUTIONS; ++i) {
+		if (buf[i])
+			fftwf_free(buf[i]);
+		buf[i] = 0;
+	}
+}
+
+/**
+ * Create the engine.
+ *
+ * @param	workers_ number of workers (including the calling task).
+ * @param	prio_ priority of the worker tasks.
+ * @param	realtime_ whether the worker tasks are realtime.
+ */
+SpectrometerEngine::SpectrometerEngine(int32_t workers_, int prio_,
+		bool realtime_): frame(0), pool(0), cwKernel(getCwKernel()),
+		pulseKernel(getPulseKernel())
+{
+	pool = new WorkerPool("spectrometer", workers_, prio_, realtime_);
+	Assert(pool);
+	for (int32_t i = 0; i < pool->getWorkers(); ++i) {
+		SpecWorker *w = new SpecWorker();
+		Assert(w);
+		workers.push_back(w);
+	}
+}
+
+SpectrometerEngine::~SpectrometerEngine()
+{
+	delete pool;
+	for (uint32_t i = 0; i < workers.size(); ++i)
+		delete workers[i];
+}
+
+/**
+ * Set up the engine for an activity.
+ *
+ * @param	params_ activity parameters.
+ * @param	resInfo_ returned resolution information (from Spectra).
+ */
+void
+SpectrometerEngine::setup(const SpecEngineParams& params_, ResInfo *resInfo_)
+{
+	params = params_;
+	Assert(params.subchannels > 0 && params.subchannels <= MAX_SUBCHANNELS);
+	Assert(params.spectraHalfFrames <= HALF_FRAME_BUFFERS);
+	if ((int32_t) params.masked.size() < params.subchannels)
+		params.masked.resize(params.subchannels, false);
+
+	for (uint32_t i = 0; i < workers.size(); ++i)
+		workers[i]->setup(params, resInfo);
+	for (int32_t i = 0; i < params.resolutions; ++i)
+		resInfo_[i] = resInfo[i];
+	items.resize(POLARIZATIONS * params.subchannels);
+}
+
+/**
+ * Process a half frame.
+ *
+ * Description:\n
+ * 	Runs all items of the half frame on the worker pool, then appends
+ * 	the pulses to the pulse list in (polarization, subchannel) order.\n
+ * Notes:\n
+ * 	A pulse is kept if its ordinal within its subchannel spectrum does
+ * 	not exceed the subchannel limit (checked by the worker) and its
+ * 	ordinal within the polarization does not exceed the half frame
+ * 	limit (checked here).  Pulses over either limit are counted but
+ * 	not stored.
+ *
+ * @param	frame_ half frame description.
+ * @param	pulseList list to which detected pulses are appended.
+ * @return	the number of over-threshold bins, including discarded ones.
+ */
+int32_t
+SpectrometerEngine::processHalfFrame(const SpecHalfFrame& frame_,
+		PulseList& pulseList)
+{
+	Assert(frame_.hfBufs > 0 && frame_.hfBufs <= HALF_FRAME_BUFFERS);
+	frame = &frame_;
+	for (uint32_t i = 0; i < workers.size(); ++i)
+		workers[i]->pulses.clear();
+	pool->run(this, items.size());
+	frame = 0;
+
+	// merge the pulses
+	int32_t maxPulses = (int32_t) params.obs.maxPulsesPerHalfFrame;
+	int32_t totalPulses = 0;
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		int32_t halfFramePulses = 0;
+		for (int32_t i = 0; i < params.subchannels; ++i) {
+			const SpecItem& item = items[p*params.subchannels+i];
+			const vector<SpecPulse>& pulses = workers[item.worker]->pulses;
+			for (int32_t j = item.first; j < item.first + item.pulses; ++j) {
+				if (halfFramePulses + pulses[j].hit <= maxPulses)
+					pulseList.push_back(pulses[j].pulse);
+			}
+			halfFramePulses += item.hits;
+		}
+		totalPulses += halfFramePulses;
+	}
+	return (totalPulses);
+}
+
+/**
+ * Execute a single item.
+ *
+ * @param	worker index of the worker.
+ * @param	item item to execute; the polarization is item / subchannels.
+ */
+void
+SpectrometerEngine::execute(int32_t worker, int32_t item)
+{
+	SpecWorker *w = workers[worker];
+	SpecItem& result = items[item];
+	result.worker = worker;
+	result.first = w->pulses.size();
+	result.hits = 0;
+	processSubchannel(w, frame->pol[item/params.subchannels],
+			item % params.subchannels, result);
+	result.pulses = w->pulses.size() - result.first;
+}
+
+/**
+ * Process a single subchannel for one polarization and one half frame.
+ *
+ * Description:\n
+ * 	Performs baselining and spectrometry for a single subchannel.  The
+ * 	output spectrum data is stored in its final destination.
+ *
+ * @param		w worker.
+ * @param		pd polarization data.
+ * @param		subchannel.
+ * @param		item result of the item.
+ */
+void
+SpectrometerEngine::processSubchannel(SpecWorker *w, const SpecPolData& pd,
+		int32_t subchannel, SpecItem& item)
+{
+	const ObsData& obs = params.obs;
+	bool masked = params.masked[subchannel];
+
+	// get the most recent half frame buffer
+	ComplexFloat32 *hfData = getHfData(pd.hfData[frame->hfBufs-1],
+			subchannel);
+
+	// compute the baseline
+	if (!masked)
+		computeBaseline(pd, subchannel, hfData, obs.baselineWeighting);
+
+	// if we're still baselining, return
+	if (frame->hf < 0)
+		return;
+
+	// the half frame buffers contain the baselined data with any signals
+	// inserted.  Now output the CD data.
+	if (obs.cdOutputOption == normal) {
+		if (masked)
+			zeroCdData(w);
+		else
+			computeCdData(w, hfData);
+	}
+	else if (obs.cdOutputOption == tagged_data)
+		loadCdPattern(w, subchannel);
+	storeCdData(w, pd, subchannel);
+
+	// now create the spectra if we have enough half frames
+	if (frame->hfBufs < params.spectraHalfFrames)
+		return;
+
+	ComplexFloat32 *hfD[HALF_FRAME_BUFFERS];
+	for (int32_t i = 0; i < params.spectraHalfFrames; ++i)
+		hfD[i] = getHfData(pd.hfData[i], subchannel);
+	w->spectra.computeSpectra(hfD, w->buf);
+
+	// do all resolutions
+	for (int32_t i = 0; i < params.resolutions; ++i) {
+		Resolution res = resInfo[i].res;
+		int32_t specLen = resInfo[i].specLen;
+		int32_t nSpectra = resInfo[i].nSpectra;
+		for (int32_t j = 0; j < nSpectra; ++j) {
+			ComplexFloat32 *data = w->buf[i] + j * specLen;
+			int32_t spectrum = frame->spectrum[i] + j;
+			// do pulse thresholding for the resolution
+			if (!masked) {
+				storePulseData(w, pd.pol, res, subchannel, spectrum,
+						obs.pulseThreshold, data, item);
+			}
+			// test for CW resolution
+			if (res == obs.cwResolution) {
+				if (obs.cwOutputOption == normal) {
+					if (masked)
+						zeroCwData(w);
+					else
+						computeCwData(w, res, data);
+				}
+				else if (obs.cwOutputOption == tagged_data)
+					loadCwPattern(w, res, subchannel, spectrum);
+				storeCwData(w, pd, res, subchannel, spectrum);
+			}
+		}
+	}
+}
+
+/**
+ * Compute the baseline and apply to the data.
+ *
+ * Description:\n
+ * 	For each subchannel and half frame, the average power in a bin is
+ * 	computed (using all the bins in the half frame for that subchannel).
+ * 	The reciprocal of this value is combined with the existing baseline
+ * 	value for the subchannel using an aging algorithm to produce a new
+ * 	baseline.\n\n
+ * Notes:\n
+ * 	This version computes a new baseline using the latest half frame,
+ * 	then applies the new baseline to the half frame.
+ */
+void
+SpectrometerEngine::computeBaseline(const SpecPolData& pd, int32_t subchannel,
+		ComplexFloat32 *hfData, float32_t weighting)
+{
+	// compute the number of initial half frames to fully prime the
+	// baseline
+	int32_t k = 1 / (1.0 - weighting);
+
+	float32_t w = weighting;
+	if (frame->baselineHf < k)
+		w = 1 - 1.0 / (frame->baselineHf + 1);
+	int32_t n = params.samples;
+
+	float32_t bl, power = 0;
+	float32_t *baseline = pd.blData;
+	bl = baseline[subchannel];
+	for (int32_t i = 0; i < n; ++i)
+		power += std::norm(hfData[i]);
+	// we've now computed the power in the subchannel; create a new baseline
+	power *= BASELINE_FACTOR;
+	float32_t hfBl = power ? sqrt(n / power) : 0;
+	baseline[subchannel] = w * bl + (1 - w) * hfBl;
+	for (int32_t i = 0; i < n; ++i)
+		hfData[i] *= baseline[subchannel];
+}
+
+/**
+ * Compute CD data.
+ *
+ * Description:\n
+ * 	Converts subchannel data from complex floating point to complex
+ * 	4-bit integer format.  Data which exceeds the maximum range are
+ * 	saturated to the maximum range.\n
+ *
+ * @param		w worker.
+ * @param		data pointer to floating-point subchannel data.  The data has
+ * 				been baselined.
+ */
+void
+SpectrometerEngine::computeCdData(SpecWorker *w, const ComplexFloat32 *data)
+{
+	int32_t n = params.samples;
+	ComplexPair *cdData = w->cdData;
+#if FLOAT4_ARCHIVE
+	for (int32_t i = 0; i < n; ++i) {
+		ComplexFloat4 d(data[i]);
+		cdData[i] = (ComplexPair) d;
+	}
+#else
+	const int32_t max = MAX_CD_VAL, min = -MAX_CD_VAL;
+
+	for (int32_t i = 0; i < n; ++i) {
+		int32_t re = (int32_t) lrintf(data[i].real());
+		int32_t im = (int32_t) lrintf(data[i].imag());
+		if (re > max)
+			re = max;
+		if (re < min)
+			re = min;
+		if (im > max)
+			im = max;
+		if (im < min)
+			im = min;
+		cdData[i].pair = (re << 4) | (im & 0xf);
+	}
+#endif
+}
+
+/**
+ ** zeroCDData: Set the data to zero for subchannels that are masked.
+ */
+void
+SpectrometerEngine::zeroCdData(SpecWorker *w)
+{
+	memset(w->cdData, 0, params.cdBytesPerSubchannelHalfFrame);
+}
+
+/**
+ * Load a CD test pattern in the output buffer.
+ *
+ * Description:\n
+ ** build a test pattern in the CD output buffer
+ ** bits 31-22 Spectrum
+ ** bits 21-10 Subchannel
+ ** bits 9-0 subchannel spectrum
+ */
+void
+SpectrometerEngine::loadCdPattern(SpecWorker *w, int32_t subchannel)
+{
+	int32_t samples = params.samples;
+	uint32_t *p = (uint32_t *) w->cdData;
+
+	uint32_t seed = (frame->seed << 8) | ((subchannel) << 16);
+
+	for (int32_t i = 0, j = 0; i < samples; i += 4)
+		p[j++] = seed | (i / 4);
+}
+
+/**
+ * Store the CD data for a single subchannel.
+ *
+ * Description:\n
+ * 	Stores the CD data for a single subchannel.  Since all CD data is buffered
+ * 	in memory, the data is corner-turned into its final location in the
+ * 	buffer.
+ *
+ * @param		w worker.
+ * @param		pd polarization data.
+ * @param		subchannel subchannel #
+ */
+void
+SpectrometerEngine::storeCdData(SpecWorker *w, const SpecPolData& pd,
+		int32_t subchannel)
+{
+	size_t ofs = (size_t) subchannel * params.cdBytesPerSubchannel
+			+ (size_t) frame->hf * params.cdBytesPerSubchannelHalfFrame;
+	uint8_t *buf = static_cast<uint8_t *> (pd.cdData) + ofs;
+	memcpy(buf, w->cdData, params.cdBytesPerSubchannelHalfFrame);
+}
+
+/**
+ * Zero the CW data.
+ *
+ * Description:\n
+ * 	Sets the CW data for a masked subchannel to zero.
+ */
+void
+SpectrometerEngine::zeroCwData(SpecWorker *w)
+{
+	memset(w->cwData, 0, params.cwBufSize);
+}
+
+/**
+ * Build a test pattern in the CW temp buffer.
+ *
+ * Description:\n
+ * 	Builds a test pattern in the CW buffer.  The pattern consists of
+ * 	64-bit words: 16 bits of subchannel, 16 bits of spectrum, 32 bits of
+ * 	bin.
+ *
+ * @param		w worker.
+ * @param		res resolution.
+ * @param		subchannel
+ * @param		spectrum
+ */
+void
+SpectrometerEngine::loadCwPattern(SpecWorker *w, Resolution res,
+		int32_t subchannel, int32_t spectrum)
+{
+	int32_t spectrumBins = params.usableBins[res];
+
+	// do 32 bins (64 bits) at a time
+	int32_t bins = sizeof(uint64_t) * CWD_BINS_PER_BYTE;
+	int32_t j = 0;
+
+	uint64_t seed = ((uint64_t) subchannel << 48)
+			| ((uint64_t) spectrum << 32);
+	for (int32_t i = 0; i < spectrumBins; i += bins)
+		w->cwData[j++] = seed + i;
+}
+
+/**
+ * Compute the CW data and pack it into the temporary buffer.
+ *
+ * Description:\n
+ * 	Converts the spectrum data for a single spectrum at a single
+ * 	resolution to CW format, which is 2-bit power packed 4 bins
+ * per byte, then stores the data in the CW temp buffer.\n\n
+ * Notes:\n
+ * 	The windowing, power and packing are done in a single pass by
+ * 	the fastest CW kernel supported by the processor.
+ *
+ * @param		w worker.
+ * @param		res resolution.
+ * @param		data complex spectrum data.
+ */
+void
+SpectrometerEngine::computeCwData(SpecWorker *w, Resolution res,
+		const ComplexFloat32 *data)
+{
+	int32_t totalBins = params.totalBins[res];
+	int32_t usableBins = params.usableBins[res];
+	int32_t hd = (totalBins - usableBins) / 2;
+	int32_t start = hd;
+
+	// do 32 bins (64 bits) at a time
+	int32_t words = (usableBins + CW_BINS_PER_WORD - 1) / CW_BINS_PER_WORD;
+	CwPackFunc pack = params.hanning ? cwKernel->packHanning
+			: cwKernel->pack;
+	pack(w->cwData, &data[start], words);
+}
+
+/**
+ * Store the CW data in the destination buffer.
+ *
+ * Description:\n
+ * 	Copies the CW data from the temp buffer to its final destination
+ * 	in the CW buffer.\n\n
+ * Notes:\n
+ * 	The data has already been converted to packed 2-bit power.
+ *
+ * @param		w worker.
+ * @param		pd polarization data.
+ * @param		res resolution.
+ * @param		subchannel.
+ * @param		spectrum spectrum #.
+ */
+void
+SpectrometerEngine::storeCwData(SpecWorker *w, const SpecPolData& pd,
+		Resolution res, int32_t subchannel, int32_t spectrum)
+{
+	size_t ofs = (size_t) spectrum * params.cwBytesPerSpectrum
+			+ (size_t) subchannel * params.cwBytesPerSubchannel;
+	uint8_t *buf = static_cast<uint8_t *> (pd.cwData) + ofs;
+	memcpy(buf, w->cwData, params.cwBytesPerSubchannel);
+}
+
+/**
+ * Threshold and store the pulse data.
+ *
+ * Description:\n
+ * 	Thresholds the data for a spectrum, adding over-threshold bins
+ * 	as pulses to the worker's pulse list.\n\n
+ * Notes:\n
+ * 	Only the per-subchannel limit can be applied here; the per-half
+ * 	frame limit depends upon the other subchannels and is applied when
+ * 	the pulses are merged.  However, a pulse whose ordinal within the
+ * 	item already exceeds the half frame limit can never be merged, so
+ * 	it is not stored.\n
+ * 	The over-threshold bins are found by the fastest pulse kernel
+ * 	supported by the processor, then appended to the pulse list.
+ *
+ * @param		w worker.
+ * @param		pol polarization.
+ * @param		res resolution.
+ * @param		subchannel.
+ * @param		spectrum spectrum #.
+ * @param		threshold pulse threshold.
+ * @param		data spectrum data.
+ * @param		item result of the item.
+ */
+void
+SpectrometerEngine::storePulseData(SpecWorker *w, Polarization pol,
+		Resolution res, int32_t subchannel, int32_t spectrum,
+		float32_t threshold, const ComplexFloat32 *data, SpecItem& item)
+{
+	int32_t bins = params.usableBins[res];
+	int32_t start = (params.totalBins[res] - bins) / 2;
+	int32_t maxPulses =
+			(int32_t) params.obs.maxPulsesPerSubchannelPerHalfFrame;
+	int32_t halfFramePulses =
+			(int32_t) params.obs.maxPulsesPerHalfFrame - item.hits;
+
+	int32_t hits = pulseKernel->threshold(&data[start], bins, threshold,
+			w->hitBin, w->hitPower);
+	int32_t n = std::min(hits, std::min(maxPulses,
+			std::max(halfFramePulses, 0)));
+	int32_t first = subchannel * bins;
+	for (int32_t i = 0; i < n; ++i) {
+		dx::Pulse pulse(res, first + w->hitBin[i], spectrum, pol,
+				w->hitPower[i], 0.0);
+		w->pulses.push_back(SpecPulse(item.hits + i + 1, pulse));
+	}
+	item.hits += hits;
+}
+
+}
@@ -37,6 +37,7 @@
 #include <DxOpsBitset.h>
 //#include "dedrift.h"
 //#include "Buffer.h"
+#include "Args.h"
 #include "ConfirmationTask.h"
 #include "CwConfirmationTask.h"
 #include "CwSignal.h"
@@ -62,13 +63,14 @@ CwConfirmationTask::getInstance()
 
 CwConfirmationTask::CwConfirmationTask(string name_):
 		QTask(name_, CWD_CONFIRMATION_PRIO), confirmationQ(0), respQ(0),
-		resolution(RES_UNINIT), msgList(0), partitionSet(0), state(0),
-		transform(0)
+		resolution(RES_UNINIT), coherentEngine(0), msgList(0),
+		partitionSet(0), state(0), transform(0)
 {
 }
 
 CwConfirmationTask::~CwConfirmationTask()
 {
+	delete coherentEngine;
 }
 
 void
@@ -112,6 +114,12 @@ CwConfirmationTask::extractArgs()
 	Assert(state);
 	transform = TransformWidth::getInstance();
 	Assert(transform);
+
+	// create the coherent search engine
+	Args *cmdArgs = Args::getInstance();
+	Assert(cmdArgs);
+	coherentEngine = new CwCoherentEngine(cmdArgs->getConfirmationThreads());
+	Assert(coherentEngine);
 }
 
 void
@@ -676,39 +684,25 @@ CwConfirmationTask::createPowerSpectra(CwData& polData)
 // doPowerSearch: search for the strongest power path
 //
 // Synopsis:
-//		void doPowerSearch(powerData, spectra, binsPerSpectrum, bin, drift);
-//		float32_t *powerData;		array of bin powers
-//		int32_t spectra;			# of spectra
-//		int32_t binsPerSpectrum;	# of bins per spectrum
-//		powerPath& bestPath;		# best path
+//		void doPowerSearch(polData);
+//		CwData& polData;			polarization data
 // Description:
-//		Find the strongest path in the array.
+//		Find the strongest path in the power plane and store it
+//		as the best path of the polarization.
 // Notes:
-//		powerData is a 2D array (spectra rows and bins columns)
+//		power.pd is a 2D array (spectra rows and bins columns)
 //		containing power values for each bin in the signal
 //		channel.
+//		The start bin of the best path is relative to the center
+//		of the signal channel.
 //
 void
 CwConfirmationTask::doPowerSearch(CwData& polData)
 {
-	PowerPath temp;
-	for (int32_t bin = 0; bin < power.bins; ++bin) {
-		int32_t startDrift = -_MIN(bin, power.spectra);
-		int32_t endDrift = _MIN(power.bins - bin, power.spectra);
-
-		for (int32_t drift = startDrift; drift <= endDrift; ++drift) {
-			int32_t sign = drift < 0 ? -1 : 1;
-			float32_t sum = computePathSum(power.spectra,
-					power.bins, drift, sign, &power.pd[bin]);
-			if (sum > temp.power) {
-				temp.power = sum;
-				temp.bin = bin;
-				temp.drift = drift;
-			}
-		}
-	}
-	polData.bestPath = temp;
-	polData.bestPath.bin -= power.bins / 2;
+	CwPath path = pathSearch.search(power.pd, power.spectra, power.bins);
+	polData.bestPath.bin = path.bin - power.bins / 2;
+	polData.bestPath.drift = path.drift;
+	polData.bestPath.power = path.power;
 }
 
 /**
@@ -726,30 +720,16 @@ CwConfirmationTask::doCoherentDetection(CwData& polData, Activity *act)
 	Assert(samples > 0);
 	int32_t l = log2(samples);
 	samples = 1 << l;
-	if (samples > coherent.samples) {
+	if (samples > coherent.maxSamples) {
 		if (coherent.td)
 			fftwf_free(coherent.td);
 		size_t size = samples * sizeof(ComplexFloat32);
 		coherent.td = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
 		Assert(coherent.td);
-		if (coherent.dd)
-			fftwf_free(coherent.dd);
-		coherent.dd = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
-		Assert(coherent.dd);
-		if (coherent.fd)
-			fftwf_free(coherent.fd);
-		coherent.fd = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
-		Assert(coherent.fd);
-		if (samples != coherent.samples) {
-			if (coherent.plan)
-				fftwf_destroy_plan(coherent.plan);
-			coherent.plan = fftwf_plan_dft_1d(samples,
-					(fftwf_complex *) coherent.dd,
-					(fftwf_complex *) coherent.fd, FFTW_FORWARD, FFTW_ESTIMATE);
-			Assert(coherent.plan);
-		}
-		coherent.samples = samples;
+		coherent.maxSamples = samples;
 	}
+	coherent.samples = samples;
+	coherentEngine->setup(samples);
 	ac->extractSignalChannel(coherent.td, polData.cfmSig.path.rfFreq,
 			polData.cfmSig.path.drift, widthHz, samples);
 
@@ -779,7 +759,7 @@ CwConfirmationTask::doCoherentDetection(CwData& polData, Activity *act)
 			coherentSpectra, coherentBins, polData.bestPath);
 #endif
 
-	polData.coherentReport = doCoherentSearch(polData, samples);
+	polData.coherentReport = coherentEngine->search(coherent.td);
 	computeSignalData(polData.cfmSig, polData.coherentReport);
 
 	polData.cfm.pfa = polData.coherentReport.chi.chiSq;
@@ -803,63 +783,6 @@ CwConfirmationTask::doCoherentDetection(CwData& polData, Activity *act)
 	polData.cfm.snr = binPower1Hz / nominalBinPower1Hz;
 }
 
-/**
- * Perform a coherent search for the best description of the signal.
- */
-CoherentReport
-CwConfirmationTask::doCoherentSearch(CwData& polData, int32_t samples)
-{
-
-	int32_t middle = samples / 2;
-
-	int32_t len = samples * sizeof(ComplexFloat32);
-	int32_t hLen = len / 2;
-
-	int32_t fSearch = samples / 2;
-	int32_t dSearch = samples - 1;
-	int32_t wSearch = samples;
-
-	int32_t minDrift = -dSearch;
-	int32_t maxDrift = dSearch;
-
-#ifdef notdef
-	int32_t sample;
-	float64_t totalPower;
-
-	for (sample = 0, totalPower = 0; sample < samples; sample++)
-		totalPower += norm(coherentTDData[sample]);
-	Debug(DEBUG_CWD_CONFIRM, totalPower, "doCoS, total TD power =");
-#endif
-
-	ComplexFloat32 temp[samples/2];
-	CoherentReport bestCoherence;
-	for (int32_t drift = minDrift; drift <= maxDrift; drift++) {
-		memcpy(coherent.dd, coherent.td, len);
-		dedriftFTPlane(coherent.dd, 1, samples, 0, 0,
-				(float64_t) drift / (samples * samples));
-		fftwf_execute_dft(coherent.plan, (fftwf_complex *) coherent.dd,
-				(fftwf_complex *) coherent.fd);
-		polData.ac->rescale(coherent.fd, coherent.samples, coherent.samples);
-
-		// rearrange the data so DC is in the middle
-		memcpy(temp, &coherent.fd[0], hLen);
-		memcpy(&coherent.fd[0], &coherent.fd[middle], hLen);
-		memcpy(&coherent.fd[middle], temp, hLen);
-
-		ChiReport chi = checkCoherence(coherent.fd, 1.0, samples, drift,
-				fSearch, wSearch);
-		if (chi.chiSq < bestCoherence.chi.chiSq) {
-			bestCoherence.chi = chi;
-			bestCoherence.microDrift = drift;
-		}
-	}
-
-	bestCoherence.chi.chiSq = ChiSquare(2 * bestCoherence.chi.clusterWidth,
-			2 * bestCoherence.chi.power);
-	bestCoherence.signif = bestCoherence.chi.chiSq;
-	return (bestCoherence);
-}
-
 //
 // extractCoherentSignal: dedrift the time-domain signal channel for the
 //		best power signal and extract the middle two bins
@@ -872,26 +795,6 @@ CwConfirmationTask::extractCoherentSignal(ComplexFloat32 *sigTDData,
 	dedrift(sigTDData, coherentTDData, spectra, bins, bestPath);
 }
 
-float32_t
-CwConfirmationTask::computePathSum(int32_t spectra, int32_t binsPerSpectrum,
-		int32_t drift, int32_t sign, float32_t *pathBase)
-{
-	float32_t sum = 0;
-	for (int32_t spectrum = 0; spectrum < spectra; spectrum++) {
-		int32_t x = computeTruePath(spectrum, spectra, abs(drift));
-		sum += pathBase[spectrum*binsPerSpectrum+sign*x];
-	}
-	return (sum);
-}
-
-int32_t
-CwConfirmationTask::computeTruePath(float32_t spectrum, float32_t spectra,
-		float32_t drift)
-{
-	int32_t x = (int32_t) ((drift / spectra) * (spectrum + 0.5) + 0.5);
-	return (x);
-}
-
 void
 CwConfirmationTask::dedrift(ComplexFloat32 *sigTDData,
 		ComplexFloat32 *coherentTDData, int32_t spectra, int32_t bins,
@@ -932,136 +835,6 @@ CwConfirmationTask::dedrift(ComplexFloat32 *sigTDData,
 #endif
 }
 
-//
-// checkCoherence: find the best coherence width for this drift
-//
-// Notes:
-//		coherenceCheck examines a complex spectrum, under the assumption
-//		that the spectrum contains a coherent signal.    It estimates
-//		the bandwidth of the signal. Power is summed in the bins
-//		taken one at a time, then two at a time, then four at a time,
-//		etc., looking for the (width, power) which is least likely
-//		to have been produced by noise; i.e. the width and power
-//		which are furthest in the tail of the appropriate Chi-squared
-//		distribution.
-//		The code here assumes binsPerSpectrum is a power of 2.
-ChiReport
-CwConfirmationTask::checkCoherence(ComplexFloat32 *data,
-		float64_t avgPower, int32_t bins, int32_t drift, int32_t fSearch,
-		int32_t wSearch)
-{
-	// normalize the power to average for the channel
-	float64_t avgBinPower = 0;
-	float64_t binPower[bins];
-	for (int32_t bin = 0; bin < bins; bin++) {
-		binPower[bin] = norm(data[bin]) / avgPower;
-		avgBinPower += binPower[bin];
-	}
-	avgBinPower /= bins;
-
-	// renormalize the power for the coherent band
-	for (int32_t bin = 0; bin < bins; bin++)
-		binPower[bin] /= avgBinPower;
-
-	ChiReport best;
-
-	// restrict the search to valid frequencies and widths for
-	// the current drift.
-	int32_t middle = bins / 2;
-	int32_t minWidth = 1;
-	int32_t maxWidth = wSearch;
-	for (int32_t width = minWidth; width <= maxWidth; width *= 2) {
-		int32_t halfWidth = width / 2;
-		int32_t fsrch = fSearch;
-
-		// maximum search range is from beginning to end, with
-		// middle as reference
-		if (fsrch > bins / 2)
-			fsrch = bins / 2;
-
-		// if the frequency search range is less than half the
-		// current width, don't search this width;
-		if (fsrch < halfWidth)
-			break;
-
-		// the actual frequency range can be restricted by the
-		// drift and width.  For negative drifts, some lower
-		// frequencies will be restricted, while for positive
-		// drifts upper frequencies will be restricted.
-		int32_t minFreq = middle - fsrch;
-		int32_t maxFreq = middle + fsrch;
-
-		if (drift < 0) {
-			if (minFreq + drift < 0)
-				minFreq = -drift;
-		}
-		else if (maxFreq > bins - drift)
-			maxFreq = bins - drift;
-
-		int32_t delta = halfWidth;
-		if (!delta)
-			delta = 1;
-
-		for (int32_t i = minFreq; i + width <= maxFreq; i += delta) {
-			float64_t power = 0;
-			for (int32_t j = 0; j < width; j++)
-				power += binPower[i+j];
-			float64_t chiSq = ChiSquare(2 * width, 2 * power);
-			if (chiSq < best.chiSq) {
-				best.power = power;
-				best.chiSq = chiSq;
-				best.clusterWidth = width;
-				best.clusterIndex = i;
-			}
-		}
-	}
-
-	best.power *= avgBinPower;
-	best.clusterIndex = (best.clusterIndex + best.clusterWidth / 2) - middle;
-	best.bins = bins;
-	return (best);
-}
-
-void
-CwConfirmationTask::dedriftFTPlane(ComplexFloat32 *ftp, int32_t spectra,
-		int32_t binsPerSpectrum, int32_t firstSample, float64_t shift,
-		float64_t drift)
-{
-	shift *= 2 * M_PI;
-	drift *= M_PI;
-
-	int32_t samples = spectra * binsPerSpectrum;
-
-#ifdef notdef
-	if (shift == 0 && drift == 0) {
-		for (sample = 0; sample < samples; sample++)
-			Debug(DEBUG_CWD_CONFIRM, &ftp[sample], "dFTP before sample =");
-	}
-#endif
-
-	float64_t temp1 = 2 * drift;
-	ComplexFloat32 ei2b = ComplexFloat32(cos(temp1), -sin(temp1));
-
-	float64_t temp2 = (2 * firstSample + 1) * drift + shift;
-	ComplexFloat32 ei2tbp1pa = ComplexFloat32(cos(temp2), -sin(temp2));
-
-	float64_t temp3 = firstSample * (firstSample * drift + shift);
-	ComplexFloat32 eitsq = ComplexFloat32(cos(temp3), -sin(temp3));
-
-	for (int32_t sample = 0; sample < samples; sample++) {
-		ftp[sample] *= eitsq;
-		eitsq *= ei2tbp1pa;
-		ei2tbp1pa *= ei2b;
-	}
-
-#ifdef notdef
-	if (shift == 0 && drift == 0) {
-		for (sample = 0; sample < samples; sample++)
-			Debug(DEBUG_CWD_CONFIRM, &ftp[sample], "dFTP after sample =");
-	}
-#endif
-}
-
 //
 // Notes:
 //		The signal description already contains the frequency and
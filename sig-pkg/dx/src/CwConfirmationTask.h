@@ -42,6 +42,8 @@
 #include <fftw3.h>
 #include "Activity.h"
 #include "ArchiveChannel.h"
+#include "CwCoherentEngine.h"
+#include "CwPathSearch.h"
 #include "DxStruct.h"
 #include "Msg.h"
 #include "Partition.h"
@@ -87,46 +89,6 @@ struct PowerPath {
 	}
 };
 
-struct ChiReport {
-	int32_t bins;						// # of bins per spectrum
-	float64_t power;					// total power
-	float64_t chiSq;
-	int32_t clusterWidth;
-	int32_t clusterIndex;
-
-	ChiReport(): bins(0), power(0), chiSq(0), clusterWidth(0),
-			clusterIndex(0) {}
-
-	friend ostream& operator << (ostream &strm, const ChiReport& pchir)
-	{
-		strm << "ChiReport: "
-			<< "bins: " << pchir.bins
-			<< ", power: " << pchir.power
-			<< ", chiSq: " << pchir.chiSq
-			<< ", clusterWidth: " << pchir.clusterWidth
-			<< ", clusterIndex: " << pchir.clusterIndex << endl;
-		return (strm);
-	}
-
-};
-
-struct CoherentReport {
-	int32_t microDrift;					// # of microbins of drift
-	float64_t signif;					// significance
-	ChiReport chi;					// chi-squared report
-
-	CoherentReport(): microDrift(0), signif(0) {}
-
-	friend ostream& operator << (ostream &strm, const CoherentReport &pcohr)
-	{
-		strm << "CoherentReport: "
-			<< "microdrift: " << pcohr.microDrift
-			<< ", signif: " << pcohr.signif << endl
-			<< pcohr.chi;
-		return (strm);
-	}
-};
-
 /**
  * Confirmation data structure for a single polarization.
  */
@@ -202,17 +164,17 @@ private:
 	} power;							// power signal
 	struct c {
 		int32_t samples;				// # of samples
+		int32_t maxSamples;				// # of samples allocated
 //		int32_t spectra;				// # of spectra
 //		int32_t bins;					// # of bins per spectrum
 		float64_t binWidthHz;			// microbin width in Hz
 		ComplexFloat32 *td;				// time-domain samples
-		ComplexFloat32 *dd;				// dedrifted time-domain samples
-		ComplexFloat32 *fd;				// frequency-time plane
 //		float32_t *pd;					// frequency-time plane power
-		fftwf_plan plan;				// fftw plan
 
-		c(): samples(0), td(0), dd(0), fd(0), plan(0) {}
+		c(): samples(0), maxSamples(0), td(0) {}
 	} coherent;							// coherent signal
+	CwPathSearch pathSearch;			// power path search
+	CwCoherentEngine *coherentEngine;	// coherent drift search
 
 	MsgList *msgList;
 	PartitionSet *partitionSet;
@@ -241,21 +203,11 @@ private:
 	void doCoherentDetection(CwData& polData, Activity *act);
 
 	void doPowerSearch(CwData& polData);
-	CoherentReport doCoherentSearch(CwData& polData, int32_t samples);
 	void extractCoherentSignal(ComplexFloat32 *sigTDData,
 			ComplexFloat32 *coherentTDData, int32_t spectra, int32_t bins,
 			PowerPath bestPath);
-	float32_t computePathSum(int32_t spectra, int32_t binsPerSpectrum,
-			int32_t drift, int32_t sign, float32_t *pathBase);
-	int32_t computeTruePath(float32_t spectrum, float32_t spectra,
-			float32_t drift);
 	void dedrift(ComplexFloat32 *sigTDData, ComplexFloat32 *coherentTDData,
 			int32_t spectra, int32_t bins, PowerPath path);
-	ChiReport checkCoherence(ComplexFloat32 *data, float64_t avgPower,
-			int32_t bins, int32_t drift, int32_t fSearch, int32_t wSearch);
-	void dedriftFTPlane(ComplexFloat32 *ftp, int32_t spectra,
-			int32_t binsPerSpectrum, int32_t firstSample, float64_t shift,
-			float64_t drift);
 	void computeSignalData(SignalDescription& cfmSig,
 			CoherentReport& coherentReport);
 	void computeData(CwData& data, Signal *cwCand, Activity *act);
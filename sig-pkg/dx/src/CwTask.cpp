@@ -66,7 +66,7 @@ CwTask::CwTask(string name_): QTask(name_, CWD_PRIO), resolution(RES_UNINIT),
 		badBandLimit(0), dualPolThreshold(0),
 		nPols(0), pol(0), singlePolThreshold(0), spectra(0), spectrumBins(0),
 		totalBins(0), activity(0), detectionBuf(0), channel(0),
-		badBandList(0), detectionQ(0), superClusterer(0),
+		badBandList(0), engine(0), detectionQ(0), superClusterer(0),
 		rightClusterer(0), leftClusterer(0),
 		cmdArgs(0), msgList(0), state(0)
 {
@@ -74,6 +74,8 @@ CwTask::CwTask(string name_): QTask(name_, CWD_PRIO), resolution(RES_UNINIT),
 
 CwTask::~CwTask()
 {
+	if (engine)
+		delete engine;
 }
 
 void
@@ -113,6 +115,10 @@ CwTask::extractArgs()
 	Assert(msgList);
 	state = State::getInstance();
 	Assert(state);
+
+	// create the DADD engine; the workers run at the CWD priority
+	engine = new CwDaddEngine(cmdArgs->getDaddThreads());
+	Assert(engine);
 }
 
 void
@@ -212,21 +218,45 @@ Debug(DEBUG_DADD, 1, "# 1");
  *
  * Descripton:\n
  * 	Perform DADD on all data, both positive and negative slopes for
- * 	left and right.
+ * 	left and right.\n\n
+ * Notes:\n
+ * 	The work is divided among the DADD engine workers by polarization,
+ * 	slope and slice of the spectrum; the spectrum is divided into one
+ * 	slice per worker.  The engine uses the detection buffer for
+ * 	its first worker.\n
+ * 	The bands are reset for each polarization, so the bad band limit
+ * 	applies to each polarization separately.
  */
 void
 CwTask::doDetection(Msg *msg)
 {
-	dadd.setup(spectra, spectrumBins, totalBins, singlePolThreshold,
-			DADD_BAND_BINS, badBandLimit, TDDadd, true);
-	if (channel->rightPolActive())
-		processPol(POL_RIGHTCIRCULAR);
-	DaddStatistics stats = dadd.getStatistics();
-//	cout << "right pol" << endl << stats;
-	if (channel->leftPolActive())
-		processPol(POL_LEFTCIRCULAR);
-	stats = dadd.getStatistics();
-//	cout << "left pol" << endl << stats;
+	CwDaddParams params;
+	params.spectra = spectra;
+	params.spectrumBins = spectrumBins;
+	params.totalBins = totalBins;
+	params.threshold = singlePolThreshold;
+	params.bandBins = DADD_BAND_BINS;
+	params.badBandLimit = badBandLimit;
+	params.slices = engine->getWorkers();
+	engine->setup(params, detectionBuf->getData(), detectionBuf->getSize());
+
+	ClusterHit rightHit(rightClusterer), leftHit(leftClusterer);
+	BandReport rightBand(POL_RIGHTCIRCULAR, badBandList);
+	BandReport leftBand(POL_LEFTCIRCULAR, badBandList);
+	CwDaddPol pols[POLARIZATIONS];
+	int32_t n = 0;
+	if (channel->rightPolActive()) {
+		pols[n++] = CwDaddPol(POL_RIGHTCIRCULAR, static_cast<uint8_t *>
+				(channel->getCwData(POL_RIGHTCIRCULAR, resolution)),
+				&rightHit, &rightBand);
+	}
+	if (channel->leftPolActive()) {
+		pols[n++] = CwDaddPol(POL_LEFTCIRCULAR, static_cast<uint8_t *>
+				(channel->getCwData(POL_LEFTCIRCULAR, resolution)),
+				&leftHit, &leftBand);
+	}
+	engine->detect(pols, n);
+//	cout << engine->getStatistics();
 
 //	sendDetectionComplete(msg, false);
 }
@@ -266,24 +296,6 @@ CwTask::computeThreshold(float64_t sigma)
 	return ((uint32_t) thresh);
 }
 
-/**
- * Process a single polarization.
- *
- * Description:\n
- * 	Performs detection on the full bandwidth for a single polarization.  The
- * 	packed power data is in a memory buffer as a contiguous block of data.
- */
-void
-CwTask::processPol(Polarization pol)
-{
-	unpack(Positive, pol);
-	detect(Positive, pol);
-	unpack(Negative, pol);
-	detect(Negative, pol);
-	BandReport reportBadBand(pol, badBandList);
-	dadd.reportBadBands(&reportBadBand);
-}
-
 //
 // sendDetectionComplete: issue a CW detection complete message
 //
@@ -315,67 +327,4 @@ CwTask::sendDetectionComplete(Msg *msg, bool stopped)
 	activity = 0;
 }
 
-/**
- * Unpack the packed CW data into the detection buffer.
- *
- * Description:\n
- * 	The packed CW data is in a memory buffer; the data has already been
- * 	corner turned.
- */
-void
-CwTask::unpack(DaddSlope slope, Polarization pol)
-{
-	uint8_t *pData =
-			static_cast<uint8_t *> (channel->getCwData(pol, resolution));
-	uint64_t *upData = static_cast<uint64_t *> (detectionBuf->getData());
-
-	int32_t pOfs = 0;
-	if (slope == Positive) {
-		// we are doing the positive slopes;
-		int32_t upOfs = 0;
-		unpacker.unpack(Positive, pData, upData, pOfs, upOfs,
-				spectra, spectrumBins, spectrumBins, totalBins);
-
-	}
-	else {
-		// negative slopes; unpack the data in reverse order
-		int32_t upOfs = totalBins;
-		unpacker.unpack(Negative, pData, upData, pOfs, upOfs,
-				spectra, spectrumBins, spectrumBins, totalBins);
-	}
-}
-
-//
-// detect: perform Cw detection
-//
-// Synopsis:
-//		void detect(slope);
-//		DaddSlope slope;			direction of slope (pos or neg)
-// Description:
-//
-// Notes:
-//		None.
-//
-void
-CwTask::detect(DaddSlope slope, Polarization pol)
-{
-	CwClusterer *clusterer;
-	switch (pol) {
-	case POL_RIGHTCIRCULAR:
-	case POL_XLINEAR:
-		clusterer = rightClusterer;
-		break;
-	case POL_LEFTCIRCULAR:
-	case POL_YLINEAR:
-		clusterer = leftClusterer;
-		break;
-	default:
-		Assert(0);
-	}
-	// do the adds
-	ClusterHit clusterHit(clusterer);
-	dadd.execute(pol, slope,
-			static_cast<DaddAccum *> (detectionBuf->getData()), &clusterHit);
-}
-
 }
@@ -39,7 +39,7 @@
 #include "Activity.h"
 #include "Args.h"
 #include "CwClusterer.h"
-#include "CwUnpacker.h"
+#include "CwDaddEngine.h"
 #include "Dadd.h"
 #include "Err.h"
 #include "Msg.h"
@@ -107,8 +107,7 @@ private:
 	Buffer *detectionBuf;
 	Channel *channel;
 	CwBadBandList *badBandList;			// bad band list
-	CwUnpacker unpacker;				// unpacker of packed data
-	Dadd dadd;							// DADD processor
+	CwDaddEngine *engine;				// DADD processor
 	Queue *detectionQ;
 	SuperClusterer *superClusterer;		// super cluster
 	CwClusterer *rightClusterer;
@@ -125,10 +124,7 @@ private:
 	void doDetection(Msg *msg);
 	void stopDetection(Msg *msg);
 	uint32_t computeThreshold(float64_t sigma);
-	void processPol(Polarization pol);
 	void sendDetectionComplete(Msg *msg, bool stopped = false);
-	void unpack(DaddSlope slope, Polarization pol);
-	void detect(DaddSlope slope, Polarization pol);
 
 	// hidden
 	CwTask(string name_);
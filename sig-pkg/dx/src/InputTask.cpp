@@ -41,8 +41,11 @@ namespace dx {
 
 InputTask::InputTask(string name_):
 		QTask(name_, INPUT_PRIO, true, false), unit(UnitNone),
-		activity(0), channel(0), msgList(0), state(0)
+		activity(0), channel(0),
+		batchList(ChannelPacketBatchList::getInstance(CHANNEL_PACKET_BATCHES)),
+		msgList(0), state(0)
 {
+	Assert(batchList);
 }
 
 InputTask::~InputTask()
@@ -96,6 +99,9 @@ InputTask::handleMsg(Msg *msg)
 	case InputPacket:
 		processPacket(msg);
 		break;
+	case InputPacketBatch:
+		processPacketBatch(msg);
+		break;
 	default:
 		Fatal(ERR_IMT);
 		break;
@@ -119,6 +125,31 @@ InputTask::processPacket(Msg *msg)
 {
 	ChannelPacket *pkt = static_cast<ChannelPacket *> (msg->getData());
 	Assert(pkt);
+	routePacket(pkt);
+}
+
+/**
+ * Process a batch of packets.
+ *
+ * Description:\n
+ * 	Routes each packet of a batch received by the receiver task in a
+ * 	single system call, then returns the batch to the free list.  The
+ * 	packets themselves are released by the channel.
+ */
+void
+InputTask::processPacketBatch(Msg *msg)
+{
+	ChannelPacketBatch *batch =
+			static_cast<ChannelPacketBatch *> (msg->getData());
+	Assert(batch);
+	for (int32_t i = 0; i < batch->count; ++i)
+		routePacket(batch->pkt[i]);
+	batchList->free(batch);
+}
+
+void
+InputTask::routePacket(ChannelPacket *pkt)
+{
 	// got a packet; route it
 	pkt->demarshall();
 	Error err = channel->handlePacket(pkt);
@@ -39,6 +39,7 @@
 #include <sseDxInterface.h>
 #include "System.h"
 #include "Activity.h"
+#include "ChannelPacketBatchList.h"
 //#include "ChannelPacketList.h"
 #include "Msg.h"
 #include "QTask.h"
@@ -64,6 +65,7 @@ private:
 	dx::Unit unit;
 	Activity *activity;				// ptr to current activity
 	Channel *channel;
+	ChannelPacketBatchList *batchList;	// free packet batch list
 
 	MsgList *msgList;
 	State *state;
@@ -73,6 +75,8 @@ private:
 	void handleMsg(Msg *msg);
 	void startActivity(Msg *msg);
 	void processPacket(Msg *msg);
+	void processPacketBatch(Msg *msg);
+	void routePacket(ChannelPacket *pkt);
 
 	// forbidden
 	InputTask(const InputTask&);
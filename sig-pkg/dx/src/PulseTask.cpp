@@ -559,40 +559,18 @@ PulseTask::extractSliceData()
 //		Each triplet found is added to the PulseClusterer hit list.
 //		This version processes the entire pulse list at once, rather
 //		than breaking the list up into frequency slices.
+//		The search is indexed by (spectrum, bin), but reports the
+//		triplets in the same order as a search of every combination
+//		of pulses.
 //
 void
 PulseTask::findTriplets()
 {
-	dx::Pulse pulse0, pulse1, pulse2;
-
 	sliceTriplets = 0;
-	for (uint32_t i = 0; i < sliceList.size(); ++i) {
-		pulse0 = sliceList[i];
-//		cout << "pulse 0 " << pulse0;
-		if (pulse0.bin >= startBin && pulse0.bin < endBin) {
-			for (uint32_t k = i + 2; k < sliceList.size(); ++k) {
-				pulse2 = sliceList[k];
-				if (insideDriftCone(pulse0, pulse2)) {
-#ifdef notdef
-					cout << "got outside pair" << endl;
-					cout << pulse0;
-					cout << pulse2;
-#endif
-					for (uint32_t j = i + 1; j < k; ++j) {
-						pulse1 = sliceList[j];
-						if (tripletCheck(pulse0, pulse1, pulse2)) {
-							addTriplet(pulse0, pulse1, pulse2);
-#ifdef notdef
-							cout << endl << "add a triplet" << endl;
-							cout << pulse0;
-							cout << pulse1;
-							cout << pulse2;
-#endif
-						}
-					}
-				}
-			}
-		}
+	tripletSearch.search(sliceList, startBin, endBin, maxDrift, tripletList);
+	for (uint32_t i = 0; i < tripletList.size(); ++i) {
+		const PulseTriplet& t = tripletList[i];
+		addTriplet(sliceList[t.p0], sliceList[t.p1], sliceList[t.p2]);
 	}
 }
 
@@ -639,40 +617,6 @@ PulseTask::buildTrains()
 {
 }
 
-bool
-PulseTask::insideDriftCone(dx::Pulse& pulse0, dx::Pulse& pulse1)
-{
-	PulseDiff d(pulse0, pulse1);
-	if (d.spectra < 2 * MIN_DELTA_SPECTRA)
-		return (false);
-
-	float32_t drift = (float32_t) d.bins / d.spectra;
-	return (fabs(drift) < maxDrift);
-}
-
-bool
-PulseTask::tripletCheck(dx::Pulse& pulse0, dx::Pulse& pulse1,
-		dx::Pulse& pulse2)
-{
-	PulseDiff d0(pulse0, pulse1);
-	PulseDiff d1(pulse1, pulse2);
-
-	return (aboutEqual(d0, d1));
-}
-
-bool
-PulseTask::aboutEqual(PulseDiff& d0, PulseDiff& d1)
-{
-	if (d0.spectra <= 0 || d1.spectra <= 0)
-		return (false);
-	if (d0.spectra < MIN_DELTA_SPECTRA || d1.spectra < MIN_DELTA_SPECTRA)
-		return (false);
-
-	int32_t dBins = abs(d0.bins - d1.bins);
-	int32_t dSpectra = abs(d0.spectra - d1.spectra);
-	return (dBins <= MAX_DIFF_BINS && dSpectra <= MAX_DIFF_SPECTRA);
-}
-
 void
 PulseTask::sendSliceComplete()
 {
@@ -41,6 +41,7 @@
 //#include "Err.h"
 #include "Msg.h"
 #include "PulseClusterer.h"
+#include "PulseTripletSearch.h"
 //#include "Pulse.h"
 #include "QTask.h"
 #include "State.h"
@@ -58,7 +59,7 @@ typedef uint64_t PulseKey;
 						| (((PulseKey) p.bin) << 24) | ((PulseKey) p.spectrum)))
 
 typedef map<PulseKey, dx::Pulse> PulseMap;
-typedef vector<dx::Pulse> SliceList;
+typedef PulseVector SliceList;
 
 struct PulseArgs {
 	Queue *detectionQ;					// detection task queue
@@ -114,6 +115,8 @@ private:
 	PulseMap pulseMap;					// complete list of pulses
 	PulseMap singletonMap;				// map of singleton pulses
 	SliceList sliceList;				// list of pulses for a single slice
+	PulseTripletSearch tripletSearch;	// triplet search engine
+	PulseTripletList tripletList;		// triplets in the current slice
 	SuperClusterer *superClusterer;
 										// (actually a vector)
 	MsgList *msgList;
@@ -136,9 +139,6 @@ private:
 	Polarization getTripletPol(Polarization pol0, Polarization pol1,
 			Polarization pol2);
 	void buildTrains();
-	bool insideDriftCone(dx::Pulse& p0, dx::Pulse& p2);
-	bool tripletCheck(dx::Pulse& p0, dx::Pulse& p1, dx::Pulse& p2);
-	bool aboutEqual(PulseDiff& d0, PulseDiff& d1);
 	void sendSliceComplete();
 	void sendResolutionComplete();
 	void displayPulseMap();
@@ -46,9 +46,13 @@ namespace dx {
 ReceiverTask::ReceiverTask(string name_):
 		Task(name_, RECEIVER_PRIO, true, false), unit(UnitNone),
 		rPort(-1), lPort(-1), activity(0),
-		pktList(ChannelPacketList::getInstance()), udp(0), msgList(0), state(0)
+		pktList(ChannelPacketList::getInstance()),
+		batchList(ChannelPacketBatchList::getInstance(CHANNEL_PACKET_BATCHES)),
+		udp(0), msgList(0), state(0)
 {
 	Assert(pktList);
+	Assert(batchList);
+	Assert(RECEIVER_BATCH <= MAX_PACKET_BATCH);
 }
 
 ReceiverTask::~ReceiverTask()
@@ -106,6 +110,12 @@ ReceiverTask::extractArgs()
  * 	as they are received.  Processing consists of adding the data
  * 	to the incoming channel data, synchronizing the two polarizations
  * 	and buffering the data.
+ * Notes:\n
+ * 	Packets are received in batches of up to RECEIVER_BATCH into a
+ * 	ring of preallocated packets with a single system call, and each
+ * 	batch is passed to the input task as a single message.  As
+ * 	packets are handed off, their slots in the ring are refilled from
+ * 	the free list.
  */
 //
 // routine: receive and process incoming packets
@@ -149,13 +159,25 @@ ReceiverTask::routine()
 	// setup and start a timeout in case we don't get packets
 	startTimeout();
 
+	// preallocate the receive ring
+	ChannelPacket *ring[RECEIVER_BATCH];
+	void *buf[RECEIVER_BATCH];
+	size_t len[RECEIVER_BATCH];
+	for (int32_t i = 0; i < RECEIVER_BATCH; ++i) {
+		ring[i] = pktList->alloc();
+		Assert(ring[i]);
+		buf[i] = (void *) ring[i]->getPacket();
+	}
+	size_t pktSize = ring[0]->getPacketSize();
+
 	// process incoming packets
 	bool done = false;
 	bool first = true;
 	while (!done) {
-		ChannelPacket *pkt = pktList->alloc();
-		Assert(pkt);
-		Error err = udp->recv((void *) pkt->getPacket(), pkt->getPacketSize());
+		int32_t count = RECEIVER_BATCH;
+		for (int32_t i = 0; i < RECEIVER_BATCH; ++i)
+			len[i] = pktSize;
+		Error err = udp->recv(buf, len, count);
 		if (first) {
 			stopTimeout();
 			first = false;
@@ -170,7 +192,8 @@ ReceiverTask::routine()
 			case ETIMEDOUT:
 				// socket has been closed
 				LogError(ERR_DCE, activity->getActivityId(), "");
-				pktList->free(pkt);
+				for (int32_t i = 0; i < RECEIVER_BATCH; ++i)
+					pktList->free(ring[i]);
 				kill();
 				break;
 			default:
@@ -181,19 +204,40 @@ ReceiverTask::routine()
 		// see if we've been terminated
 		lock.lock();
 		if (!testCancel()) {
-			// got a packet; route it
-			pkt->demarshall();
-			Msg *msg = msgList->alloc((DxMessageCode) InputPacket, 0,
-					pkt, sizeof(ChannelPacket), 0, USER);
-			Assert(!inQ->send(msg, 0));
+			// got packets; route them as a single batch.  Short
+			// datagrams are dropped and their buffers reused.
+			ChannelPacketBatch *batch = 0;
+			for (int32_t i = 0; i < count; ++i) {
+				if (len[i] != pktSize)
+					continue;
+				if (!batch) {
+					batch = batchList->alloc();
+					Assert(batch);
+					batch->count = 0;
+				}
+				ChannelPacket *pkt = ring[i];
+				pkt->demarshall();
+				batch->pkt[batch->count++] = pkt;
+				ring[i] = pktList->alloc();
+				Assert(ring[i]);
+				buf[i] = (void *) ring[i]->getPacket();
+			}
+			if (batch) {
+				Msg *msg = msgList->alloc((DxMessageCode) InputPacketBatch, 0,
+						batch, sizeof(ChannelPacketBatch), 0, USER);
+				Assert(!inQ->send(msg, 0));
+			}
 		}
 		else {
 			udp->terminate();
-			pktList->free(pkt);
 			done = true;
 		}
 		lock.unlock();
 	}
+
+	// release the receive ring
+	for (int32_t i = 0; i < RECEIVER_BATCH; ++i)
+		pktList->free(ring[i]);
 	delete udp;
 	return (0);
 }
@@ -41,6 +41,7 @@
 #include <sseDxInterface.h>
 #include "System.h"
 #include "Activity.h"
+#include "ChannelPacketBatchList.h"
 #include "ChannelPacketList.h"
 #include "Msg.h"
 #include "Queue.h"
@@ -119,6 +120,7 @@ private:
 	IpAddress rAddr, lAddr;			// right, left IP addresses
 	Activity *activity;				// ptr to current activity
 	ChannelPacketList *pktList;		// free packet list
+	ChannelPacketBatchList *batchList;	// free packet batch list
 	Lock lock;						// mutex lock
 	Queue *inQ;						// input task queue
 	Udp *udp;						// UDP multicast socket
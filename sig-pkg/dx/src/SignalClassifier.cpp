@@ -81,6 +81,8 @@ SignalClassifier::classifySignals(Activity *act)
 
 	SuperClusterer *superClusterer = act->getSuperClusterer();
 	Assert(superClusterer);
+	// test all the signals against the masks and bad bands at once
+	loadEngine(act, superClusterer);
 	// scan the list of signals
 	for (int32_t i = 0; i < superClusterer->getCount(); i++) {
 		// get the next signal
@@ -91,7 +93,8 @@ SignalClassifier::classifySignals(Activity *act)
 			Debug(DEBUG_NEVER, i, "cw clusterer");
 			CwPowerSignal& signal = cwClusterer->getNth(tag.index);
 			classifySignal(act, signal.sig, superClusterer, i, maxCandidates);
-			signal.sig.containsBadBands = applyBadBands(act, signal.sig);
+			signal.sig.containsBadBands = engine.isInBadBand(i) ? SSE_TRUE
+					: SSE_FALSE;
 			if (signal.sig.sigClass == CLASS_CAND)
 				act->addCwCandidate(&signal, origin);
 			act->addCwSignal(&signal);
@@ -104,7 +107,8 @@ SignalClassifier::classifySignals(Activity *act)
 //			for (int j = 0; j < signal->train.numberOfPulses; ++j)
 //				cout << "pulse " << j << p[j];
 			classifySignal(act, signal->sig, superClusterer, i, maxCandidates);
-			signal->sig.containsBadBands = applyBadBands(act, signal->sig);
+			signal->sig.containsBadBands = engine.isInBadBand(i) ? SSE_TRUE
+					: SSE_FALSE;
 			if (signal->sig.sigClass == CLASS_CAND)
 				act->addPulseCandidate(signal, origin);
 			act->addPulseSignal(signal);
@@ -112,6 +116,61 @@ SignalClassifier::classifySignals(Activity *act)
 		}
 	}
 	act->setCandidatesOverMax(candidatesOverMax);
+	engine.clear();
+}
+
+/**
+ * Load the signals and bad bands of an activity into the engine and
+ * classify them.
+ *
+ * Notes:\n
+ * 	Each mask is given to the engine only if classifySignal will use
+ * 	its result.  The signals are added in super clusterer order, so
+ * 	signal i of the engine is main signal i of the super clusterer.
+ */
+void
+SignalClassifier::loadEngine(Activity *act, SuperClusterer *superClusterer)
+{
+	engine.clear();
+	for (int32_t i = 0; i < superClusterer->getCount(); ++i) {
+		SignalDescription *sig = getSignal(superClusterer, i);
+		Assert(sig);
+		engine.addSignal(sig);
+	}
+	CwBadBandList *cwBadBandList = act->getCwBadBandList();
+	for (int32_t i = 0; i < cwBadBandList->getSize(); ++i)
+		engine.addBadBand(cwBadBandList->getNth(i).band);
+	for (int32_t i = 0; i < MAX_RESOLUTIONS; ++i) {
+		PulseBadBandList *badBandList =
+					act->getPulseBadBandList((Resolution) i);
+		Assert(badBandList);
+		for (int j = 0; j < badBandList->getSize(); ++j)
+			engine.addBadBand(badBandList->getNth(j).band);
+	}
+	FrequencyMask *recentRfiMask = 0;
+	if (act->getMode() == PRIMARY && operations.test(APPLY_RECENT_RFI_MASK))
+		recentRfiMask = recentRfi;
+	FrequencyMask *testSignalMask = 0;
+	if (operations.test(APPLY_TEST_SIGNAL_MASK))
+		testSignalMask = testSignal;
+	engine.classify(recentRfiMask, testSignalMask,
+			act->getDataCollectionTime());
+}
+
+/**
+ * Get the description of the nth main signal of the super clusterer.
+ */
+SignalDescription *
+SignalClassifier::getSignal(SuperClusterer *superClusterer, int32_t sigNum)
+{
+	ClusterTag tag = superClusterer->getNthMainSignal(sigNum);
+	CwClusterer *cwClusterer = tag.holder->getCw();
+	PulseClusterer *pulseClusterer = tag.holder->getPulse();
+	if (cwClusterer)
+		return (&cwClusterer->getNth(tag.index).sig);
+	else if (pulseClusterer)
+		return (&pulseClusterer->getNth(tag.index).sig);
+	return (0);
 }
 
 void
@@ -136,8 +195,7 @@ SignalClassifier::classifySignal(Activity * act, SignalDescription& sig,
 	if (act->getMode() == PRIMARY) {
 		if (operations.test(APPLY_RECENT_RFI_MASK) && recentRfi) {
 			Debug(DEBUG_SIGNAL_CLASS, (void *) recentRfi, "apply mask?");
-			if (recentRfi->isMasked(sig.path.rfFreq,
-					HZ_TO_MHZ(sig.path.width))) {
+			if (engine.isRecentRfi(sigNum)) {
 				sig.sigClass = CLASS_RFI;
 				sig.reason = RECENT_RFI_MATCH;
 				Debug(DEBUG_SIGNAL_CLASS, (void *) recentRfi, "yep");
@@ -166,7 +224,7 @@ SignalClassifier::classifySignal(Activity * act, SignalDescription& sig,
 
 	// test for test signal mask match; this overrides rfi mask
 	if (operations.test(APPLY_TEST_SIGNAL_MASK) && testSignal) {
-		if (testSignal->isMasked(sig.path.rfFreq, HZ_TO_MHZ(sig.path.width))) {
+		if (engine.isTestSignal(sigNum)) {
 			sig.sigClass = CLASS_CAND;
 			sig.reason = TEST_SIGNAL_MATCH;
 		}
@@ -260,10 +318,11 @@ SignalClassifier::displayPulseSignal(PulseSignalHeader& signal)
 bool_t
 SignalClassifier::applyBadBands(Activity *act, SignalDescription& sig)
 {
+	float64_t obsLen = act->getDataCollectionTime();
 	CwBadBandList *cwBadBandList = act->getCwBadBandList();
 	for (int32_t i = 0; i < cwBadBandList->getSize(); ++i) {
 		::CwBadBand badBand = cwBadBandList->getNth(i);
-		if (match(act, sig, badBand.band))
+		if (SignalClassifierEngine::match(sig, badBand.band, obsLen))
 			return (SSE_TRUE);
 	}
 	for (int32_t i = 0; i < MAX_RESOLUTIONS; ++i) {
@@ -272,28 +331,11 @@ SignalClassifier::applyBadBands(Activity *act, SignalDescription& sig)
 		Assert(badBandList);
 		for (int j = 0; j < badBandList->getSize(); ++j) {
 			::PulseBadBand badBand = badBandList->getNth(j);
-			if (match(act, sig, badBand.band))
+			if (SignalClassifierEngine::match(sig, badBand.band, obsLen))
 				return (SSE_TRUE);
 		}
 	}
 	return (SSE_FALSE);
 }
 
-bool
-SignalClassifier::match(Activity *act, SignalDescription& sig,
-		FrequencyBand& band)
-{
-	float64_t sigLo = sig.path.rfFreq - (HZ_TO_MHZ(sig.path.width / 2));
-	float64_t sigHi = sig.path.rfFreq + (HZ_TO_MHZ(sig.path.width / 2));
-	float64_t bandLo = band.centerFreq - band.bandwidth / 2;
-	float64_t bandHi = band.centerFreq + band.bandwidth / 2;
-
-	float64_t obsLen = act->getDataCollectionTime();
-	if (sig.path.drift >= 0)
-		sigHi += HZ_TO_MHZ(sig.path.drift * obsLen);
-	else
-		sigLo -= HZ_TO_MHZ(sig.path.drift * obsLen);
-	return (sigLo < bandHi && sigHi > bandLo);
-}
-
 }
@@ -40,6 +40,7 @@
 #include "Activity.h"
 #include "DxOpsBitset.h"
 #include "Signal.h"
+#include "SignalClassifierEngine.h"
 #include "SuperClusterer.h"
 
 using namespace sonata_lib;
@@ -64,12 +65,15 @@ private:
 	DxOpsBitset operations;
 	RecentRfiMask *recentRfi;
 	TestSignalMask *testSignal;
+	SignalClassifierEngine engine;		// batch mask and bad band tests
 
 	void classifySignal(Activity *act, SignalDescription& sig,
 			SuperClusterer *superClusterer, int32_t sigNum,
 			int32_t maxCandidates);
 	void displayPulseSignal(PulseSignalHeader& signal);
-	static bool match(Activity *act, SignalDescription& sig, FrequencyBand& band);
+	void loadEngine(Activity *act, SuperClusterer *superClusterer);
+	static SignalDescription *getSignal(SuperClusterer *superClusterer,
+			int32_t sigNum);
 
 	// forbidden
 	SignalClassifier(const SignalClassifier&);
@@ -48,6 +48,7 @@
 #include "Partition.h"
 #include "QTask.h"
 #include "Spectra.h"
+#include "SpectrometerEngine.h"
 #include "State.h"
 
 using namespace sonata_lib;
@@ -117,7 +118,9 @@ struct scalar {
  * 	baselined spectra for all requested resolutions.  It also inserts
  * 	simulated signals and outputs science data.\n
  * Notes:\n
- * 	It performs spectrometry for both polarizations.\n
+ * 	It performs spectrometry for both polarizations.  The per-subchannel
+ * 	work is done by the spectrometer engine, which may divide it among
+ * 	several worker tasks.\n
  * 	The spectrometer contains very little state information of its own -
  * 	just a wave table for inserting simulated signals.  Virtually all of
  * 	the relevant data is contained in the channel class.
@@ -144,15 +147,9 @@ private:
 	int32_t halfFrame;
 	int32_t resolutions;			// resolutions being created
 	int32_t spectraHalfFrames;		// # of half frames to pass to Spectra
-	int32_t subchannelPulses;
-	int32_t halfFramePulses;
 	int32_t totalPulses;
 	int32_t baselineReportingRate;
 	int32_t waits;
-	uint32_t cdDataSize;			// size of CD data buffer
-	uint32_t cwDataSize;			// size of CW DADD buffer
-	ComplexPair *cdData;			// temp buffer for converted CD data
-	uint64_t *cwData;				// temp buffer for CW power data
 	Activity *activity;				// current activity
 	Channel *channel;
 	BaselineLimits blLimits;		// baseline limits
@@ -160,25 +157,7 @@ private:
 	Condition condition;
 	ObsData obs;					// observation parameters
 	ResInfo resInfo[MAX_RESOLUTIONS];
-	struct s {
-		int32_t spectrum[MAX_RESOLUTIONS];
-		ComplexFloat32 *buf[MAX_RESOLUTIONS];
-
-		s() {
-			for (int32_t i = 0; i < MAX_RESOLUTIONS; ++i) {
-				spectrum[i] = 0;
-				buf[i] = 0;
-			}
-		}
-		void init() {
-			for (int32_t i = 0; i < MAX_RESOLUTIONS; ++i) {
-				spectrum[i] = 0;
-				if (buf[i])
-					fftwf_free(buf[i]);
-				buf[i] = 0;
-			}
-		}
-	} resSpectra;
+	int32_t spectrum[MAX_RESOLUTIONS];	// next spectrum, by res index
 #ifdef notdef
 	struct s {
 		struct _s {
@@ -201,7 +180,7 @@ private:
 		}
 	} resSpectra;
 #endif
-	spectra::Spectra spectra;		// spectra library
+	SpectrometerEngine *engine;		// subchannel processing
 	HfBufList hfBufs;
 
 	MsgList *msgList;
@@ -209,33 +188,8 @@ private:
 	Queue *respQ;
 	State *state;
 
-	void setupSpectra();
-
-	void doPolarization(Polarization pol, int32_t hf);
-	void processSubchannel(Polarization pol, int32_t subchannel, int32_t hf);
-
-	// confirmation data functions
-	void zeroCdData();
-	void loadCdPattern(Polarization pol, int32_t subchannel, int32_t hf);
-	void computeCdData(ComplexFloat32 *);
-	void storeCdData(Polarization pol, int32_t subchannel, int32_t hf);
-
-	// CW data methods
-	void zeroCwData();
-	void loadCwPattern(Polarization pol, Resolution res, int32_t subchannel,
-			int32_t spectrum);
-	void computeCwData(Resolution res, const ComplexFloat32 *data);
-	void storeCwData(Polarization pol, Resolution res, int32_t subchannel,
-			int32_t spectrum);
-//	void moveCwData(complexFloat32 *,  complexFloat32 *, int, Resolution );
-
-	// baseline functions
-	void computeBaseline(Polarization pol, int32_t subchannel,
-			ComplexFloat32 *hfData, float32_t weighting);
-
-	// pulse data functions
-	void storePulseData(Polarization pol, Resolution res, int32_t subchannel,
-			int32_t spectrum, float32_t threshold, const ComplexFloat32 *data);
+	void setupEngine();
+	void setupHalfFrame(SpecHalfFrame& frame, int32_t hf);
 
 	// science data functions
 	void sendBlData(const float32_t *data);
@@ -0,0 +1,316 @@
+/*******************************************************************************
+
+ File:    TestCwClusterer.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for CW hit clustering
+//
+// The clusters are checked against the original computation, which
+// inserted each hit into a multimap keyed by mid-bin and swept the map
+// in order.  Hits are recorded from a single thread, including hits
+// with equal mid-bins and equal powers, and from several threads at
+// once, with distinct powers so that the result does not depend on the
+// order in which the threads recorded.
+//
+#include <map>
+#include <pthread.h>
+#include <stdlib.h>
+#include <vector>
+#include "TestRunner.h"
+#include "TestCwClusterer.h"
+#include "CwClusterer.h"
+#include "SuperClusterer.h"
+
+using namespace dx;
+using std::multimap;
+using std::vector;
+
+namespace {
+
+const int32_t HITS = 20000;
+const int32_t BINS = 100000;
+const int32_t MAX_DRIFT = 64;
+const int32_t MAX_POWER = 1000;
+const int32_t CLUSTER_RANGE = 3;
+const int32_t THREADS = 4;
+const int32_t SEED = 1;
+const float64_t BASE_FREQ = 1420.0;
+const int32_t SPECTRA = 512;
+const float64_t BIN_WIDTH = 0.7;
+
+struct Hit
+{
+	int32_t startBin, drift, power;
+
+	Hit(): startBin(0), drift(0), power(0) {}
+	Hit(int32_t startBin_, int32_t drift_, int32_t power_):
+			startBin(startBin_), drift(drift_), power(power_) {}
+};
+
+/**
+ * Original cluster, as the strongest hit and the mid-bin extent.
+ */
+struct Cluster
+{
+	Hit hit;
+	float loBin, hiBin;
+};
+
+/**
+ * Create a set of hits.  The hits are grouped around a number of
+ * signals, so that many clusters contain several hits; drifts may be
+ * negative.  If unique is set, every hit has a different power.
+ */
+void
+createHits(vector<Hit>& hits, int32_t n, bool unique, int32_t seed)
+{
+	srand(seed);
+	hits.clear();
+	int32_t bin = 0;
+	for (int32_t i = 0; i < n; ++i) {
+		if (rand() % 8 == 0)
+			bin = rand() % BINS - MAX_DRIFT;
+		int32_t startBin = bin + rand() % (2 * CLUSTER_RANGE);
+		int32_t drift = rand() % (2 * MAX_DRIFT + 1) - MAX_DRIFT;
+		int32_t power = unique ? i : rand() % MAX_POWER;
+		hits.push_back(Hit(startBin, drift, power));
+	}
+	// shuffle, so that hits do not arrive in order
+	for (int32_t i = n - 1; i > 0; --i) {
+		int32_t j = rand() % (i + 1);
+		Hit t = hits[i];
+		hits[i] = hits[j];
+		hits[j] = t;
+	}
+}
+
+/**
+ * Cluster the hits as before.
+ */
+void
+clusterHits(const vector<Hit>& hits, vector<Cluster>& clusters)
+{
+	multimap<float,Hit> hitMap;
+	for (uint32_t i = 0; i < hits.size(); ++i) {
+		float midBin = hits[i].startBin + (hits[i].drift + 0.5)/2;
+		hitMap.insert(std::pair<float,Hit>(midBin, hits[i]));
+	}
+	clusters.clear();
+	multimap<float,Hit>::iterator i;
+	for (i = hitMap.begin(); i != hitMap.end(); ++i) {
+		if (clusters.empty()
+				|| i->first > clusters.back().hiBin + CLUSTER_RANGE) {
+			Cluster c;
+			c.hit = i->second;
+			c.loBin = c.hiBin = i->first;
+			clusters.push_back(c);
+		}
+		else {
+			Cluster& c = clusters.back();
+			c.hiBin = i->first;
+			if (i->second.power > c.hit.power)
+				c.hit = i->second;
+		}
+	}
+}
+
+/**
+ * Check the clusters found against the original clusters.
+ */
+bool
+checkClusters(CwClusterer& cw, const vector<Hit>& hits)
+{
+	vector<Cluster> clusters;
+	clusterHits(hits, clusters);
+	if (cw.getCount() != (int) clusters.size())
+		return (false);
+	for (uint32_t i = 0; i < clusters.size(); ++i) {
+		const Cluster& c = clusters[i];
+		const CwPowerSignal& sig = cw.getNth(i);
+		float32_t drift = cw.binsToRelativeHz(c.hit.drift)
+				/ cw.getSecondsPerObs();
+		float32_t width = cw.binsToRelativeHz((int) (1 + c.hiBin - c.loBin));
+		if (sig.sig.path.rfFreq != cw.binsToAbsoluteMHz(c.hit.startBin)
+				|| sig.sig.path.drift != drift
+				|| sig.sig.path.width != width
+				|| sig.sig.path.power != c.hit.power)
+			return (false);
+	}
+	return (true);
+}
+
+void
+recordHits(CwClusterer& cw, const vector<Hit>& hits, int32_t first,
+		int32_t stride)
+{
+	for (uint32_t i = first; i < hits.size(); i += stride)
+		cw.recordHit(hits[i].startBin, hits[i].drift, hits[i].power);
+}
+
+struct ThreadArgs
+{
+	CwClusterer *cw;
+	const vector<Hit> *hits;
+	int32_t first;
+};
+
+void *
+recordThread(void *arg)
+{
+	ThreadArgs *args = static_cast<ThreadArgs *> (arg);
+	recordHits(*args->cw, *args->hits, args->first, THREADS);
+	return (0);
+}
+
+}
+
+TestCwClusterer::TestCwClusterer(std::string name):
+		TestCase(name)
+{
+}
+
+void
+TestCwClusterer::setUp()
+{
+}
+
+void
+TestCwClusterer::tearDown()
+{
+}
+
+/**
+ * Hits recorded by a single thread.
+ */
+void
+TestCwClusterer::testClusters()
+{
+	SuperClusterer super;
+	CwClusterer cw(&super, POL_RIGHTCIRCULAR);
+	cw.setObsParams(BASE_FREQ, SPECTRA, BIN_WIDTH);
+	cw.setClusterRange(CLUSTER_RANGE);
+
+	vector<Hit> hits;
+	createHits(hits, HITS, false, SEED);
+	// a run of hits with the same mid-bin and power
+	for (int32_t i = 0; i < 8; ++i)
+		hits.push_back(Hit(BINS / 2, i & 1 ? 2 : -2, MAX_POWER));
+	recordHits(cw, hits, 0, 1);
+	cu_assert(cw.getHits() == (int) hits.size());
+	cw.allHitsLoaded();
+	cu_assert(cw.isComplete());
+	cu_assert(cw.getHits() == (int) hits.size());
+	cu_assert(checkClusters(cw, hits));
+}
+
+/**
+ * Hits recorded by several threads at once, into two clusterers.
+ */
+void
+TestCwClusterer::testThreads()
+{
+	SuperClusterer super;
+	CwClusterer right(&super, POL_RIGHTCIRCULAR);
+	CwClusterer left(&super, POL_LEFTCIRCULAR);
+	right.setClusterRange(CLUSTER_RANGE);
+	left.setClusterRange(CLUSTER_RANGE);
+
+	vector<Hit> hits;
+	createHits(hits, HITS, true, SEED + 1);
+	pthread_t tid[2 * THREADS];
+	ThreadArgs args[2 * THREADS];
+	for (int32_t i = 0; i < 2 * THREADS; ++i) {
+		args[i].cw = i < THREADS ? &right : &left;
+		args[i].hits = &hits;
+		args[i].first = i % THREADS;
+		pthread_create(&tid[i], 0, recordThread, &args[i]);
+	}
+	for (int32_t i = 0; i < 2 * THREADS; ++i)
+		pthread_join(tid[i], 0);
+	// and some from this thread
+	vector<Hit> more;
+	createHits(more, HITS / 10, true, SEED + 2);
+	for (uint32_t i = 0; i < more.size(); ++i)
+		more[i].power += HITS;
+	recordHits(right, more, 0, 1);
+	hits.insert(hits.end(), more.begin(), more.end());
+
+	right.allHitsLoaded();
+	left.allHitsLoaded();
+	cu_assert(checkClusters(right, hits));
+	hits.resize(HITS);
+	cu_assert(checkClusters(left, hits));
+}
+
+/**
+ * Clusterers reused after their hits have been cleared.
+ */
+void
+TestCwClusterer::testClear()
+{
+	SuperClusterer super;
+	CwClusterer cw(&super, POL_RIGHTCIRCULAR);
+	cw.setClusterRange(CLUSTER_RANGE);
+
+	for (int32_t pass = 0; pass < 3; ++pass) {
+		vector<Hit> hits;
+		createHits(hits, pass * HITS / 4, false, SEED + pass);
+		recordHits(cw, hits, 0, 1);
+		cw.allHitsLoaded();
+		cu_assert(checkClusters(cw, hits));
+		cw.clearHits();
+		cu_assert(!cw.isComplete());
+		cu_assert(cw.getHits() == 0);
+	}
+	// a new clusterer must not receive hits cached for the old one
+	CwClusterer *other = new CwClusterer(&super, POL_LEFTCIRCULAR);
+	other->recordHit(0, 0, 1);
+	delete other;
+	CwClusterer next(&super, POL_LEFTCIRCULAR);
+	cu_assert(next.getHits() == 0);
+	next.recordHit(0, 0, 1);
+	cu_assert(next.getHits() == 1);
+}
+
+Test *
+TestCwClusterer::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestCwClusterer");
+
+	testSuite->addTest(new TestCaller<TestCwClusterer>(
+			"testClusters",
+			&TestCwClusterer::testClusters));
+	testSuite->addTest(new TestCaller<TestCwClusterer>(
+			"testThreads",
+			&TestCwClusterer::testThreads));
+	testSuite->addTest(new TestCaller<TestCwClusterer>(
+			"testClear",
+			&TestCwClusterer::testClear));
+	return (testSuite);
+}
@@ -0,0 +1,246 @@
+/*******************************************************************************
+
+ File:    TestCwCoherentEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the CW coherent search engine
+//
+// The signal is a drifting CW signal in Gaussian noise, sampled at the
+// width of the coherent channel.  The engine must find its frequency
+// and drift, and must report the same drift and significance as the
+// original serial search for any number of workers.
+//
+#include <fftw3.h>
+#include <string.h>
+#include <vector>
+#include "TestRunner.h"
+#include "TestCwCoherentEngine.h"
+#include "CwCoherentEngine.h"
+#include "DedriftKernel.h"
+#include "Gaussian.h"
+#include "Statistics.h"
+
+using namespace dx;
+using std::vector;
+
+namespace {
+
+const int32_t SEED = 1;
+const int32_t SAMPLES = 256;
+// power of the signal in a microbin, relative to the noise
+const float64_t SNR = 20;
+// microbins from the center of the channel, and microbins of drift
+const float64_t FREQ = 10.3;
+const int32_t DRIFT = 21;
+
+/**
+ * Create the time samples of a CW signal.  With a sample rate of
+ * samples Hz a microbin is 1 Hz and the signal lasts 1 second, so
+ * a drift of drift microbins is drift Hz/s.  If snr is zero there
+ * is only noise.
+ */
+void
+createSignal(vector<ComplexFloat32>& td, int32_t samples, float64_t freq,
+		float64_t drift, float64_t snr, int32_t seed)
+{
+	gauss::Gaussian gen;
+	gen.setup(seed, samples / 1e6, 1.0);
+	if (snr)
+		gen.addCwSignal(freq / 1e6, drift, snr);
+	td.resize(samples);
+	gen.getSamples(&td[0], samples);
+}
+
+/**
+ * Original serial search.  The samples are dedrifted with the extended
+ * precision kernel, since the single precision phase recurrence of the
+ * original dedrift has errors of up to 1e-3.
+ */
+CoherentReport
+searchSerial(const ComplexFloat32 *td, int32_t samples)
+{
+	size_t len = samples * sizeof(ComplexFloat32);
+	ComplexFloat32 *dd = static_cast<ComplexFloat32 *> (fftwf_malloc(len));
+	ComplexFloat32 *fd = static_cast<ComplexFloat32 *> (fftwf_malloc(len));
+	fftwf_plan plan = fftwf_plan_dft_1d(samples, (fftwf_complex *) dd,
+			(fftwf_complex *) fd, FFTW_FORWARD, FFTW_ESTIMATE);
+
+	const DedriftKernel *dedriftKernel = getDedriftKernel(ScalarDedriftKernel);
+	int32_t middle = samples / 2;
+	float32_t factor = 1 / sqrt(samples);
+	vector<ComplexFloat32> temp(middle);
+	CoherentReport best;
+	for (int32_t drift = -(samples - 1); drift <= samples - 1; drift++) {
+		dedriftKernel->dedrift(dd, td, samples, 0,
+				-M_PI * drift / ((float64_t) samples * samples));
+		fftwf_execute_dft(plan, (fftwf_complex *) dd, (fftwf_complex *) fd);
+		for (int32_t i = 0; i < samples; ++i)
+			fd[i] *= factor;
+		memcpy(&temp[0], &fd[0], len / 2);
+		memcpy(&fd[0], &fd[middle], len / 2);
+		memcpy(&fd[middle], &temp[0], len / 2);
+		ChiReport chi = CwCoherentEngine::checkCoherence(fd, 1.0, samples,
+				drift, samples / 2, samples);
+		if (chi.chiSq < best.chi.chiSq) {
+			best.chi = chi;
+			best.microDrift = drift;
+		}
+	}
+	best.chi.chiSq = ChiSquare(2 * best.chi.clusterWidth,
+			2 * best.chi.power);
+	best.signif = best.chi.chiSq;
+
+	fftwf_destroy_plan(plan);
+	fftwf_free(fd);
+	fftwf_free(dd);
+	return (best);
+}
+
+bool
+sameReport(const CoherentReport& r0, const CoherentReport& r1)
+{
+	return (r0.microDrift == r1.microDrift && r0.signif == r1.signif
+			&& r0.chi.bins == r1.chi.bins && r0.chi.power == r1.chi.power
+			&& r0.chi.chiSq == r1.chi.chiSq
+			&& r0.chi.clusterWidth == r1.chi.clusterWidth
+			&& r0.chi.clusterIndex == r1.chi.clusterIndex);
+}
+
+}
+
+TestCwCoherentEngine::TestCwCoherentEngine(std::string name):
+		TestCase(name)
+{
+}
+
+void
+TestCwCoherentEngine::setUp()
+{
+}
+
+void
+TestCwCoherentEngine::tearDown()
+{
+}
+
+/**
+ * The signal is found at its frequency and drift.
+ */
+void
+TestCwCoherentEngine::testSignal()
+{
+	vector<ComplexFloat32> td;
+	createSignal(td, SAMPLES, FREQ, DRIFT, SNR, SEED);
+
+	CwCoherentEngine engine(1, CWD_CONFIRMATION_PRIO, false);
+	engine.setup(SAMPLES);
+	CoherentReport report = engine.search(&td[0]);
+	cu_assert(abs(report.microDrift - DRIFT) <= 1);
+	cu_assert(abs(report.chi.clusterIndex - FREQ) <= report.chi.clusterWidth);
+	cu_assert(report.chi.bins == SAMPLES);
+	cu_assert(report.signif < 0);
+
+	// the original search finds the same description
+	CoherentReport serial = searchSerial(&td[0], SAMPLES);
+	cu_assert(report.microDrift == serial.microDrift);
+	cu_assert(report.chi.clusterWidth == serial.chi.clusterWidth);
+	cu_assert(report.chi.clusterIndex == serial.chi.clusterIndex);
+	cu_assert(fabs(report.chi.power - serial.chi.power)
+			<= 1e-4 * serial.chi.power);
+	cu_assert(fabs(report.signif - serial.signif) <= 1e-4 * -serial.signif);
+}
+
+/**
+ * The report is identical for any number of workers, for signals and
+ * for noise alone.
+ */
+void
+TestCwCoherentEngine::testWorkers()
+{
+	const int32_t workers[] = { 2, 3, 4 };
+	const float64_t drift[] = { DRIFT, -DRIFT, 0 };
+	const float64_t snr[] = { SNR, SNR, 0 };
+
+	CwCoherentEngine engine(1, CWD_CONFIRMATION_PRIO, false);
+	engine.setup(SAMPLES);
+	for (uint32_t w = 0; w < sizeof(workers) / sizeof(workers[0]); ++w) {
+		CwCoherentEngine parallel(workers[w], CWD_CONFIRMATION_PRIO, false);
+		cu_assert(parallel.getWorkers() == workers[w]);
+		parallel.setup(SAMPLES);
+		for (uint32_t d = 0; d < sizeof(drift) / sizeof(drift[0]); ++d) {
+			vector<ComplexFloat32> td;
+			createSignal(td, SAMPLES, FREQ, drift[d], snr[d], SEED + d);
+			CoherentReport r0 = engine.search(&td[0]);
+			CoherentReport r1 = parallel.search(&td[0]);
+			cu_assert(sameReport(r0, r1));
+		}
+	}
+}
+
+/**
+ * Changing the number of samples rebuilds the plans; searches with the
+ * rebuilt plans give the same reports as a new engine.
+ */
+void
+TestCwCoherentEngine::testSetup()
+{
+	const int32_t samples[] = { SAMPLES, SAMPLES / 2, SAMPLES * 2, SAMPLES };
+
+	CwCoherentEngine engine(2, CWD_CONFIRMATION_PRIO, false);
+	for (uint32_t i = 0; i < sizeof(samples) / sizeof(samples[0]); ++i) {
+		vector<ComplexFloat32> td;
+		createSignal(td, samples[i], FREQ, DRIFT, SNR, SEED);
+		engine.setup(samples[i]);
+		cu_assert(engine.getSamples() == samples[i]);
+		CoherentReport r0 = engine.search(&td[0]);
+		cu_assert(r0.chi.bins == samples[i]);
+
+		CwCoherentEngine fresh(1, CWD_CONFIRMATION_PRIO, false);
+		fresh.setup(samples[i]);
+		CoherentReport r1 = fresh.search(&td[0]);
+		cu_assert(sameReport(r0, r1));
+	}
+}
+
+Test *
+TestCwCoherentEngine::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestCwCoherentEngine");
+
+	testSuite->addTest(new TestCaller<TestCwCoherentEngine>(
+			"testSignal",
+			&TestCwCoherentEngine::testSignal));
+	testSuite->addTest(new TestCaller<TestCwCoherentEngine>(
+			"testWorkers",
+			&TestCwCoherentEngine::testWorkers));
+	testSuite->addTest(new TestCaller<TestCwCoherentEngine>(
+			"testSetup",
+			&TestCwCoherentEngine::testSetup));
+	return (testSuite);
+}
@@ -0,0 +1,378 @@
+/*******************************************************************************
+
+ File:    TestCwDaddEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the CW DADD engine
+//
+// Each test runs the same packed CW data (random bins plus a few
+// drifting signals) through a serial engine and engines with several
+// workers and slices, and checks that the hits and bad bands are
+// identical.  A plane full of RFI checks that the paths stored by the
+// engine stay bounded.
+//
+#include <fftw3.h>
+#include <stdlib.h>
+#include <string.h>
+#include "TestRunner.h"
+#include "TestCwDaddEngine.h"
+#include "Args.h"
+#include "CwDaddEngine.h"
+
+using namespace dx;
+using std::vector;
+
+namespace {
+
+const int32_t SPECTRA = 64;
+const int32_t SPECTRUM_BINS = 2048;
+const int32_t TOTAL_BINS = SPECTRUM_BINS + SPECTRA;
+const int32_t BAND_BINS = 256;
+const int32_t SEED = 1;
+
+/**
+ * Output of a detection.
+ */
+struct DaddOutput {
+	vector<DaddPath> hits;
+	vector<DaddBand> bands;
+};
+
+class HitList: public ReportHit {
+public:
+	HitList(vector<DaddPath> *hits_): hits(hits_) {}
+	virtual void report(const DaddPath& path) { hits->push_back(path); }
+
+private:
+	vector<DaddPath> *hits;
+};
+
+class BandList: public ReportBadBand {
+public:
+	BandList(vector<DaddBand> *bands_): bands(bands_) {}
+	virtual void report(const DaddBand& band) { bands->push_back(band); }
+
+private:
+	vector<DaddBand> *bands;
+};
+
+/**
+ * Create the packed data for a polarization.
+ *
+ * Description:\n
+ * 	Fills the data with random 2-bit bins, then adds full power
+ * 	signals with positive and negative drifts, including signals which
+ * 	start at the edges of the spectrum.
+ */
+void
+createData(vector<uint8_t>& data, int32_t seed)
+{
+	int32_t bytesPerSpectrum = SPECTRUM_BINS / CWD_BINS_PER_BYTE;
+	data.resize(SPECTRA * bytesPerSpectrum);
+	srand(seed);
+	for (uint32_t i = 0; i < data.size(); ++i)
+		data[i] = (uint8_t) (rand() & 0xff);
+
+	const int32_t signals[][2] = {
+		{ 100, 0 }, { 300, 17 }, { 700, -23 }, { 1030, SPECTRA - 1 },
+		{ 1500, -(SPECTRA - 1) }, { 2, 40 }, { SPECTRUM_BINS - 3, -40 },
+		{ SPECTRUM_BINS - SPECTRA, SPECTRA - 1 }
+	};
+	int32_t n = sizeof(signals) / sizeof(signals[0]);
+	for (int32_t i = 0; i < n; ++i) {
+		for (int32_t j = 0; j < SPECTRA; ++j) {
+			int32_t bin = signals[i][0] + (signals[i][1] * j) / (SPECTRA - 1);
+			if (bin < 0 || bin >= SPECTRUM_BINS)
+				continue;
+			uint8_t& b = data[j*bytesPerSpectrum+bin/CWD_BINS_PER_BYTE];
+			b |= 3 << (2 * (bin % CWD_BINS_PER_BYTE));
+		}
+	}
+}
+
+CwDaddParams
+createParams(int32_t threshold, int32_t badBandLimit, int32_t slices)
+{
+	CwDaddParams params;
+	params.spectra = SPECTRA;
+	params.spectrumBins = SPECTRUM_BINS;
+	params.totalBins = TOTAL_BINS;
+	params.threshold = threshold;
+	params.bandBins = BAND_BINS;
+	params.badBandLimit = badBandLimit;
+	params.slices = slices;
+	return (params);
+}
+
+/**
+ * Run the engine on both polarizations.
+ *
+ * @return	the number of paths stored by the items.
+ */
+size_t
+runEngine(int32_t workers, const CwDaddParams& params,
+		vector<uint8_t> *data, DaddOutput *out)
+{
+	CwDaddEngine engine(workers, CWD_PRIO, false);
+	engine.setup(params);
+
+	HitList rightHit(&out[0].hits), leftHit(&out[1].hits);
+	BandList rightBand(&out[0].bands), leftBand(&out[1].bands);
+	CwDaddPol pols[POLARIZATIONS];
+	pols[0] = CwDaddPol(POL_RIGHTCIRCULAR, &data[0][0], &rightHit,
+			&rightBand);
+	pols[1] = CwDaddPol(POL_LEFTCIRCULAR, &data[1][0], &leftHit,
+			&leftBand);
+	engine.detect(pols, POLARIZATIONS);
+	return (engine.getStoredPaths());
+}
+
+/**
+ * Run a single DADD on the entire spectrum, the way the CW detection
+ * task originally did, but with the overlap bins zeroed.
+ */
+void
+runDadd(const CwDaddParams& params, vector<uint8_t> *data, DaddOutput *out)
+{
+	size_t size = (SPECTRA * TOTAL_BINS + VECTOR_LEN) * sizeof(DaddAccum);
+	DaddAccum *buf = static_cast<DaddAccum *> (fftwf_malloc(size));
+	CwUnpacker unpacker;
+	Dadd dadd;
+	dadd.setup(SPECTRA, SPECTRUM_BINS, TOTAL_BINS, params.threshold,
+			BAND_BINS, params.badBandLimit);
+	Polarization pol[POLARIZATIONS] = { POL_RIGHTCIRCULAR, POL_LEFTCIRCULAR };
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		HitList hitList(&out[p].hits);
+		BandList bandList(&out[p].bands);
+		dadd.reset();
+		memset(buf, 0, size);
+		unpacker.unpack(Positive, &data[p][0], buf, 0, 0, SPECTRA,
+				SPECTRUM_BINS, SPECTRUM_BINS, TOTAL_BINS);
+		dadd.execute(pol[p], Positive, buf, &hitList);
+		memset(buf, 0, size);
+		unpacker.unpack(Negative, &data[p][0], buf, 0, TOTAL_BINS, SPECTRA,
+				SPECTRUM_BINS, SPECTRUM_BINS, TOTAL_BINS);
+		dadd.execute(pol[p], Negative, buf, &hitList);
+		dadd.reportBadBands(&bandList);
+	}
+	fftwf_free(buf);
+}
+
+bool
+samePath(const DaddPath& a, const DaddPath& b)
+{
+	return (a.pol == b.pol && a.bin == b.bin && a.drift == b.drift
+			&& a.power == b.power);
+}
+
+bool
+sameOutput(const DaddOutput *a, const DaddOutput *b)
+{
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		if (a[p].hits.size() != b[p].hits.size()
+				|| a[p].bands.size() != b[p].bands.size())
+			return (false);
+		for (uint32_t i = 0; i < a[p].hits.size(); ++i) {
+			if (!samePath(a[p].hits[i], b[p].hits[i]))
+				return (false);
+		}
+		for (uint32_t i = 0; i < a[p].bands.size(); ++i) {
+			const DaddBand& x = a[p].bands[i];
+			const DaddBand& y = b[p].bands[i];
+			if (x.bin != y.bin || x.hits != y.hits
+					|| !samePath(x.maxPath, y.maxPath))
+				return (false);
+		}
+	}
+	return (true);
+}
+
+/**
+ * Check that a signal was detected at its starting bin and drift.
+ */
+bool
+findHit(const DaddOutput& out, int32_t bin, int32_t drift)
+{
+	for (uint32_t i = 0; i < out.hits.size(); ++i) {
+		if (out.hits[i].bin == bin && out.hits[i].drift == drift)
+			return (true);
+	}
+	return (false);
+}
+
+}
+
+TestCwDaddEngine::TestCwDaddEngine(std::string name): TestCase(name)
+{
+}
+
+void
+TestCwDaddEngine::setUp()
+{
+	// the unpacker requires the command line arguments
+	static char name[] = "testUnitDx";
+	static char *argv[] = { name, 0 };
+	Args::getInstance(1, argv);
+}
+
+void
+TestCwDaddEngine::tearDown()
+{
+}
+
+/**
+ * A single-slice engine must produce the same output as a DADD of the
+ * entire spectrum.
+ */
+void
+TestCwDaddEngine::testSerialDadd()
+{
+	vector<uint8_t> data[POLARIZATIONS];
+	for (int32_t p = 0; p < POLARIZATIONS; ++p)
+		createData(data[p], SEED + p);
+
+	// threshold well above the noise
+	CwDaddParams params = createParams(SPECTRA * 5 / 2, 100000, 1);
+	DaddOutput engine[POLARIZATIONS], dadd[POLARIZATIONS];
+	runEngine(1, params, data, engine);
+	runDadd(params, data, dadd);
+
+	// the zero and maximum drift signals are found exactly
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		cu_assert(findHit(engine[p], 100, 0));
+		cu_assert(findHit(engine[p], 1030, SPECTRA - 1));
+		cu_assert(findHit(engine[p], 1500, -(SPECTRA - 1)));
+		cu_assert(findHit(engine[p], SPECTRUM_BINS - SPECTRA, SPECTRA - 1));
+	}
+	cu_assert(sameOutput(engine, dadd));
+}
+
+/**
+ * Engines with several workers and slices must produce exactly the same
+ * output as a serial engine.
+ */
+void
+TestCwDaddEngine::testSerialParallel()
+{
+	vector<uint8_t> data[POLARIZATIONS];
+	for (int32_t p = 0; p < POLARIZATIONS; ++p)
+		createData(data[p], SEED + p);
+
+	// threshold low enough to produce many noise hits
+	CwDaddParams params = createParams(SPECTRA * 2, 100000, 1);
+	DaddOutput serial[POLARIZATIONS];
+	runEngine(1, params, data, serial);
+	cu_assert(serial[0].hits.size() > 100);
+
+	const int32_t config[][2] = { { 1, 5 }, { 2, 2 }, { 4, 4 }, { 3, 7 } };
+	for (uint32_t i = 0; i < sizeof(config) / sizeof(config[0]); ++i) {
+		DaddOutput parallel[POLARIZATIONS];
+		params.slices = config[i][1];
+		runEngine(config[i][0], params, data, parallel);
+		cu_assert(sameOutput(serial, parallel));
+	}
+}
+
+/**
+ * Bad bands must be independent of the number of workers and slices.
+ */
+void
+TestCwDaddEngine::testBadBands()
+{
+	vector<uint8_t> data[POLARIZATIONS];
+	for (int32_t p = 0; p < POLARIZATIONS; ++p)
+		createData(data[p], SEED + p);
+
+	CwDaddParams params = createParams(SPECTRA * 2, 20, 1);
+	DaddOutput serial[POLARIZATIONS], dadd[POLARIZATIONS];
+	runEngine(1, params, data, serial);
+	runDadd(params, data, dadd);
+	cu_assert(serial[0].bands.size() > 0);
+	cu_assert(sameOutput(serial, dadd));
+
+	DaddOutput parallel[POLARIZATIONS];
+	params.slices = 6;
+	runEngine(4, params, data, parallel);
+	cu_assert(sameOutput(serial, parallel));
+}
+
+/**
+ * A plane full of RFI must produce the same output as a DADD of the
+ * entire spectrum, while each item stores at most badBandLimit + 1
+ * paths per band, plus the overflow of the band.
+ */
+void
+TestCwDaddEngine::testSaturated()
+{
+	vector<uint8_t> data[POLARIZATIONS];
+	for (int32_t p = 0; p < POLARIZATIONS; ++p)
+		data[p].assign(SPECTRA * SPECTRUM_BINS / CWD_BINS_PER_BYTE, 0xff);
+
+	const int32_t limit = 20;
+	CwDaddParams params = createParams(SPECTRA * 2, limit, 4);
+	DaddOutput engine[POLARIZATIONS], dadd[POLARIZATIONS];
+	size_t stored = runEngine(2, params, data, engine);
+	runDadd(params, data, dadd);
+	cu_assert(sameOutput(engine, dadd));
+
+	// every band is bad, and holds far more hits than are stored
+	int32_t bands = (TOTAL_BINS + BAND_BINS - 1) / BAND_BINS;
+	int32_t hits = 0;
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		cu_assert((int32_t) engine[p].bands.size() == bands);
+		for (uint32_t i = 0; i < engine[p].bands.size(); ++i)
+			hits += engine[p].bands[i].hits;
+	}
+	CwDaddEngine e(1, CWD_PRIO, false);
+	e.setup(params);
+	int32_t items = POLARIZATIONS * 2 * e.getSlices();
+	int32_t itemBands = e.getSliceWidth() / BAND_BINS + 2;
+	cu_assert(stored <= (size_t) items * itemBands * (limit + 2));
+	cu_assert((size_t) hits > 10 * stored);
+}
+
+Test *
+TestCwDaddEngine::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestCwDaddEngine");
+
+	testSuite->addTest(new TestCaller<TestCwDaddEngine>(
+			"testSerialDadd",
+			&TestCwDaddEngine::testSerialDadd));
+	testSuite->addTest(new TestCaller<TestCwDaddEngine>(
+			"testSerialParallel",
+			&TestCwDaddEngine::testSerialParallel));
+	testSuite->addTest(new TestCaller<TestCwDaddEngine>(
+			"testBadBands",
+			&TestCwDaddEngine::testBadBands));
+	testSuite->addTest(new TestCaller<TestCwDaddEngine>(
+			"testSaturated",
+			&TestCwDaddEngine::testSaturated));
+	return (testSuite);
+}
@@ -0,0 +1,209 @@
+/*******************************************************************************
+
+ File:    TestCwKernel.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the CW power kernels
+//
+// The scalar kernels are checked against the original bin-at-a-time
+// computation, then each kernel supported by the processor is checked
+// word for word against the scalar kernels, for unaligned data and for
+// powers at and around the quantization thresholds.
+//
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "TestRunner.h"
+#include "TestCwKernel.h"
+#include "CwKernel.h"
+
+// the reference computation must round like the kernels
+#pragma GCC optimize ("fp-contract=off")
+
+using namespace dx;
+using std::vector;
+
+namespace {
+
+const int32_t WORDS = 64;
+const int32_t MAX_OFFSET = 3;
+const int32_t SEED = 1;
+const uint64_t GUARD = 0xdeadbeefdeadbeefULL;
+
+/**
+ * Create the spectrum data, including a bin before and after the
+ * packed bins for the Hanning window.  Most bins have powers close
+ * to the thresholds.
+ */
+void
+createData(vector<ComplexFloat32>& data, int32_t n, int32_t seed)
+{
+	srand(seed);
+	data.resize(n);
+	for (int32_t i = 0; i < n; ++i) {
+		float64_t phase = 2 * M_PI * rand() / RAND_MAX;
+		float64_t power = rand() % 5 + (rand() % 3 - 1) * 1e-6
+				+ (rand() % 4 ? 0 : (float64_t) rand() / RAND_MAX);
+		if (power < 0)
+			power = 0;
+		data[i] = ComplexFloat32(sqrt(power) * cos(phase),
+				sqrt(power) * sin(phase));
+	}
+	// exact thresholds and out of range values
+	data[1] = ComplexFloat32(1, 0);
+	data[2] = ComplexFloat32(1, 1);
+	data[3] = ComplexFloat32(0, 0);
+	data[4] = ComplexFloat32(-1e10, 1e10);
+}
+
+/**
+ * Original CW computation of a single word, except that powers too large
+ * to convert to an integer are limited directly.
+ */
+uint64_t
+reference(const ComplexFloat32 *d, bool hanning)
+{
+	float32_t hanningScale = sqrt(8.0 / 3.0) / 2;
+	uint64_t val = 0;
+	for (int32_t j = 0; j < CW_BINS_PER_WORD; ++j) {
+		ComplexFloat32 bin = d[j];
+		if (hanning) {
+			ComplexFloat32 adj = d[j-1] + d[j+1];
+			adj *= .5;
+			bin += adj;
+			bin *= hanningScale;
+		}
+		float32_t norm = std::norm(bin);
+		uint64_t power = (norm < 3) ? (uint32_t) norm : 3;
+		val |= (power << (j * CWD_BITS_PER_BIN));
+	}
+	return (val);
+}
+
+/**
+ * Pack the words at an offset into the data and check the result against
+ * the scalar kernel and that the word following the block is untouched.
+ */
+bool
+checkPack(const CwKernel *k, bool hanning, const vector<ComplexFloat32>& data,
+		int32_t ofs)
+{
+	const CwKernel *scalar = getCwKernel(ScalarCwKernel);
+	CwPackFunc pack = hanning ? k->packHanning : k->pack;
+	CwPackFunc ref = hanning ? scalar->packHanning : scalar->pack;
+	vector<uint64_t> out(WORDS + 1, GUARD), expected(WORDS);
+	pack(&out[0], &data[ofs+1], WORDS);
+	ref(&expected[0], &data[ofs+1], WORDS);
+	for (int32_t i = 0; i < WORDS; ++i) {
+		if (out[i] != expected[i])
+			return (false);
+	}
+	return (out[WORDS] == GUARD);
+}
+
+}
+
+TestCwKernel::TestCwKernel(std::string name):
+		TestCase(name)
+{
+}
+
+void
+TestCwKernel::setUp()
+{
+}
+
+void
+TestCwKernel::tearDown()
+{
+}
+
+/**
+ * The scalar kernels against the original computation.
+ */
+void
+TestCwKernel::testScalar()
+{
+	vector<ComplexFloat32> data;
+	createData(data, WORDS * CW_BINS_PER_WORD + 2, SEED);
+	const CwKernel *k = getCwKernel(ScalarCwKernel);
+	cu_assert(k);
+	vector<uint64_t> out(WORDS);
+	for (int32_t h = 0; h < 2; ++h) {
+		bool hanning = h;
+		(hanning ? k->packHanning : k->pack)(&out[0], &data[1], WORDS);
+		bool ok = true;
+		for (int32_t i = 0; i < WORDS; ++i) {
+			ok = ok && out[i] == reference(&data[1+i*CW_BINS_PER_WORD],
+					hanning);
+		}
+		cu_assert(ok);
+		// the out-of-range bin is limited
+		cu_assert(((out[0] >> (3 * CWD_BITS_PER_BIN)) & 3) == 3);
+	}
+}
+
+/**
+ * All kernels supported by the processor, with and without the Hanning
+ * window.
+ */
+void
+TestCwKernel::testKernels()
+{
+	vector<ComplexFloat32> data;
+	createData(data, WORDS * CW_BINS_PER_WORD + MAX_OFFSET + 2, SEED + 1);
+
+	cu_assert(getCwKernel());
+	const CwKernelType types[] = { ScalarCwKernel, Sse2CwKernel,
+			Avx2CwKernel };
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const CwKernel *k = getCwKernel(types[t]);
+		if (!k)
+			continue;
+		cu_assert(k->type == types[t]);
+		for (int32_t ofs = 0; ofs <= MAX_OFFSET; ++ofs) {
+			cu_assert(checkPack(k, false, data, ofs));
+			cu_assert(checkPack(k, true, data, ofs));
+		}
+	}
+}
+
+Test *
+TestCwKernel::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestCwKernel");
+
+	testSuite->addTest(new TestCaller<TestCwKernel>(
+			"testScalar",
+			&TestCwKernel::testScalar));
+	testSuite->addTest(new TestCaller<TestCwKernel>(
+			"testKernels",
+			&TestCwKernel::testKernels));
+	return (testSuite);
+}
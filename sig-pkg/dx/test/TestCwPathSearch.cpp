@@ -0,0 +1,235 @@
+/*******************************************************************************
+
+ File:    TestCwPathSearch.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the CW power path search
+//
+// The path offsets are checked against the original computation, then
+// the block search is checked against the path by path search, both
+// for the power plane of a drifting CW signal in Gaussian noise and
+// for random planes of many shapes, with and without equal powers.
+//
+#include <fftw3.h>
+#include <stdlib.h>
+#include <vector>
+#include "TestRunner.h"
+#include "TestCwPathSearch.h"
+#include "CwPathSearch.h"
+#include "Gaussian.h"
+
+using namespace dx;
+using std::vector;
+
+namespace {
+
+const int32_t SEED = 1;
+const int32_t BINS = 32;
+const int32_t SPECTRA = 128;
+const float64_t BIN_WIDTH_HZ = 1.0;
+const float64_t SNR = 2.0;
+
+/**
+ * Original path offset computation.
+ */
+int32_t
+computeTruePath(float32_t spectrum, float32_t spectra, float32_t drift)
+{
+	int32_t x = (int32_t) ((drift / spectra) * (spectrum + 0.5) + 0.5);
+	return (x);
+}
+
+/**
+ * Create the power plane of a CW signal.  The signal starts at
+ * freqHz from the center of the channel and drifts at driftHz Hz/s.
+ */
+void
+createSignalPlane(vector<float32_t>& plane, float64_t freqHz,
+		float64_t driftHz, int32_t seed)
+{
+	gauss::Gaussian gen;
+	gen.setup(seed, BINS * BIN_WIDTH_HZ / 1e6, 1.0);
+	gen.addCwSignal(freqHz / 1e6, driftHz, SNR);
+
+	size_t size = BINS * sizeof(ComplexFloat32);
+	ComplexFloat32 *td = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
+	ComplexFloat32 *fd = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
+	fftwf_plan plan = fftwf_plan_dft_1d(BINS, (fftwf_complex *) td,
+			(fftwf_complex *) fd, FFTW_FORWARD, FFTW_ESTIMATE);
+	plane.resize(SPECTRA * BINS);
+	for (int32_t s = 0; s < SPECTRA; ++s) {
+		gen.getSamples(td, BINS);
+		fftwf_execute(plan);
+		// DC in the middle
+		for (int32_t j = 0; j < BINS; ++j)
+			plane[s*BINS+j] = std::norm(fd[(j + BINS / 2) % BINS]) / BINS;
+	}
+	fftwf_destroy_plan(plan);
+	fftwf_free(fd);
+	fftwf_free(td);
+}
+
+/**
+ * Create a random plane.  If levels is nonzero, the powers are
+ * restricted to that many values, so that many paths are equal.
+ */
+void
+createRandomPlane(vector<float32_t>& plane, int32_t spectra, int32_t bins,
+		int32_t levels, int32_t seed)
+{
+	srand(seed);
+	plane.resize(spectra * bins);
+	for (int32_t i = 0; i < spectra * bins; ++i) {
+		if (levels)
+			plane[i] = rand() % levels;
+		else
+			plane[i] = (float32_t) rand() / RAND_MAX;
+	}
+}
+
+bool
+samePath(const CwPath& p0, const CwPath& p1)
+{
+	return (p0.bin == p1.bin && p0.drift == p1.drift && p0.power == p1.power);
+}
+
+}
+
+TestCwPathSearch::TestCwPathSearch(std::string name):
+		TestCase(name)
+{
+}
+
+void
+TestCwPathSearch::setUp()
+{
+}
+
+void
+TestCwPathSearch::tearDown()
+{
+}
+
+/**
+ * Path offsets against the original computation.
+ */
+void
+TestCwPathSearch::testOffset()
+{
+	const int32_t spectra[] = { 1, 3, 64, 100, 255 };
+	bool ok = true;
+	for (uint32_t i = 0; i < sizeof(spectra) / sizeof(spectra[0]); ++i) {
+		int32_t n = spectra[i];
+		for (int32_t drift = -n; drift <= n; ++drift) {
+			int32_t sign = drift < 0 ? -1 : 1;
+			for (int32_t s = 0; s < n; ++s) {
+				int32_t x = sign * computeTruePath(s, n, abs(drift));
+				ok = ok && CwPathSearch::getOffset(s, n, drift) == x;
+			}
+		}
+		ok = ok && CwPathSearch::getOffset(n - 1, n, n) == n;
+	}
+	cu_assert(ok);
+}
+
+/**
+ * Drifting CW signals in Gaussian noise.
+ */
+void
+TestCwPathSearch::testSignal()
+{
+	// start frequency (Hz from center), drift (Hz/s)
+	const float64_t signals[][2] = { { -5, 0.1 }, { 8, -0.05 }, { 0, 0 },
+			{ -12, 0.2 } };
+	CwPathSearch search;
+	for (uint32_t i = 0; i < sizeof(signals) / sizeof(signals[0]); ++i) {
+		float64_t freq = signals[i][0];
+		float64_t drift = signals[i][1];
+		vector<float32_t> plane;
+		createSignalPlane(plane, freq, drift, SEED + i);
+		CwPath path = search.search(&plane[0], SPECTRA, BINS);
+		cu_assert(samePath(path, search.searchAll(&plane[0], SPECTRA, BINS)));
+		cu_assert(search.getPruned() > 0);
+
+		// the path must follow the signal
+		int32_t bin = lrint(freq / BIN_WIDTH_HZ) + BINS / 2;
+		float64_t seconds = SPECTRA / BIN_WIDTH_HZ;
+		int32_t driftBins = lrint(drift * seconds / BIN_WIDTH_HZ);
+		cu_assert(abs(path.bin - bin) <= 1);
+		cu_assert(abs(path.drift - driftBins) <= 2);
+	}
+}
+
+/**
+ * Random planes, including planes narrower than, wider than and not a
+ * multiple of a block, and planes with few spectra.
+ */
+void
+TestCwPathSearch::testPlanes()
+{
+	const int32_t shapes[][2] = { { 1, 1 }, { 1, 8 }, { 3, 4 }, { 7, 32 },
+			{ 64, 16 }, { 200, 32 }, { 50, PATH_BLOCK_BINS + 7 },
+			{ 20, 3 * PATH_BLOCK_BINS } };
+	const int32_t levels[] = { 0, 2, 5 };
+	CwPathSearch search;
+	CwPath empty = search.search(0, 0, 0);
+	cu_assert(samePath(empty, CwPath()));
+	for (uint32_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); ++i) {
+		int32_t spectra = shapes[i][0];
+		int32_t bins = shapes[i][1];
+		for (uint32_t l = 0; l < sizeof(levels) / sizeof(levels[0]); ++l) {
+			vector<float32_t> plane;
+			createRandomPlane(plane, spectra, bins, levels[l], SEED + i);
+			CwPath path = search.search(&plane[0], spectra, bins);
+			cu_assert(samePath(path, search.searchAll(&plane[0], spectra,
+					bins)));
+		}
+		// all powers equal: the first path
+		vector<float32_t> plane(spectra * bins, 1);
+		CwPath path = search.search(&plane[0], spectra, bins);
+		cu_assert(path.bin == 0 && path.drift == 0);
+	}
+}
+
+Test *
+TestCwPathSearch::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestCwPathSearch");
+
+	testSuite->addTest(new TestCaller<TestCwPathSearch>(
+			"testOffset",
+			&TestCwPathSearch::testOffset));
+	testSuite->addTest(new TestCaller<TestCwPathSearch>(
+			"testSignal",
+			&TestCwPathSearch::testSignal));
+	testSuite->addTest(new TestCaller<TestCwPathSearch>(
+			"testPlanes",
+			&TestCwPathSearch::testPlanes));
+	return (testSuite);
+}
@@ -0,0 +1,216 @@
+/*******************************************************************************
+
+ File:    TestDedriftKernel.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the dedrift kernels
+//
+// Each kernel supported by the processor is checked against the exact
+// phasors, computed independently for every sample in extended
+// precision, for block lengths which exercise the anchor and step
+// remainders and for the frequencies and drifts of both coherent
+// confirmation and archive channel dedrifting.
+//
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "TestRunner.h"
+#include "TestDedriftKernel.h"
+#include "DedriftKernel.h"
+
+using namespace dx;
+using std::vector;
+
+namespace {
+
+const int32_t SEED = 1;
+const int32_t LONG_SAMPLES = 1 << 20;
+// maximum error of an output sample relative to the input magnitude
+const float64_t SCALAR_TOLERANCE = 2e-7;
+const float64_t VECTOR_TOLERANCE = 1e-6;
+
+void
+createSamples(vector<ComplexFloat32>& samples, int32_t n, int32_t seed)
+{
+	srand(seed);
+	samples.resize(n);
+	for (int32_t i = 0; i < n; ++i) {
+		samples[i] = ComplexFloat32(2.0 * rand() / RAND_MAX - 1,
+				2.0 * rand() / RAND_MAX - 1);
+	}
+}
+
+/**
+ * Largest error of a dedrifted block relative to the input magnitude.
+ */
+float64_t
+maxError(const vector<ComplexFloat32>& in, const vector<ComplexFloat32>& out,
+		int32_t n, float64_t freq, float64_t drift)
+{
+	float64_t maxErr = 0;
+	for (int32_t i = 0; i < n; ++i) {
+		float96_t t = i;
+		float96_t phase = fmodl(freq * t + drift * t * t, 2 * M_PI);
+		ComplexFloat96 expected = ComplexFloat96(in[i])
+				* ComplexFloat96(cosl(phase), sinl(phase));
+		float64_t err = abs(ComplexFloat96(out[i]) - expected);
+		float64_t mag = abs(in[i]);
+		if (mag > 0 && err / mag > maxErr)
+			maxErr = err / mag;
+	}
+	return (maxErr);
+}
+
+float64_t
+tolerance(const DedriftKernel *k)
+{
+	return (k->type == ScalarDedriftKernel ? SCALAR_TOLERANCE
+			: VECTOR_TOLERANCE);
+}
+
+}
+
+TestDedriftKernel::TestDedriftKernel(std::string name): TestCase(name)
+{
+}
+
+void
+TestDedriftKernel::setUp()
+{
+}
+
+void
+TestDedriftKernel::tearDown()
+{
+}
+
+/**
+ * Every kernel against the exact phasors, for short blocks with the
+ * frequencies and drifts of coherent confirmation.
+ */
+void
+TestDedriftKernel::testAccuracy()
+{
+	const int32_t samples[] = { 1, 3, 4, 5, 63, 64, 65, 127, 256, 1024 };
+	const DedriftKernelType types[] = { ScalarDedriftKernel,
+			Sse2DedriftKernel, Avx2DedriftKernel };
+
+	cu_assert(getDedriftKernel(ScalarDedriftKernel));
+	cu_assert(getDedriftKernel());
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const DedriftKernel *k = getDedriftKernel(types[t]);
+		if (!k)
+			continue;
+		cu_assert(k->type == types[t]);
+		for (uint32_t s = 0; s < sizeof(samples) / sizeof(samples[0]); ++s) {
+			int32_t n = samples[s];
+			vector<ComplexFloat32> in, out(n);
+			createSamples(in, n, SEED + s);
+			// every drift of a coherent search, plus a frequency shift
+			for (int32_t d = -(n - 1); d < n; d += (n > 64 ? 7 : 1)) {
+				float64_t drift = -M_PI * d / ((float64_t) n * n);
+				for (int32_t f = -1; f <= 1; ++f) {
+					float64_t freq = f * 0.3;
+					k->dedrift(&out[0], &in[0], n, freq, drift);
+					cu_assert(maxError(in, out, n, freq, drift)
+							<= tolerance(k));
+				}
+			}
+			// in place
+			vector<ComplexFloat32> inPlace = in;
+			k->dedrift(&out[0], &in[0], n, 0.1, -1e-3);
+			k->dedrift(&inPlace[0], &inPlace[0], n, 0.1, -1e-3);
+			cu_assert(inPlace == out);
+		}
+	}
+}
+
+/**
+ * Every kernel against the exact phasors for a block as long as an
+ * archive channel, where the phase reaches millions of radians.
+ */
+void
+TestDedriftKernel::testLong()
+{
+	const float64_t freq[] = { 0, M_PI * 0.49, -M_PI * 0.23 };
+	const float64_t drift[] = { -M_PI * 1e-6, M_PI * 3.7e-8, 0 };
+	const DedriftKernelType types[] = { ScalarDedriftKernel,
+			Sse2DedriftKernel, Avx2DedriftKernel };
+
+	vector<ComplexFloat32> in, out(LONG_SAMPLES);
+	createSamples(in, LONG_SAMPLES, SEED);
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const DedriftKernel *k = getDedriftKernel(types[t]);
+		if (!k)
+			continue;
+		for (uint32_t i = 0; i < sizeof(freq) / sizeof(freq[0]); ++i) {
+			k->dedrift(&out[0], &in[0], LONG_SAMPLES, freq[i], drift[i]);
+			cu_assert(maxError(in, out, LONG_SAMPLES, freq[i], drift[i])
+					<= tolerance(k));
+		}
+	}
+}
+
+/**
+ * The vector kernels produce identical results.
+ */
+void
+TestDedriftKernel::testIdentical()
+{
+	const DedriftKernel *sse2 = getDedriftKernel(Sse2DedriftKernel);
+	const DedriftKernel *avx2 = getDedriftKernel(Avx2DedriftKernel);
+	if (!sse2 || !avx2)
+		return;
+	const int32_t samples[] = { 3, 64, 67, 4099 };
+	for (uint32_t s = 0; s < sizeof(samples) / sizeof(samples[0]); ++s) {
+		int32_t n = samples[s];
+		vector<ComplexFloat32> in, out0(n), out1(n);
+		createSamples(in, n, SEED + s);
+		sse2->dedrift(&out0[0], &in[0], n, 1.1, -2.3e-4);
+		avx2->dedrift(&out1[0], &in[0], n, 1.1, -2.3e-4);
+		cu_assert(out0 == out1);
+	}
+}
+
+Test *
+TestDedriftKernel::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestDedriftKernel");
+
+	testSuite->addTest(new TestCaller<TestDedriftKernel>(
+			"testAccuracy",
+			&TestDedriftKernel::testAccuracy));
+	testSuite->addTest(new TestCaller<TestDedriftKernel>(
+			"testLong",
+			&TestDedriftKernel::testLong));
+	testSuite->addTest(new TestCaller<TestDedriftKernel>(
+			"testIdentical",
+			&TestDedriftKernel::testIdentical));
+	return (testSuite);
+}
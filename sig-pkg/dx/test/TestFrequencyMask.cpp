@@ -0,0 +1,308 @@
+/*******************************************************************************
+
+ File:    TestFrequencyMask.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the frequency mask
+//
+// The interval index is checked against the linear scan it replaced
+// for ordered, disjoint masks like those sent by the SSE, and against
+// an exhaustive test of every band for masks with unordered and
+// overlapping bands, which the linear scan did not handle.  The batch
+// lookup is checked against the single lookup.
+//
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "TestRunner.h"
+#include "TestFrequencyMask.h"
+#include "FrequencyMask.h"
+
+using namespace dx;
+using std::vector;
+
+namespace {
+
+const int32_t SEED = 1;
+const int32_t BANDS = 500;
+const int32_t SIGNALS = 20000;
+const float64_t CENTER_FREQ = 1420.0;		// MHz
+const float64_t MASK_WIDTH = 100.0;			// MHz
+const float64_t MAX_BANDWIDTH = 0.05;		// MHz
+
+float64_t
+uniform(float64_t lo, float64_t hi)
+{
+	return (lo + (hi - lo) * rand() / RAND_MAX);
+}
+
+bool
+lessFreq(const FrequencyBand& a, const FrequencyBand& b)
+{
+	return (a.centerFreq < b.centerFreq);
+}
+
+/**
+ * Create a mask of random bands; if ordered is set, the bands are
+ * ascending and disjoint.
+ */
+void
+createMask(vector<FrequencyBand>& bands, int32_t n, bool ordered)
+{
+	bands.resize(n);
+	for (int32_t i = 0; i < n; ++i) {
+		bands[i].centerFreq = uniform(CENTER_FREQ - MASK_WIDTH / 2,
+				CENTER_FREQ + MASK_WIDTH / 2);
+		bands[i].bandwidth = uniform(0, MAX_BANDWIDTH);
+	}
+	if (!ordered)
+		return;
+	std::sort(bands.begin(), bands.end(), lessFreq);
+	// shrink bands which would overlap their predecessor
+	for (int32_t i = 1; i < n; ++i) {
+		float64_t gap = bands[i].centerFreq - bands[i-1].centerFreq;
+		if (bands[i].bandwidth > gap)
+			bands[i].bandwidth = gap / 2;
+		if (bands[i-1].bandwidth > gap)
+			bands[i-1].bandwidth = gap / 2;
+	}
+}
+
+FrequencyMask *
+createFrequencyMask(const vector<FrequencyBand>& bands)
+{
+	FrequencyBand covered;
+	covered.centerFreq = CENTER_FREQ;
+	covered.bandwidth = MASK_WIDTH;
+	return (new FrequencyMask(bands.size(), &bands[0], covered));
+}
+
+/**
+ * The linear scan formerly used by isMasked; requires an ordered,
+ * disjoint mask.
+ */
+bool
+linearScan(const vector<FrequencyBand>& mask, float64_t frequency,
+		float64_t width)
+{
+	float64_t loFreq = frequency - width / 2;
+	float64_t hiFreq = frequency + width / 2;
+	for (size_t i = 0; i < mask.size(); ++i) {
+		float64_t loMask = mask[i].centerFreq - mask[i].bandwidth / 2;
+		float64_t hiMask = mask[i].centerFreq + mask[i].bandwidth / 2;
+		if (hiFreq < loMask)
+			break;
+		if (loFreq <= hiMask && hiFreq >= loMask)
+			return (true);
+	}
+	return (false);
+}
+
+/**
+ * Test every band, in any order.
+ */
+bool
+exhaustive(const vector<FrequencyBand>& mask, float64_t frequency,
+		float64_t width)
+{
+	float64_t loFreq = frequency - width / 2;
+	float64_t hiFreq = frequency + width / 2;
+	for (size_t i = 0; i < mask.size(); ++i) {
+		float64_t loMask = mask[i].centerFreq - mask[i].bandwidth / 2;
+		float64_t hiMask = mask[i].centerFreq + mask[i].bandwidth / 2;
+		if (loFreq <= hiMask && hiFreq >= loMask)
+			return (true);
+	}
+	return (false);
+}
+
+}
+
+TestFrequencyMask::TestFrequencyMask(std::string name): TestCase(name)
+{
+}
+
+void
+TestFrequencyMask::setUp()
+{
+}
+
+void
+TestFrequencyMask::tearDown()
+{
+}
+
+/**
+ * Ordered, disjoint masks give the same result as the linear scan,
+ * for signals of zero and nonzero width.
+ */
+void
+TestFrequencyMask::testLinearScan()
+{
+	const int32_t bands[] = { 1, 2, 7, 64, BANDS };
+	const float64_t widths[] = { 0, 1e-6, 1e-3, 0.1 };
+
+	srand(SEED);
+	for (uint32_t b = 0; b < sizeof(bands) / sizeof(bands[0]); ++b) {
+		vector<FrequencyBand> mask;
+		createMask(mask, bands[b], true);
+		FrequencyMask *fm = createFrequencyMask(mask);
+		int32_t masked = 0;
+		for (int32_t i = 0; i < SIGNALS; ++i) {
+			float64_t freq = uniform(CENTER_FREQ - MASK_WIDTH,
+					CENTER_FREQ + MASK_WIDTH);
+			float64_t width = widths[i % (sizeof(widths) / sizeof(widths[0]))];
+			bool expected = linearScan(mask, freq, width);
+			cu_assert(fm->isMasked(freq, width) == expected);
+			masked += expected;
+		}
+		// make sure both outcomes were exercised
+		if (bands[b] == BANDS)
+			cu_assert(masked > 0 && masked < SIGNALS);
+		delete fm;
+	}
+}
+
+/**
+ * Unordered masks with overlapping and nested bands give the same
+ * result as an exhaustive test.
+ */
+void
+TestFrequencyMask::testOverlap()
+{
+	srand(SEED + 1);
+	vector<FrequencyBand> mask;
+	createMask(mask, BANDS, false);
+	// nest a band inside another and duplicate one
+	mask[3] = mask[2];
+	mask[3].bandwidth = mask[2].bandwidth / 4;
+	mask[5] = mask[4];
+	// wide bands which overlap many others
+	mask[6].bandwidth = 2;
+	mask[7].bandwidth = 0.5;
+	FrequencyMask *fm = createFrequencyMask(mask);
+	for (int32_t i = 0; i < SIGNALS; ++i) {
+		float64_t freq = uniform(CENTER_FREQ - MASK_WIDTH,
+				CENTER_FREQ + MASK_WIDTH);
+		float64_t width = uniform(0, 0.01);
+		cu_assert(fm->isMasked(freq, width) == exhaustive(mask, freq, width));
+	}
+	delete fm;
+}
+
+/**
+ * Signals touching a band edge are masked; signals just outside are
+ * not.  Bands which touch are merged without losing either edge.
+ */
+void
+TestFrequencyMask::testEdges()
+{
+	vector<FrequencyBand> mask(3);
+	mask[0].centerFreq = 1000.5;
+	mask[0].bandwidth = 1;
+	mask[1].centerFreq = 1001.5;
+	mask[1].bandwidth = 1;
+	mask[2].centerFreq = 1010;
+	mask[2].bandwidth = 0;
+	FrequencyMask *fm = createFrequencyMask(mask);
+
+	cu_assert(fm->isMasked(1000, 0));
+	cu_assert(fm->isMasked(1001, 0));
+	cu_assert(fm->isMasked(1002, 0));
+	cu_assert(!fm->isMasked(999.99, 0));
+	cu_assert(!fm->isMasked(1002.01, 0));
+	cu_assert(fm->isMasked(999.99, 0.04));
+	cu_assert(fm->isMasked(1010, 0));
+	cu_assert(fm->isMasked(1009.98, 0.06));
+	cu_assert(!fm->isMasked(1009.99, 0));
+	cu_assert(!fm->isMasked(1005, 4));
+	cu_assert(fm->isMasked(1005, 6));
+	delete fm;
+
+	// an empty mask masks nothing
+	FrequencyBand covered;
+	FrequencyMask empty(0, 0, covered);
+	cu_assert(!empty.isMasked(1000, 1));
+	float64_t freq = 1000;
+	bool masked = true;
+	empty.isMasked(&freq, 1, 1, &masked);
+	cu_assert(!masked);
+}
+
+/**
+ * The batch lookup agrees with single lookups, for ordered
+ * frequencies and for frequencies out of order.
+ */
+void
+TestFrequencyMask::testBatch()
+{
+	const float64_t widths[] = { 0, 1e-4, 0.02 };
+
+	srand(SEED + 2);
+	vector<FrequencyBand> mask;
+	createMask(mask, BANDS, false);
+	FrequencyMask *fm = createFrequencyMask(mask);
+
+	vector<float64_t> freq(SIGNALS);
+	for (int32_t i = 0; i < SIGNALS; ++i)
+		freq[i] = uniform(CENTER_FREQ - MASK_WIDTH, CENTER_FREQ + MASK_WIDTH);
+	vector<float64_t> sorted = freq;
+	std::sort(sorted.begin(), sorted.end());
+	for (uint32_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+		bool *masked = new bool[SIGNALS];
+		fm->isMasked(&sorted[0], SIGNALS, widths[w], masked);
+		for (int32_t i = 0; i < SIGNALS; ++i)
+			cu_assert(masked[i] == fm->isMasked(sorted[i], widths[w]));
+		fm->isMasked(&freq[0], SIGNALS, widths[w], masked);
+		for (int32_t i = 0; i < SIGNALS; ++i)
+			cu_assert(masked[i] == fm->isMasked(freq[i], widths[w]));
+		delete [] masked;
+	}
+	delete fm;
+}
+
+Test *
+TestFrequencyMask::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestFrequencyMask");
+
+	testSuite->addTest(new TestCaller<TestFrequencyMask>(
+			"testLinearScan",
+			&TestFrequencyMask::testLinearScan));
+	testSuite->addTest(new TestCaller<TestFrequencyMask>(
+			"testOverlap",
+			&TestFrequencyMask::testOverlap));
+	testSuite->addTest(new TestCaller<TestFrequencyMask>(
+			"testEdges",
+			&TestFrequencyMask::testEdges));
+	testSuite->addTest(new TestCaller<TestFrequencyMask>(
+			"testBatch",
+			&TestFrequencyMask::testBatch));
+	return (testSuite);
+}
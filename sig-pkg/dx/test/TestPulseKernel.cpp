@@ -0,0 +1,192 @@
+/*******************************************************************************
+
+ File:    TestPulseKernel.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+//
+// Unit tests for the pulse threshold kernels
+//
+// The scalar kernel is checked against the original bin-at-a-time
+// computation, then each kernel supported by the processor is checked
+// against the scalar kernel for unaligned data, lengths which are not a
+// multiple of the vector width, and hit densities from none to every bin.
+//
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "TestRunner.h"
+#include "TestPulseKernel.h"
+#include "PulseKernel.h"
+
+// the reference computation must round like the kernels
+#pragma GCC optimize ("fp-contract=off")
+
+using namespace dx;
+using std::vector;
+
+namespace {
+
+const int32_t BINS = 1024;
+const int32_t MAX_OFFSET = 3;
+const int32_t SEED = 1;
+const float32_t THRESHOLD = 10;
+const float32_t GUARD = -1;
+
+/**
+ * Create the spectrum data.  A fraction of the bins, which increases
+ * with density, have powers above the threshold; the rest are below it.
+ * A few bins have powers exactly at the threshold.
+ */
+void
+createData(vector<ComplexFloat32>& data, int32_t n, int32_t density,
+		int32_t seed)
+{
+	srand(seed);
+	data.resize(n);
+	for (int32_t i = 0; i < n; ++i) {
+		float64_t phase = 2 * M_PI * rand() / RAND_MAX;
+		float64_t power = (float64_t) rand() / RAND_MAX * THRESHOLD;
+		if (rand() % 100 < density)
+			power += THRESHOLD * (1 + (float64_t) rand() / RAND_MAX);
+		data[i] = ComplexFloat32(sqrt(power) * cos(phase),
+				sqrt(power) * sin(phase));
+	}
+	data[n/2] = ComplexFloat32(sqrt(THRESHOLD), 0);
+	data[n/3] = ComplexFloat32(0, sqrt(THRESHOLD));
+}
+
+/**
+ * Threshold the data and check the result against the scalar kernel.
+ */
+bool
+checkThreshold(const PulseKernel *k, const vector<ComplexFloat32>& data,
+		int32_t ofs, int32_t n)
+{
+	const PulseKernel *scalar = getPulseKernel(ScalarPulseKernel);
+	// one extra entry, so that the arrays are never empty
+	vector<int32_t> bin(n + 1, -1), expectedBin(n + 1);
+	vector<float32_t> power(n + 1, GUARD), expectedPower(n + 1);
+	int32_t hits = k->threshold(&data[ofs], n, THRESHOLD, &bin[0],
+			&power[0]);
+	int32_t expected = scalar->threshold(&data[ofs], n, THRESHOLD,
+			&expectedBin[0], &expectedPower[0]);
+	if (hits != expected)
+		return (false);
+	for (int32_t i = 0; i < hits; ++i) {
+		if (bin[i] != expectedBin[i] || power[i] != expectedPower[i])
+			return (false);
+	}
+	return (true);
+}
+
+}
+
+TestPulseKernel::TestPulseKernel(std::string name):
+		TestCase(name)
+{
+}
+
+void
+TestPulseKernel::setUp()
+{
+}
+
+void
+TestPulseKernel::tearDown()
+{
+}
+
+/**
+ * The scalar kernel against the original computation.
+ */
+void
+TestPulseKernel::testScalar()
+{
+	vector<ComplexFloat32> data;
+	createData(data, BINS, 10, SEED);
+	const PulseKernel *k = getPulseKernel(ScalarPulseKernel);
+	cu_assert(k);
+	vector<int32_t> bin(BINS);
+	vector<float32_t> power(BINS);
+	int32_t hits = k->threshold(&data[0], BINS, THRESHOLD, &bin[0],
+			&power[0]);
+	cu_assert(hits > 0);
+
+	int32_t j = 0;
+	bool ok = true;
+	for (int32_t i = 0; i < BINS; ++i) {
+		float32_t p = std::norm(data[i]);
+		if (p > THRESHOLD) {
+			ok = ok && j < hits && bin[j] == i && power[j] == p;
+			++j;
+		}
+	}
+	cu_assert(ok);
+	cu_assert(j == hits);
+}
+
+/**
+ * All kernels supported by the processor.
+ */
+void
+TestPulseKernel::testKernels()
+{
+	cu_assert(getPulseKernel());
+	const PulseKernelType types[] = { ScalarPulseKernel, Sse2PulseKernel,
+			Avx2PulseKernel };
+	const int32_t densities[] = { 0, 1, 10, 50, 90, 100 };
+	const int32_t lengths[] = { 0, 1, 7, 9, 31, BINS - 5, BINS };
+	for (uint32_t d = 0; d < sizeof(densities) / sizeof(densities[0]); ++d) {
+		vector<ComplexFloat32> data;
+		createData(data, BINS + MAX_OFFSET, densities[d], SEED + d);
+		for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+			const PulseKernel *k = getPulseKernel(types[t]);
+			if (!k)
+				continue;
+			cu_assert(k->type == types[t]);
+			for (uint32_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]);
+					++n) {
+				for (int32_t ofs = 0; ofs <= MAX_OFFSET; ++ofs)
+					cu_assert(checkThreshold(k, data, ofs, lengths[n]));
+			}
+		}
+	}
+}
+
+Test *
+TestPulseKernel::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestPulseKernel");
+
+	testSuite->addTest(new TestCaller<TestPulseKernel>(
+			"testScalar",
+			&TestPulseKernel::testScalar));
+	testSuite->addTest(new TestCaller<TestPulseKernel>(
+			"testKernels",
+			&TestPulseKernel::testKernels));
+	return (testSuite);
+}
@@ -0,0 +1,222 @@
+/*******************************************************************************
+
+ File:    TestPulseTripletSearch.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the pulse triplet search
+//
+// Each test builds a dense synthetic pulse map (random pulses plus a
+// few regular pulse trains) and checks that the indexed search finds
+// exactly the same triplets, in the same order, as the search of every
+// combination of pulses.
+//
+#include <algorithm>
+#include <map>
+#include <stdlib.h>
+#include "TestRunner.h"
+#include "TestPulseTripletSearch.h"
+#include "PulseTripletSearch.h"
+
+using namespace dx;
+
+namespace {
+
+const int32_t SPECTRA = 64;
+const int32_t BINS = 256;
+const int32_t SEED = 1;
+
+bool
+compareSpectra(const dx::Pulse& p0, const dx::Pulse& p1)
+{
+	return (p0.spectrum < p1.spectrum);
+}
+
+/**
+ * Create a pulse map.
+ *
+ * Description:\n
+ * 	Creates random pulses with the specified density (percent), adds
+ * 	trains with a range of periods and drifts, then orders the pulses
+ * 	by spectrum.  If shuffle is set, the pulses within a spectrum are
+ * 	left in random order; otherwise they are in bin order, as the
+ * 	pulse detection task produces them.
+ */
+void
+createPulses(PulseVector& pulses, int32_t density, bool shuffle,
+		int32_t seed)
+{
+	std::map<int64_t, dx::Pulse> map;
+	srand(seed);
+	for (int32_t s = 0; s < SPECTRA; ++s) {
+		for (int32_t b = 0; b < BINS; ++b) {
+			if (rand() % 100 < density) {
+				map[(int64_t) b * SPECTRA + s] = dx::Pulse(RES_1HZ, b, s,
+						POL_RIGHTCIRCULAR, 10 + rand() % 10);
+			}
+		}
+	}
+	// start bin, start spectrum, period, drift per pulse
+	const int32_t trains[][4] = {
+		{ 20, 0, 5, 0 }, { 60, 3, 7, 3 }, { 120, 1, 4, -2 },
+		{ 200, 2, 9, -6 }, { 240, 0, 3, 1 }
+	};
+	for (uint32_t t = 0; t < sizeof(trains) / sizeof(trains[0]); ++t) {
+		int32_t b = trains[t][0];
+		for (int32_t s = trains[t][1]; s < SPECTRA && b >= 0 && b < BINS;
+				s += trains[t][2], b += trains[t][3]) {
+			map[(int64_t) b * SPECTRA + s] = dx::Pulse(RES_1HZ, b, s,
+					POL_LEFTCIRCULAR, 50);
+		}
+	}
+
+	pulses.clear();
+	for (std::map<int64_t, dx::Pulse>::iterator p = map.begin();
+			p != map.end(); ++p)
+		pulses.push_back(p->second);
+	if (shuffle)
+		std::random_shuffle(pulses.begin(), pulses.end());
+	std::stable_sort(pulses.begin(), pulses.end(), compareSpectra);
+}
+
+bool
+sameTriplets(const PulseTripletList& a, const PulseTripletList& b)
+{
+	if (a.size() != b.size())
+		return (false);
+	for (uint32_t i = 0; i < a.size(); ++i) {
+		if (a[i].p0 != b[i].p0 || a[i].p1 != b[i].p1 || a[i].p2 != b[i].p2)
+			return (false);
+	}
+	return (true);
+}
+
+/**
+ * Run both searches, returning whether they match and the number of
+ * triplets found.
+ */
+bool
+compareSearch(const PulseVector& pulses, int32_t startBin, int32_t endBin,
+		float32_t maxDrift, int32_t& triplets)
+{
+	PulseTripletSearch search;
+	PulseTripletList all, indexed;
+	search.searchAll(pulses, startBin, endBin, maxDrift, all);
+	search.search(pulses, startBin, endBin, maxDrift, indexed);
+	triplets = all.size();
+	return (sameTriplets(all, indexed));
+}
+
+}
+
+TestPulseTripletSearch::TestPulseTripletSearch(std::string name):
+		TestCase(name)
+{
+}
+
+void
+TestPulseTripletSearch::setUp()
+{
+}
+
+void
+TestPulseTripletSearch::tearDown()
+{
+}
+
+/**
+ * A dense map, in both bin and random order within each spectrum.
+ */
+void
+TestPulseTripletSearch::testDenseMap()
+{
+	PulseVector pulses;
+	int32_t triplets;
+
+	createPulses(pulses, 6, false, SEED);
+	cu_assert(pulses.size() > 900);
+	cu_assert(compareSearch(pulses, 0, BINS, 1, triplets));
+	cu_assert(triplets > 1000);
+
+	createPulses(pulses, 6, true, SEED + 1);
+	cu_assert(compareSearch(pulses, 0, BINS, 1, triplets));
+	cu_assert(triplets > 1000);
+}
+
+/**
+ * Drift cones narrower and wider than the default.
+ */
+void
+TestPulseTripletSearch::testDriftLimits()
+{
+	PulseVector pulses;
+	createPulses(pulses, 4, true, SEED + 2);
+
+	const float32_t drifts[] = { 0.25, 0.5, 1.5, 2.0, 3.7 };
+	for (uint32_t i = 0; i < sizeof(drifts) / sizeof(drifts[0]); ++i) {
+		int32_t triplets;
+		cu_assert(compareSearch(pulses, 0, BINS, drifts[i], triplets));
+		cu_assert(triplets > 0);
+	}
+}
+
+/**
+ * Only pulses within the slice may start a triplet, but the other
+ * pulses of a triplet may lie outside it.
+ */
+void
+TestPulseTripletSearch::testSliceBounds()
+{
+	PulseVector pulses;
+	createPulses(pulses, 6, false, SEED + 3);
+
+	int32_t full, slice;
+	cu_assert(compareSearch(pulses, 0, BINS, 1, full));
+	cu_assert(compareSearch(pulses, 64, 192, 1, slice));
+	cu_assert(slice > 0 && slice < full);
+	cu_assert(compareSearch(pulses, 250, 256, 2, slice));
+	cu_assert(compareSearch(pulses, 300, 400, 1, slice));
+	cu_assert(slice == 0);
+}
+
+Test *
+TestPulseTripletSearch::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestPulseTripletSearch");
+
+	testSuite->addTest(new TestCaller<TestPulseTripletSearch>(
+			"testDenseMap",
+			&TestPulseTripletSearch::testDenseMap));
+	testSuite->addTest(new TestCaller<TestPulseTripletSearch>(
+			"testDriftLimits",
+			&TestPulseTripletSearch::testDriftLimits));
+	testSuite->addTest(new TestCaller<TestPulseTripletSearch>(
+			"testSliceBounds",
+			&TestPulseTripletSearch::testSliceBounds));
+	return (testSuite);
+}
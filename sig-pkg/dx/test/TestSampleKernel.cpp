@@ -0,0 +1,195 @@
+/*******************************************************************************
+
+ File:    TestSampleKernel.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the input sample conversion kernels
+//
+// Each kernel supported by the processor is checked against the
+// expected conversion for block lengths which exercise the vector
+// remainders, for unaligned buffers and for the extreme sample values.
+//
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "TestRunner.h"
+#include "TestSampleKernel.h"
+#include "SampleKernel.h"
+
+using namespace dx;
+using std::vector;
+
+namespace {
+
+const int32_t MAX_SAMPLES = 4099;
+const int32_t MAX_OFFSET = 3;
+const int32_t BUF_SAMPLES = 1000;
+const int32_t SEED = 1;
+const ComplexFloat32 GUARD(-1e30, 1e30);
+
+void
+createSamples(vector<ComplexInt16>& samples, int32_t n, int32_t seed)
+{
+	srand(seed);
+	samples.resize(n);
+	for (int32_t i = 0; i < n; ++i) {
+		samples[i] = ComplexInt16((int16_t) (rand() & 0xffff),
+				(int16_t) (rand() & 0xffff));
+	}
+	// include the extreme values
+	samples[0] = ComplexInt16(-32768, 32767);
+	samples[n-1] = ComplexInt16(32767, -32768);
+}
+
+ComplexFloat32
+expected(const ComplexInt16& s, bool swapped)
+{
+	if (swapped)
+		return (ComplexFloat32(s.imag(), s.real()));
+	return (ComplexFloat32(s.real(), s.imag()));
+}
+
+/**
+ * Convert n samples at an offset into the buffers and check the result
+ * and that the sample following the block is untouched.
+ */
+bool
+checkConvert(SampleConvertFunc convert, bool swapped,
+		const vector<ComplexInt16>& in, int32_t ofs, int32_t n)
+{
+	vector<ComplexFloat32> out(ofs + n + 1, GUARD);
+	convert(&out[ofs], &in[ofs], n);
+	for (int32_t i = 0; i < n; ++i) {
+		if (out[ofs+i] != expected(in[ofs+i], swapped))
+			return (false);
+	}
+	return (out[ofs+n] == GUARD);
+}
+
+}
+
+TestSampleKernel::TestSampleKernel(std::string name):
+		TestCase(name)
+{
+}
+
+void
+TestSampleKernel::setUp()
+{
+}
+
+void
+TestSampleKernel::tearDown()
+{
+}
+
+/**
+ * All kernels supported by the processor, both orders.
+ */
+void
+TestSampleKernel::testKernels()
+{
+	vector<ComplexInt16> in;
+	createSamples(in, MAX_SAMPLES + MAX_OFFSET, SEED);
+
+	cu_assert(getSampleKernel(ScalarSampleKernel));
+	cu_assert(getSampleKernel());
+	const SampleKernelType types[] = { ScalarSampleKernel,
+			Sse41SampleKernel, Avx2SampleKernel };
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const SampleKernel *k = getSampleKernel(types[t]);
+		if (!k)
+			continue;
+		cu_assert(k->type == types[t]);
+		for (int32_t ofs = 0; ofs <= MAX_OFFSET; ++ofs) {
+			for (int32_t n = 0; n <= 40; ++n) {
+				cu_assert(checkConvert(k->convert, false, in, ofs, n));
+				cu_assert(checkConvert(k->convertSwapped, true, in, ofs, n));
+			}
+			cu_assert(checkConvert(k->convert, false, in, ofs, MAX_SAMPLES));
+			cu_assert(checkConvert(k->convertSwapped, true, in, ofs,
+					MAX_SAMPLES));
+		}
+	}
+}
+
+/**
+ * Blocks which do and do not wrap past the end of the circular input
+ * buffer.
+ */
+void
+TestSampleKernel::testWrap()
+{
+	InputBuffer inBuf(BUF_SAMPLES, sizeof(ComplexInt16));
+	vector<ComplexInt16> data;
+	createSamples(data, BUF_SAMPLES, SEED + 1);
+	memcpy(inBuf.getBuf(), &data[0], BUF_SAMPLES * sizeof(ComplexInt16));
+
+	// make sample 900 the first sample, at the same index
+	inBuf.setDone(900);
+	const SampleKernel *k = getSampleKernel();
+	const int32_t n = 300;
+	vector<ComplexFloat32> out(n + 1, GUARD);
+	for (int32_t s = 0; s < 2; ++s) {
+		bool swapped = s;
+		SampleConvertFunc convert = swapped ? k->convertSwapped : k->convert;
+
+		// no wrap
+		out.assign(n + 1, GUARD);
+		convertSamples(convert, &inBuf, 900, 100, &out[0]);
+		bool ok = (out[100] == GUARD);
+		for (int32_t i = 0; i < 100; ++i)
+			ok = ok && out[i] == expected(data[900+i], swapped);
+		cu_assert(ok);
+
+		// wrap
+		out.assign(n + 1, GUARD);
+		convertSamples(convert, &inBuf, 900, n, &out[0]);
+		ok = (out[n] == GUARD);
+		for (int32_t i = 0; i < n; ++i) {
+			ok = ok && out[i] == expected(data[(900+i)%BUF_SAMPLES],
+					swapped);
+		}
+		cu_assert(ok);
+	}
+}
+
+Test *
+TestSampleKernel::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestSampleKernel");
+
+	testSuite->addTest(new TestCaller<TestSampleKernel>(
+			"testKernels",
+			&TestSampleKernel::testKernels));
+	testSuite->addTest(new TestCaller<TestSampleKernel>(
+			"testWrap",
+			&TestSampleKernel::testWrap));
+	return (testSuite);
+}
@@ -0,0 +1,322 @@
+/*******************************************************************************
+
+ File:    TestSignalClassifierEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the signal classifier engine
+//
+// A synthetic set of candidates, in no particular order and with
+// duplicated frequencies and positive, negative and zero drifts, is
+// classified by the engine and checked signal by signal against the
+// tests the classifier formerly applied to each candidate on its own:
+// a single lookup in each mask and a scan of every bad band.
+//
+#include <stdlib.h>
+#include <vector>
+#include "TestRunner.h"
+#include "TestSignalClassifierEngine.h"
+#include "SignalClassifierEngine.h"
+
+using namespace dx;
+using std::vector;
+
+namespace {
+
+const int32_t SEED = 1;
+const int32_t SIGNALS = 5000;
+const int32_t MASK_BANDS = 300;
+const int32_t BAD_BANDS = 200;
+const float64_t CENTER_FREQ = 1420.0;		// MHz
+const float64_t BANDWIDTH = 10.0;			// MHz
+const float64_t OBS_LEN = 98.0;				// seconds
+
+float64_t
+uniform(float64_t lo, float64_t hi)
+{
+	return (lo + (hi - lo) * rand() / RAND_MAX);
+}
+
+void
+createSignals(vector<SignalDescription>& sigs, int32_t n)
+{
+	sigs.resize(n);
+	for (int32_t i = 0; i < n; ++i) {
+		SignalPath& path = sigs[i].path;
+		if (i && !(i % 10))
+			path.rfFreq = sigs[i-1].path.rfFreq;
+		else
+			path.rfFreq = uniform(CENTER_FREQ - BANDWIDTH / 2,
+					CENTER_FREQ + BANDWIDTH / 2);
+		path.width = uniform(0, 500);
+		switch (i % 3) {
+		case 0:
+			path.drift = 0;
+			break;
+		case 1:
+			path.drift = uniform(0, 5);
+			break;
+		default:
+			path.drift = -uniform(0, 5);
+			break;
+		}
+	}
+}
+
+/**
+ * Create bands of widths from a few Hz to tens of kHz, which may
+ * overlap.
+ */
+void
+createBands(vector<FrequencyBand>& bands, int32_t n)
+{
+	bands.resize(n);
+	for (int32_t i = 0; i < n; ++i) {
+		bands[i].centerFreq = uniform(CENTER_FREQ - BANDWIDTH / 2,
+				CENTER_FREQ + BANDWIDTH / 2);
+		bands[i].bandwidth = uniform(1e-6, 2e-2);
+	}
+}
+
+FrequencyMask *
+createMask(const vector<FrequencyBand>& bands)
+{
+	FrequencyBand covered;
+	covered.centerFreq = CENTER_FREQ;
+	covered.bandwidth = BANDWIDTH;
+	return (new FrequencyMask(bands.size(), &bands[0], covered));
+}
+
+/**
+ * The bad band test formerly applied by the classifier.
+ */
+bool
+match(const SignalDescription& sig, const FrequencyBand& band,
+		float64_t obsLen)
+{
+	float64_t sigLo = sig.path.rfFreq - (HZ_TO_MHZ(sig.path.width / 2));
+	float64_t sigHi = sig.path.rfFreq + (HZ_TO_MHZ(sig.path.width / 2));
+	float64_t bandLo = band.centerFreq - band.bandwidth / 2;
+	float64_t bandHi = band.centerFreq + band.bandwidth / 2;
+
+	if (sig.path.drift >= 0)
+		sigHi += HZ_TO_MHZ(sig.path.drift * obsLen);
+	else
+		sigLo -= HZ_TO_MHZ(sig.path.drift * obsLen);
+	return (sigLo < bandHi && sigHi > bandLo);
+}
+
+bool
+inBadBand(const SignalDescription& sig, const vector<FrequencyBand>& bands)
+{
+	for (uint32_t j = 0; j < bands.size(); ++j) {
+		if (match(sig, bands[j], OBS_LEN))
+			return (true);
+	}
+	return (false);
+}
+
+}
+
+TestSignalClassifierEngine::TestSignalClassifierEngine(std::string name):
+		TestCase(name)
+{
+}
+
+void
+TestSignalClassifierEngine::setUp()
+{
+}
+
+void
+TestSignalClassifierEngine::tearDown()
+{
+}
+
+/**
+ * Recent RFI and test signal mask results match single lookups.
+ */
+void
+TestSignalClassifierEngine::testMasks()
+{
+	srand(SEED);
+	vector<SignalDescription> sigs;
+	createSignals(sigs, SIGNALS);
+	vector<FrequencyBand> rfiBands, testBands;
+	createBands(rfiBands, MASK_BANDS);
+	createBands(testBands, MASK_BANDS / 10);
+	FrequencyMask *recentRfi = createMask(rfiBands);
+	FrequencyMask *testSignal = createMask(testBands);
+
+	SignalClassifierEngine engine;
+	for (int32_t i = 0; i < SIGNALS; ++i)
+		engine.addSignal(&sigs[i]);
+	engine.classify(recentRfi, testSignal, OBS_LEN);
+	cu_assert(engine.getCount() == SIGNALS);
+	int32_t rfi = 0, test = 0;
+	for (int32_t i = 0; i < SIGNALS; ++i) {
+		const SignalPath& path = sigs[i].path;
+		bool expected = recentRfi->isMasked(path.rfFreq,
+				HZ_TO_MHZ(path.width));
+		cu_assert(engine.isRecentRfi(i) == expected);
+		rfi += expected;
+		expected = testSignal->isMasked(path.rfFreq, HZ_TO_MHZ(path.width));
+		cu_assert(engine.isTestSignal(i) == expected);
+		test += expected;
+		cu_assert(!engine.isInBadBand(i));
+	}
+	// make sure both outcomes were exercised
+	cu_assert(rfi > 0 && rfi < SIGNALS);
+	cu_assert(test > 0 && test < SIGNALS);
+
+	// a mask which is not applied flags nothing
+	engine.classify(0, testSignal, OBS_LEN);
+	for (int32_t i = 0; i < SIGNALS; ++i)
+		cu_assert(!engine.isRecentRfi(i));
+	delete testSignal;
+	delete recentRfi;
+}
+
+/**
+ * Bad band results match a scan of every band, including drifting
+ * signals whose band edges the drift has crossed.
+ */
+void
+TestSignalClassifierEngine::testBadBands()
+{
+	srand(SEED + 1);
+	vector<SignalDescription> sigs;
+	createSignals(sigs, SIGNALS);
+	vector<FrequencyBand> bands;
+	createBands(bands, BAD_BANDS);
+	// a zero-width band and a band nested in another
+	bands[0].bandwidth = 0;
+	bands[2] = bands[1];
+	bands[2].bandwidth /= 3;
+
+	SignalClassifierEngine engine;
+	for (int32_t i = 0; i < SIGNALS; ++i)
+		engine.addSignal(&sigs[i]);
+	for (int32_t j = 0; j < BAD_BANDS; ++j)
+		engine.addBadBand(bands[j]);
+	engine.classify(0, 0, OBS_LEN);
+	int32_t bad = 0;
+	for (int32_t i = 0; i < SIGNALS; ++i) {
+		bool expected = inBadBand(sigs[i], bands);
+		cu_assert(engine.isInBadBand(i) == expected);
+		cu_assert(!engine.isRecentRfi(i) && !engine.isTestSignal(i));
+		bad += expected;
+	}
+	cu_assert(bad > 0 && bad < SIGNALS);
+
+	// a signal whose negative drift moves its low edge above its high
+	// edge lies only in bands which contain both edges, not in two
+	// overlapping bands which together do
+	SignalDescription sig;
+	sig.path.rfFreq = 1000;
+	sig.path.width = 10;
+	sig.path.drift = -1;
+	FrequencyBand wide, lower, upper;
+	wide.centerFreq = 1000 + HZ_TO_MHZ(50);
+	wide.bandwidth = HZ_TO_MHZ(200);
+	lower.centerFreq = 1000 + HZ_TO_MHZ(15);
+	lower.bandwidth = HZ_TO_MHZ(90);
+	upper.centerFreq = 1000 + HZ_TO_MHZ(80);
+	upper.bandwidth = HZ_TO_MHZ(60);
+	cu_assert(match(sig, wide, OBS_LEN));
+	cu_assert(!match(sig, lower, OBS_LEN));
+	cu_assert(!match(sig, upper, OBS_LEN));
+	engine.clear();
+	engine.addSignal(&sig);
+	engine.addBadBand(lower);
+	engine.addBadBand(upper);
+	engine.classify(0, 0, OBS_LEN);
+	cu_assert(!engine.isInBadBand(0));
+	engine.addBadBand(wide);
+	engine.classify(0, 0, OBS_LEN);
+	cu_assert(engine.isInBadBand(0));
+	cu_assert(SignalClassifierEngine::match(sig, wide, OBS_LEN));
+	cu_assert(!SignalClassifierEngine::match(sig, lower, OBS_LEN));
+
+	// a drifting signal whose high edge lies above that of the next
+	// signal in frequency
+	SignalDescription drifting, next;
+	drifting.path.rfFreq = 1000;
+	drifting.path.width = 0;
+	drifting.path.drift = 1;
+	next.path.rfFreq = 1000 + HZ_TO_MHZ(10);
+	next.path.width = 0;
+	next.path.drift = 0;
+	FrequencyBand between;
+	between.centerFreq = 1000 + HZ_TO_MHZ(55);
+	between.bandwidth = HZ_TO_MHZ(10);
+	engine.clear();
+	engine.addSignal(&next);
+	engine.addSignal(&drifting);
+	engine.addBadBand(between);
+	engine.classify(0, 0, OBS_LEN);
+	cu_assert(!engine.isInBadBand(0));
+	cu_assert(engine.isInBadBand(1));
+}
+
+/**
+ * An engine with no signals, or no bands, classifies nothing.
+ */
+void
+TestSignalClassifierEngine::testEmpty()
+{
+	SignalClassifierEngine engine;
+	engine.classify(0, 0, OBS_LEN);
+	cu_assert(engine.getCount() == 0);
+
+	SignalDescription sig;
+	sig.path.rfFreq = CENTER_FREQ;
+	engine.addSignal(&sig);
+	engine.classify(0, 0, OBS_LEN);
+	cu_assert(engine.getCount() == 1);
+	cu_assert(!engine.isRecentRfi(0));
+	cu_assert(!engine.isTestSignal(0));
+	cu_assert(!engine.isInBadBand(0));
+}
+
+Test *
+TestSignalClassifierEngine::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestSignalClassifierEngine");
+
+	testSuite->addTest(new TestCaller<TestSignalClassifierEngine>(
+			"testMasks",
+			&TestSignalClassifierEngine::testMasks));
+	testSuite->addTest(new TestCaller<TestSignalClassifierEngine>(
+			"testBadBands",
+			&TestSignalClassifierEngine::testBadBands));
+	testSuite->addTest(new TestCaller<TestSignalClassifierEngine>(
+			"testEmpty",
+			&TestSignalClassifierEngine::testEmpty));
+	return (testSuite);
+}
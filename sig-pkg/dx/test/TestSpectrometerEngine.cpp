@@ -0,0 +1,320 @@
+/*******************************************************************************
+
+ File:    TestSpectrometerEngine.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit tests for the spectrometer engine
+//
+// Each test runs the same Gaussian noise half frames through a serial
+// (single worker) engine and a parallel engine and checks that the
+// baselines, CD data, CW data and pulse lists are identical.
+//
+#include <algorithm>
+#include <deque>
+#include <string.h>
+#include "TestRunner.h"
+#include "TestSpectrometerEngine.h"
+#include "Gaussian.h"
+#include "SpectrometerEngine.h"
+
+using namespace dx;
+using std::deque;
+using std::vector;
+
+namespace {
+
+const int32_t PARALLEL_WORKERS = 4;
+const int32_t SUBCHANNELS = 16;
+const int32_t SAMPLES = 512;
+const int32_t BASELINE_HALF_FRAMES = 4;
+const int32_t HALF_FRAMES = 8;
+const int32_t SEED = 1;
+const float64_t BANDWIDTH_MHZ = 0.001;
+
+/**
+ * Output of a complete run of the engine.
+ */
+struct EngineOutput {
+	int32_t hits;
+	PulseList pulses;
+	vector<float32_t> bl[POLARIZATIONS];
+	vector<uint8_t> cd[POLARIZATIONS];
+	vector<uint8_t> cw[POLARIZATIONS];
+
+	EngineOutput(): hits(0) {}
+};
+
+/**
+ * Create the parameters for a 16-subchannel activity with 1, 2 and
+ * 4Hz resolutions and CW at 1Hz.
+ */
+SpecEngineParams
+createParams()
+{
+	SpecEngineParams params;
+	params.subchannels = SUBCHANNELS;
+	params.samples = SAMPLES;
+	params.hfBytesPerSubchannel = SAMPLES * sizeof(ComplexFloat32);
+	params.cdBytesPerSubchannelHalfFrame = SAMPLES * sizeof(ComplexPair);
+	params.cdBytesPerSubchannel = HALF_FRAMES
+			* params.cdBytesPerSubchannelHalfFrame;
+	params.resolutions = 3;
+	for (int32_t i = 0; i < params.resolutions; ++i) {
+		Resolution res = (Resolution) (RES_1HZ + i);
+		params.resData[i].res = res;
+		params.resData[i].fftLen = (2 * SAMPLES) >> i;
+		params.resData[i].overlap = true;
+		params.totalBins[res] = params.resData[i].fftLen;
+		params.usableBins[res] = params.totalBins[res] * 3 / 4;
+	}
+	params.obs.cwResolution = RES_1HZ;
+	params.cwBytesPerSubchannel = params.usableBins[RES_1HZ]
+			/ CWD_BINS_PER_BYTE;
+	params.cwBytesPerSpectrum = SUBCHANNELS * params.cwBytesPerSubchannel;
+	params.cwBufSize = params.cwBytesPerSubchannel;
+	params.obs.baselineWeighting = 0.9;
+	params.obs.pulseThreshold = 6.0;
+	params.obs.maxPulsesPerHalfFrame = 100000;
+	params.obs.maxPulsesPerSubchannelPerHalfFrame = 100000;
+	params.masked.resize(SUBCHANNELS, false);
+	params.masked[3] = true;
+	return (params);
+}
+
+/**
+ * Run the engine over a set of Gaussian noise half frames.
+ *
+ * Description:\n
+ * 	Manages the half frame buffers the same way the spectrometer does:
+ * 	during baselining each buffer is released immediately, and after
+ * 	spectra have been computed all but the last buffer are released.
+ */
+void
+runEngine(int32_t workers, const SpecEngineParams& params,
+		EngineOutput& out)
+{
+	SpectrometerEngine engine(workers, WORKER_PRIO, false);
+
+	ResInfo resInfo[MAX_RESOLUTIONS];
+	engine.setup(params, resInfo);
+
+	int32_t hfLen = params.subchannels * params.samples;
+	int32_t spectra = HALF_FRAMES + resInfo[0].nSpectra;
+	ComplexFloat32 *hfBuf[POLARIZATIONS][HALF_FRAME_BUFFERS];
+	gauss::Gaussian gen[POLARIZATIONS];
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		gen[p].setup(SEED + p, BANDWIDTH_MHZ, 1.0);
+		for (int32_t i = 0; i < HALF_FRAME_BUFFERS; ++i) {
+			hfBuf[p][i] = static_cast<ComplexFloat32 *>
+					(fftwf_malloc(hfLen * sizeof(ComplexFloat32)));
+		}
+		out.bl[p].assign(params.subchannels, 0.0);
+		out.cd[p].assign(params.subchannels * params.cdBytesPerSubchannel, 0);
+		out.cw[p].assign(spectra * params.cwBytesPerSpectrum, 0);
+	}
+
+	SpecHalfFrame frame;
+	frame.pol[0].pol = POL_RIGHTCIRCULAR;
+	frame.pol[1].pol = POL_LEFTCIRCULAR;
+	deque<int32_t> bufs;
+	int32_t baselineHf = 0;
+	for (int32_t hf = -BASELINE_HALF_FRAMES; hf < HALF_FRAMES; ++hf) {
+		// get a free buffer and fill it with noise
+		int32_t buf = 0;
+		while (std::find(bufs.begin(), bufs.end(), buf) != bufs.end())
+			++buf;
+		bufs.push_back(buf);
+		for (int32_t p = 0; p < POLARIZATIONS; ++p)
+			gen[p].getSamples(hfBuf[p][buf], hfLen);
+
+		frame.hf = hf;
+		frame.seed = hf + 1;
+		frame.baselineHf = baselineHf++;
+		frame.hfBufs = bufs.size();
+		for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+			SpecPolData& pd = frame.pol[p];
+			for (int32_t i = 0; i < frame.hfBufs; ++i)
+				pd.hfData[i] = hfBuf[p][bufs[i]];
+			pd.blData = &out.bl[p][0];
+			pd.cdData = &out.cd[p][0];
+			pd.cwData = &out.cw[p][0];
+		}
+		out.hits += engine.processHalfFrame(frame, out.pulses);
+
+		if (hf < 0)
+			bufs.pop_front();
+		else if (frame.hfBufs >= params.spectraHalfFrames) {
+			for (int32_t i = 0; i < params.spectraHalfFrames - 1; ++i)
+				bufs.pop_front();
+			for (int32_t i = 0; i < params.resolutions; ++i)
+				frame.spectrum[i] += resInfo[i].nSpectra;
+		}
+	}
+
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		for (int32_t i = 0; i < HALF_FRAME_BUFFERS; ++i)
+			fftwf_free(hfBuf[p][i]);
+	}
+}
+
+bool
+samePulses(const PulseList& a, const PulseList& b)
+{
+	if (a.size() != b.size())
+		return (false);
+	for (uint32_t i = 0; i < a.size(); ++i) {
+		if (a[i].pol != b[i].pol || a[i].res != b[i].res
+				|| a[i].bin != b[i].bin || a[i].spectrum != b[i].spectrum
+				|| a[i].power != b[i].power)
+			return (false);
+	}
+	return (true);
+}
+
+bool
+sameOutput(const EngineOutput& serial, const EngineOutput& parallel)
+{
+	if (serial.hits != parallel.hits
+			|| !samePulses(serial.pulses, parallel.pulses))
+		return (false);
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		if (serial.bl[p] != parallel.bl[p] || serial.cd[p] != parallel.cd[p]
+				|| serial.cw[p] != parallel.cw[p])
+			return (false);
+	}
+	return (true);
+}
+
+}
+
+TestSpectrometerEngine::TestSpectrometerEngine(std::string name):
+		TestCase(name)
+{
+}
+
+void
+TestSpectrometerEngine::setUp()
+{
+}
+
+void
+TestSpectrometerEngine::tearDown()
+{
+}
+
+/**
+ * A parallel engine must produce exactly the same output as a serial one.
+ */
+void
+TestSpectrometerEngine::testSerialParallel()
+{
+	SpecEngineParams params = createParams();
+	EngineOutput serial, parallel;
+	runEngine(1, params, serial);
+	runEngine(PARALLEL_WORKERS, params, parallel);
+
+	// noise alone must produce some pulses, none in the masked subchannel
+	cu_assert(serial.pulses.size() > 0);
+	cu_assert(serial.hits == (int32_t) serial.pulses.size());
+	for (uint32_t i = 0; i < serial.pulses.size(); ++i) {
+		const dx::Pulse& pulse = serial.pulses[i];
+		int32_t bins = params.usableBins[pulse.res];
+		cu_assert(pulse.bin / bins != 3);
+	}
+	cu_assert(sameOutput(serial, parallel));
+}
+
+/**
+ * The pulse limits must be applied in subchannel order, independent of
+ * the order in which the workers finish.
+ */
+void
+TestSpectrometerEngine::testPulseLimits()
+{
+	SpecEngineParams params = createParams();
+	params.obs.pulseThreshold = 4.0;
+	params.obs.maxPulsesPerHalfFrame = 50;
+	params.obs.maxPulsesPerSubchannelPerHalfFrame = 2;
+	EngineOutput serial, parallel;
+	runEngine(1, params, serial);
+	runEngine(PARALLEL_WORKERS, params, parallel);
+
+	cu_assert(serial.hits > (int32_t) serial.pulses.size());
+	cu_assert(serial.pulses.size() <= (uint32_t) (HALF_FRAMES * POLARIZATIONS
+			* params.obs.maxPulsesPerHalfFrame));
+	cu_assert(sameOutput(serial, parallel));
+}
+
+/**
+ * Tagged CD and CW data must be stored at the correct location.
+ */
+void
+TestSpectrometerEngine::testTaggedData()
+{
+	SpecEngineParams params = createParams();
+	params.obs.cdOutputOption = tagged_data;
+	params.obs.cwOutputOption = tagged_data;
+	EngineOutput serial, parallel;
+	runEngine(1, params, serial);
+	runEngine(PARALLEL_WORKERS, params, parallel);
+	cu_assert(sameOutput(serial, parallel));
+
+	// check the first CW word of subchannel 5, spectrum 2
+	int32_t subchannel = 5, spectrum = 2;
+	const uint64_t *cw = reinterpret_cast<const uint64_t *>
+			(&serial.cw[0][spectrum * params.cwBytesPerSpectrum
+			+ subchannel * params.cwBytesPerSubchannel]);
+	cu_assert(cw[0] == (((uint64_t) subchannel << 48)
+			| ((uint64_t) spectrum << 32)));
+	cu_assert(cw[1] == cw[0] + sizeof(uint64_t) * CWD_BINS_PER_BYTE);
+
+	// check the first CD word of subchannel 5, half frame 1
+	int32_t hf = 1;
+	const uint32_t *cd = reinterpret_cast<const uint32_t *>
+			(&serial.cd[0][subchannel * params.cdBytesPerSubchannel
+			+ hf * params.cdBytesPerSubchannelHalfFrame]);
+	cu_assert(cd[0] == (uint32_t) (((hf + 1) << 8) | (subchannel << 16)));
+}
+
+Test *
+TestSpectrometerEngine::suite()
+{
+	TestSuite *testSuite = new TestSuite("TestSpectrometerEngine");
+
+	testSuite->addTest(new TestCaller<TestSpectrometerEngine>(
+			"testSerialParallel",
+			&TestSpectrometerEngine::testSerialParallel));
+	testSuite->addTest(new TestCaller<TestSpectrometerEngine>(
+			"testPulseLimits",
+			&TestSpectrometerEngine::testPulseLimits));
+	testSuite->addTest(new TestCaller<TestSpectrometerEngine>(
+			"testTaggedData",
+			&TestSpectrometerEngine::testTaggedData));
+	return (testSuite);
+}
@@ -0,0 +1,159 @@
+/*******************************************************************************
+
+ File:    classifierBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Signal classifier benchmark: compares testing each candidate on its
+// own against the recent RFI mask, the test signal mask and every bad
+// band, as the classifier formerly did, with the signal classifier
+// engine, for candidate counts into the tens of thousands.  Reports
+// the fastest of several passes in microseconds per activity, and the
+// number of candidates whose results differ.
+//
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "SignalClassifierEngine.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t PASSES = 5;
+const int32_t MASK_BANDS = 2000;
+const int32_t TEST_BANDS = 20;
+const int32_t BAD_BANDS = 500;
+const float64_t CENTER_FREQ = 1420.0;		// MHz
+const float64_t BANDWIDTH = 20.0;			// MHz
+const float64_t OBS_LEN = 98.0;				// seconds
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+static float64_t
+uniform(float64_t lo, float64_t hi)
+{
+	return (lo + (hi - lo) * rand() / RAND_MAX);
+}
+
+static void
+createBands(vector<FrequencyBand>& bands, int32_t n, float64_t maxWidth)
+{
+	bands.resize(n);
+	for (int32_t i = 0; i < n; ++i) {
+		bands[i].centerFreq = uniform(CENTER_FREQ - BANDWIDTH / 2,
+				CENTER_FREQ + BANDWIDTH / 2);
+		bands[i].bandwidth = uniform(0, maxWidth);
+	}
+}
+
+static bool
+inBadBand(const SignalDescription& sig, const vector<FrequencyBand>& bands)
+{
+	for (uint32_t j = 0; j < bands.size(); ++j) {
+		if (SignalClassifierEngine::match(sig, bands[j], OBS_LEN))
+			return (true);
+	}
+	return (false);
+}
+
+int
+main(int argc, char **argv)
+{
+	const int32_t signals[] = { 100, 1000, 10000, 50000 };
+
+	srand(1);
+	FrequencyBand covered;
+	covered.centerFreq = CENTER_FREQ;
+	covered.bandwidth = BANDWIDTH;
+	vector<FrequencyBand> rfiBands, testBands, badBands;
+	createBands(rfiBands, MASK_BANDS, 1e-3);
+	createBands(testBands, TEST_BANDS, 1e-4);
+	createBands(badBands, BAD_BANDS, 2e-3);
+	FrequencyMask recentRfi(rfiBands.size(), &rfiBands[0], covered);
+	FrequencyMask testSignal(testBands.size(), &testBands[0], covered);
+
+	cout << MASK_BANDS << " recent RFI bands, " << TEST_BANDS
+			<< " test signal bands, " << BAD_BANDS << " bad bands" << endl;
+	cout << "signals\tsingle us\tengine us\tmismatches" << endl;
+	for (uint32_t s = 0; s < sizeof(signals) / sizeof(signals[0]); ++s) {
+		int32_t n = signals[s];
+		vector<SignalDescription> sigs(n);
+		for (int32_t i = 0; i < n; ++i) {
+			sigs[i].path.rfFreq = uniform(CENTER_FREQ - BANDWIDTH / 2,
+					CENTER_FREQ + BANDWIDTH / 2);
+			sigs[i].path.width = uniform(0, 100);
+			sigs[i].path.drift = uniform(-1, 1);
+		}
+
+		vector<uint8_t> single(n), batch(n);
+		SignalClassifierEngine engine;
+		float64_t singleBest = 1e9, engineBest = 1e9;
+		for (int32_t p = 0; p < PASSES; ++p) {
+			float64_t t0 = now();
+			for (int32_t i = 0; i < n; ++i) {
+				const SignalPath& path = sigs[i].path;
+				single[i] = recentRfi.isMasked(path.rfFreq,
+						HZ_TO_MHZ(path.width))
+						| testSignal.isMasked(path.rfFreq,
+						HZ_TO_MHZ(path.width)) << 1
+						| inBadBand(sigs[i], badBands) << 2;
+			}
+			float64_t t1 = now();
+			engine.clear();
+			for (int32_t i = 0; i < n; ++i)
+				engine.addSignal(&sigs[i]);
+			for (int32_t j = 0; j < BAD_BANDS; ++j)
+				engine.addBadBand(badBands[j]);
+			engine.classify(&recentRfi, &testSignal, OBS_LEN);
+			for (int32_t i = 0; i < n; ++i) {
+				batch[i] = engine.isRecentRfi(i)
+						| engine.isTestSignal(i) << 1
+						| engine.isInBadBand(i) << 2;
+			}
+			float64_t t2 = now();
+			singleBest = std::min(singleBest, t1 - t0);
+			engineBest = std::min(engineBest, t2 - t1);
+		}
+		int32_t mismatches = 0;
+		for (int32_t i = 0; i < n; ++i)
+			mismatches += (single[i] != batch[i]);
+
+		cout << n << "\t" << singleBest * 1e6 << "\t" << engineBest * 1e6
+				<< "\t" << mismatches << endl;
+	}
+}
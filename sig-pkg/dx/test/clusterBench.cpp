@@ -0,0 +1,251 @@
+/*******************************************************************************
+
+ File:    clusterBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW clustering benchmark: compares the original hit recording path
+// (one lock and one multimap insertion per hit, clustering by walking
+// the map) with the current path (lock-free append to a per-thread
+// buffer, radix sort and linear sweep when all hits are loaded).  Hits
+// are recorded by one thread, as by the CWD merge, and by several
+// threads at once.  Reports nanoseconds per hit to record and to
+// cluster.
+//
+#include <iostream>
+#include <map>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "CwClusterer.h"
+#include "Lock.h"
+#include "SuperClusterer.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::multimap;
+using std::vector;
+
+const int32_t BINS = 1 << 20;
+const int32_t MAX_DRIFT = 512;
+const int32_t MAX_POWER = 1000;
+const int32_t CLUSTER_RANGE = 3;
+const int32_t MAX_THREADS = 4;
+const int32_t PASSES = 3;
+
+struct Hit
+{
+	int32_t startBin, drift, power;
+
+	Hit(): startBin(0), drift(0), power(0) {}
+	Hit(int32_t startBin_, int32_t drift_, int32_t power_):
+			startBin(startBin_), drift(drift_), power(power_) {}
+};
+
+/**
+ * Original clusterer: hits are inserted into a multimap under a lock.
+ */
+class MapClusterer {
+public:
+	void recordHit(int startBin, int drift, int power)
+	{
+		float midBin = startBin + (drift + 0.5)/2;
+		l.lock();
+		hitList.insert(std::pair<float,Hit>(midBin,
+				Hit(startBin, drift, power)));
+		l.unlock();
+	}
+
+	void allHitsLoaded()
+	{
+		bool first = true;
+		float loBin = 0, hiBin = 0;
+		Hit hit;
+		l.lock();
+		multimap<float,Hit>::iterator i;
+		for (i = hitList.begin(); i != hitList.end(); ++i) {
+			if (first || i->first > hiBin + CLUSTER_RANGE) {
+				if (!first)
+					clusterDone(hit, loBin, hiBin);
+				first = false;
+				hit = i->second;
+				loBin = i->first;
+			}
+			else if (i->second.power > hit.power)
+				hit = i->second;
+			hiBin = i->first;
+		}
+		if (!first)
+			clusterDone(hit, loBin, hiBin);
+		l.unlock();
+	}
+
+	void clearHits()
+	{
+		hitList.clear();
+		clusterList.clear();
+	}
+
+private:
+	Lock l;
+	multimap<float,Hit> hitList;
+	vector<CwPowerSignal> clusterList;
+
+	// same results as CwClusterer
+	void clusterDone(const Hit& hit, float loBin, float hiBin)
+	{
+		CwPowerSignal cw;
+		cw.sig.path.rfFreq = hit.startBin;
+		cw.sig.path.drift = hit.drift;
+		cw.sig.path.width = 1 + hiBin - loBin;
+		cw.sig.path.power = hit.power;
+		clusterList.push_back(cw);
+	}
+};
+
+struct ThreadArgs
+{
+	MapClusterer *map;
+	CwClusterer *cw;
+	const vector<Hit> *hits;
+	int32_t first;
+	int32_t stride;
+};
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Create hits grouped around signals, in no particular order.
+ */
+static void
+createHits(vector<Hit>& hits, int32_t n)
+{
+	srand(1);
+	hits.clear();
+	int32_t bin = 0;
+	for (int32_t i = 0; i < n; ++i) {
+		if (rand() % 8 == 0)
+			bin = rand() % BINS;
+		int32_t drift = rand() % (2 * MAX_DRIFT + 1) - MAX_DRIFT;
+		hits.push_back(Hit(bin + rand() % (2 * CLUSTER_RANGE), drift,
+				rand() % MAX_POWER));
+	}
+}
+
+static void *
+recordThread(void *arg)
+{
+	ThreadArgs *a = static_cast<ThreadArgs *> (arg);
+	const vector<Hit>& hits = *a->hits;
+	for (uint32_t i = a->first; i < hits.size(); i += a->stride) {
+		if (a->map)
+			a->map->recordHit(hits[i].startBin, hits[i].drift, hits[i].power);
+		else
+			a->cw->recordHit(hits[i].startBin, hits[i].drift, hits[i].power);
+	}
+	return (0);
+}
+
+/**
+ * Record the hits from the specified number of threads.
+ */
+static void
+record(MapClusterer *map, CwClusterer *cw, const vector<Hit>& hits,
+		int32_t threads)
+{
+	pthread_t tid[MAX_THREADS];
+	ThreadArgs args[MAX_THREADS];
+	for (int32_t i = 0; i < threads; ++i) {
+		args[i].map = map;
+		args[i].cw = cw;
+		args[i].hits = &hits;
+		args[i].first = i;
+		args[i].stride = threads;
+		if (threads > 1)
+			pthread_create(&tid[i], 0, recordThread, &args[i]);
+		else
+			recordThread(&args[i]);
+	}
+	for (int32_t i = 0; threads > 1 && i < threads; ++i)
+		pthread_join(tid[i], 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	const int32_t hitCounts[] = { 1000, 10000, 100000, 1000000 };
+	const int32_t threadCounts[] = { 1, MAX_THREADS };
+
+	SuperClusterer super;
+	CwClusterer cw(&super, POL_RIGHTCIRCULAR);
+	cw.setClusterRange(CLUSTER_RANGE);
+	MapClusterer map;
+
+	cout << "ns per hit" << endl;
+	cout << "hits\tthreads\tmap rec\tmap clust\tcw rec\tcw clust" << endl;
+	for (uint32_t h = 0; h < sizeof(hitCounts) / sizeof(hitCounts[0]); ++h) {
+		vector<Hit> hits;
+		createHits(hits, hitCounts[h]);
+		for (uint32_t t = 0; t < sizeof(threadCounts) /
+				sizeof(threadCounts[0]); ++t) {
+			float64_t mapRec = 0, mapClust = 0, cwRec = 0, cwClust = 0;
+			int32_t threads = threadCounts[t];
+			for (int32_t p = 0; p < PASSES; ++p) {
+				float64_t t0 = now();
+				record(&map, 0, hits, threads);
+				float64_t t1 = now();
+				map.allHitsLoaded();
+				float64_t t2 = now();
+				map.clearHits();
+				mapRec += t1 - t0;
+				mapClust += t2 - t1;
+
+				t0 = now();
+				record(0, &cw, hits, threads);
+				t1 = now();
+				cw.allHitsLoaded();
+				t2 = now();
+				cw.clearHits();
+				cwRec += t1 - t0;
+				cwClust += t2 - t1;
+			}
+			float64_t scale = 1e9 / ((float64_t) PASSES * hits.size());
+			cout << hits.size() << "\t" << threads << "\t" << mapRec * scale
+					<< "\t" << mapClust * scale << "\t" << cwRec * scale
+					<< "\t" << cwClust * scale << endl;
+		}
+	}
+}
@@ -0,0 +1,185 @@
+/*******************************************************************************
+
+ File:    coherentBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW coherent search benchmark: compares the original serial drift
+// search, which used an FFTW_ESTIMATE plan, with the coherent search
+// engine for several numbers of workers, for the signal lengths of a
+// range of observation lengths.  The signal is a drifting CW signal in
+// Gaussian noise.  Reports the fastest of several searches in
+// milliseconds and the drift found.
+//
+#include <fftw3.h>
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "CwCoherentEngine.h"
+#include "Gaussian.h"
+#include "Statistics.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t PASSES = 3;
+const float64_t SNR = 20;
+const float64_t FREQ = 10.3;
+const float64_t DRIFT = 21;
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Dedrift of the original search.
+ */
+static void
+dedriftFTPlane(ComplexFloat32 *ftp, int32_t samples, float64_t drift)
+{
+	drift *= M_PI;
+
+	ComplexFloat32 ei2b = ComplexFloat32(cos(2 * drift), -sin(2 * drift));
+	ComplexFloat32 ei2tbp1pa = ComplexFloat32(cos(drift), -sin(drift));
+	ComplexFloat32 eitsq = ComplexFloat32(1, 0);
+
+	for (int32_t sample = 0; sample < samples; sample++) {
+		ftp[sample] *= eitsq;
+		eitsq *= ei2tbp1pa;
+		ei2tbp1pa *= ei2b;
+	}
+}
+
+/**
+ * Original search.
+ */
+static CoherentReport
+searchSerial(const ComplexFloat32 *td, ComplexFloat32 *dd, ComplexFloat32 *fd,
+		fftwf_plan plan, int32_t samples)
+{
+	int32_t middle = samples / 2;
+	int32_t len = samples * sizeof(ComplexFloat32);
+	int32_t hLen = len / 2;
+	float32_t factor = 1 / sqrt(samples);
+
+	ComplexFloat32 temp[samples/2];
+	CoherentReport best;
+	for (int32_t drift = -(samples - 1); drift <= samples - 1; drift++) {
+		memcpy(dd, td, len);
+		dedriftFTPlane(dd, samples, (float64_t) drift / (samples * samples));
+		fftwf_execute_dft(plan, (fftwf_complex *) dd, (fftwf_complex *) fd);
+		for (int32_t i = 0; i < samples; ++i)
+			fd[i] *= factor;
+		memcpy(temp, &fd[0], hLen);
+		memcpy(&fd[0], &fd[middle], hLen);
+		memcpy(&fd[middle], temp, hLen);
+		ChiReport chi = CwCoherentEngine::checkCoherence(fd, 1.0, samples,
+				drift, samples / 2, samples);
+		if (chi.chiSq < best.chi.chiSq) {
+			best.chi = chi;
+			best.microDrift = drift;
+		}
+	}
+	best.chi.chiSq = ChiSquare(2 * best.chi.clusterWidth,
+			2 * best.chi.power);
+	best.signif = best.chi.chiSq;
+	return (best);
+}
+
+int
+main(int argc, char **argv)
+{
+	int32_t maxWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+	if (argc > 1)
+		maxWorkers = atoi(argv[1]);
+	vector<int32_t> workers;
+	for (int32_t w = 1; w < maxWorkers; w *= 2)
+		workers.push_back(w);
+	workers.push_back(maxWorkers);
+
+	cout << "samples\tserial";
+	for (uint32_t w = 0; w < workers.size(); ++w)
+		cout << "\t" << workers[w] << " wkr";
+	cout << "\tdrift" << endl;
+
+	const int32_t lengths[] = { 128, 256, 512, 1024 };
+	for (uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+		int32_t samples = lengths[l];
+		size_t size = samples * sizeof(ComplexFloat32);
+		ComplexFloat32 *td = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
+		ComplexFloat32 *dd = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
+		ComplexFloat32 *fd = static_cast<ComplexFloat32 *> (fftwf_malloc(size));
+		gauss::Gaussian gen;
+		gen.setup(1, samples / 1e6, 1.0);
+		gen.addCwSignal(FREQ / 1e6, DRIFT, SNR);
+		gen.getSamples(td, samples);
+
+		fftwf_plan plan = fftwf_plan_dft_1d(samples, (fftwf_complex *) dd,
+				(fftwf_complex *) fd, FFTW_FORWARD, FFTW_ESTIMATE);
+		float64_t best = 1e9;
+		CoherentReport report;
+		for (int32_t p = 0; p < PASSES; ++p) {
+			float64_t t0 = now();
+			report = searchSerial(td, dd, fd, plan, samples);
+			best = std::min(best, now() - t0);
+		}
+		fftwf_destroy_plan(plan);
+		cout << samples << "\t" << best * 1e3;
+
+		bool same = true;
+		for (uint32_t w = 0; w < workers.size(); ++w) {
+			CwCoherentEngine engine(workers[w], CWD_CONFIRMATION_PRIO, false);
+			engine.setup(samples);
+			best = 1e9;
+			CoherentReport r;
+			for (int32_t p = 0; p < PASSES; ++p) {
+				float64_t t0 = now();
+				r = engine.search(td);
+				best = std::min(best, now() - t0);
+			}
+			same &= (r.microDrift == report.microDrift);
+			cout << "\t" << best * 1e3;
+		}
+		cout << "\t" << report.microDrift << (same ? "" : " (differs)")
+				<< endl;
+
+		fftwf_free(fd);
+		fftwf_free(dd);
+		fftwf_free(td);
+	}
+}
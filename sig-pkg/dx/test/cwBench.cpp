@@ -0,0 +1,104 @@
+/*******************************************************************************
+
+ File:    cwBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW power benchmark: reports the throughput of each CW power kernel
+// supported by the processor, in millions of bins per second, with and
+// without the Hanning window, for the bins of a single 1Hz subchannel
+// spectrum and for a block too large for the first-level cache.
+//
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "CwKernel.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t SMALL_WORDS = 1024 / CW_BINS_PER_WORD;
+const int32_t LARGE_WORDS = 65536 / CW_BINS_PER_WORD;
+const int64_t BENCH_BINS = 500000000;
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+static float64_t
+bench(CwPackFunc pack, const ComplexFloat32 *data, uint64_t *out,
+		int32_t words)
+{
+	int32_t bins = words * CW_BINS_PER_WORD;
+	int32_t passes = (int32_t) (BENCH_BINS / bins);
+	pack(out, data, words);
+	float64_t t0 = now();
+	for (int32_t i = 0; i < passes; ++i)
+		pack(out, data, words);
+	float64_t t = now() - t0;
+	return ((float64_t) passes * bins / t / 1e6);
+}
+
+int
+main(int argc, char **argv)
+{
+	// noise with a mean power of 1, plus the bins on either side
+	int32_t bins = LARGE_WORDS * CW_BINS_PER_WORD + 2;
+	vector<ComplexFloat32> data(bins);
+	for (int32_t i = 0; i < bins; ++i) {
+		float64_t a = sqrt(-log((rand() + 1.0) / (RAND_MAX + 2.0)));
+		float64_t phase = 2 * M_PI * rand() / RAND_MAX;
+		data[i] = ComplexFloat32(a * cos(phase), a * sin(phase));
+	}
+	vector<uint64_t> out(LARGE_WORDS);
+
+	cout << "Mbins/s" << endl;
+	cout << "kernel\tbins\tpack\thanning" << endl;
+	const CwKernelType types[] = { ScalarCwKernel, Sse2CwKernel,
+			Avx2CwKernel };
+	const int32_t sizes[] = { SMALL_WORDS, LARGE_WORDS };
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const CwKernel *k = getCwKernel(types[t]);
+		if (!k)
+			continue;
+		for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+			cout << k->name << "\t" << sizes[s] * CW_BINS_PER_WORD << "\t"
+					<< bench(k->pack, &data[1], &out[0], sizes[s]) << "\t"
+					<< bench(k->packHanning, &data[1], &out[0], sizes[s])
+					<< endl;
+		}
+	}
+}
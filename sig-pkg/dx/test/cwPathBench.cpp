@@ -0,0 +1,166 @@
+/*******************************************************************************
+
+ File:    cwPathBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// CW power path search benchmark: compares the original search, which
+// computed every path sum separately with the offsets recomputed for
+// each path, with the block search, for the signal channel widths of
+// the confirmation resolutions and a range of observation lengths.
+// The planes contain Gaussian noise, with or without a CW signal.
+// Reports the fastest of several searches in microseconds, and the
+// fraction of blocks pruned.
+//
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "CwPathSearch.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t PASSES = 5;
+const float32_t SNR = 1.0;
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Original search.
+ */
+static int32_t
+computeTruePath(float32_t spectrum, float32_t spectra, float32_t drift)
+{
+	int32_t x = (int32_t) ((drift / spectra) * (spectrum + 0.5) + 0.5);
+	return (x);
+}
+
+static float32_t
+computePathSum(int32_t spectra, int32_t binsPerSpectrum, int32_t drift,
+		int32_t sign, const float32_t *pathBase)
+{
+	float32_t sum = 0;
+	for (int32_t spectrum = 0; spectrum < spectra; spectrum++) {
+		int32_t x = computeTruePath(spectrum, spectra, abs(drift));
+		sum += pathBase[spectrum*binsPerSpectrum+sign*x];
+	}
+	return (sum);
+}
+
+static CwPath
+originalSearch(const float32_t *pd, int32_t spectra, int32_t bins)
+{
+	CwPath temp;
+	for (int32_t bin = 0; bin < bins; ++bin) {
+		int32_t startDrift = -std::min(bin, spectra);
+		int32_t endDrift = std::min(bins - bin - 1, spectra);
+		for (int32_t drift = startDrift; drift <= endDrift; ++drift) {
+			int32_t sign = drift < 0 ? -1 : 1;
+			float32_t sum = computePathSum(spectra, bins, drift, sign,
+					&pd[bin]);
+			if (sum > temp.power)
+				temp = CwPath(bin, drift, sum);
+		}
+	}
+	return (temp);
+}
+
+/**
+ * Create a plane of exponentially distributed noise powers, with a CW
+ * signal from the lower quarter to the upper quarter if snr is nonzero.
+ */
+static void
+createPlane(vector<float32_t>& plane, int32_t spectra, int32_t bins,
+		float32_t snr)
+{
+	srand(1);
+	plane.resize(spectra * bins);
+	for (int32_t i = 0; i < spectra * bins; ++i)
+		plane[i] = -log((rand() + 1.0) / (RAND_MAX + 1.0));
+	if (snr) {
+		for (int32_t s = 0; s < spectra; ++s) {
+			int32_t bin = bins / 4 + (bins / 2) * s / spectra;
+			plane[s*bins+bin] += snr;
+		}
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	const int32_t binCounts[] = { 8, 16, 32 };
+	const int32_t spectraCounts[] = { 64, 128, 256, 512 };
+	const float32_t snrs[] = { 0, SNR };
+
+	CwPathSearch search;
+	cout << "us per search" << endl;
+	cout << "bins\tspectra\tsnr\toriginal\tblock\tspeedup\tpruned" << endl;
+	for (uint32_t b = 0; b < sizeof(binCounts) / sizeof(binCounts[0]); ++b) {
+		for (uint32_t s = 0; s < sizeof(spectraCounts) /
+				sizeof(spectraCounts[0]); ++s) {
+			for (uint32_t n = 0; n < sizeof(snrs) / sizeof(snrs[0]); ++n) {
+				int32_t bins = binCounts[b];
+				int32_t spectra = spectraCounts[s];
+				vector<float32_t> plane;
+				createPlane(plane, spectra, bins, snrs[n]);
+
+				// fastest of several passes
+				float64_t orig = 1e9, block = 1e9;
+				CwPath p0, p1;
+				for (int32_t p = 0; p < PASSES; ++p) {
+					float64_t t0 = now();
+					p0 = originalSearch(&plane[0], spectra, bins);
+					float64_t t1 = now();
+					p1 = search.search(&plane[0], spectra, bins);
+					float64_t t2 = now();
+					orig = std::min(orig, (t1 - t0) * 1e6);
+					block = std::min(block, (t2 - t1) * 1e6);
+				}
+				if (p0.bin != p1.bin || p0.drift != p1.drift
+						|| p0.power != p1.power)
+					cout << "paths differ" << endl;
+
+				cout << bins << "\t" << spectra << "\t" << snrs[n] << "\t"
+						<< orig << "\t" << block << "\t" << orig / block
+						<< "\t" << (float64_t) search.getPruned()
+						/ search.getBlocks() << endl;
+			}
+		}
+	}
+}
@@ -0,0 +1,158 @@
+/*******************************************************************************
+
+ File:    dedriftBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Dedrift benchmark: compares the single precision phase recurrence of
+// the original coherent confirmation dedrift with each dedrift kernel
+// supported by the processor, for the block lengths of coherent
+// confirmation and of archive channels.  Reports the fastest of several
+// passes in nanoseconds per sample, and the largest error of an output
+// sample relative to the input magnitude.  The original dedrift works in
+// place, so its time includes copying the samples, as in the original
+// coherent search.
+//
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "DedriftKernel.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t PASSES = 5;
+const int32_t MIN_SAMPLES = 1 << 22;	// minimum samples timed per pass
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Original dedrift: CwConfirmationTask::dedriftFTPlane for a single
+ * spectrum with no frequency shift, starting at the first sample.
+ */
+static void
+dedriftFTPlane(ComplexFloat32 *ftp, int32_t samples, float64_t drift)
+{
+	drift *= M_PI;
+
+	ComplexFloat32 ei2b = ComplexFloat32(cos(2 * drift), -sin(2 * drift));
+	ComplexFloat32 ei2tbp1pa = ComplexFloat32(cos(drift), -sin(drift));
+	ComplexFloat32 eitsq = ComplexFloat32(1, 0);
+
+	for (int32_t sample = 0; sample < samples; sample++) {
+		ftp[sample] *= eitsq;
+		eitsq *= ei2tbp1pa;
+		ei2tbp1pa *= ei2b;
+	}
+}
+
+static float64_t
+maxError(const vector<ComplexFloat32>& in, const vector<ComplexFloat32>& out,
+		float64_t freq, float64_t drift)
+{
+	float64_t maxErr = 0;
+	for (uint32_t i = 0; i < in.size(); ++i) {
+		float96_t t = i;
+		float96_t phase = fmodl(freq * t + drift * t * t, 2 * M_PI);
+		ComplexFloat96 expected = ComplexFloat96(in[i])
+				* ComplexFloat96(cosl(phase), sinl(phase));
+		float64_t err = abs(ComplexFloat96(out[i]) - expected) / abs(in[i]);
+		maxErr = std::max(maxErr, err);
+	}
+	return (maxErr);
+}
+
+int
+main(int argc, char **argv)
+{
+	const int32_t lengths[] = { 256, 1024, 65536, 1 << 20 };
+	const DedriftKernelType types[] = { ScalarDedriftKernel,
+			Sse2DedriftKernel, Avx2DedriftKernel };
+
+	cout << "ns per sample (max relative error)" << endl;
+	cout << "samples\toriginal";
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const DedriftKernel *k = getDedriftKernel(types[t]);
+		if (k)
+			cout << "\t" << k->name;
+	}
+	cout << endl;
+
+	for (uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+		int32_t n = lengths[l];
+		int32_t reps = std::max(1, MIN_SAMPLES / n);
+		vector<ComplexFloat32> in(n), out(n);
+		srand(1);
+		for (int32_t i = 0; i < n; ++i) {
+			in[i] = ComplexFloat32(2.0 * rand() / RAND_MAX - 1,
+					2.0 * rand() / RAND_MAX - 1);
+		}
+		// the largest drift of a coherent search of n samples
+		float64_t d = (float64_t) (n - 1) / ((float64_t) n * n);
+		float64_t drift = -M_PI * d;
+
+		float64_t best = 1e9;
+		for (int32_t p = 0; p < PASSES; ++p) {
+			float64_t t0 = now();
+			for (int32_t r = 0; r < reps; ++r) {
+				out = in;
+				dedriftFTPlane(&out[0], n, d);
+			}
+			best = std::min(best, now() - t0);
+		}
+		cout << n << "\t" << best / reps / n * 1e9 << " ("
+				<< maxError(in, out, 0, drift) << ")";
+
+		for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+			const DedriftKernel *k = getDedriftKernel(types[t]);
+			if (!k)
+				continue;
+			best = 1e9;
+			for (int32_t p = 0; p < PASSES; ++p) {
+				float64_t t0 = now();
+				for (int32_t r = 0; r < reps; ++r)
+					k->dedrift(&out[0], &in[0], n, 0, drift);
+				best = std::min(best, now() - t0);
+			}
+			cout << "\t" << best / reps / n * 1e9 << " ("
+					<< maxError(in, out, 0, drift) << ")";
+		}
+		cout << endl;
+	}
+}
@@ -0,0 +1,156 @@
+/*******************************************************************************
+
+ File:    maskBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Frequency mask benchmark: compares the linear scan formerly used by
+// FrequencyMask::isMasked with the interval index, one signal at a
+// time and as a batch of ordered frequencies, for masks of the sizes
+// of birdie, permanent and recent RFI masks.  The bands are ordered and
+// disjoint, as the linear scan requires, and spread over the band
+// covered by the mask; the signals are spread uniformly over the same
+// band.  Reports the fastest of several passes in nanoseconds per
+// signal, and the number of signals whose result differs from the
+// linear scan.
+//
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "FrequencyMask.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t PASSES = 5;
+const int32_t SIGNALS = 100000;
+const float64_t LO_FREQ = 1000.0;			// MHz
+const float64_t HI_FREQ = 11000.0;			// MHz
+const float64_t SIGNAL_WIDTH = 1e-6;		// MHz
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+static float64_t
+uniform(float64_t lo, float64_t hi)
+{
+	return (lo + (hi - lo) * rand() / RAND_MAX);
+}
+
+static bool
+linearScan(const vector<FrequencyBand>& mask, float64_t frequency,
+		float64_t width)
+{
+	float64_t loFreq = frequency - width / 2;
+	float64_t hiFreq = frequency + width / 2;
+	for (size_t i = 0; i < mask.size(); ++i) {
+		float64_t loMask = mask[i].centerFreq - mask[i].bandwidth / 2;
+		float64_t hiMask = mask[i].centerFreq + mask[i].bandwidth / 2;
+		if (hiFreq < loMask)
+			break;
+		if (loFreq <= hiMask && hiFreq >= loMask)
+			return (true);
+	}
+	return (false);
+}
+
+/**
+ * Create an ordered, disjoint mask covering about a tenth of the band.
+ */
+static void
+createMask(vector<FrequencyBand>& mask, int32_t bands)
+{
+	float64_t spacing = (HI_FREQ - LO_FREQ) / bands;
+	mask.resize(bands);
+	for (int32_t i = 0; i < bands; ++i) {
+		mask[i].centerFreq = LO_FREQ + (i + 0.5) * spacing;
+		mask[i].bandwidth = uniform(0, spacing / 5);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	const int32_t bands[] = { 16, 128, 1024, 4096, 16384 };
+
+	srand(1);
+	vector<float64_t> freq(SIGNALS);
+	for (int32_t i = 0; i < SIGNALS; ++i)
+		freq[i] = uniform(LO_FREQ, HI_FREQ);
+	vector<float64_t> sorted = freq;
+	std::sort(sorted.begin(), sorted.end());
+
+	cout << SIGNALS << " signals, ns per signal" << endl;
+	cout << "bands\tlinear\tindex\tbatch\tmismatches" << endl;
+	for (uint32_t b = 0; b < sizeof(bands) / sizeof(bands[0]); ++b) {
+		vector<FrequencyBand> mask;
+		createMask(mask, bands[b]);
+		FrequencyBand covered;
+		covered.centerFreq = (LO_FREQ + HI_FREQ) / 2;
+		covered.bandwidth = HI_FREQ - LO_FREQ;
+		FrequencyMask fm(bands[b], &mask[0], covered);
+
+		vector<bool> expected(SIGNALS), indexed(SIGNALS);
+		bool *batch = new bool[SIGNALS];
+		float64_t linearBest = 1e9, indexBest = 1e9, batchBest = 1e9;
+		for (int32_t p = 0; p < PASSES; ++p) {
+			float64_t t0 = now();
+			for (int32_t i = 0; i < SIGNALS; ++i)
+				expected[i] = linearScan(mask, freq[i], SIGNAL_WIDTH);
+			float64_t t1 = now();
+			for (int32_t i = 0; i < SIGNALS; ++i)
+				indexed[i] = fm.isMasked(freq[i], SIGNAL_WIDTH);
+			float64_t t2 = now();
+			fm.isMasked(&sorted[0], SIGNALS, SIGNAL_WIDTH, batch);
+			float64_t t3 = now();
+			linearBest = std::min(linearBest, t1 - t0);
+			indexBest = std::min(indexBest, t2 - t1);
+			batchBest = std::min(batchBest, t3 - t2);
+		}
+		int32_t mismatches = 0;
+		for (int32_t i = 0; i < SIGNALS; ++i) {
+			mismatches += (indexed[i] != expected[i]);
+			mismatches += (batch[i] != linearScan(mask, sorted[i],
+					SIGNAL_WIDTH));
+		}
+		delete [] batch;
+
+		cout << bands[b] << "\t" << linearBest / SIGNALS * 1e9 << "\t"
+				<< indexBest / SIGNALS * 1e9 << "\t"
+				<< batchBest / SIGNALS * 1e9 << "\t" << mismatches << endl;
+	}
+}
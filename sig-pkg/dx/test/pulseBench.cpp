@@ -0,0 +1,112 @@
+/*******************************************************************************
+
+ File:    pulseBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Pulse triplet search benchmark: times the exhaustive and indexed
+// triplet searches on random pulse maps of increasing density.
+//
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <stdlib.h>
+#include <time.h>
+#include "PulseTripletSearch.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+
+const int32_t SPECTRA = 128;
+const int32_t BINS = 1024;
+const float32_t BENCH_DRIFT = 1;
+const int32_t MAX_EXHAUSTIVE_PULSES = 8000;
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+static bool
+compareSpectra(const dx::Pulse& p0, const dx::Pulse& p1)
+{
+	return (p0.spectrum < p1.spectrum);
+}
+
+static void
+createPulses(PulseVector& pulses, int32_t n)
+{
+	std::set<int64_t> used;
+	pulses.clear();
+	while ((int32_t) pulses.size() < n) {
+		int32_t s = rand() % SPECTRA;
+		int32_t b = rand() % BINS;
+		if (used.insert((int64_t) b * SPECTRA + s).second) {
+			pulses.push_back(dx::Pulse(RES_1HZ, b, s, POL_RIGHTCIRCULAR,
+					10));
+		}
+	}
+	std::stable_sort(pulses.begin(), pulses.end(), compareSpectra);
+}
+
+int
+main(int argc, char **argv)
+{
+	srand(1);
+	cout << SPECTRA << " spectra, " << BINS << " bins, max drift "
+			<< BENCH_DRIFT << endl;
+	cout << "pulses\ttriplets\texhaustive (s)\tindexed (s)\tspeedup" << endl;
+
+	PulseTripletSearch search;
+	PulseTripletList all, indexed;
+	for (int32_t n = 1000; n <= 32000; n *= 2) {
+		PulseVector pulses;
+		createPulses(pulses, n);
+
+		float64_t t0 = now();
+		search.search(pulses, 0, BINS, BENCH_DRIFT, indexed);
+		float64_t tIndexed = now() - t0;
+
+		cout << n << "\t" << indexed.size() << "\t";
+		if (n <= MAX_EXHAUSTIVE_PULSES) {
+			t0 = now();
+			search.searchAll(pulses, 0, BINS, BENCH_DRIFT, all);
+			float64_t tAll = now() - t0;
+			if (all.size() != indexed.size())
+				cout << "MISMATCH ";
+			cout << tAll << "\t" << tIndexed << "\t" << tAll / tIndexed;
+		}
+		else
+			cout << "-\t" << tIndexed << "\t-";
+		cout << endl;
+	}
+}
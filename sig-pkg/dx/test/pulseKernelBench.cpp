@@ -0,0 +1,119 @@
+/*******************************************************************************
+
+ File:    pulseKernelBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+//
+// Pulse threshold benchmark: reports the throughput of each pulse kernel
+// supported by the processor, in millions of bins per second, for the
+// bins of a single 1Hz subchannel spectrum at hit densities from the
+// nominal noise rate up to every bin over threshold.
+//
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "PulseKernel.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t BINS = 768;
+const int64_t BENCH_BINS = 500000000;
+const float32_t THRESHOLD = 10;
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Create a spectrum in which the given fraction of the bins is over
+ * threshold.
+ */
+static void
+createData(vector<ComplexFloat32>& data, float64_t density)
+{
+	for (uint32_t i = 0; i < data.size(); ++i) {
+		float64_t power = THRESHOLD * (float64_t) rand() / RAND_MAX;
+		if ((float64_t) rand() / RAND_MAX < density)
+			power += THRESHOLD;
+		float64_t phase = 2 * M_PI * rand() / RAND_MAX;
+		data[i] = ComplexFloat32(sqrt(power) * cos(phase),
+				sqrt(power) * sin(phase));
+	}
+}
+
+static float64_t
+bench(const PulseKernel *k, const vector<ComplexFloat32>& data,
+		int32_t *bin, float32_t *power)
+{
+	int32_t passes = (int32_t) (BENCH_BINS / BINS);
+	k->threshold(&data[0], BINS, THRESHOLD, bin, power);
+	float64_t t0 = now();
+	for (int32_t i = 0; i < passes; ++i)
+		k->threshold(&data[0], BINS, THRESHOLD, bin, power);
+	float64_t t = now() - t0;
+	return ((float64_t) passes * BINS / t / 1e6);
+}
+
+int
+main(int argc, char **argv)
+{
+	const PulseKernelType types[] = { ScalarPulseKernel, Sse2PulseKernel,
+			Avx2PulseKernel };
+	const float64_t densities[] = { 4.5e-5, 1e-3, 1e-2, 0.1, 0.5, 1 };
+	const int32_t nDensities = sizeof(densities) / sizeof(densities[0]);
+
+	vector<ComplexFloat32> data(BINS);
+	vector<int32_t> bin(BINS);
+	vector<float32_t> power(BINS);
+
+	cout << "Mbins/s" << endl;
+	cout << "kernel";
+	for (int32_t d = 0; d < nDensities; ++d)
+		cout << "\t" << densities[d];
+	cout << endl;
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const PulseKernel *k = getPulseKernel(types[t]);
+		if (!k)
+			continue;
+		cout << k->name;
+		for (int32_t d = 0; d < nDensities; ++d) {
+			srand(d + 1);
+			createData(data, densities[d]);
+			cout << "\t" << bench(k, data, &bin[0], &power[0]);
+		}
+		cout << endl;
+	}
+}
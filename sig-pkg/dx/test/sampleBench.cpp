@@ -0,0 +1,99 @@
+/*******************************************************************************
+
+ File:    sampleBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Sample conversion benchmark: reports the throughput of each input
+// sample conversion kernel supported by the processor, in millions of
+// samples per second, for a cache-resident block and for a block the
+// size of a DFB input buffer.
+//
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "SampleKernel.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t SMALL_SAMPLES = 4096;
+const int32_t LARGE_SAMPLES = 400000;
+const int64_t BENCH_SAMPLES = 200000000;
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+static float64_t
+bench(SampleConvertFunc convert, const ComplexInt16 *in, ComplexFloat32 *out,
+		int32_t n)
+{
+	int32_t passes = (int32_t) (BENCH_SAMPLES / n);
+	convert(out, in, n);
+	float64_t t0 = now();
+	for (int32_t i = 0; i < passes; ++i)
+		convert(out, in, n);
+	float64_t t = now() - t0;
+	return ((float64_t) passes * n / t / 1e6);
+}
+
+int
+main(int argc, char **argv)
+{
+	vector<ComplexInt16> in(LARGE_SAMPLES);
+	for (int32_t i = 0; i < LARGE_SAMPLES; ++i)
+		in[i] = ComplexInt16((int16_t) rand(), (int16_t) rand());
+	ComplexFloat32 *out = static_cast<ComplexFloat32 *>
+			(fftwf_malloc(LARGE_SAMPLES * sizeof(ComplexFloat32)));
+
+	cout << "Msamples/s" << endl;
+	cout << "kernel\tsamples\tconvert\tswapped" << endl;
+	const SampleKernelType types[] = { ScalarSampleKernel,
+			Sse41SampleKernel, Avx2SampleKernel };
+	const int32_t sizes[] = { SMALL_SAMPLES, LARGE_SAMPLES };
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+		const SampleKernel *k = getSampleKernel(types[t]);
+		if (!k)
+			continue;
+		for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+			cout << k->name << "\t" << sizes[s] << "\t"
+					<< bench(k->convert, &in[0], out, sizes[s]) << "\t"
+					<< bench(k->convertSwapped, &in[0], out, sizes[s])
+					<< endl;
+		}
+	}
+	fftwf_free(out);
+}
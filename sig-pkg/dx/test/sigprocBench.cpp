@@ -0,0 +1,510 @@
+/*******************************************************************************
+
+ File:    sigprocBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Signal processing benchmark: times the DFB, spectrometry, pulse
+// thresholding, CW unpacking and DADD kernels on Gaussian noise in
+// production-sized configurations.
+//
+// Each stage is run for a number of iterations after an untimed warmup
+// pass, and the per-iteration times are reported as one tab-separated
+// line per stage, preceded by a header line.  Lines beginning with '#'
+// are comments describing the host and run parameters, so the output
+// can be collected directly from several hosts and compared.
+//
+// usage: sigprocBench [-i iterations] [-s seed]
+//
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fftw3.h>
+#include "System.h"
+#include "Args.h"
+#include "CwUnpacker.h"
+#include "Dadd.h"
+#include "Dfb.h"
+#include "Gaussian.h"
+#include "Spectra.h"
+#include "SpectrometerEngine.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+const int32_t DEFAULT_ITERATIONS = 50;
+const int32_t DEFAULT_SEED = 1;
+
+// DFB: 1024 subchannels with 25% oversampling, using the default filter
+const int32_t DFB_CHANNELS = 1024;
+const int32_t DFB_OVERLAP = 256;
+const int32_t DFB_BENCH_FOLDINGS = dfb::DFB_FOLDINGS;
+const int32_t SAMPLES = SUBCHANNEL_SAMPLES_PER_HALF_FRAME;
+
+// spectrometry: 1, 2 and 4Hz resolutions, CW at 1Hz
+const int32_t BENCH_RESOLUTIONS = 3;
+const int32_t SUBCHANNELS = 1024;
+const float32_t PULSE_THRESHOLD = 9.0;
+
+// CW detection: 1024 spectra of a single slice
+const int32_t DADD_SPECTRA = 1024;
+const int32_t DADD_BINS = 4096;
+const int32_t DADD_TOTAL_BINS = DADD_BINS + DADD_SPECTRA;
+const int32_t DADD_THRESHOLD = 2 * DADD_SPECTRA;
+const int32_t DADD_BAD_BAND_LIMIT = 1000;
+
+static float64_t
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Per-iteration timing of a single stage.
+ */
+class StageTimer {
+public:
+	StageTimer(int32_t iterations) {
+		cycles.reserve(iterations);
+		secs.reserve(iterations);
+	}
+
+	void start() {
+		t0 = now();
+		tk0 = getticks();
+	}
+	void stop() {
+		ticks tk1 = getticks();
+		float64_t t1 = now();
+		cycles.push_back(elapsed(tk1, tk0));
+		secs.push_back(t1 - t0);
+	}
+
+	void report(const string& stage, const string& config, int64_t samples);
+
+private:
+	ticks tk0;
+	float64_t t0;
+	vector<float64_t> cycles;			// cycles of each iteration
+	vector<float64_t> secs;				// seconds of each iteration
+
+	static float64_t percentile(const vector<float64_t>& v, float64_t p);
+};
+
+/**
+ * Report the results of a stage.
+ *
+ * Description:\n
+ * 	Throughput is computed from the total time of all iterations;
+ * 	cycles per sample from the median iteration, which is insensitive
+ * 	to preemption.  Percentiles are of the per-iteration time in
+ * 	microseconds.
+ *
+ * @param	stage name of the stage.
+ * @param	config configuration of the stage.
+ * @param	samples samples processed by each iteration.
+ */
+void
+StageTimer::report(const string& stage, const string& config,
+		int64_t samples)
+{
+	float64_t total = 0;
+	for (uint32_t i = 0; i < secs.size(); ++i)
+		total += secs[i];
+	vector<float64_t> t(secs);
+	std::sort(t.begin(), t.end());
+	vector<float64_t> c(cycles);
+	std::sort(c.begin(), c.end());
+
+	cout << stage << "\t" << config << "\t" << secs.size() << "\t"
+			<< samples << "\t"
+			<< samples * secs.size() / total / 1e6 << "\t"
+			<< percentile(c, .5) / samples << "\t"
+			<< percentile(t, .5) * 1e6 << "\t"
+			<< percentile(t, .9) * 1e6 << "\t"
+			<< percentile(t, .99) * 1e6 << "\t"
+			<< t.back() * 1e6 << endl;
+}
+
+/**
+ * Return the nearest-rank percentile of a sorted vector.
+ */
+float64_t
+StageTimer::percentile(const vector<float64_t>& v, float64_t p)
+{
+	int32_t i = (int32_t) ceil(p * v.size()) - 1;
+	if (i < 0)
+		i = 0;
+	return (v[i]);
+}
+
+/**
+ * Time the DFB on a half frame of input.
+ *
+ * Description:\n
+ * 	Each iteration produces one half frame (512 samples) for each of the
+ * 	1024 subchannels, using the default filter as the DX does.
+ */
+void
+benchDfb(int32_t iterations, int32_t seed)
+{
+	dfb::Dfb dfb;
+	dfb.setup(DFB_CHANNELS, DFB_OVERLAP, DFB_BENCH_FOLDINGS, SAMPLES);
+	dfb::DfbInfo info;
+	dfb.getInfo(&info);
+
+	ComplexFloat32 *in = static_cast<ComplexFloat32 *>
+			(fftwf_malloc(info.dataLen * sizeof(ComplexFloat32)));
+	gauss::Gaussian gen;
+	gen.setup(seed, DEFAULT_CHANNEL_WIDTH_MHZ, 1.0);
+	gen.getSamples(in, info.dataLen);
+
+	ComplexFloat32 *out[DFB_CHANNELS];
+	for (int32_t i = 0; i < DFB_CHANNELS; ++i) {
+		out[i] = static_cast<ComplexFloat32 *>
+				(fftwf_malloc(SAMPLES * sizeof(ComplexFloat32)));
+	}
+
+	StageTimer timer(iterations);
+	int32_t used = 0;
+	for (int32_t i = -1; i < iterations; ++i) {
+		const ComplexFloat32 *inBuf = in;
+		if (i >= 0)
+			timer.start();
+		used = dfb.iterate(&inBuf, 1, info.dataLen, out);
+		if (i >= 0)
+			timer.stop();
+	}
+	char config[64];
+	sprintf(config, "%dch/%dov/%dfold", DFB_CHANNELS, DFB_OVERLAP,
+			DFB_BENCH_FOLDINGS);
+	timer.report("dfb", config, used);
+
+	for (int32_t i = 0; i < DFB_CHANNELS; ++i)
+		fftwf_free(out[i]);
+	fftwf_free(in);
+}
+
+/**
+ * Build the resolution table: 1, 2 and 4Hz, all overlapped.
+ */
+void
+getResData(ResData *resData)
+{
+	for (int32_t i = 0; i < BENCH_RESOLUTIONS; ++i) {
+		resData[i].res = (Resolution) (RES_1HZ + i);
+		resData[i].fftLen = (2 * SAMPLES) >> i;
+		resData[i].overlap = true;
+	}
+}
+
+/**
+ * Time the spectrometry library on a single subchannel.
+ */
+void
+benchSpectra(int32_t iterations, int32_t seed)
+{
+	ResData resData[BENCH_RESOLUTIONS];
+	ResInfo resInfo[BENCH_RESOLUTIONS];
+	getResData(resData);
+	int32_t halfFrames = DEFAULT_SPECTRA_HALF_FRAMES;
+	spectra::Spectra spectra;
+	spectra.setup(resData, BENCH_RESOLUTIONS, halfFrames, SAMPLES, resInfo);
+
+	int32_t len = halfFrames * SAMPLES;
+	ComplexFloat32 *in = static_cast<ComplexFloat32 *>
+			(fftwf_malloc(len * sizeof(ComplexFloat32)));
+	gauss::Gaussian gen;
+	gen.setup(seed, DEFAULT_CHANNEL_WIDTH_MHZ / DFB_CHANNELS, 1.0);
+	gen.getSamples(in, len);
+
+	ComplexFloat32 *out[BENCH_RESOLUTIONS];
+	for (int32_t i = 0; i < BENCH_RESOLUTIONS; ++i) {
+		out[i] = static_cast<ComplexFloat32 *> (fftwf_malloc(resInfo[i].specLen
+				* resInfo[i].nSpectra * sizeof(ComplexFloat32)));
+	}
+
+	StageTimer timer(iterations);
+	for (int32_t i = -1; i < iterations; ++i) {
+		if (i >= 0)
+			timer.start();
+		spectra.computeSpectra(in, out);
+		if (i >= 0)
+			timer.stop();
+	}
+	char config[64];
+	sprintf(config, "1-4Hz/%dhf", halfFrames);
+	timer.report("spectra", config, len);
+
+	for (int32_t i = 0; i < BENCH_RESOLUTIONS; ++i)
+		fftwf_free(out[i]);
+	fftwf_free(in);
+}
+
+/**
+ * Time the pulse threshold path.
+ *
+ * Description:\n
+ * 	Runs a single-worker spectrometer engine over a full set of
+ * 	subchannels for both polarizations, so each iteration includes
+ * 	baselining, CD and CW data generation and pulse thresholding of
+ * 	every resolution, exactly as a half frame of an observation.\n\n
+ * Notes:\n
+ * 	The same half frame numbers are used on every iteration so that
+ * 	the output buffers need only hold a single half frame.
+ */
+void
+benchPulse(int32_t iterations, int32_t seed)
+{
+	SpecEngineParams params;
+	params.subchannels = SUBCHANNELS;
+	params.samples = SAMPLES;
+	params.hfBytesPerSubchannel = SAMPLES * sizeof(ComplexFloat32);
+	params.cdBytesPerSubchannelHalfFrame = SAMPLES * sizeof(ComplexPair);
+	params.cdBytesPerSubchannel = params.cdBytesPerSubchannelHalfFrame;
+	params.resolutions = BENCH_RESOLUTIONS;
+	getResData(params.resData);
+	for (int32_t i = 0; i < BENCH_RESOLUTIONS; ++i) {
+		Resolution res = params.resData[i].res;
+		params.totalBins[res] = params.resData[i].fftLen;
+		params.usableBins[res] = params.totalBins[res] * 3 / 4;
+	}
+	params.obs.cwResolution = RES_1HZ;
+	params.cwBytesPerSubchannel = params.usableBins[RES_1HZ]
+			/ CWD_BINS_PER_BYTE;
+	params.cwBytesPerSpectrum = SUBCHANNELS * params.cwBytesPerSubchannel;
+	params.cwBufSize = params.cwBytesPerSubchannel;
+	params.obs.baselineWeighting = 0.9;
+	params.obs.pulseThreshold = PULSE_THRESHOLD;
+	params.obs.maxPulsesPerHalfFrame = 100000;
+	params.obs.maxPulsesPerSubchannelPerHalfFrame = 100000;
+	params.masked.resize(SUBCHANNELS, false);
+
+	SpectrometerEngine engine(1, WORKER_PRIO, false);
+	ResInfo resInfo[MAX_RESOLUTIONS];
+	engine.setup(params, resInfo);
+
+	int32_t hfLen = SUBCHANNELS * SAMPLES;
+	int32_t hfBufs = params.spectraHalfFrames;
+	vector<float32_t> bl[POLARIZATIONS];
+	vector<uint8_t> cd[POLARIZATIONS];
+	vector<uint8_t> cw[POLARIZATIONS];
+	ComplexFloat32 *hfBuf[POLARIZATIONS][HALF_FRAME_BUFFERS];
+	SpecHalfFrame frame;
+	frame.pol[0].pol = POL_RIGHTCIRCULAR;
+	frame.pol[1].pol = POL_LEFTCIRCULAR;
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		gauss::Gaussian gen;
+		gen.setup(seed + p, DEFAULT_CHANNEL_WIDTH_MHZ / DFB_CHANNELS, 1.0);
+		SpecPolData& pd = frame.pol[p];
+		for (int32_t i = 0; i < hfBufs; ++i) {
+			hfBuf[p][i] = static_cast<ComplexFloat32 *>
+					(fftwf_malloc(hfLen * sizeof(ComplexFloat32)));
+			gen.getSamples(hfBuf[p][i], hfLen);
+			pd.hfData[i] = hfBuf[p][i];
+		}
+		bl[p].assign(SUBCHANNELS, 0.0);
+		cd[p].assign(SUBCHANNELS * params.cdBytesPerSubchannel, 0);
+		cw[p].assign(resInfo[0].nSpectra * params.cwBytesPerSpectrum, 0);
+		pd.blData = &bl[p][0];
+		pd.cdData = &cd[p][0];
+		pd.cwData = &cw[p][0];
+	}
+
+	// prime the baseline
+	PulseList pulses;
+	frame.hf = -1;
+	frame.hfBufs = 1;
+	engine.processHalfFrame(frame, pulses);
+
+	StageTimer timer(iterations);
+	int64_t hits = 0;
+	frame.hf = 0;
+	frame.baselineHf = 1;
+	frame.hfBufs = hfBufs;
+	for (int32_t i = -1; i < iterations; ++i) {
+		pulses.clear();
+		if (i >= 0)
+			timer.start();
+		int32_t n = engine.processHalfFrame(frame, pulses);
+		if (i >= 0) {
+			timer.stop();
+			hits += n;
+		}
+	}
+	char config[64];
+	sprintf(config, "%dsub/1-4Hz/thresh%g", SUBCHANNELS, PULSE_THRESHOLD);
+	timer.report("pulse", config, (int64_t) POLARIZATIONS * hfLen);
+	cout << "# pulse hits per half frame " << (float64_t) hits / iterations
+			<< endl;
+
+	for (int32_t p = 0; p < POLARIZATIONS; ++p) {
+		for (int32_t i = 0; i < hfBufs; ++i)
+			fftwf_free(hfBuf[p][i]);
+	}
+}
+
+/**
+ * Create packed CW data from Gaussian noise.
+ *
+ * Description:\n
+ * 	Quantizes the power of each sample to 2 bits, with thresholds
+ * 	chosen so that the four values are equally likely for unit noise.
+ */
+void
+createCwData(uint8_t *packed, int32_t bytes, int32_t seed)
+{
+	const float32_t level[] = { 0.2877, 0.6931, 1.3863 };
+	int32_t n = bytes * CWD_BINS_PER_BYTE;
+	vector<ComplexFloat32> samples(n);
+	gauss::Gaussian gen;
+	gen.setup(seed, DEFAULT_CHANNEL_WIDTH_MHZ / DFB_CHANNELS, 1.0);
+	gen.getSamples(&samples[0], n);
+	for (int32_t i = 0; i < bytes; ++i) {
+		uint8_t b = 0;
+		for (int32_t j = 0; j < CWD_BINS_PER_BYTE; ++j) {
+			float32_t power = std::norm(samples[i*CWD_BINS_PER_BYTE+j]);
+			uint8_t v = (power > level[0]) + (power > level[1])
+					+ (power > level[2]);
+			b |= v << (j * CWD_BITS_PER_BIN);
+		}
+		packed[i] = b;
+	}
+}
+
+/**
+ * Time CW unpacking and DADD on a single slice.
+ *
+ * Description:\n
+ * 	Each iteration unpacks 1024 spectra of packed CW data into the
+ * 	detection buffer, then runs DADD on it.  Both slopes are measured.
+ */
+void
+benchDadd(int32_t iterations, int32_t seed)
+{
+	int32_t packedStride = DADD_BINS / CWD_BINS_PER_BYTE;
+	size_t packedSize = (size_t) DADD_SPECTRA * packedStride;
+	uint8_t *packed = static_cast<uint8_t *> (fftwf_malloc(packedSize));
+	createCwData(packed, packedSize, seed);
+
+	size_t size = ((size_t) DADD_SPECTRA * DADD_TOTAL_BINS + 2 * VECTOR_LEN)
+			* sizeof(DaddAccum);
+	DaddAccum *buf = static_cast<DaddAccum *> (fftwf_malloc(size));
+	memset(buf, 0, size);
+
+	CwUnpacker unpacker;
+	dadd::Dadd dadd;
+	dadd.setup(DADD_SPECTRA, DADD_BINS, DADD_TOTAL_BINS, DADD_THRESHOLD,
+			DADD_BAND_BINS, DADD_BAD_BAND_LIMIT);
+
+	DaddSlope slopes[] = { Positive, Negative };
+	const char *names[] = { "pos", "neg" };
+	for (int32_t s = 0; s < 2; ++s) {
+		StageTimer unpackTimer(iterations), daddTimer(iterations);
+		int32_t ofs = slopes[s] == Positive ? 0 : DADD_BINS;
+		for (int32_t i = -1; i < iterations; ++i) {
+			if (i >= 0)
+				unpackTimer.start();
+			unpacker.unpack(slopes[s], packed, buf, 0, ofs, DADD_SPECTRA,
+					DADD_BINS, DADD_BINS, DADD_TOTAL_BINS);
+			if (i >= 0) {
+				unpackTimer.stop();
+				daddTimer.start();
+			}
+			dadd.execute(POL_RIGHTCIRCULAR, slopes[s], buf, 0);
+			if (i >= 0)
+				daddTimer.stop();
+		}
+		char config[64];
+		sprintf(config, "%dx%d/%s", DADD_SPECTRA, DADD_BINS, names[s]);
+		int64_t bins = (int64_t) DADD_SPECTRA * DADD_BINS;
+		unpackTimer.report("unpack", config, bins);
+		sprintf(config, "%dx%d/%s/%dbit", DADD_SPECTRA, DADD_BINS, names[s],
+				DADD_ACC_BITS);
+		daddTimer.report("dadd", config, bins);
+	}
+
+	fftwf_free(buf);
+	fftwf_free(packed);
+}
+
+int
+main(int argc, char **argv)
+{
+	// the unpacker gets its options from the command line arguments,
+	// which are all for the benchmark
+	char *args[] = { argv[0], 0 };
+	Args::getInstance(1, args);
+	optind = 1;
+
+	int32_t iterations = DEFAULT_ITERATIONS;
+	int32_t seed = DEFAULT_SEED;
+	int c;
+	while ((c = getopt(argc, argv, "i:s:")) != -1) {
+		switch (c) {
+		case 'i':
+			iterations = atoi(optarg);
+			break;
+		case 's':
+			seed = atoi(optarg);
+			break;
+		default:
+			std::cerr << "usage: sigprocBench [-i iterations] [-s seed]"
+					<< endl;
+			return (1);
+		}
+	}
+	if (iterations < 1)
+		iterations = 1;
+
+	char host[256];
+	if (gethostname(host, sizeof(host)))
+		strcpy(host, "unknown");
+	host[sizeof(host)-1] = '\0';
+	cout << "# host " << host << endl;
+	cout << "# iterations " << iterations << ", seed " << seed << endl;
+	cout << "stage\tconfig\titerations\tsamples\tMsamples/s\tcycles/sample"
+			"\tp50 (us)\tp90 (us)\tp99 (us)\tmax (us)" << endl;
+
+	benchDfb(iterations, seed);
+	benchSpectra(iterations, seed);
+	benchPulse(iterations, seed);
+	benchDadd(iterations, seed);
+	return (0);
+}
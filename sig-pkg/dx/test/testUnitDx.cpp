@@ -0,0 +1,67 @@
+/*******************************************************************************
+
+ File:    testUnitDx.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Unit test runner for the dx
+//
+#include "TestRunner.h"
+#include "TestCwClusterer.h"
+#include "TestCwCoherentEngine.h"
+#include "TestCwDaddEngine.h"
+#include "TestCwKernel.h"
+#include "TestCwPathSearch.h"
+#include "TestDedriftKernel.h"
+#include "TestFrequencyMask.h"
+#include "TestPulseKernel.h"
+#include "TestPulseTripletSearch.h"
+#include "TestSampleKernel.h"
+#include "TestSignalClassifierEngine.h"
+#include "TestSpectrometerEngine.h"
+
+int
+main(int argc, char **argv)
+{
+	TestRunner runner;
+	runner.addTest("TestCwClusterer", TestCwClusterer::suite());
+	runner.addTest("TestCwCoherentEngine", TestCwCoherentEngine::suite());
+	runner.addTest("TestCwDaddEngine", TestCwDaddEngine::suite());
+	runner.addTest("TestCwKernel", TestCwKernel::suite());
+	runner.addTest("TestCwPathSearch", TestCwPathSearch::suite());
+	runner.addTest("TestDedriftKernel", TestDedriftKernel::suite());
+	runner.addTest("TestFrequencyMask", TestFrequencyMask::suite());
+	runner.addTest("TestPulseKernel", TestPulseKernel::suite());
+	runner.addTest("TestPulseTripletSearch",
+			TestPulseTripletSearch::suite());
+	runner.addTest("TestSampleKernel", TestSampleKernel::suite());
+	runner.addTest("TestSignalClassifierEngine",
+			TestSignalClassifierEngine::suite());
+	runner.addTest("TestSpectrometerEngine", TestSpectrometerEngine::suite());
+	return (runner.run(argc, argv));
+}
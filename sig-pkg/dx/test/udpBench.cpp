@@ -0,0 +1,298 @@
+/*******************************************************************************
+
+ File:    udpBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Receiver benchmark: compares the single-packet receive path (one
+// recvfrom and one queue operation per packet) with the batched path
+// (one recvmmsg and one queue operation per batch) over the loopback
+// interface.  A sender thread in the same process supplies channel
+// packets and a consumer thread stands in for the input task.
+// Reports packets per second and receiver CPU time per packet.
+//
+#include <iostream>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "System.h"
+#include "ChannelPacketBatchList.h"
+#include "ChannelPacketList.h"
+#include "DxTypes.h"
+#include "Msg.h"
+#include "Queue.h"
+#include "Udp.h"
+
+using namespace dx;
+using std::cout;
+using std::endl;
+
+const int32_t BENCH_PORT = 51999;
+const int32_t BENCH_PACKETS = 200000;
+const int32_t SEND_BATCH = 32;
+const int32_t POOL_PACKETS = 8192;
+const int32_t POOL_MSGS = 8192;
+const int32_t QUEUE_SLOTS = 8192;
+
+struct BenchArgs {
+	Udp *udp;						// receiver socket
+	Queue *inQ;						// consumer queue
+	int32_t packets;				// packets to send
+	volatile bool stop;				// consumer stop flag
+
+	BenchArgs(): udp(0), inQ(0), packets(0), stop(false) {}
+};
+
+static float64_t
+now(clockid_t clk)
+{
+	timespec ts;
+	clock_gettime(clk, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+ * Send packets to the receiver as fast as possible, then shut down
+ * the receiver socket to terminate the receive loop.
+ */
+static void *
+sender(void *arg)
+{
+	BenchArgs *b = static_cast<BenchArgs *> (arg);
+	int s = socket(AF_INET, SOCK_DGRAM, 0);
+	sockaddr_in dest;
+	memset(&dest, 0, sizeof(dest));
+	dest.sin_family = AF_INET;
+	dest.sin_port = htons(BENCH_PORT);
+	dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	ChannelPacket pkt;
+	iovec iov;
+	iov.iov_base = (void *) pkt.getPacket();
+	iov.iov_len = pkt.getPacketSize();
+	mmsghdr mmsg[SEND_BATCH];
+	memset(mmsg, 0, sizeof(mmsg));
+	for (int32_t i = 0; i < SEND_BATCH; ++i) {
+		mmsg[i].msg_hdr.msg_name = &dest;
+		mmsg[i].msg_hdr.msg_namelen = sizeof(dest);
+		mmsg[i].msg_hdr.msg_iov = &iov;
+		mmsg[i].msg_hdr.msg_iovlen = 1;
+	}
+	for (int32_t sent = 0; sent < b->packets; ) {
+		int32_t n = b->packets - sent;
+		if (n > SEND_BATCH)
+			n = SEND_BATCH;
+		int rval = sendmmsg(s, mmsg, n, 0);
+		if (rval > 0)
+			sent += rval;
+	}
+	close(s);
+	// allow the receiver to drain its socket buffer
+	usleep(200000);
+	b->udp->terminate();
+	return (0);
+}
+
+/**
+ * Stand-in for the input task: releases packets, batches and messages.
+ */
+static void *
+consumer(void *arg)
+{
+	BenchArgs *b = static_cast<BenchArgs *> (arg);
+	MsgList *msgList = MsgList::getInstance();
+	ChannelPacketList *pktList = ChannelPacketList::getInstance();
+	ChannelPacketBatchList *batchList = ChannelPacketBatchList::getInstance();
+	while (1) {
+		Msg *msg;
+		if (b->inQ->recv((void **) &msg, 100)) {
+			if (b->stop)
+				break;
+			continue;
+		}
+		switch (msg->getCode()) {
+		case InputPacket:
+			pktList->free(static_cast<ChannelPacket *> (msg->getData()));
+			break;
+		case InputPacketBatch:
+			{
+				ChannelPacketBatch *batch =
+						static_cast<ChannelPacketBatch *> (msg->getData());
+				for (int32_t i = 0; i < batch->count; ++i)
+					pktList->free(batch->pkt[i]);
+				batchList->free(batch);
+			}
+			break;
+		default:
+			break;
+		}
+		msgList->free(msg);
+	}
+	return (0);
+}
+
+/**
+ * Single-packet receive loop, as used before batching.
+ */
+static int32_t
+recvSingle(Udp *udp, Queue *inQ, float64_t& wall)
+{
+	MsgList *msgList = MsgList::getInstance();
+	ChannelPacketList *pktList = ChannelPacketList::getInstance();
+	int32_t packets = 0;
+	float64_t start = 0, end = 0;
+	while (1) {
+		ChannelPacket *pkt = pktList->alloc();
+		Assert(pkt);
+		if (udp->recv((void *) pkt->getPacket(), pkt->getPacketSize())) {
+			pktList->free(pkt);
+			break;
+		}
+		end = now(CLOCK_MONOTONIC);
+		if (!packets++)
+			start = end;
+		pkt->demarshall();
+		Msg *msg = msgList->alloc((DxMessageCode) InputPacket, 0, pkt,
+				sizeof(ChannelPacket), 0, USER);
+		Assert(!inQ->send(msg));
+	}
+	wall = end - start;
+	return (packets);
+}
+
+/**
+ * Batched receive loop, as used by the receiver task.
+ */
+static int32_t
+recvBatch(Udp *udp, Queue *inQ, float64_t& wall)
+{
+	MsgList *msgList = MsgList::getInstance();
+	ChannelPacketList *pktList = ChannelPacketList::getInstance();
+	ChannelPacketBatchList *batchList = ChannelPacketBatchList::getInstance();
+
+	ChannelPacket *ring[RECEIVER_BATCH];
+	void *buf[RECEIVER_BATCH];
+	size_t len[RECEIVER_BATCH];
+	for (int32_t i = 0; i < RECEIVER_BATCH; ++i) {
+		ring[i] = pktList->alloc();
+		Assert(ring[i]);
+		buf[i] = (void *) ring[i]->getPacket();
+	}
+	size_t pktSize = ring[0]->getPacketSize();
+
+	int32_t packets = 0;
+	float64_t start = 0, end = 0;
+	while (1) {
+		int32_t count = RECEIVER_BATCH;
+		for (int32_t i = 0; i < RECEIVER_BATCH; ++i)
+			len[i] = pktSize;
+		if (udp->recv(buf, len, count) || !count)
+			break;
+		end = now(CLOCK_MONOTONIC);
+		if (!packets)
+			start = end;
+		ChannelPacketBatch *batch = batchList->alloc();
+		Assert(batch);
+		batch->count = 0;
+		for (int32_t i = 0; i < count; ++i) {
+			if (len[i] != pktSize)
+				continue;
+			ChannelPacket *pkt = ring[i];
+			pkt->demarshall();
+			batch->pkt[batch->count++] = pkt;
+			ring[i] = pktList->alloc();
+			Assert(ring[i]);
+			buf[i] = (void *) ring[i]->getPacket();
+		}
+		packets += batch->count;
+		Msg *msg = msgList->alloc((DxMessageCode) InputPacketBatch, 0,
+				batch, sizeof(ChannelPacketBatch), 0, USER);
+		Assert(!inQ->send(msg));
+	}
+	for (int32_t i = 0; i < RECEIVER_BATCH; ++i)
+		pktList->free(ring[i]);
+	wall = end - start;
+	return (packets);
+}
+
+static void
+run(const char *name, bool batched, int32_t packets)
+{
+	Udp udp("bench", (sonata_lib::Unit) UnitReceiver);
+	size_t size = DEFAULT_RCV_BUFSIZE;
+	udp.setRcvBufsize(size);
+	IpAddress any = "0.0.0.0";
+	udp.setAddress(any, BENCH_PORT, false, true);
+
+	Queue inQ("bench", QUEUE_SLOTS);
+	BenchArgs b;
+	b.udp = &udp;
+	b.inQ = &inQ;
+	b.packets = packets;
+
+	pthread_t cons, send;
+	pthread_create(&cons, 0, consumer, &b);
+	pthread_create(&send, 0, sender, &b);
+
+	float64_t wall = 0;
+	float64_t cpu0 = now(CLOCK_THREAD_CPUTIME_ID);
+	int32_t received = batched ? recvBatch(&udp, &inQ, wall)
+			: recvSingle(&udp, &inQ, wall);
+	float64_t cpu = now(CLOCK_THREAD_CPUTIME_ID) - cpu0;
+
+	pthread_join(send, 0);
+	b.stop = true;
+	pthread_join(cons, 0);
+
+	float64_t rate = (wall > 0) ? received / wall : 0;
+	float64_t perPkt = received ? cpu / received * 1e6 : 0;
+	cout << name << "\t" << received << "\t" << (int64_t) rate << "\t"
+			<< perPkt << endl;
+}
+
+int
+main(int argc, char **argv)
+{
+	int32_t packets = BENCH_PACKETS;
+	if (argc > 1)
+		packets = atoi(argv[1]);
+
+	// size the free lists before anyone else creates them
+	ChannelPacketList::getInstance(POOL_PACKETS);
+	ChannelPacketBatchList::getInstance(POOL_PACKETS);
+	MsgList::getInstance("MsgList", POOL_MSGS);
+
+	cout << packets << " packets sent, " << RECEIVER_BATCH
+			<< " packets per batch" << endl;
+	cout << "path\treceived\tpkts/s\tcpu us/pkt" << endl;
+	run("single", false, packets);
+	run("batch", true, packets);
+}
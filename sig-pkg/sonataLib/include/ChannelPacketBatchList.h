@@ -0,0 +1,64 @@
+/*******************************************************************************
+
+ File:    ChannelPacketBatchList.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+// Packet batch list: maintains a free list of channel packet batches
+//
+// Note: this is a singleton
+//
+#ifndef _ChannelPacketBatchListH
+#define _ChannelPacketBatchListH
+
+#include "ChannelPacket.h"
+#include "PacketList.h"
+
+namespace sonata_lib {
+
+/**
+ * A batch of channel packets.
+ *
+ * Description:\n
+ * 	Carries a group of packets received with a single system call
+ * 	so that they can be passed between tasks with a single queue
+ * 	operation.  The packets themselves are owned by the
+ * 	ChannelPacketList; the batch only holds the pointers.
+ */
+struct ChannelPacketBatch {
+	int32_t count;						// number of packets in the batch
+	ChannelPacket *pkt[MAX_PACKET_BATCH];	// packets
+
+	ChannelPacketBatch(): count(0) {}
+};
+
+typedef PacketList<ChannelPacketBatch, DEFAULT_CHANNEL_PACKET_BATCHES>
+		ChannelPacketBatchList;
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*******************************************************************************
+
+ File:    LockFreeQueue.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Lock-free queue classes
+//
+// Drop-in replacements for Queue which do not take a lock to access
+// the ring.  The send and receive semaphores are retained, so the
+// blocking and timeout semantics are the same as Queue; only the
+// mutex around the ring is removed.
+//
+#ifndef _LockFreeQueueH
+#define _LockFreeQueueH
+
+#include "Queue.h"
+
+namespace sonata_lib {
+
+/**
+ * Single-producer, single-consumer queue.
+ *
+ * Description:\n
+ * 	Each index of the ring is owned by one side, so no lock or atomic
+ * 	update is required; the semaphores order the slot accesses.\n
+ * Notes:\n
+ * 	Only one task may send to the queue, and only one task may
+ * 	receive from it.
+ */
+class SpscQueue: public Queue {
+public:
+	SpscQueue(string name_, int slots_ = DEFAULT_QSLOTS);
+	~SpscQueue();
+
+	Error send(void *msg_, int milliseconds_ = -1);
+	Error recv(void **msg_, int milliseconds_ = -1);
+
+private:
+	// forbidden
+	SpscQueue(const SpscQueue&);
+	SpscQueue& operator=(const SpscQueue&);
+};
+
+/**
+ * Bounded multiple-producer, multiple-consumer queue.
+ *
+ * Description:\n
+ * 	Senders and receivers claim tickets with an atomic increment.  Each
+ * 	cell of the ring carries a sequence number which tells the owner of
+ * 	a ticket when the cell has been emptied (send) or filled (recv) by
+ * 	the previous user.\n
+ * Notes:\n
+ * 	The ring is rounded up to a power of two cells; the semaphores
+ * 	still limit the queue to the requested number of slots.
+ */
+class MpmcQueue: public Queue {
+public:
+	MpmcQueue(string name_, int slots_ = DEFAULT_QSLOTS);
+	~MpmcQueue();
+
+	Error send(void *msg_, int milliseconds_ = -1);
+	Error recv(void **msg_, int milliseconds_ = -1);
+
+private:
+	struct Cell {
+		volatile uint32_t seq;			// sequence number
+		void *msg;						// message
+
+		Cell(): seq(0), msg(0) {}
+	};
+
+	uint32_t mask;						// cell index mask
+	Cell *cells;						// ring
+	volatile uint32_t sTicket;			// next send ticket
+	volatile uint32_t rTicket;			// next receive ticket
+
+	// forbidden
+	MpmcQueue(const MpmcQueue&);
+	MpmcQueue& operator=(const MpmcQueue&);
+};
+
+}
+
+#endif
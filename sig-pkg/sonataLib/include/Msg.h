@@ -127,6 +127,8 @@ public:
 			int32_t activityId_ = -1, void *data_ = 0, int32_t len_ = 0,
 			MemBlk *blk_ = 0, MsgDataType dataType_ = FIXED_BLOCK);
 	bool free(Msg *msg_);
+	int32_t allocBatch(Msg **msgs, int32_t n);
+	void freeBatch(Msg **msgs, int32_t n);
 	int getFreeMessages() { return (msgList.size()); }
 	int32_t getAllocs() { return (allocs); }
 	int32_t getFrees() { return (frees); }
@@ -145,7 +147,13 @@ protected:
 	void lock() { llock.lock(); }
 	void unlock() { llock.unlock(); }
 
+	static void initMsg(Msg *msg, DxMessageCode code_, int32_t activityId_,
+			void *data_, int32_t len_, MemBlk *blk_, MsgDataType dataType_);
+	static void releaseMsg(Msg *msg);
+
 private:
+	friend class MsgCache;
+
 	MsgList(string name_, int messages_);
 
 	// forbidden
@@ -153,6 +161,48 @@ private:
 	MsgList& operator=(const MsgList&);
 };
 
+/**
+ * Message cache
+ *
+ * Description:\n
+ * 	A per-thread front end to the message list.  Messages are taken
+ * 	from and returned to the message list in batches, so a task which
+ * 	allocates or frees many messages takes the list lock only once
+ * 	per batch.  Messages are identical to those allocated directly
+ * 	from the list, and may be freed to either.\n
+ * Notes:\n
+ * 	A cache must only be used by one thread; getInstance returns the
+ * 	cache of the calling thread, creating it if necessary.  A thread
+ * 	which has allocated many messages through its cache, or which
+ * 	frees messages allocated by another thread, holds up to twice the
+ * 	cache size; flush returns them to the list, as does the exit of
+ * 	the thread.
+ */
+class MsgCache {
+public:
+	static MsgCache *getInstance();
+
+	MsgCache(MsgList *list_ = 0, int32_t size_ = DEFAULT_MSG_CACHE);
+	~MsgCache();
+
+	Msg *alloc(DxMessageCode code_ = MESSAGE_CODE_UNINIT,
+			int32_t activityId_ = -1, void *data_ = 0, int32_t len_ = 0,
+			MemBlk *blk_ = 0, MsgDataType dataType_ = FIXED_BLOCK);
+	bool free(Msg *msg_);
+	void flush();
+	int32_t getCached() { return (count); }
+
+private:
+	MsgList *list;						// master message list
+	int32_t size;						// batch size
+	int32_t count;						// # of cached messages
+	Msg **cache;						// cached messages
+
+	// forbidden
+	MsgCache(const MsgCache&);
+	MsgCache& operator=(const MsgCache&);
+};
+
 }
 
 #endif
\ No newline at end of file
@@ -71,6 +71,8 @@ public:
 		delete inQ;
 		inQ = q;
 	}
+	// free handled messages through the task's message cache
+	void setMsgCache(bool flag = true) { msgCache = flag; }
 	void terminate() { terminated = true; }
 
 protected:
@@ -78,6 +80,7 @@ protected:
 	
 private:
 	bool terminated;
+	bool msgCache;
 	Queue *inQ;
 	QTaskTiming timing;
 
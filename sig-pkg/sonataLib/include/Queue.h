@@ -67,17 +67,17 @@ struct QTiming {
 class Queue {
 public:
 	Queue(string name_, int slots_ = DEFAULT_QSLOTS);
-	~Queue();
+	virtual ~Queue();
 
 	// send and receive queue messages
-	Error send(void *msg_, int milliseconds_ = -1);
-	Error recv(void **msg_, int milliseconds_ = -1);
+	virtual Error send(void *msg_, int milliseconds_ = -1);
+	virtual Error recv(void **msg_, int milliseconds_ = -1);
 
 	void name(string& name_);
 
 	int32_t getCount() { return (rSem.getCount()); }
 
-private:
+protected:
 	void **data;
 	string qname;
 	int slots, sIndex, rIndex;
@@ -86,6 +86,7 @@ private:
 	Semaphore sSem;
 	QTiming timing;
 
+private:
 	// forbidden
 	Queue(const Queue&);
 	Queue& operator=(const Queue&);	
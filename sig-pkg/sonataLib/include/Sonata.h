@@ -96,10 +96,14 @@ const int32_t DEFAULT_ID = 1;
 const IpAddress DEFAULT_ADDR = "default";
 const int32_t DEFAULT_PORT = 0;
 const int32_t DEFAULT_MESSAGES = 100;
+const int32_t DEFAULT_MSG_CACHE = 16;
 const int32_t DEFAULT_QSLOTS = 50;
 const int32_t DEFAULT_PACKETS = 10000;
 const int32_t DEFAULT_BEAM_PACKETS = 100000;
 const int32_t DEFAULT_CHANNEL_PACKETS = 100000;
+const int32_t DEFAULT_BEAM_PACKET_BATCHES = 10000;
+const int32_t DEFAULT_CHANNEL_PACKET_BATCHES = 10000;
+const int32_t MAX_PACKET_BATCH = 64;
 const int32_t MAX_STR_LEN = 50;
 
 #ifdef notdef
@@ -39,6 +39,7 @@
 #include <set>
 #include <string>
 #include <fcntl.h>
+#include <sys/socket.h>
 #include <sseDxInterface.h>
 #include "Sonata.h"
 #include "Connection.h"
@@ -50,6 +51,9 @@ namespace sonata_lib {
 
 #define DEFAULT_IP			"127.0.0.1"
 
+// maximum number of datagrams returned by a single batch receive
+const int32_t MAX_UDP_BATCH = MAX_PACKET_BATCH;
+
 class Udp: public Connection {
 public:
 	Udp(string name_, Unit unit_);
@@ -66,8 +70,11 @@ public:
 	Error setRcvBufsize(size_t& size_);
 	Error setSndBufsize(size_t& size_);
 	Error recv(void *msg, size_t len);
+	Error recv(void **msg, size_t *len, int32_t& count);
 	Error send(void *msg, size_t len);
 	Error send(void *msg, size_t len, const IpAddress& addr, int32_t port);
+	Error send(void **msg, size_t *len, const struct sockaddr_in **dest,
+			int32_t& count);
 
 private:
 	bool nonblock;					// blocking or non-blocking
@@ -76,6 +83,8 @@ private:
 	GroupSet groupSet;				// groups assigned to socket
 	IpAddress hostIp;				// target host
 	struct sockaddr_in saddr;		// socket address
+	struct mmsghdr *mmsg;			// batch message headers
+	struct iovec *iov;				// batch message buffers
 
 	Error connect();				// active connection
 	Error create(bool nonblock_); // create a socket
@@ -0,0 +1,141 @@
+/*******************************************************************************
+
+ File:    WorkerPool.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Worker pool class
+//
+// A worker pool is a fixed set of tasks which cooperate to execute a
+// job which has been divided into independent work items.
+//
+#ifndef _WorkerPoolH
+#define _WorkerPoolH
+
+#include <string>
+#include "Sonata.h"
+#include "Lock.h"
+#include "Semaphore.h"
+#include "Task.h"
+
+using std::string;
+
+namespace sonata_lib {
+
+/**
+ * Job executed by a worker pool.
+ *
+ * Description:\n
+ * 	A job consists of a number of independent items, which are handed
+ * 	out to the workers of the pool in no particular order.  The worker
+ * 	index passed with each item identifies the per-worker state which
+ * 	the item may use without locking; worker 0 is always the task
+ * 	which called WorkerPool::run.
+ */
+class PoolJob {
+public:
+	virtual void execute(int32_t worker, int32_t item) = 0;
+	virtual ~PoolJob() = 0;
+};
+
+inline PoolJob::~PoolJob() {}
+
+class WorkerPool;
+
+/**
+ * Worker task.
+ *
+ * Description:\n
+ * 	One of the helper tasks owned by a worker pool.  It waits for the
+ * 	pool to start a job, executes items until there are none left, then
+ * 	reports completion to the pool.
+ */
+class PoolTask: public Task {
+public:
+	PoolTask(string name_, int prio_, bool realtime_, WorkerPool *pool_,
+			int32_t worker_);
+	~PoolTask();
+
+	void startJob() { startSem.signal(); }
+
+private:
+	int32_t worker;
+	WorkerPool *pool;
+	Semaphore startSem;
+
+	void extractArgs() {}
+	void *routine();
+
+	// forbidden
+	PoolTask(const PoolTask&);
+	PoolTask& operator=(const PoolTask&);
+};
+
+/**
+ * Worker pool.
+ *
+ * Description:\n
+ * 	Executes jobs on a fixed number of workers.  The calling task always
+ * 	participates as worker 0, so a pool with a single worker creates no
+ * 	tasks and simply executes every item in order in the caller.\n
+ * Notes:\n
+ * 	run() does not return until every item of the job has been executed.
+ * 	Calls from different tasks are serialized.
+ */
+class WorkerPool {
+public:
+	WorkerPool(string name_, int32_t workers_, int prio_,
+			bool realtime_ = true);
+	~WorkerPool();
+
+	int32_t getWorkers() { return (workers); }
+	void run(PoolJob *job_, int32_t items_);
+
+private:
+	bool stopped;						// pool is being destroyed
+	int32_t workers;					// total # of workers, incl. caller
+	int32_t items;						// # of items in current job
+	volatile int32_t next;				// next item to be executed
+	PoolJob *job;						// current job
+	PoolTask **tasks;					// helper tasks (workers - 1)
+	Lock runLock;						// serializes run()
+	Semaphore doneSem;					// helper task completions
+	string pname;
+
+	void work(int32_t worker);
+
+	friend class PoolTask;
+
+	// forbidden
+	WorkerPool(const WorkerPool&);
+	WorkerPool& operator=(const WorkerPool&);
+};
+
+}
+
+#endif
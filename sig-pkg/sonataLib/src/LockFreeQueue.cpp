@@ -0,0 +1,154 @@
+/*******************************************************************************
+
+ File:    LockFreeQueue.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Lock-free queue class methods
+//
+#include <sched.h>
+#include "Err.h"
+#include "LockFreeQueue.h"
+
+namespace sonata_lib {
+
+// spins before yielding while waiting on a cell
+const int32_t CELL_SPINS = 100;
+
+SpscQueue::SpscQueue(string name_, int slots_): Queue(name_, slots_)
+{
+}
+
+SpscQueue::~SpscQueue()
+{
+}
+
+/**
+ * Send a message.
+ *
+ * Notes:\n
+ * 	The semaphore post which follows the store publishes the slot to
+ * 	the receiver.
+ */
+Error
+SpscQueue::send(void *msg_, int milliseconds_)
+{
+	Error err = sSem.wait(milliseconds_);
+	if (err)
+		return (err);
+	data[sIndex] = msg_;
+	if (++sIndex == slots)
+		sIndex = 0;
+	rSem.signal();
+	return (0);
+}
+
+Error
+SpscQueue::recv(void **msg_, int milliseconds_)
+{
+	*msg_ = NULL;
+	Error err = rSem.wait(milliseconds_);
+	if (err)
+		return (err);
+	*msg_ = data[rIndex];
+	if (++rIndex == slots)
+		rIndex = 0;
+	sSem.signal();
+	return (0);
+}
+
+MpmcQueue::MpmcQueue(string name_, int slots_): Queue(name_, slots_),
+		mask(0), cells(0), sTicket(0), rTicket(0)
+{
+	uint32_t n = 1;
+	while (n < (uint32_t) slots_)
+		n <<= 1;
+	mask = n - 1;
+	cells = new Cell[n];
+	if (!cells)
+		Fatal(ERR_MAF);
+	for (uint32_t i = 0; i < n; ++i)
+		cells[i].seq = i;
+}
+
+MpmcQueue::~MpmcQueue()
+{
+	delete [] cells;
+}
+
+/**
+ * Send a message.
+ *
+ * Description:\n
+ * 	Waits for a free slot, claims the next ticket, then waits for the
+ * 	receiver of the previous lap to release the cell.  The wait is
+ * 	normally zero; it is only nonzero if that receiver was preempted
+ * 	between claiming its ticket and emptying the cell.
+ */
+Error
+MpmcQueue::send(void *msg_, int milliseconds_)
+{
+	Error err = sSem.wait(milliseconds_);
+	if (err)
+		return (err);
+	uint32_t ticket = __sync_fetch_and_add(&sTicket, 1);
+	Cell& cell = cells[ticket & mask];
+	for (int32_t spin = 0; cell.seq != ticket; ++spin) {
+		if (spin >= CELL_SPINS)
+			sched_yield();
+	}
+	__sync_synchronize();
+	cell.msg = msg_;
+	__sync_synchronize();
+	cell.seq = ticket + 1;
+	rSem.signal();
+	return (0);
+}
+
+Error
+MpmcQueue::recv(void **msg_, int milliseconds_)
+{
+	*msg_ = NULL;
+	Error err = rSem.wait(milliseconds_);
+	if (err)
+		return (err);
+	uint32_t ticket = __sync_fetch_and_add(&rTicket, 1);
+	Cell& cell = cells[ticket & mask];
+	for (int32_t spin = 0; cell.seq != ticket + 1; ++spin) {
+		if (spin >= CELL_SPINS)
+			sched_yield();
+	}
+	__sync_synchronize();
+	*msg_ = cell.msg;
+	__sync_synchronize();
+	cell.seq = ticket + mask + 1;
+	sSem.signal();
+	return (0);
+}
+
+}
@@ -34,6 +34,7 @@
 // $Header: /home/cvs/nss/sonata-pkg/sonataLib/src/Msg.cpp,v 1.4 2009/05/24 23:29:05 kes Exp $
 //
 #include <string>
+#include <pthread.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include <sseInterface.h>
@@ -221,7 +222,6 @@ MsgList::alloc(DxMessageCode code_, int32_t activityId_, void *data_,
 		int32_t len_, MemBlk *blk_, MsgDataType dataType_)
 {
 	Msg *msg;
-	SseInterfaceHeader hdr;
 
 	lock();
 	if (msgList.empty()) {
@@ -234,15 +234,7 @@ MsgList::alloc(DxMessageCode code_, int32_t activityId_, void *data_,
 	msg = msgList.front();
 	msgList.pop_front();
 
-	Assert(!msg->allocated());
-	msg->setAllocated();
-
-	hdr.code = code_;
-	hdr.activityId = activityId_;
-	GetNssDate(hdr.timestamp);
-	hdr.messageNumber = GetNextMsg();
-	msg->setHeader(hdr);
-	msg->setData(data_, len_, blk_, dataType_);
+	initMsg(msg, code_, activityId_, data_, len_, blk_, dataType_);
 
 	++allocs;
 	unlock();
@@ -259,12 +251,7 @@ MsgList::alloc(DxMessageCode code_, int32_t activityId_, void *data_,
 bool
 MsgList::free(Msg *msg_)
 {
-	void *data;
-
-	if (msg_->getDataLength() && (data = msg_->getData()))
-		msg_->freeData();
-	Assert(msg_->allocated());
-	msg_->setAllocated(false);
+	releaseMsg(msg_);
 
 	lock();
 	msgList.push_back(msg_);
@@ -273,6 +260,174 @@ MsgList::free(Msg *msg_)
 	return (true);
 }
 
+/**
+ * Take a batch of messages from the list.
+ *
+ * Description:\n
+ * 	Removes up to n messages from the free list with a single lock.
+ * 	The messages are not initialized; each must be set up by initMsg
+ * 	before it is used.
+ *
+ * @param		msgs array to receive the messages.
+ * @param		n maximum number of messages.
+ * @return		number of messages removed.
+ */
+int32_t
+MsgList::allocBatch(Msg **msgs, int32_t n)
+{
+	lock();
+	int32_t i;
+	for (i = 0; i < n && !msgList.empty(); ++i) {
+		msgs[i] = msgList.front();
+		msgList.pop_front();
+	}
+	allocs += i;
+	unlock();
+	return (i);
+}
+
+/**
+ * Return a batch of released messages to the list.
+ */
+void
+MsgList::freeBatch(Msg **msgs, int32_t n)
+{
+	lock();
+	for (int32_t i = 0; i < n; ++i)
+		msgList.push_back(msgs[i]);
+	frees += n;
+	unlock();
+}
+
+void
+MsgList::initMsg(Msg *msg, DxMessageCode code_, int32_t activityId_,
+		void *data_, int32_t len_, MemBlk *blk_, MsgDataType dataType_)
+{
+	SseInterfaceHeader hdr;
+
+	Assert(!msg->allocated());
+	msg->setAllocated();
+
+	hdr.code = code_;
+	hdr.activityId = activityId_;
+	GetNssDate(hdr.timestamp);
+	hdr.messageNumber = GetNextMsg();
+	msg->setHeader(hdr);
+	msg->setData(data_, len_, blk_, dataType_);
+}
 
+void
+MsgList::releaseMsg(Msg *msg)
+{
+	if (msg->getDataLength() && msg->getData())
+		msg->freeData();
+	Assert(msg->allocated());
+	msg->setAllocated(false);
+}
 
-}
\ No newline at end of file
+/**
+ * Msg cache
+*/
+
+static __thread MsgCache *threadCache = 0;
+static pthread_key_t cacheKey;
+static pthread_once_t cacheKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Release the cache of an exiting thread, returning its messages to
+ * the message list.
+ */
+static void
+releaseThreadCache(void *cache)
+{
+	delete static_cast<MsgCache *> (cache);
+	threadCache = 0;
+}
+
+static void
+createCacheKey()
+{
+	if (pthread_key_create(&cacheKey, releaseThreadCache))
+		Fatal(ERR_MAF);
+}
+
+/**
+ * Get the cache of the calling thread.
+ *
+ * Notes:\n
+ * 	The cache is created on first use and deleted, after its messages
+ * 	are returned to the list, when the thread exits.
+ */
+MsgCache *
+MsgCache::getInstance()
+{
+	if (!threadCache) {
+		pthread_once(&cacheKeyOnce, createCacheKey);
+		threadCache = new MsgCache();
+		if (pthread_setspecific(cacheKey, threadCache))
+			Fatal(ERR_MAF);
+	}
+	return (threadCache);
+}
+
+MsgCache::MsgCache(MsgList *list_, int32_t size_): list(list_), size(size_),
+		count(0), cache(0)
+{
+	if (!list)
+		list = MsgList::getInstance();
+	Assert(list);
+	Assert(size > 0);
+	cache = new Msg *[2 * size];
+	if (!cache)
+		Fatal(ERR_MAF);
+}
+
+MsgCache::~MsgCache()
+{
+	flush();
+	delete [] cache;
+}
+
+Msg *
+MsgCache::alloc(DxMessageCode code_, int32_t activityId_, void *data_,
+		int32_t len_, MemBlk *blk_, MsgDataType dataType_)
+{
+	if (!count && !(count = list->allocBatch(cache, size)))
+		Fatal(ERR_NMA);
+	Msg *msg = cache[--count];
+	MsgList::initMsg(msg, code_, activityId_, data_, len_, blk_, dataType_);
+	return (msg);
+}
+
+/**
+ * Free a message.
+ *
+ * Description:\n
+ * 	Releases the message data and caches the message.  When the cache
+ * 	is full, the oldest half is returned to the message list.
+ */
+bool
+MsgCache::free(Msg *msg_)
+{
+	MsgList::releaseMsg(msg_);
+	if (count == 2 * size) {
+		list->freeBatch(cache, size);
+		memmove(cache, cache + size, size * sizeof(Msg *));
+		count = size;
+	}
+	cache[count++] = msg_;
+	return (true);
+}
+
+/**
+ * Return all cached messages to the message list.
+ */
+void
+MsgCache::flush()
+{
+	if (count)
+		list->freeBatch(cache, count);
+	count = 0;
+}
+
+}
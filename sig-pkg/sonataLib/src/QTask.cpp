@@ -46,7 +46,8 @@ namespace sonata_lib {
 // base class for all DX tasks which accept input via a queue
 //
 QTask::QTask(string tname_, int prio_, bool realtime_, bool detach_):
-		Task(tname_, prio_, realtime_, detach_), terminated(false)
+		Task(tname_, prio_, realtime_, detach_), terminated(false),
+		msgCache(false)
 {
 	inQ = new Queue("inQ" + tname_);
 	Assert(inQ);
@@ -87,7 +88,9 @@ QTask::routine()
 		uint64_t t2 = getticks();
 #endif
 		// then free it
-		if (!msgList->free(msg)) {
+		bool freed = msgCache ? MsgCache::getInstance()->free(msg)
+				: msgList->free(msg);
+		if (!freed) {
 			Debug(DEBUG_QTASK, 0, getName());
 			Fatal(0);
 		}
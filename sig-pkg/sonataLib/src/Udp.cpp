@@ -45,14 +45,23 @@
 namespace sonata_lib {
 
 Udp::Udp(string cname_, Unit unit_): Connection(cname_, unit_, UdpConnection),
-		port(DEFAULT_PORT)
+		port(DEFAULT_PORT), mmsg(0), iov(0)
 {
 	strcpy(hostIp, DEFAULT_IP);
+	mmsg = new struct mmsghdr[MAX_UDP_BATCH];
+	iov = new struct iovec[MAX_UDP_BATCH];
+	memset(mmsg, 0, MAX_UDP_BATCH * sizeof(struct mmsghdr));
+	for (int32_t i = 0; i < MAX_UDP_BATCH; ++i) {
+		mmsg[i].msg_hdr.msg_iov = &iov[i];
+		mmsg[i].msg_hdr.msg_iovlen = 1;
+	}
 }
 
 Udp::~Udp()
 {
 	groupSet.clear();
+	delete [] mmsg;
+	delete [] iov;
 }
 
 void
@@ -276,6 +285,51 @@ Udp::recv(void *msg_, size_t len)
 	return (0);
 }
 
+/**
+ * Receive a batch of packets.
+ *
+ * Description:\n
+ * 	Receives up to count datagrams with a single recvmmsg call,
+ * 	blocking only until the first datagram arrives.  The buffers
+ * 	are supplied by the caller as an array of pointers with a
+ * 	matching array of lengths; on return count is the number of
+ * 	datagrams received and len[i] is the length of datagram i.
+ * Notes:\n
+ * 	Datagrams are not validated; the caller must compare the
+ * 	returned lengths against the expected packet size.\n
+ * 	A return of 0 with count == 0 means the socket was shut down.
+ *
+ * @param		msg array of packet buffers.
+ * @param		len on entry, the size of each buffer; on return, the
+ * 				length of each datagram received.
+ * @param		count on entry, the number of buffers; on return, the
+ * 				number of datagrams received.
+ */
+Error
+Udp::recv(void **msg, size_t *len, int32_t& count)
+{
+	int32_t n = count;
+	count = 0;
+	if (connection < 0)
+		return (ERR_NS);
+	if (n > MAX_UDP_BATCH)
+		n = MAX_UDP_BATCH;
+
+	for (int32_t i = 0; i < n; ++i) {
+		mmsg[i].msg_hdr.msg_name = 0;
+		mmsg[i].msg_hdr.msg_namelen = 0;
+		iov[i].iov_base = msg[i];
+		iov[i].iov_len = len[i];
+	}
+	int rval = recvmmsg(connection, mmsg, n, MSG_WAITFORONE, 0);
+	if (rval < 0)
+		return (errno);
+	for (int32_t i = 0; i < rval; ++i)
+		len[i] = mmsg[i].msg_len;
+	count = rval;
+	return (0);
+}
+
 //
 // send: send a packet
 //
@@ -323,6 +377,48 @@ Udp::send(void *msg_, size_t len, const IpAddress& dest, int32_t port)
 	return (0);
 }
 
+/**
+ * Send a batch of packets.
+ *
+ * Description:\n
+ * 	Sends up to count datagrams with a single sendmmsg call, each to
+ * 	its own destination.  On return count is the number of datagrams
+ * 	actually sent, which may be less than requested; the caller is
+ * 	responsible for resubmitting the remainder.
+ * Notes:\n
+ * 	If the first datagram cannot be sent the error is returned and
+ * 	count is 0.
+ *
+ * @param		msg array of packet buffers.
+ * @param		len array of packet lengths.
+ * @param		dest array of destination addresses.
+ * @param		count on entry, the number of packets; on return, the
+ * 				number of packets sent.
+ */
+Error
+Udp::send(void **msg, size_t *len, const struct sockaddr_in **dest,
+		int32_t& count)
+{
+	int32_t n = count;
+	count = 0;
+	if (connection < 0)
+		return (ERR_NS);
+	if (n > MAX_UDP_BATCH)
+		n = MAX_UDP_BATCH;
+
+	for (int32_t i = 0; i < n; ++i) {
+		mmsg[i].msg_hdr.msg_name = (void *) dest[i];
+		mmsg[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		iov[i].iov_base = msg[i];
+		iov[i].iov_len = len[i];
+	}
+	int rval = sendmmsg(connection, mmsg, n, 0);
+	if (rval < 0)
+		return (errno);
+	count = rval;
+	return (0);
+}
+
 /**
  * Close the connection.
  *
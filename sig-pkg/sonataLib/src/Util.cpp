@@ -44,7 +44,8 @@ GetNextMsg()
 {
 	static uint32_t nextMsg = 0;
 
-	return (nextMsg++);
+	// messages may be allocated outside the message list lock
+	return (__sync_fetch_and_add(&nextMsg, 1));
 }
 
 void
@@ -0,0 +1,168 @@
+/*******************************************************************************
+
+ File:    WorkerPool.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Worker pool class methods
+//
+// The pool hands out items with an atomic counter, so the assignment of
+// items to workers is dynamic; a job which needs deterministic results
+// must keep the output of each item separate and combine it in item order
+// after run() returns.
+//
+#include <sstream>
+#include "Err.h"
+#include "WorkerPool.h"
+
+namespace sonata_lib {
+
+PoolTask::PoolTask(string name_, int prio_, bool realtime_,
+		WorkerPool *pool_, int32_t worker_):
+		Task(name_, prio_, realtime_, false), worker(worker_), pool(pool_),
+		startSem(name_ + "Start", 0)
+{
+}
+
+PoolTask::~PoolTask()
+{
+}
+
+void *
+PoolTask::routine()
+{
+	while (1) {
+		startSem.wait();
+		if (pool->stopped)
+			break;
+		pool->work(worker);
+		pool->doneSem.signal();
+	}
+	return (0);
+}
+
+/**
+ * Create a worker pool.
+ *
+ * Description:\n
+ * 	Creates and starts workers - 1 helper tasks; the task calling run()
+ * 	is the remaining worker.
+ *
+ * @param	name_ name of the pool; helper tasks are named name_N.
+ * @param	workers_ total number of workers.
+ * @param	prio_ priority of the helper tasks.
+ * @param	realtime_ whether the helper tasks are realtime.
+ */
+WorkerPool::WorkerPool(string name_, int32_t workers_, int prio_,
+		bool realtime_): stopped(false), workers(workers_), items(0),
+		next(0), job(0), tasks(0), runLock(name_ + "Run"),
+		doneSem(name_ + "Done", 0), pname(name_)
+{
+	if (workers < 1)
+		workers = 1;
+	if (workers > 1) {
+		tasks = new PoolTask *[workers - 1];
+		if (!tasks)
+			Fatal(ERR_MAF);
+	}
+	for (int32_t i = 1; i < workers; ++i) {
+		std::stringstream s;
+		s << pname << i;
+		PoolTask *task = new PoolTask(s.str(), prio_, realtime_, this, i);
+		if (!task)
+			Fatal(ERR_MAF);
+		task->start();
+		tasks[i-1] = task;
+	}
+}
+
+/**
+ * Destroy the pool.
+ *
+ * Description:\n
+ * 	Wakes each helper task with the stopped flag set, then waits for
+ * 	it to exit.
+ */
+WorkerPool::~WorkerPool()
+{
+	runLock.lock();
+	stopped = true;
+	for (int32_t i = 0; i < workers - 1; ++i) {
+		tasks[i]->startJob();
+		tasks[i]->join();
+		delete tasks[i];
+	}
+	delete [] tasks;
+	runLock.unlock();
+}
+
+/**
+ * Execute a job.
+ *
+ * Description:\n
+ * 	Starts all helper tasks on the job, executes items in the calling
+ * 	task until there are none left, then waits for the helper tasks to
+ * 	finish their last items.
+ *
+ * @param	job_ the job to execute.
+ * @param	items_ the number of items in the job.
+ */
+void
+WorkerPool::run(PoolJob *job_, int32_t items_)
+{
+	Assert(job_);
+	runLock.lock();
+	job = job_;
+	items = items_;
+	next = 0;
+	__sync_synchronize();
+	// with only one item there is nothing to share
+	int32_t helpers = (items > 1 ? workers - 1 : 0);
+	for (int32_t i = 0; i < helpers; ++i)
+		tasks[i]->startJob();
+	work(0);
+	for (int32_t i = 0; i < helpers; ++i)
+		doneSem.wait();
+	job = 0;
+	runLock.unlock();
+}
+
+/**
+ * Execute items until the job is exhausted.
+ *
+ * @param	worker index of the worker executing the items.
+ */
+void
+WorkerPool::work(int32_t worker)
+{
+	int32_t item;
+	while ((item = __sync_fetch_and_add(&next, 1)) < items)
+		job->execute(worker, item);
+}
+
+}
@@ -0,0 +1,187 @@
+/*******************************************************************************
+
+ File:    queueBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Queue benchmark: measures message throughput and send-to-receive
+// latency through the locked queue and the lock-free queues with 1, 2
+// and 4 producers feeding a single consumer.  Each configuration is
+// run both with messages allocated from the message list and with
+// per-thread message caches, as a task would send them.
+//
+#include <iomanip>
+#include <iostream>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+#include "LockFreeQueue.h"
+#include "Msg.h"
+
+using namespace sonata_lib;
+using std::cout;
+using std::endl;
+using std::fixed;
+using std::setprecision;
+using std::setw;
+using std::vector;
+
+const int32_t BENCH_MSGS = 400000;
+const int32_t BENCH_SLOTS = 1000;
+const int32_t BENCH_MSG_LIST = 4000;
+
+enum QueueType { LockedQueue, SingleQueue, MultiQueue };
+
+static const char *queueName[] = { "Queue", "SpscQueue", "MpmcQueue" };
+
+static uint64_t
+nsec()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+struct BenchArgs {
+	Queue *q;
+	int32_t msgs;
+	bool cache;
+	uint64_t *stamp;					// send time of each message
+	double latency;						// total latency (ns)
+	uint64_t maxLatency;
+
+	BenchArgs(): q(0), msgs(0), cache(false), stamp(0), latency(0),
+			maxLatency(0) {}
+};
+
+static void *
+producer(void *arg)
+{
+	BenchArgs *a = static_cast<BenchArgs *> (arg);
+	MsgList *msgList = MsgList::getInstance();
+	MsgCache *cache = MsgCache::getInstance();
+	for (int32_t i = 0; i < a->msgs; ++i) {
+		a->stamp[i] = nsec();
+		Msg *msg = a->cache ? cache->alloc() : msgList->alloc();
+		msg->setData(&a->stamp[i], sizeof(uint64_t), 0, USER);
+		a->q->send(msg);
+	}
+	cache->flush();
+	return (0);
+}
+
+static void *
+consumer(void *arg)
+{
+	BenchArgs *a = static_cast<BenchArgs *> (arg);
+	MsgList *msgList = MsgList::getInstance();
+	MsgCache *cache = MsgCache::getInstance();
+	for (int32_t i = 0; i < a->msgs; ++i) {
+		Msg *msg;
+		a->q->recv((void **) &msg);
+		uint64_t t = nsec() - *static_cast<uint64_t *> (msg->getData());
+		a->latency += t;
+		if (t > a->maxLatency)
+			a->maxLatency = t;
+		// the data belongs to the producer
+		msg->setData(0, 0, 0, USER);
+		if (a->cache)
+			cache->free(msg);
+		else
+			msgList->free(msg);
+	}
+	cache->flush();
+	return (0);
+}
+
+static void
+run(QueueType type, int32_t producers, bool cache)
+{
+	Queue *q;
+	switch (type) {
+	case SingleQueue:
+		q = new SpscQueue("bench", BENCH_SLOTS);
+		break;
+	case MultiQueue:
+		q = new MpmcQueue("bench", BENCH_SLOTS);
+		break;
+	default:
+		q = new Queue("bench", BENCH_SLOTS);
+		break;
+	}
+	int32_t msgs = BENCH_MSGS / producers;
+	vector<uint64_t> stamp(producers * msgs);
+	vector<BenchArgs> p(producers);
+	vector<pthread_t> pt(producers);
+	BenchArgs c;
+	c.q = q;
+	c.msgs = producers * msgs;
+	c.cache = cache;
+
+	uint64_t start = nsec();
+	pthread_t ct;
+	pthread_create(&ct, 0, consumer, &c);
+	for (int32_t i = 0; i < producers; ++i) {
+		p[i].q = q;
+		p[i].msgs = msgs;
+		p[i].cache = cache;
+		p[i].stamp = &stamp[i * msgs];
+		pthread_create(&pt[i], 0, producer, &p[i]);
+	}
+	for (int32_t i = 0; i < producers; ++i)
+		pthread_join(pt[i], 0);
+	pthread_join(ct, 0);
+	double t = (nsec() - start) / 1e9;
+	delete q;
+
+	cout << setw(10) << queueName[type] << setw(8) << (cache ? "cache" : "list")
+			<< setw(4) << producers << fixed << setprecision(0)
+			<< setw(12) << c.msgs / t
+			<< setw(12) << c.latency / c.msgs
+			<< setw(12) << c.maxLatency / 1000 << endl;
+}
+
+int
+main(int argc, char **argv)
+{
+	MsgList::getInstance("MsgList", BENCH_MSG_LIST);
+
+	cout << "     queue   msgs   P      msgs/s   mean (ns)    max (us)"
+			<< endl;
+	const int32_t producers[] = { 1, 2, 4 };
+	for (int32_t cache = 0; cache < 2; ++cache) {
+		run(SingleQueue, 1, cache);
+		for (uint32_t i = 0; i < sizeof(producers) / sizeof(producers[0]);
+				++i) {
+			run(LockedQueue, producers[i], cache);
+			run(MultiQueue, producers[i], cache);
+		}
+	}
+	return (0);
+}
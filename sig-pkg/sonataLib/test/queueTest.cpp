@@ -0,0 +1,330 @@
+/*******************************************************************************
+
+ File:    queueTest.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Queue stress test: checks that the locked, single-producer and
+// multiple-producer queues deliver every message exactly once and in
+// order for each producer, that timeouts behave as for Queue, and that
+// messages allocated and freed through message caches are all returned
+// to the message list.
+//
+// Returns a non-zero exit status on failure.
+//
+#include <iostream>
+#include <pthread.h>
+#include <stdint.h>
+#include <vector>
+#include "LockFreeQueue.h"
+#include "Msg.h"
+
+using namespace sonata_lib;
+using std::cout;
+using std::endl;
+using std::vector;
+
+const int32_t STRESS_SLOTS = 8;
+const int32_t STRESS_MSGS = 200000;
+const int32_t CACHE_MSGS = 100000;
+const int32_t MSG_LIST_SIZE = 1000;
+const int32_t PRODUCER_SHIFT = 24;
+
+enum QueueType { LockedQueue, SingleQueue, MultiQueue };
+
+static const char *queueName[] = { "Queue", "SpscQueue", "MpmcQueue" };
+
+static Queue *
+createQueue(QueueType type, int32_t slots)
+{
+	switch (type) {
+	case SingleQueue:
+		return (new SpscQueue("test", slots));
+	case MultiQueue:
+		return (new MpmcQueue("test", slots));
+	default:
+		return (new Queue("test", slots));
+	}
+}
+
+struct StressArgs {
+	Queue *q;
+	int32_t id;
+	int32_t msgs;						// messages per producer
+	int32_t producers;
+	int32_t received;
+	int32_t errors;
+	vector<uint8_t> *seen;				// shared: one entry per message
+
+	StressArgs(): q(0), id(0), msgs(0), producers(0), received(0),
+			errors(0), seen(0) {}
+};
+
+static void *
+producer(void *arg)
+{
+	StressArgs *a = static_cast<StressArgs *> (arg);
+	for (int32_t i = 0; i < a->msgs; ++i) {
+		intptr_t v = ((intptr_t) a->id << PRODUCER_SHIFT) | i;
+		if (a->q->send((void *) (v + 1)))
+			++a->errors;
+	}
+	return (0);
+}
+
+/**
+ * Receive messages until the shared count is exhausted, checking that
+ * each producer's messages arrive in order.
+ */
+static void *
+consumer(void *arg)
+{
+	StressArgs *a = static_cast<StressArgs *> (arg);
+	vector<int32_t> last(a->producers, -1);
+	while (1) {
+		void *msg;
+		if (a->q->recv(&msg, 1000))
+			break;
+		intptr_t v = (intptr_t) msg - 1;
+		int32_t p = v >> PRODUCER_SHIFT;
+		int32_t seq = v & ((1 << PRODUCER_SHIFT) - 1);
+		if (p < 0 || p >= a->producers || seq <= last[p])
+			++a->errors;
+		else {
+			last[p] = seq;
+			++(*a->seen)[p * a->msgs + seq];
+		}
+		++a->received;
+	}
+	return (0);
+}
+
+/**
+ * Run producers and consumers through a queue.
+ */
+static int32_t
+stress(QueueType type, int32_t producers, int32_t consumers)
+{
+	Queue *q = createQueue(type, STRESS_SLOTS);
+	int32_t msgs = STRESS_MSGS / producers;
+	vector<uint8_t> seen(producers * msgs, 0);
+	vector<StressArgs> p(producers), c(consumers);
+	vector<pthread_t> pt(producers), ct(consumers);
+
+	for (int32_t i = 0; i < consumers; ++i) {
+		c[i].q = q;
+		c[i].msgs = msgs;
+		c[i].producers = producers;
+		c[i].seen = &seen;
+		pthread_create(&ct[i], 0, consumer, &c[i]);
+	}
+	for (int32_t i = 0; i < producers; ++i) {
+		p[i].q = q;
+		p[i].id = i;
+		p[i].msgs = msgs;
+		pthread_create(&pt[i], 0, producer, &p[i]);
+	}
+	int32_t errors = 0, received = 0;
+	for (int32_t i = 0; i < producers; ++i) {
+		pthread_join(pt[i], 0);
+		errors += p[i].errors;
+	}
+	for (int32_t i = 0; i < consumers; ++i) {
+		pthread_join(ct[i], 0);
+		errors += c[i].errors;
+		received += c[i].received;
+	}
+	int32_t lost = 0;
+	for (uint32_t i = 0; i < seen.size(); ++i) {
+		if (seen[i] != 1)
+			++lost;
+	}
+	delete q;
+
+	bool ok = !errors && !lost && received == producers * msgs;
+	cout << queueName[type] << ": " << producers << " producers, "
+			<< consumers << " consumers, " << received << " received, "
+			<< errors << " out of order, " << lost << " lost or duplicated: "
+			<< (ok ? "OK" : "FAILED") << endl;
+	return (ok ? 0 : 1);
+}
+
+/**
+ * A receive from an empty queue and a send to a full queue must time
+ * out.
+ */
+static int32_t
+timeouts(QueueType type)
+{
+	Queue *q = createQueue(type, 2);
+	void *msg = (void *) 1;
+	int32_t errors = 0;
+	if (!q->recv(&msg, 10) || msg)
+		++errors;
+	if (!q->recv(&msg, 0))
+		++errors;
+	if (q->send((void *) 1, 0) || q->send((void *) 2, 0))
+		++errors;
+	if (!q->send((void *) 3, 0) || !q->send((void *) 3, 10))
+		++errors;
+	if (q->recv(&msg, 0) || msg != (void *) 1)
+		++errors;
+	if (q->recv(&msg, 0) || msg != (void *) 2)
+		++errors;
+	delete q;
+	cout << queueName[type] << " timeouts: " << (errors ? "FAILED" : "OK")
+			<< endl;
+	return (errors ? 1 : 0);
+}
+
+struct CacheArgs {
+	Queue *q;
+	int32_t msgs;
+	int32_t errors;
+
+	CacheArgs(): q(0), msgs(0), errors(0) {}
+};
+
+static void *
+cacheProducer(void *arg)
+{
+	CacheArgs *a = static_cast<CacheArgs *> (arg);
+	MsgCache *cache = MsgCache::getInstance();
+	for (int32_t i = 0; i < a->msgs; ++i) {
+		Msg *msg = cache->alloc(MESSAGE_CODE_UNINIT, i);
+		if (a->q->send(msg))
+			++a->errors;
+	}
+	cache->flush();
+	return (0);
+}
+
+static void *
+cacheConsumer(void *arg)
+{
+	CacheArgs *a = static_cast<CacheArgs *> (arg);
+	MsgCache *cache = MsgCache::getInstance();
+	for (int32_t i = 0; i < a->msgs; ++i) {
+		Msg *msg;
+		if (a->q->recv((void **) &msg) || msg->getActivityId() != i)
+			++a->errors;
+		cache->free(msg);
+	}
+	cache->flush();
+	return (0);
+}
+
+/**
+ * Pass messages allocated from one thread's cache to another thread
+ * which frees them to its own cache; every message must get back to
+ * the message list.
+ */
+static int32_t
+msgCache()
+{
+	MsgList *msgList = MsgList::getInstance();
+	int32_t free = msgList->getFreeMessages();
+	SpscQueue q("cache", 64);
+	CacheArgs p, c;
+	p.q = c.q = &q;
+	p.msgs = c.msgs = CACHE_MSGS;
+	pthread_t pt, ct;
+	pthread_create(&ct, 0, cacheConsumer, &c);
+	pthread_create(&pt, 0, cacheProducer, &p);
+	pthread_join(pt, 0);
+	pthread_join(ct, 0);
+
+	int32_t errors = p.errors + c.errors;
+	if (msgList->getFreeMessages() != free)
+		++errors;
+	cout << "MsgCache: " << CACHE_MSGS << " messages, "
+			<< msgList->getFreeMessages() << " of " << free << " free: "
+			<< (errors ? "FAILED" : "OK") << endl;
+	return (errors ? 1 : 0);
+}
+
+static void *
+cacheHolder(void *arg)
+{
+	CacheArgs *a = static_cast<CacheArgs *> (arg);
+	MsgCache *cache = MsgCache::getInstance();
+	std::vector<Msg *> msgs(a->msgs);
+	for (int32_t i = 0; i < a->msgs; ++i)
+		msgs[i] = cache->alloc(MESSAGE_CODE_UNINIT, i);
+	for (int32_t i = 0; i < a->msgs; ++i)
+		cache->free(msgs[i]);
+	if (!cache->getCached())
+		++a->errors;
+	return (0);
+}
+
+/**
+ * Let a thread exit while its cache holds messages; they must get
+ * back to the message list.
+ */
+static int32_t
+msgCacheExit()
+{
+	MsgList *msgList = MsgList::getInstance();
+	int32_t free = msgList->getFreeMessages();
+	CacheArgs a;
+	a.msgs = DEFAULT_MSG_CACHE + DEFAULT_MSG_CACHE / 2;
+	pthread_t t;
+	pthread_create(&t, 0, cacheHolder, &a);
+	pthread_join(t, 0);
+
+	int32_t errors = a.errors;
+	if (msgList->getFreeMessages() != free)
+		++errors;
+	cout << "MsgCache thread exit: " << msgList->getFreeMessages() << " of "
+			<< free << " free: " << (errors ? "FAILED" : "OK") << endl;
+	return (errors ? 1 : 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	MsgList::getInstance("MsgList", MSG_LIST_SIZE);
+
+	int32_t failures = 0;
+	QueueType types[] = { LockedQueue, SingleQueue, MultiQueue };
+	for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t)
+		failures += timeouts(types[t]);
+
+	failures += stress(LockedQueue, 1, 1);
+	failures += stress(SingleQueue, 1, 1);
+	const int32_t config[][2] = { { 1, 1 }, { 2, 1 }, { 4, 1 }, { 4, 4 },
+			{ 1, 3 } };
+	for (uint32_t i = 0; i < sizeof(config) / sizeof(config[0]); ++i)
+		failures += stress(MultiQueue, config[i][0], config[i][1]);
+	failures += stress(LockedQueue, 4, 2);
+
+	failures += msgCache();
+	failures += msgCacheExit();
+	return (failures ? 1 : 0);
+}
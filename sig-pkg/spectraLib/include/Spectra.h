@@ -105,6 +105,27 @@ struct scalar {
 	}
 };
 
+/**
+* Spectrum computation modes.
+*
+* In swap mode, the two halves of each FFT output are swapped after the
+* transform to put DC in the middle of the spectrum, then the spectrum
+* is rescaled.  In modulate mode, the input is multiplied by (-1)^n as
+* it is copied, which shifts DC to the middle of the FFT output, so the
+* FFT can be performed directly into the output buffer and the only
+* pass after the transform is the rescale.  The two modes agree to
+* within rounding error.
+*
+* Notes:
+*	Modulate mode requires the modulation to have the same phase at
+*	the start of every transform, so every spectrum length must be a
+*	multiple of 4; otherwise swap mode is used.
+*/
+enum SpectraMode {
+	SPECTRA_SWAP,
+	SPECTRA_MODULATE
+};
+
 // resolution data
 struct ResData {
 	Resolution res;					// resolution
@@ -129,9 +150,9 @@ struct ResInfo {
 
 struct SpecRes {
 	SpecRes(): resolution(RES_UNINIT), overlap(false), specLen(0), fftLen(0),
-			nSpectra(0), scale(0), plan(0) {}
+			nSpectra(0), scale(0), plan(0), sharedPlan(false) {}
 	~SpecRes() {
-		if (plan)
+		if (plan && !sharedPlan)
 			fftwf_destroy_plan(plan);
 	}
 
@@ -142,6 +163,7 @@ struct SpecRes {
 	int32_t nSpectra;					// # of spectra created by computeSpectra
 	float scale;						// normalization scale factor
 	fftwf_plan plan;					// plan
+	bool sharedPlan;					// plan belongs to another resolution
 
 	friend ostream& operator << (ostream& s, const SpecRes& specRes);
 };
@@ -185,6 +207,8 @@ public:
 	void computeSpectra(const complex<float> *input, complex<float> **output);
 	void computeSpectra(complex<float> **input, complex<float> **output);
 	void setDebugLevel(int32_t level) { debugLevel = level; }
+	void setMode(SpectraMode mode_) { mode = mode_; }
+	SpectraMode getMode() { return (mode); }
 	const SpectraTiming& getTiming() { return (timing); }
 
 private:
@@ -194,6 +218,9 @@ private:
 	int32_t newHalfFrames;				// # of new half frames each computeSpectra
 	int32_t samplesPerHalfFrame;		// # of samples per half frame
 	int32_t samples;					// total # of td input samples
+	SpectraMode mode;					// spectrum computation mode
+	bool canModulate;					// spectrum lengths allow modulation
+	bool modulate;						// input is modulated by (-1)^n
 	complex<float> *hfData;				// time domain data
 	complex<float> *hfData0;			// time domain data (hf 0)
 	complex<float> *hfData1;			// time domain data (hf 1)
@@ -208,7 +235,10 @@ private:
 
 	void computeSpectra(complex<float> **output);
 	void computeSpectraFft(complex<float> **output);
-	void rescale(complex<float> *data, int32_t len, float factor);
+	void copyInput(complex<float> *dest, const complex<float> *src,
+			int32_t len);
+	void rescale(const complex<float> *src, complex<float> *dest,
+			int32_t len, float factor);
 };
 
 }
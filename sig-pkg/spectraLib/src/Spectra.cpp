@@ -32,6 +32,7 @@
 // Spectrum library
 //
 #include <iostream>
+#include <xmmintrin.h>
 #include "Spectra.h"
 
 using std::cout;
@@ -46,7 +47,8 @@ namespace spectra {
 
 Spectra::Spectra(): debugLevel(0), resolutions(0),
 		halfFrames(0), newHalfFrames(0), samplesPerHalfFrame(0), samples(0),
-		hfData(0), hfData0(0), hfData1(0), hfDataN(0), spectra(0),
+		mode(SPECTRA_SWAP), canModulate(false), modulate(false), hfData(0),
+		hfData0(0), hfData1(0), hfDataN(0), spectra(0),
 		spectra0(0), spectra1(0), spectraN(0)
 {
 }
@@ -54,6 +56,7 @@ Spectra::Spectra(): debugLevel(0), resolutions(0),
 Spectra::~Spectra()
 {
 	fftwf_free(hfData);
+	fftwf_free(spectra);
 }
 
 /**
@@ -156,12 +159,26 @@ Spectra::setup(const ResData *res_, int32_t resolutions_,
 	SpecAssert(halfFrames >= 3);
 	SpecAssert(newHalfFrames % 2 == 0);
 
+	// release the plans and buffers of any previous setup
+	for (int32_t i = 0; i < MAX_RESOLUTIONS; ++i) {
+		if (resolution[i].plan && !resolution[i].sharedPlan)
+			fftwf_destroy_plan(resolution[i].plan);
+		resolution[i].plan = 0;
+		resolution[i].sharedPlan = false;
+	}
+	if (hfData)
+		fftwf_free(hfData);
+	if (spectra)
+		fftwf_free(spectra);
+	hfData = spectra = 0;
+
 	// allocate space for the time-domain data
 	size_t tdLen = halfFrames * samplesPerHalfFrame;
 	hfData = (complex<float> *) fftwf_malloc(tdLen * sizeof(complex<float>));
 	SpecAssert(hfData);
 
 	// initialize each resolution;
+	canModulate = true;
 	for (int32_t i = 0; i < resolutions; ++i) {
 		const ResData& r = res_[i];
 		SpecRes& res = resolution[i];
@@ -171,6 +188,11 @@ Spectra::setup(const ResData *res_, int32_t resolutions_,
 		SpecAssert(res.fftLen);
 		// frame length must be a multiple of spectrum length
 		SpecAssert((2 * samplesPerHalfFrame) % res.specLen == 0);
+		// overlapped transforms start every half spectrum, so the
+		// modulation phase is the same at the start of every transform
+		// only if the spectrum length is a multiple of 4
+		if (res.specLen % 4)
+			canModulate = false;
 
 		//////////////////////////////////////////////
 		// compute parameters for call to computeSpectra, which processes
@@ -195,6 +217,23 @@ Spectra::setup(const ResData *res_, int32_t resolutions_,
 					fftwf_malloc(sSize * sizeof(complex<float>));
 		}
 
+		resInfo[i].res = res.resolution;
+		resInfo[i].nSpectra = res.nSpectra;
+		resInfo[i].specLen = res.specLen;
+
+		// a resolution with the same transforms as an earlier one
+		// shares its plan
+		for (int32_t j = 0; j < i; ++j) {
+			const SpecRes& r = resolution[j];
+			if (r.fftLen == res.fftLen && r.overlap == res.overlap) {
+				res.plan = r.plan;
+				res.sharedPlan = true;
+				break;
+			}
+		}
+		if (res.plan)
+			continue;
+
 		int32_t idist = res.fftLen;
 		if (res.overlap)
 			idist /= 2;
@@ -221,9 +260,6 @@ Spectra::setup(const ResData *res_, int32_t resolutions_,
 				(fftwf_complex *) out, NULL, ostride, odist,
 				FFTW_FORWARD, FFTW_MEASURE);
 		SpecAssert(res.plan);
-		resInfo[i].res = res.resolution;
-		resInfo[i].nSpectra = res.nSpectra;
-		resInfo[i].specLen = res.specLen;
 	}
 #ifdef notdef
 	if (swapBuf && swapBufSize < maxFftLen) {
@@ -268,7 +304,8 @@ Spectra::computeSpectra(const complex<float> *input, complex<float> **output)
 	}
 
 	// copy the input time domain data to the internal buffer
-	memcpy(hfData, input, samples * sizeof(complex<float>));
+	modulate = (mode == SPECTRA_MODULATE && canModulate);
+	copyInput(hfData, input, samples);
 
 	// compute the spectra
 	computeSpectra(output);
@@ -296,9 +333,10 @@ void
 Spectra::computeSpectra(complex<float> **input, complex<float> **output)
 {
 	// move the input data to the correct buffers
+	modulate = (mode == SPECTRA_MODULATE && canModulate);
 	for (int32_t i = 0; i < halfFrames; ++i) {
-		memcpy(&hfData[i*samplesPerHalfFrame], input[i],
-				samplesPerHalfFrame * sizeof(complex<float>));
+		copyInput(&hfData[i*samplesPerHalfFrame], input[i],
+				samplesPerHalfFrame);
 	}
 
 	// compute the spectra
@@ -313,7 +351,11 @@ Spectra::computeSpectra(complex<float> **input, complex<float> **output)
 *	Assumes the input data has already been moved into the half frame
 *	buffers allocated by setup.\n
 * Notes:\n
-*	None.
+*	If the input was modulated, DC is already in the middle of each
+*	FFT output, so the FFT is performed directly into the output
+*	buffer when its alignment allows, and the spectra are rescaled
+*	in place.  Otherwise the halves of each spectrum are swapped into
+*	the output buffer and then rescaled.
 *
 * @param	output array of pointers to output buffers, one for each
 *			resolution.
@@ -335,6 +377,29 @@ Spectra::computeSpectra(complex<float> **output)
 #if (SPECTRA_TIMING)
 		uint64_t t1 = getticks();
 #endif
+		int32_t count = res.nSpectra * res.specLen;
+		if (modulate) {
+			// the FFT can write directly to the output buffer only if
+			// it has the alignment of the buffer used for planning
+			complex<float> *dest = output[i];
+			if (fftwf_alignment_of((float *) dest)
+					!= fftwf_alignment_of((float *) spectra))
+				dest = spectra;
+			fftwf_execute_dft(res.plan, (fftwf_complex *) hfData,
+					(fftwf_complex *) dest);
+#if (SPECTRA_TIMING)
+			uint64_t t2 = getticks();
+#endif
+			rescale(dest, output[i], count, res.specLen);
+#if (SPECTRA_TIMING)
+			uint64_t t4 = getticks();
+			++timing.res.resComputes;
+			timing.res.fft += elapsed(t2, t1);
+			timing.res.rescale += elapsed(t4, t2);
+			timing.res.total += elapsed(t4, t1);
+#endif
+			continue;
+		}
 		fftwf_execute_dft(res.plan, (fftwf_complex *) hfData,
 				(fftwf_complex *) spectra);
 		// swap the front and back half of the FFT output; this puts DC
@@ -355,9 +420,8 @@ Spectra::computeSpectra(complex<float> **output)
 #if (SPECTRA_TIMING)
 		uint64_t t3 = getticks();
 #endif
-		int32_t count = res.nSpectra * res.specLen;
 //		memcpy(output[i], spectra, count * sizeof(complex<float>));
-		rescale(output[i], count, res.specLen);
+		rescale(output[i], output[i], count, res.specLen);
 #if (SPECTRA_TIMING)
 		uint64_t t4 = getticks();
 		++timing.res.resComputes;
@@ -375,11 +439,49 @@ Spectra::computeSpectra(complex<float> **output)
 }
 
 
+/**
+* Copy time-domain input data to the internal buffer.
+*
+* Description:\n
+*	If the input is being modulated, multiplies each sample by
+*	(-1)^n, where n is its index in the buffer, as it is copied;
+*	otherwise the data is copied unchanged.\n\n
+* Notes:\n
+*	The destination must be at an even index in the buffer.
+*/
+void
+Spectra::copyInput(complex<float> *dest, const complex<float> *src,
+		int32_t len)
+{
+	if (!modulate) {
+		memcpy(dest, src, len * sizeof(complex<float>));
+		return;
+	}
+	SpecAssert(((dest - hfData) & 1) == 0);
+	SpecAssert((len & 1) == 0);
+	// negate the odd sample of each pair by flipping its sign bits
+	const __m128 sign = _mm_set_ps(-0.0, -0.0, 0.0, 0.0);
+
+	// use vector operations, so halve the iteration count; the input
+	// buffers need not be aligned
+	len /= 2;
+
+	float *d = (float *) dest;
+	const float *sd = (const float *) src;
+	for (int32_t i = 0; i < len; ++i, d += 4, sd += 4)
+		_mm_store_ps(d, _mm_xor_ps(_mm_loadu_ps(sd), sign));
+}
+
 /**
 * Rescale the spectrum to normalize the power.
+*
+* Description:\n
+*	Stores the scaled source data in the destination, which may be the
+*	same as the source.
 */
 void
-Spectra::rescale(complex<float> *data, int32_t len, float factor)
+Spectra::rescale(const complex<float> *src, complex<float> *dest, int32_t len,
+		float factor)
 {
 	scalar f[2] __attribute__ ((aligned (16)));
 
@@ -388,11 +490,12 @@ Spectra::rescale(complex<float> *data, int32_t len, float factor)
 	// use vector operations, so halve the iteration count
 	len /= 2;
 
-	v4sf *d = (v4sf *) data;
+	v4sf *d = (v4sf *) dest;
+	const v4sf *sd = (const v4sf *) src;
 	v4sf *s = (v4sf *) f;
 
 	for (int32_t i = 0; i < len; ++i)
-		d[i] *= s[0];
+		d[i] = sd[i] * s[0];
 //		d[i] = d[i] * s[0];
 }
 
@@ -31,6 +31,7 @@
 //
 // Spectra test code
 //
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -125,6 +126,117 @@ SpectraTest::test()
 
 	testArgs test11 = { RES_1HZ, true, 1024, 1, 3, 3, 512, 2.0 };
 	doTest(test11, true, false, true);
+
+	testModes();
+}
+
+/**
+* Test the spectrum computation modes.
+*
+* Description:\n
+*	Compares modulate mode output with swap mode output for overlapped,
+*	non-overlapped and mixed resolutions, contiguous and scattered
+*	input, output buffers with and without the alignment of the
+*	internal spectrum buffer, spectrum lengths too short to modulate
+*	and resolutions which share a plan.
+*/
+void
+SpectraTest::testModes()
+{
+	OUTL("test spectrum modes");
+	ResData r[MAX_RESOLUTIONS];
+	for (int32_t i = 0; i < 7; ++i) {
+		r[i].res = (Resolution) (RES_64HZ - i);
+		r[i].fftLen = 16 << i;
+		r[i].overlap = (i > 3);
+	}
+	CONFIRM(compareModes(r, 7, false, 0));
+	CONFIRM(compareModes(r, 7, true, 0));
+	CONFIRM(compareModes(r, 7, false, 2));
+	CONFIRM(compareModes(r, 7, true, 2));
+
+	// a spectrum length of 2 cannot be modulated
+	r[0].res = RES_512HZ;
+	r[0].fftLen = 2;
+	CONFIRM(compareModes(r, 7, false, 0));
+
+	// duplicate resolutions share a plan
+	r[0] = r[1] = r[6];
+	CONFIRM(compareModes(r, 7, true, 0));
+}
+
+/**
+* Compare modulate mode with swap mode for a single configuration.
+*
+* Description:\n
+*	Computes two consecutive sets of spectra from random input in each
+*	mode and returns true if no output differs by more than 1e-5
+*	relative to the largest swap mode output.
+*
+* @param	res array of resolutions.
+* @param	resolutions # of resolutions.
+* @param	useArray pass the input as an array of half frame buffers.
+* @param	ofs offset of each output buffer from an aligned address.
+*/
+bool
+SpectraTest::compareModes(const ResData *res, int32_t resolutions,
+		bool useArray, int32_t ofs)
+{
+	const int32_t halfFrames = 3;
+	const int32_t totalHalfFrames = 5;
+	const int32_t samplesPerHalfFrame = 512;
+	ResInfo resInfo[resolutions];
+	Spectra swap, modulate;
+	swap.setup(res, resolutions, halfFrames, samplesPerHalfFrame, resInfo);
+	modulate.setup(res, resolutions, halfFrames, samplesPerHalfFrame,
+			resInfo);
+	modulate.setMode(SPECTRA_MODULATE);
+	if (modulate.getMode() != SPECTRA_MODULATE)
+		return (false);
+
+	size_t tdLen = totalHalfFrames * samplesPerHalfFrame;
+	complex<float> *tdData = (complex<float> *) fftwf_malloc(tdLen
+			* sizeof(complex<float>));
+	srand(resolutions + ofs);
+	for (size_t i = 0; i < tdLen; ++i) {
+		tdData[i] = complex<float>(rand() / (float) RAND_MAX - .5,
+				rand() / (float) RAND_MAX - .5);
+	}
+	complex<float> *hfData[totalHalfFrames];
+	for (int32_t i = 0; i < totalHalfFrames; ++i)
+		hfData[i] = &tdData[i*samplesPerHalfFrame];
+
+	bool same = true;
+	for (int32_t i = 0; i < totalHalfFrames - 1; i += halfFrames - 1) {
+		complex<float> *sSpec[resolutions], *mSpec[resolutions];
+		for (int32_t j = 0; j < resolutions; ++j) {
+			size_t size = (resInfo[j].nSpectra * resInfo[j].specLen + ofs)
+					* sizeof(complex<float>);
+			sSpec[j] = (complex<float> *) fftwf_malloc(size) + ofs;
+			mSpec[j] = (complex<float> *) fftwf_malloc(size) + ofs;
+		}
+		if (useArray) {
+			swap.computeSpectra(&hfData[i], sSpec);
+			modulate.computeSpectra(&hfData[i], mSpec);
+		}
+		else {
+			swap.computeSpectra(&tdData[i*samplesPerHalfFrame], sSpec);
+			modulate.computeSpectra(&tdData[i*samplesPerHalfFrame], mSpec);
+		}
+		for (int32_t j = 0; j < resolutions; ++j) {
+			float maxVal = 0, maxErr = 0;
+			for (int32_t k = 0; k < resInfo[j].nSpectra * resInfo[j].specLen;
+					++k) {
+				maxVal = std::max(maxVal, abs(sSpec[j][k]));
+				maxErr = std::max(maxErr, abs(sSpec[j][k] - mSpec[j][k]));
+			}
+			same = same && maxErr <= 1e-5 * maxVal;
+			fftwf_free(sSpec[j] - ofs);
+			fftwf_free(mSpec[j] - ofs);
+		}
+	}
+	fftwf_free(tdData);
+	return (same);
 }
 
 void
@@ -63,6 +63,9 @@ private:
 
 	void doTest(testArgs& args, bool useArray, bool printData, bool doTiming,
 			const bool *overlap = 0);
+	void testModes();
+	bool compareModes(const ResData *res, int32_t resolutions,
+			bool useArray, int32_t ofs);
 	void generateSignals(int32_t fftLen, int32_t halfFrames,
 			int32_t samplesPerHalfFrame, float freq, complex<float> *tdData);
 	void printArray(const char *s, const complex<float> *data, int32_t count);
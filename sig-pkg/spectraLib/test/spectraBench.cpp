@@ -0,0 +1,132 @@
+/*******************************************************************************
+
+ File:    spectraBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+//
+// Spectrum mode benchmark: times computeSpectra in swap and modulate
+// modes for each resolution separately, then for all of them together,
+// reporting input samples per second for each mode.
+//
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+#include "Spectra.h"
+
+using namespace spectra;
+using std::cout;
+using std::endl;
+
+const int32_t BENCH_PASSES = 2000;
+const int32_t HALF_FRAMES = 3;
+const int32_t SAMPLES_PER_HALF_FRAME = 512;
+const int32_t MIN_FFT_LEN = 16;
+const int32_t RESOLUTIONS = 7;
+
+static double
+now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+/**
+* Time a number of computeSpectra calls for a set of resolutions.
+*
+* @param	mode spectrum computation mode.
+* @param	res array of resolutions.
+* @param	resolutions # of resolutions.
+* @param	passes # of computeSpectra calls.
+* @return	input samples per second.
+*/
+static double
+run(SpectraMode mode, const ResData *res, int32_t resolutions, int32_t passes)
+{
+	Spectra spectra;
+	ResInfo resInfo[resolutions];
+	spectra.setup(res, resolutions, HALF_FRAMES, SAMPLES_PER_HALF_FRAME,
+			resInfo);
+	spectra.setMode(mode);
+
+	int32_t samples = HALF_FRAMES * SAMPLES_PER_HALF_FRAME;
+	complex<float> *td = (complex<float> *) fftwf_malloc(samples
+			* sizeof(complex<float>));
+	for (int32_t i = 0; i < samples; ++i) {
+		td[i] = complex<float>(rand() / (float) RAND_MAX - .5,
+				rand() / (float) RAND_MAX - .5);
+	}
+	complex<float> *out[resolutions];
+	for (int32_t i = 0; i < resolutions; ++i) {
+		out[i] = (complex<float> *) fftwf_malloc(resInfo[i].nSpectra
+				* resInfo[i].specLen * sizeof(complex<float>));
+	}
+
+	spectra.computeSpectra(td, out);
+	double t0 = now();
+	for (int32_t i = 0; i < passes; ++i)
+		spectra.computeSpectra(td, out);
+	double t = now() - t0;
+
+	fftwf_free(td);
+	for (int32_t i = 0; i < resolutions; ++i)
+		fftwf_free(out[i]);
+	return (t > 0 ? (double) passes * samples / t : 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	int32_t passes = BENCH_PASSES;
+	if (argc > 1)
+		passes = atoi(argv[1]);
+
+	ResData res[RESOLUTIONS];
+	for (int32_t i = 0; i < RESOLUTIONS; ++i) {
+		res[i].res = (Resolution) (RES_64HZ - i);
+		res[i].fftLen = MIN_FFT_LEN << i;
+		res[i].overlap = true;
+	}
+
+	cout << HALF_FRAMES << " half frames of " << SAMPLES_PER_HALF_FRAME
+			<< " samples, " << passes << " passes, Msamples/s" << endl;
+	cout << "fftLen\tswap\tmodulate\tspeedup" << endl;
+	for (int32_t i = 0; i <= RESOLUTIONS; ++i) {
+		// the last pass does all resolutions at once
+		const ResData *r = (i < RESOLUTIONS) ? &res[i] : res;
+		int32_t n = (i < RESOLUTIONS) ? 1 : RESOLUTIONS;
+		double swap = run(SPECTRA_SWAP, r, n, passes);
+		double modulate = run(SPECTRA_MODULATE, r, n, passes);
+		if (i < RESOLUTIONS)
+			cout << r->fftLen;
+		else
+			cout << "all";
+		cout << "\t" << swap / 1e6 << "\t" << modulate / 1e6 << "\t"
+				<< (swap > 0 ? modulate / swap : 0) << endl;
+	}
+}
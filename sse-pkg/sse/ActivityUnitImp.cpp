@@ -277,6 +277,8 @@ ActivityUnitImp::ActivityUnitImp (
    dbParam_(activity->getDbParameters()),
    dbConn_(0),
    useDb_(false),
+   signalDb_(0),
+   signalDbRecorder_(0),
    beamNumber_(-1),
    targetId_(-1),
    detachedSelfFromDxProxy_(false),
@@ -294,6 +296,8 @@ ActivityUnitImp::ActivityUnitImp (
       // if one is not already open
       dbConn_ = dbParam_.getDb();
    }
+   signalDb_ = new MysqlSignalDb(dbConn_);
+   signalDbRecorder_ = new SignalDbRecorder(signalDb_);
 
    beamNumber_ = obsActivity_->getBeamNumberForDxName(dxProxy->getName());
    siteName_ = obsActivity_->getSiteName();
@@ -358,6 +362,8 @@ ActivityUnitImp::~ActivityUnitImp()
    delete expandedAllSignalReport_;
    delete expandedCandidateReport_;
 
+   delete signalDbRecorder_;
+   delete signalDb_;
 }
 
 // Release all non-memory-related resources.  Do this
@@ -1206,6 +1212,12 @@ void ActivityUnitImp::terminateActivityUnit(DbParameters &callerDbParam,
       // try to save any signals we have so far
       saveSignalReports();
       
+      if (callerDbParam.useDb())
+      {
+	 // rows still buffered since the last flush
+	 recordPendingSignalsInDb();
+      }
+      
       releaseResources();
       
       // Warning: ActivityUnit may be destroyed in this method.
@@ -1389,6 +1401,9 @@ void ActivityUnitImp::activityUnitComplete()
       
       if (useDb_) 
       {
+	 // anything not already recorded
+	 recordPendingSignalsInDb();
+
 	 updateStats();
       }
       
@@ -1552,99 +1567,90 @@ void ActivityUnitImp::updateDbErrorComment(MYSQL *callerDbConn, const string& co
 
 
 // convert the fields in a signal Id into 
-// a stream format suitable for updating the database.
+// columns of a database row.
 
 void ActivityUnitImp::putSignalIdIntoSqlStatement(
-   ostream &sqlStmt,
+   SignalDbRow &row,
    const SignalId &signalId)
 {
    // ----- signal id -----
 
-   sqlStmt << ", dxNumber = "
-	   << signalId.dxNumber;
+   row.set("dxNumber") << signalId.dxNumber;
 
   // store the start time in a datetime field
   // (set here as an ISO date-time string)
 
-   sqlStmt << ", activityStartTime = '" 
+   row.set("activityStartTime") << "'" 
 	   << SseUtil::isoDateTimeWithoutTimezone(
 	      signalId.activityStartTime.tv_sec)
 	   << "'";
 
-   sqlStmt << ", signalIdNumber = " 
-	   << signalId.number;
+   row.set("signalIdNumber") << signalId.number;
 
 }
 
 // convert the fields in an original signal Id into 
-// a stream format suitable for updating the database.
+// columns of a database row.
 
 void ActivityUnitImp::putOrigSignalIdIntoSqlStatement(
-   ostream &sqlStmt, const SignalId &origSignalId)
+   SignalDbRow &row, const SignalId &origSignalId)
 {
    // ----- orig signal id -----
 
-   sqlStmt << ", origDxNumber = "
-	   << origSignalId.dxNumber;
+   row.set("origDxNumber") << origSignalId.dxNumber;
 
-   sqlStmt << ", origActivityId = " 
-	   << origSignalId.activityId;
+   row.set("origActivityId") << origSignalId.activityId;
 
   // store the start time in a datetime field
   // (set here as an ISO date-time string)
 
-   sqlStmt << ", origActivityStartTime = '" 
+   row.set("origActivityStartTime") << "'" 
 	   << SseUtil::isoDateTimeWithoutTimezone(
 	      origSignalId.activityStartTime.tv_sec)
 	   << "'";
 
-   sqlStmt << ", origSignalIdNumber = " 
-	   << origSignalId.number;
+   row.set("origSignalIdNumber") << origSignalId.number;
 
 }
 
 // convert the fields in a SignalDescription into 
-// a stream format suitable for updating the database.
+// columns of a database row.
 
 void ActivityUnitImp::putSignalDescriptionIntoSqlStatement(
-   ostream &sqlStmt, const SignalDescription &sig)
+   SignalDbRow &row, const SignalDescription &sig)
 {
-   sqlStmt.precision(PrintPrecision);
-   sqlStmt.setf(std::ios::fixed);  // show all decimal places up to precision
+   row.stream().precision(PrintPrecision);
+   row.stream().setf(std::ios::fixed);  // show all decimal places up to precision
 
-   sqlStmt << ", rfFreq = " << sig.path.rfFreq;
+   row.set("rfFreq") << sig.path.rfFreq;
 
-   sqlStmt.precision(PrintPrecision);
+   row.stream().precision(PrintPrecision);
 
-   sqlStmt << ", drift = "
-	   << sig.path.drift;
+   row.set("drift") << sig.path.drift;
 
-   sqlStmt << ", width = "
-	   << sig.path.width;
+   row.set("width") << sig.path.width;
 
-   sqlStmt << ", power = "
-	   << sig.path.power;
+   row.set("power") << sig.path.power;
 
-   sqlStmt << ", pol = '"
+   row.set("pol") << "'"
 	   << SseMsg::polarizationToString(sig.pol)
 	   << "'";
 
-   sqlStmt << ", sigClass = '"
+   row.set("sigClass") << "'"
 	   << SseDxMsg::signalClassToString(sig.sigClass)
 	   << "'";
 
-   sqlStmt << ", reason = '" 
+   row.set("reason") << "'" 
 	   << SseDxMsg::signalClassReasonToBriefString(sig.reason)
 	   << "'";
 
-   sqlStmt << ", subchanNumber = " << sig.subchannelNumber;
+   row.set("subchanNumber") << sig.subchannelNumber;
 
-   sqlStmt << ", containsBadBands = " 
-	   << BoolToQuotedYesNo(sig.containsBadBands);
+   row.set("containsBadBands") << BoolToQuotedYesNo(sig.containsBadBands);
 
-   putSignalIdIntoSqlStatement(sqlStmt, sig.signalId); 
+   putSignalIdIntoSqlStatement(row, sig.signalId); 
 
-   putOrigSignalIdIntoSqlStatement(sqlStmt, sig.origSignalId);
+   putOrigSignalIdIntoSqlStatement(row, sig.origSignalId);
 
 
 }
@@ -1653,8 +1659,15 @@ DbTableKeyId ActivityUnitImp::recordCandidate(
    const PulseSignalHeader& pulseSignalHdr,
    Pulse pulses[], const string& location) 
 {
-   return record(CandidateSignalTableName, CandidatePulseTrainTableName, 
-		 pulseSignalHdr, pulses, location);
+   DbTableKeyId dbSignalTableId = 
+      record(CandidateSignalTableName, CandidatePulseTrainTableName, 
+	     pulseSignalHdr, pulses, location);
+
+   // candidates are looked up later in the activity,
+   // so record them now
+   recordPendingSignalsInDb();
+
+   return dbSignalTableId;
 }
 
 void ActivityUnitImp::recordSignal(const PulseSignalHeader& pulseSignalHdr,
@@ -1689,56 +1702,49 @@ DbTableKeyId ActivityUnitImp::record(
 			     SSE_MSG_DBERR, SEVERITY_WARNING );
       }
 
-      stringstream sqlStmt;
-
-      sqlStmt << "INSERT INTO " << signalTableName << " SET ";
+      SignalDbRow row;
 
-      putCommonSignalInfoIntoSqlStatement(sqlStmt, pulseSignalHdr.sig,
+      putCommonSignalInfoIntoSqlStatement(row, pulseSignalHdr.sig,
 					  PulseSigType, location);
 
-      putConfirmationStatsIntoSqlStatement(sqlStmt, pulseSignalHdr.cfm);
+      putConfirmationStatsIntoSqlStatement(row, pulseSignalHdr.cfm);
 
       // pulse train signal description
 
-      sqlStmt << ", pulsePeriod = "
-	      << pulseSignalHdr.train.pulsePeriod
+      row.set("pulsePeriod") << pulseSignalHdr.train.pulsePeriod;
 
-	      << ", numberOfPulses = "
-	      << pulseSignalHdr.train.numberOfPulses
-	    
-	      << ", res = '" 
-	      << SseDxMsg::resolutionToString(pulseSignalHdr.train.res)
-	      << "'";
+      row.set("numberOfPulses") << pulseSignalHdr.train.numberOfPulses;
 
-      submitDbQueryWithThrowOnError(dbConn_, sqlStmt.str(), methodName, __LINE__);
+      row.set("res") << "'" 
+		     << SseDxMsg::resolutionToString(pulseSignalHdr.train.res)
+		     << "'";
 
-      dbSignalTableId = mysql_insert_id(dbConn_);
+      // the signal is inserted now to get its id for the pulses
+      dbSignalTableId = signalDbRecorder_->insert(signalTableName, row);
 
-      // record pulses
+      // record pulses (written when the pending signals are recorded)
       for (int i=0; i < pulseSignalHdr.train.numberOfPulses; ++i)
       {
-	 stringstream pulseSqlStmt;
+	 SignalDbRow pulseRow;
 
-	 pulseSqlStmt << "INSERT into " << pulseTrainTableName << " SET "
-		      << "signalTableId = " << dbSignalTableId;
+	 pulseRow.set("signalTableId") << dbSignalTableId;
 	 
-	 pulseSqlStmt.precision(PrintPrecision);
-	 pulseSqlStmt.setf(std::ios::fixed);  // show all decimal places to precision
-	 pulseSqlStmt << ", rfFreq = " << pulses[i].rfFreq;
+	 pulseRow.stream().precision(PrintPrecision);
+	 pulseRow.stream().setf(std::ios::fixed);  // show all decimal places to precision
+	 pulseRow.set("rfFreq") << pulses[i].rfFreq;
 	 
-	 pulseSqlStmt.precision(PrintPrecision);
-	 pulseSqlStmt << ", power = " << pulses[i].power
-		      << ", spectrumNumber = " << pulses[i].spectrumNumber
-		      << ", binNumber = " << pulses[i].binNumber
-		      << ", pol = '" 
-		      << SseMsg::polarizationToString(pulses[i].pol)
-		      << "'"
-		      << " ";
+	 pulseRow.stream().precision(PrintPrecision);
+	 pulseRow.set("power") << pulses[i].power;
+	 pulseRow.set("spectrumNumber") << pulses[i].spectrumNumber;
+	 pulseRow.set("binNumber") << pulses[i].binNumber;
+	 pulseRow.set("pol") << "'" 
+			     << SseMsg::polarizationToString(pulses[i].pol)
+			     << "'";
 	 
 	 // debug
-	 //cout << "pulseSqlStmt: " << pulseSqlStmt.str() << endl;
+	 //cout << "pulseRow: " << pulseRow.getSetClause() << endl;
 	 
-	 submitDbQueryWithThrowOnError(dbConn_, pulseSqlStmt.str(), methodName, __LINE__);
+	 signalDbRecorder_->add(pulseTrainTableName, pulseRow);
 
       }
 
@@ -1762,6 +1768,8 @@ void ActivityUnitImp::recordCandidate(const CwPowerSignal& cwPowerSignal,
    const string & signalTableName(CandidateSignalTableName);
 
    record(signalTableName, cwPowerSignal, location);
+
+   recordPendingSignalsInDb();
 }
 
 void ActivityUnitImp::recordSignal(const CwPowerSignal& cwPowerSignal,
@@ -1779,8 +1787,6 @@ void ActivityUnitImp::record(const string &signalTableName,
 			     const CwPowerSignal& cwPowerSignal,
 			     const string& location)
 {
-   const string methodName("record(...CwPowerSignal...)");
-
    try
    {
       if (!getDbActivityUnitId())
@@ -1794,19 +1800,13 @@ void ActivityUnitImp::record(const string &signalTableName,
 			     SSE_MSG_DBERR, SEVERITY_WARNING );
       }
 
-      stringstream sqlStmt;
+      SignalDbRow row;
 
-      sqlStmt << "INSERT INTO " << signalTableName << " SET ";
-
-      putCommonSignalInfoIntoSqlStatement(sqlStmt, cwPowerSignal.sig,
+      putCommonSignalInfoIntoSqlStatement(row, cwPowerSignal.sig,
 					  CwPowerSigType, location);
 
-      submitDbQueryWithThrowOnError(dbConn_, sqlStmt.str(), methodName, __LINE__);
-
-      // TBD add error check
-      //  unsigned int dbSigDesId = 
-
-      mysql_insert_id(dbConn_);
+      // written when the pending signals are recorded
+      signalDbRecorder_->add(signalTableName, row);
   
    }
    catch (SseException &except)
@@ -1822,31 +1822,30 @@ void ActivityUnitImp::record(const string &signalTableName,
 }
 
 void ActivityUnitImp::putConfirmationStatsIntoSqlStatement(
-   ostream & sqlStmt, 
+   SignalDbRow & row, 
    const ConfirmationStats & cfm)
 {
-   sqlStmt.precision(PrintPrecision);
+   row.stream().precision(PrintPrecision);
     
-   sqlStmt << ", pfa = " << ValidPfa(cfm.pfa)
-	   << ", snr = " << cfm.snr;
+   row.set("pfa") << ValidPfa(cfm.pfa);
+   row.set("snr") << cfm.snr;
 
 }
 
 void ActivityUnitImp::putCommonSignalInfoIntoSqlStatement(
-   ostream & sqlStmt, 
+   SignalDbRow & row, 
    const SignalDescription &sig,
    const string & sigTypeString,
    const string & location)
 {
-   sqlStmt << " activityId = " << getActivityId()
-	   << ", dbActivityUnitId = " << getDbActivityUnitId()
-	   << ", location = '" << location << "'"
-	   << ", targetId = " << targetId_
-	   << ", beamNumber = " << beamNumber_
-	   << ", type = '" << sigTypeString << "'"
-	   << " ";
+   row.set("activityId") << getActivityId();
+   row.set("dbActivityUnitId") << getDbActivityUnitId();
+   row.set("location") << "'" << location << "'";
+   row.set("targetId") << targetId_;
+   row.set("beamNumber") << beamNumber_;
+   row.set("type") << "'" << sigTypeString << "'";
 
-   putSignalDescriptionIntoSqlStatement(sqlStmt, sig);
+   putSignalDescriptionIntoSqlStatement(row, sig);
 
 }
 
@@ -1874,17 +1873,19 @@ DbTableKeyId ActivityUnitImp::recordCandidate(
 			     SSE_MSG_DBERR, SEVERITY_WARNING );
       }
 
-      stringstream sqlStmt;
-
-      sqlStmt << "INSERT INTO " << signalTableName << " SET ";
+      SignalDbRow row;
 
-      putCommonSignalInfoIntoSqlStatement(sqlStmt, cwCoherentSignal.sig,
+      putCommonSignalInfoIntoSqlStatement(row, cwCoherentSignal.sig,
 					  CwCohSigType, location);
 
-      putConfirmationStatsIntoSqlStatement(sqlStmt, cwCoherentSignal.cfm);
+      putConfirmationStatsIntoSqlStatement(row, cwCoherentSignal.cfm);
       // number of coherent segments
-      sqlStmt << ", nSegments = "
-	      << cwCoherentSignal.nSegments;
+      row.set("nSegments") << cwCoherentSignal.nSegments;
+
+      stringstream sqlStmt;
+
+      sqlStmt << "INSERT INTO " << signalTableName << " SET "
+	      << row.getSetClause();
 
       submitDbQueryWithThrowOnError(dbConn_, sqlStmt.str(), methodName, __LINE__);
 
@@ -2065,62 +2066,78 @@ void ActivityUnitImp::recordDetectionStats(DxProxy *proxy,
 void ActivityUnitImp::recordBadBandInDb(DxProxy *proxy,
 					const CwBadBand & cwBadBand) 
 {
-   const string methodName("recordBadBandInDb");
    string tableName("CwBadBands");
   
-   stringstream sqlStmt;
-   sqlStmt.precision(PrintPrecision);
-   sqlStmt.setf(std::ios::fixed);  // show all decimal places up to precision
+   SignalDbRow row;
+   row.stream().precision(PrintPrecision);
+   row.stream().setf(std::ios::fixed);  // show all decimal places up to precision
 
-   sqlStmt << "INSERT INTO " << tableName  << " SET "
-	   << " actId = " << getActivityId()
-	   << ", dxNumber = " << proxy->getNumber()
-	   << ", centerFreq = " << cwBadBand.band.centerFreq
-	   << ", bandwidth = " << cwBadBand.band.bandwidth
-	   << ", pol = '" << SseMsg::polarizationToString(cwBadBand.pol)
-	   << "'"
-	   << ", paths = " <<  cwBadBand.paths
-	   << ", maxPathCount = " << cwBadBand.maxPathCount
-	   << ", rfFreq = " << cwBadBand.maxPath.rfFreq
-	   << ", drift = " << cwBadBand.maxPath.drift
-	   << ", width = " << cwBadBand.maxPath.width
-	   << ", power = " << cwBadBand.maxPath.power
-	   << " ";
+   row.set("actId") << getActivityId();
+   row.set("dxNumber") << proxy->getNumber();
+   row.set("centerFreq") << cwBadBand.band.centerFreq;
+   row.set("bandwidth") << cwBadBand.band.bandwidth;
+   row.set("pol") << "'" << SseMsg::polarizationToString(cwBadBand.pol)
+		  << "'";
+   row.set("paths") << cwBadBand.paths;
+   row.set("maxPathCount") << cwBadBand.maxPathCount;
+   row.set("rfFreq") << cwBadBand.maxPath.rfFreq;
+   row.set("drift") << cwBadBand.maxPath.drift;
+   row.set("width") << cwBadBand.maxPath.width;
+   row.set("power") << cwBadBand.maxPath.power;
 
-   submitDbQueryWithLoggingOnError(dbConn_, sqlStmt.str(), methodName, __LINE__);
+   // written when the pending signals are recorded
+   signalDbRecorder_->add(tableName, row);
 
 }
 
 void ActivityUnitImp::recordBadBandInDb(DxProxy *proxy,
 					const PulseBadBand & pulseBadBand) 
 {
-   const string methodName("recordBadBandInDb");
    string tableName("PulseBadBands");
   
-   stringstream sqlStmt;
-   sqlStmt.precision(PrintPrecision);
-   sqlStmt.setf(std::ios::fixed);  // show all decimal places up to precision
+   SignalDbRow row;
+   row.stream().precision(PrintPrecision);
+   row.stream().setf(std::ios::fixed);  // show all decimal places up to precision
 
-   sqlStmt << "INSERT INTO " << tableName  << " SET "
-	   << " actId = " << getActivityId()
-	   << ", dxNumber = " << proxy->getNumber()
-	   << ", centerFreq = " << pulseBadBand.band.centerFreq
-	   << ", bandwidth = " << pulseBadBand.band.bandwidth
-	   << ", res = '" << SseDxMsg::resolutionToString(pulseBadBand.res)
-	   << "'"
-	   << ", pol = '" << SseMsg::polarizationToString(pulseBadBand.pol)
-	   << "'"
-	   << ", pulses = " <<  pulseBadBand.pulses
-	   << ", maxPulseCount = " << pulseBadBand.maxPulseCount
-	   << ", triplets = " << pulseBadBand.triplets
-	   << ", maxTripletCount = " << pulseBadBand.maxTripletCount
-	   << ", tooManyTriplets = " << BoolToQuotedYesNo(pulseBadBand.tooManyTriplets)
-	   << " ";
+   row.set("actId") << getActivityId();
+   row.set("dxNumber") << proxy->getNumber();
+   row.set("centerFreq") << pulseBadBand.band.centerFreq;
+   row.set("bandwidth") << pulseBadBand.band.bandwidth;
+   row.set("res") << "'" << SseDxMsg::resolutionToString(pulseBadBand.res)
+		  << "'";
+   row.set("pol") << "'" << SseMsg::polarizationToString(pulseBadBand.pol)
+		  << "'";
+   row.set("pulses") << pulseBadBand.pulses;
+   row.set("maxPulseCount") << pulseBadBand.maxPulseCount;
+   row.set("triplets") << pulseBadBand.triplets;
+   row.set("maxTripletCount") << pulseBadBand.maxTripletCount;
+   row.set("tooManyTriplets") << BoolToQuotedYesNo(pulseBadBand.tooManyTriplets);
 
-   submitDbQueryWithLoggingOnError(dbConn_, sqlStmt.str(), methodName, __LINE__);
+   // written when the pending signals are recorded
+   signalDbRecorder_->add(tableName, row);
 
 }
 
+// Write the signals, pulses and bad bands which have been
+// collected since the last time, with one multi-row INSERT
+// per table.
+
+void ActivityUnitImp::recordPendingSignalsInDb()
+{
+   try
+   {
+      signalDbRecorder_->flush();
+   }
+   catch (SseException &except)
+   {
+      SseMessage::log(MsgSender,
+                      getActivityId(), except.code(),
+                      except.severity(), 
+                      except.descrip(),
+                      except.sourceFilename(), except.lineNumber());
+   }
+}
+
 void ActivityUnitImp::recordBaselineStatsInDb(
    DxProxy *proxy, const BaselineStatistics &stats)
 {
@@ -2342,6 +2359,17 @@ void ActivityUnitImp::dataCollectionComplete(DxProxy* dx)
                         << SseUtil::currentIsoDateTime() << "\n"
                         << endl;
 
+   // write out the buffered baselines & complex amplitudes
+   try
+   {
+      getScienceDataArchive()->flush();
+   }
+   catch (SseException &except)
+   {
+      terminateActivityUnit(dbParam_, except);
+      return;
+   }
+
    getObsAct()->dataCollectionComplete(this);
 }
 
@@ -2897,7 +2925,10 @@ void ActivityUnitImp::sendCwPowerSignal(DxProxy* dx,
 
 void ActivityUnitImp::doneSendingSignals(DxProxy* dx)
 {
-   // do nothing
+   if (getObsAct()->getDbParameters().useDb())
+   {
+      recordPendingSignalsInDb();
+   }
 }
 
 
@@ -3139,7 +3170,10 @@ void ActivityUnitImp::sendPulseBadBand(DxProxy *dx,
 
 void ActivityUnitImp::doneSendingBadBands(DxProxy *dx)
 {
-   // do nothing
+   if (getObsAct()->getDbParameters().useDb())
+   {
+      recordPendingSignalsInDb();
+   }
 }
 
 
@@ -46,6 +46,7 @@
 #include "SseException.h"
 #include "TargetId.h"
 #include "MutexBool.h"
+#include "SignalDbRecorder.h"
 #include <mysql.h>
 #include <string>
 #include <fstream>
@@ -61,8 +62,6 @@ class CondensedSignalReport;
 class ExpandedSignalReport;
 class DbParameters;
 
-typedef unsigned int DbTableKeyId;
-
 class ActivityUnitImp : public ActivityUnit
 {
  public:
@@ -273,15 +272,15 @@ class ActivityUnitImp : public ActivityUnit
   virtual const string prepareDatabaseRecordStatement();
 
   virtual void putCommonSignalInfoIntoSqlStatement(
-      ostream & sqlstmt, const SignalDescription & sig,
+      SignalDbRow & row, const SignalDescription & sig,
       const string &sigTypeString, const string &location);
 
-  virtual void putSignalDescriptionIntoSqlStatement(ostream &sqlstmt, 
+  virtual void putSignalDescriptionIntoSqlStatement(SignalDbRow &row, 
 						    const SignalDescription &sig);
-  virtual void putSignalIdIntoSqlStatement(ostream &sqlstmt, const SignalId &signalId);
-  virtual void putOrigSignalIdIntoSqlStatement(ostream &sqlstmt,
+  virtual void putSignalIdIntoSqlStatement(SignalDbRow &row, const SignalId &signalId);
+  virtual void putOrigSignalIdIntoSqlStatement(SignalDbRow &row,
 					       const SignalId &origSignalId);
-  virtual void putConfirmationStatsIntoSqlStatement(ostream & sqlstmt, 
+  virtual void putConfirmationStatsIntoSqlStatement(SignalDbRow & row, 
 						    const ConfirmationStats & cfm);
 
   virtual void recordDetectionStats(DxProxy *proxy,
@@ -289,6 +288,7 @@ class ActivityUnitImp : public ActivityUnit
 
   virtual void recordBadBandInDb(DxProxy *proxy, const CwBadBand &cwBadBand);
   virtual void recordBadBandInDb(DxProxy *proxy, const PulseBadBand &pulseBadBand);
+  virtual void recordPendingSignalsInDb();
 
   virtual void recordBaselineStatsInDb(
       DxProxy *proxy, const BaselineStatistics &baselineStats);
@@ -385,6 +385,8 @@ class ActivityUnitImp : public ActivityUnit
   DbParameters & dbParam_;
   MYSQL *dbConn_;
   bool useDb_;
+  SignalDb *signalDb_;
+  SignalDbRecorder *signalDbRecorder_;
 
   int beamNumber_;
   TargetId targetId_;
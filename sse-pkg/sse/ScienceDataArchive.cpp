@@ -48,46 +48,78 @@ ScienceDataArchive::ScienceDataArchive(const string &archiveFilenamePrefix,
     archiveFilenamePrefix_ = archiveFilenamePrefix;
 
     // NSS baselines & complex amplitudes
-    nssBaselinesOutFilenameL_ = archiveFilenamePrefix_ + "L.baseline";
-    nssBaselinesOutFilenameR_= archiveFilenamePrefix_ + "R.baseline";
-    nssCompampsOutFilenameL_ = archiveFilenamePrefix_ + "L.compamp";
-    nssCompampsOutFilenameR_ = archiveFilenamePrefix_ + "R.compamp";
+    nssBaselinesOutFileL_ = new ScienceDataFile(
+	archiveFilenamePrefix_ + "L.baseline");
+    nssBaselinesOutFileR_ = new ScienceDataFile(
+	archiveFilenamePrefix_ + "R.baseline");
+    nssCompampsOutFileL_ = new ScienceDataFile(
+	archiveFilenamePrefix_ + "L.compamp");
+    nssCompampsOutFileR_ = new ScienceDataFile(
+	archiveFilenamePrefix_ + "R.compamp");
 
     // Monitored confirmation data (overwritten for each activity)
     string confirmDataPrefix = SseArchive::getConfirmationDataDir() +
 	dxName + "-";
 
     // compamps 
-    nssCompampsMonitorOutFilenameL_ = confirmDataPrefix + "L.compamp";
-    nssCompampsMonitorOutFilenameR_ = confirmDataPrefix + "R.compamp";
+    nssCompampsMonitorOutFileL_ = new ScienceDataFile(
+	confirmDataPrefix + "L.compamp");
+    nssCompampsMonitorOutFileR_ = new ScienceDataFile(
+	confirmDataPrefix + "R.compamp");
 
     // baselines
-    nssBaselinesMonitorOutFilenameL_ = confirmDataPrefix + "L.baseline";
-    nssBaselinesMonitorOutFilenameR_ = confirmDataPrefix + "R.baseline";
+    nssBaselinesMonitorOutFileL_ = new ScienceDataFile(
+	confirmDataPrefix + "L.baseline");
+    nssBaselinesMonitorOutFileR_ = new ScienceDataFile(
+	confirmDataPrefix + "R.baseline");
 
 
 }
 
 ScienceDataArchive::~ScienceDataArchive()
 {
+    // closing the files writes out any buffered data
+    delete nssBaselinesOutFileL_;
+    delete nssBaselinesOutFileR_;
+    delete nssCompampsOutFileL_;
+    delete nssCompampsOutFileR_;
+
+    delete nssCompampsMonitorOutFileL_;
+    delete nssCompampsMonitorOutFileR_;
+    delete nssBaselinesMonitorOutFileL_;
+    delete nssBaselinesMonitorOutFileR_;
 }
 
 void ScienceDataArchive::truncateOutputFiles()
 {
     // truncate sci data output files, if they exist
-    SseUtil::truncateFile(nssBaselinesOutFilenameL_);
-    SseUtil::truncateFile(nssBaselinesOutFilenameR_);
-    SseUtil::truncateFile(nssCompampsOutFilenameL_);
-    SseUtil::truncateFile(nssCompampsOutFilenameR_);
+    nssBaselinesOutFileL_->truncate();
+    nssBaselinesOutFileR_->truncate();
+    nssCompampsOutFileL_->truncate();
+    nssCompampsOutFileR_->truncate();
 
-    SseUtil::truncateFile(nssCompampsMonitorOutFilenameL_);
-    SseUtil::truncateFile(nssCompampsMonitorOutFilenameR_);
-    SseUtil::truncateFile(nssBaselinesMonitorOutFilenameL_);
-    SseUtil::truncateFile(nssBaselinesMonitorOutFilenameR_);
+    nssCompampsMonitorOutFileL_->truncate();
+    nssCompampsMonitorOutFileR_->truncate();
+    nssBaselinesMonitorOutFileL_->truncate();
+    nssBaselinesMonitorOutFileR_->truncate();
 
 
 }
 
+// write out all buffered science data
+void ScienceDataArchive::flush()
+{
+    nssBaselinesOutFileL_->flush();
+    nssBaselinesOutFileR_->flush();
+    nssCompampsOutFileL_->flush();
+    nssCompampsOutFileR_->flush();
+
+    nssCompampsMonitorOutFileL_->flush();
+    nssCompampsMonitorOutFileR_->flush();
+    nssBaselinesMonitorOutFileL_->flush();
+    nssBaselinesMonitorOutFileR_->flush();
+}
+
 void ScienceDataArchive::storeBaseline(const BaselineHeader &hdr,
 		       const BaselineValue valueArray[])
 {
@@ -141,12 +173,12 @@ void ScienceDataArchive::storeBaseline(const BaselineHeader &hdr,
 	writeVariableLengthBaselineToNssFile(baseline.header, 
 					     baseline.baselineValues,
 					     numberOfBaselineValues, 
-					     nssBaselinesOutFilenameR_);
+					     *nssBaselinesOutFileR_);
 
 	writeVariableLengthBaselineToNssFile(baseline.header, 
 					     baseline.baselineValues,
 					     numberOfBaselineValues, 
-					     nssBaselinesMonitorOutFilenameR_);
+					     *nssBaselinesMonitorOutFileR_);
     }
     else
     {
@@ -162,12 +194,12 @@ void ScienceDataArchive::storeBaseline(const BaselineHeader &hdr,
 	writeVariableLengthBaselineToNssFile(baseline.header, 
 					     baseline.baselineValues,
 					     numberOfBaselineValues, 
-					     nssBaselinesOutFilenameL_);
+					     *nssBaselinesOutFileL_);
 
 	writeVariableLengthBaselineToNssFile(baseline.header, 
 					     baseline.baselineValues,
 					     numberOfBaselineValues, 
-					     nssBaselinesMonitorOutFilenameL_);
+					     *nssBaselinesMonitorOutFileL_);
     }
 
     delete baselineBuffer;
@@ -218,14 +250,14 @@ void ScienceDataArchive::storeComplexAmplitudes(
 	if (compamp.header.pol == POL_RIGHTCIRCULAR)
 	{
 	    compamp.marshall();
-	    writeCompAmpsToNssFile(compamp, nssCompampsMonitorOutFilenameR_);
-	    writeCompAmpsToNssFile(compamp, nssCompampsOutFilenameR_);
+	    writeCompAmpsToNssFile(compamp, *nssCompampsMonitorOutFileR_);
+	    writeCompAmpsToNssFile(compamp, *nssCompampsOutFileR_);
 	}
 	else
 	{
 	    compamp.marshall(); 
-	    writeCompAmpsToNssFile(compamp, nssCompampsMonitorOutFilenameL_);
-	    writeCompAmpsToNssFile(compamp, nssCompampsOutFilenameL_);
+	    writeCompAmpsToNssFile(compamp, *nssCompampsMonitorOutFileL_);
+	    writeCompAmpsToNssFile(compamp, *nssCompampsOutFileL_);
 	}
 
     }
@@ -36,6 +36,8 @@
 #include <string>
 using std::string;
 
+class ScienceDataFile;
+
 class ScienceDataArchive
 {
  public:
@@ -54,6 +56,8 @@ class ScienceDataArchive
 
     void truncateOutputFiles();
 
+    void flush();
+
 
  private:
     // Disable copy construction & assignment.
@@ -63,17 +67,16 @@ class ScienceDataArchive
 
     string archiveFilenamePrefix_;
 
-    string nssBaselinesOutFilenameL_;
-    string nssBaselinesOutFilenameR_;
-    string nssCompampsOutFilenameL_;
-    string nssCompampsOutFilenameR_;
-
-    string nssCompampsRaw1HzOutFilenameL_;
-    string nssCompampsRaw1HzOutFilenameR_;
-    string nssCompampsMonitorOutFilenameL_;
-    string nssCompampsMonitorOutFilenameR_;
-    string nssBaselinesMonitorOutFilenameL_;
-    string nssBaselinesMonitorOutFilenameR_;
+    // output files, kept open for the life of the activity
+    ScienceDataFile *nssBaselinesOutFileL_;
+    ScienceDataFile *nssBaselinesOutFileR_;
+    ScienceDataFile *nssCompampsOutFileL_;
+    ScienceDataFile *nssCompampsOutFileR_;
+
+    ScienceDataFile *nssCompampsMonitorOutFileL_;
+    ScienceDataFile *nssCompampsMonitorOutFileR_;
+    ScienceDataFile *nssBaselinesMonitorOutFileL_;
+    ScienceDataFile *nssBaselinesMonitorOutFileR_;
 };
 
 #endif // ScienceDataArchive_H
\ No newline at end of file
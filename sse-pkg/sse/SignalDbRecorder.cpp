@@ -0,0 +1,313 @@
+/*******************************************************************************
+
+ File:    SignalDbRecorder.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+
+#include "SignalDbRecorder.h"
+#include "SseException.h"
+#include "Assert.h"
+#include <sstream>
+
+using namespace std;
+
+SignalDb::~SignalDb()
+{
+}
+
+MysqlSignalDb::MysqlSignalDb(MYSQL *conn):
+   conn_(conn)
+{
+}
+
+MysqlSignalDb::~MysqlSignalDb()
+{
+}
+
+void MysqlSignalDb::submit(const string &sqlStmt)
+{
+   if (!conn_)
+   {
+      throw SseException("MysqlSignalDb::submit() MySQL error: NULL db\n",
+			 __FILE__, __LINE__, 
+			 SSE_MSG_DBERR, SEVERITY_ERROR);
+   }
+
+   if (mysql_query(conn_, sqlStmt.c_str()) != 0)
+   {	
+      stringstream strm;
+      strm << "MysqlSignalDb::submit() MySQL error: " 
+	   << mysql_error(conn_)  << endl;
+      
+      throw SseException(strm.str(), __FILE__, __LINE__,
+			 SSE_MSG_DBERR, SEVERITY_ERROR);
+   }
+}
+
+DbTableKeyId MysqlSignalDb::getInsertId()
+{
+   return mysql_insert_id(conn_);
+}
+
+
+SignalDbRow::SignalDbRow()
+{
+}
+
+SignalDbRow::~SignalDbRow()
+{
+}
+
+// Add a column.  Its value is then written to the stream returned.
+
+ostream & SignalDbRow::set(const string &column)
+{
+   columns_.push_back(column);
+   valueStarts_.push_back(values_.str().size());
+
+   return values_;
+}
+
+// The stream the values are written to, to set their format.
+
+ostream & SignalDbRow::stream()
+{
+   return values_;
+}
+
+string SignalDbRow::getColumnList() const
+{
+   stringstream strm;
+   strm << "(";
+   for (unsigned int i=0; i<columns_.size(); ++i)
+   {
+      if (i > 0)
+      {
+	 strm << ", ";
+      }
+      strm << columns_[i];
+   }
+   strm << ")";
+
+   return strm.str();
+}
+
+string SignalDbRow::getValueList() const
+{
+   vector<string> values(getValues());
+
+   stringstream strm;
+   strm << "(";
+   for (unsigned int i=0; i<values.size(); ++i)
+   {
+      if (i > 0)
+      {
+	 strm << ", ";
+      }
+      strm << values[i];
+   }
+   strm << ")";
+
+   return strm.str();
+}
+
+string SignalDbRow::getSetClause() const
+{
+   vector<string> values(getValues());
+
+   stringstream strm;
+   for (unsigned int i=0; i<values.size(); ++i)
+   {
+      if (i > 0)
+      {
+	 strm << ", ";
+      }
+      strm << columns_[i] << " = " << values[i];
+   }
+
+   return strm.str();
+}
+
+vector<string> SignalDbRow::getValues() const
+{
+   string text(values_.str());
+
+   vector<string> values;
+   for (unsigned int i=0; i<valueStarts_.size(); ++i)
+   {
+      string::size_type end = (i + 1 < valueStarts_.size()) ?
+	 valueStarts_[i+1] : text.size();
+      values.push_back(text.substr(valueStarts_[i], end - valueStarts_[i]));
+   }
+
+   return values;
+}
+
+
+SignalDbRecorder::SignalDbRecorder(SignalDb *db, int maxRowsPerInsert):
+   db_(db),
+   maxRowsPerInsert_(maxRowsPerInsert),
+   pendingRows_(0)
+{
+   Assert(db_);
+   Assert(maxRowsPerInsert_ > 0);
+}
+
+// Pending rows are not written here: the database
+// connection may already be gone.  Call flush() first.
+
+SignalDbRecorder::~SignalDbRecorder()
+{
+}
+
+// Insert a row immediately and return its id.
+
+DbTableKeyId SignalDbRecorder::insert(const string &tableName,
+				      const SignalDbRow &row)
+{
+   db_->submit("INSERT INTO " + tableName + " SET " + row.getSetClause());
+
+   return db_->getInsertId();
+}
+
+// Add a row to be written by the next flush.
+
+void SignalDbRecorder::add(const string &tableName, const SignalDbRow &row)
+{
+   string columns(row.getColumnList());
+
+   // rows usually arrive in runs with the same columns,
+   // so look for a match starting with the latest table
+   PendingInsert *pending(0);
+   for (int i=pending_.size()-1; i>=0; --i)
+   {
+      if (pending_[i].tableName == tableName
+	  && pending_[i].columns == columns)
+      {
+	 pending = &pending_[i];
+	 break;
+      }
+   }
+   if (!pending)
+   {
+      pending_.push_back(PendingInsert());
+      pending = &pending_.back();
+      pending->tableName = tableName;
+      pending->columns = columns;
+   }
+   pending->rows.push_back(row.getValueList());
+   ++pendingRows_;
+}
+
+// Write all the pending rows.  The rows are discarded even if
+// a write fails, so that they are not written twice.
+// Throws SseException on error, after trying all the rows.
+
+void SignalDbRecorder::flush()
+{
+   vector<PendingInsert> pending;
+   pending.swap(pending_);
+   pendingRows_ = 0;
+
+   string errorText;
+   for (unsigned int i=0; i<pending.size(); ++i)
+   {
+      submitRows(pending[i], errorText);
+   }
+
+   if (!errorText.empty())
+   {
+      throw SseException(errorText, __FILE__, __LINE__,
+			 SSE_MSG_DBERR, SEVERITY_ERROR);
+   }
+}
+
+int SignalDbRecorder::getPendingRows() const
+{
+   return pendingRows_;
+}
+
+// Write the rows of one table, maxRowsPerInsert_ at a time.
+// If an INSERT fails, its rows are written again one at a time,
+// so that a bad row loses only itself.  Errors are appended
+// to errorText.
+
+void SignalDbRecorder::submitRows(const PendingInsert &pending,
+				  string &errorText)
+{
+   for (unsigned int first=0; first<pending.rows.size();
+	first += maxRowsPerInsert_)
+   {
+      unsigned int last = min(pending.rows.size(),
+			      static_cast<size_t>(first + maxRowsPerInsert_));
+      try
+      {
+	 submitRows(pending, first, last);
+      }
+      catch (SseException &except)
+      {
+	 if (last - first == 1)
+	 {
+	    errorText += except.descrip();
+	    continue;
+	 }
+	 for (unsigned int i=first; i<last; ++i)
+	 {
+	    try
+	    {
+	       submitRows(pending, i, i + 1);
+	    }
+	    catch (SseException &rowExcept)
+	    {
+	       errorText += rowExcept.descrip();
+	    }
+	 }
+      }
+   }
+}
+
+// Write rows [first, last) of one table with a single INSERT.
+// Throws SseException on error.
+
+void SignalDbRecorder::submitRows(const PendingInsert &pending,
+				  unsigned int first, unsigned int last)
+{
+   stringstream sqlStmt;
+   sqlStmt << "INSERT INTO " << pending.tableName
+	   << " " << pending.columns << " VALUES ";
+   for (unsigned int i=first; i<last; ++i)
+   {
+      if (i > first)
+      {
+	 sqlStmt << ", ";
+      }
+      sqlStmt << pending.rows[i];
+   }
+
+   db_->submit(sqlStmt.str());
+}
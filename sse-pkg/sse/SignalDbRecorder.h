@@ -0,0 +1,149 @@
+/*******************************************************************************
+
+ File:    SignalDbRecorder.h
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+#ifndef SignalDbRecorder_H
+#define SignalDbRecorder_H
+
+#include "mysql.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::ostream;
+using std::string;
+using std::stringstream;
+using std::vector;
+
+typedef unsigned int DbTableKeyId;
+
+// Database used to record signals.
+// Implemented for MySQL, and by stubs for testing.
+
+class SignalDb
+{
+public:
+  virtual ~SignalDb();
+
+  // Submit an SQL statement.  Throws SseException on error.
+  virtual void submit(const string &sqlStmt) = 0;
+
+  // Id of the row added by the last single row INSERT
+  virtual DbTableKeyId getInsertId() = 0;
+};
+
+class MysqlSignalDb : public SignalDb
+{
+public:
+  MysqlSignalDb(MYSQL *conn);
+  virtual ~MysqlSignalDb();
+
+  virtual void submit(const string &sqlStmt);
+  virtual DbTableKeyId getInsertId();
+
+private:
+  MYSQL *conn_;
+};
+
+// One row of a table, given as its columns and their values.
+// The value of a column is written, in SQL ("12.5", "'text'"),
+// to the stream returned by set().  The stream keeps its format
+// (precision, fixed) from one value to the next.
+
+class SignalDbRow
+{
+public:
+  SignalDbRow();
+  virtual ~SignalDbRow();
+
+  ostream & set(const string &column);
+  ostream & stream();
+
+  string getColumnList() const;    // "(col1, col2, ...)"
+  string getValueList() const;     // "(value1, value2, ...)"
+  string getSetClause() const;     // "col1 = value1, col2 = value2, ..."
+
+private:
+  // Disable copy construction & assignment.
+  // Don't define these.
+  SignalDbRow(const SignalDbRow& rhs);
+  SignalDbRow& operator=(const SignalDbRow& rhs);
+
+  vector<string> getValues() const;
+
+  vector<string> columns_;
+  vector<string::size_type> valueStarts_;  // of each column in values_
+  stringstream values_;
+};
+
+// Records signal rows in the database.
+// Rows which are added are held until the recorder is flushed,
+// then written with one multi-row INSERT per table and set of
+// columns.  If a multi-row INSERT fails, its rows are written
+// one at a time.  Rows whose id is needed are inserted immediately.
+
+class SignalDbRecorder
+{
+public:
+  static const int DefaultMaxRowsPerInsert = 500;
+
+  SignalDbRecorder(SignalDb *db,
+		   int maxRowsPerInsert = DefaultMaxRowsPerInsert);
+  virtual ~SignalDbRecorder();
+
+  DbTableKeyId insert(const string &tableName, const SignalDbRow &row);
+  void add(const string &tableName, const SignalDbRow &row);
+  void flush();
+  int getPendingRows() const;
+
+private:
+  // Disable copy construction & assignment.
+  // Don't define these.
+  SignalDbRecorder(const SignalDbRecorder& rhs);
+  SignalDbRecorder& operator=(const SignalDbRecorder& rhs);
+
+  // rows waiting to be written to one table, all with the same columns
+  struct PendingInsert
+  {
+    string tableName;
+    string columns;         // "(col1, col2, ...)"
+    vector<string> rows;    // "(value1, value2, ...)"
+  };
+
+  void submitRows(const PendingInsert &pending, string &errorText);
+  void submitRows(const PendingInsert &pending,
+		  unsigned int first, unsigned int last);
+
+  SignalDb *db_;
+  int maxRowsPerInsert_;
+  int pendingRows_;
+  vector<PendingInsert> pending_;
+};
+
+#endif
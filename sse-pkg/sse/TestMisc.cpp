@@ -33,6 +33,8 @@
 #include "TestRunner.h"
 #include "TestMisc.h"
 #include "ScienceDataArchive.h"
+#include "SignalDbRecorder.h"
+#include "WriteScienceData.h"
 #include "ObserveActivityStatus.h"
 #include "ObsSummaryStats.h"
 #include "ExpectedNssComponentsTree.h"
@@ -42,13 +44,20 @@
 #include "MinMaxBandwidth.h"
 #include "SseAstro.h"
 #include "SseArchive.h"
+#include "SseUtil.h"
 #include "TargetPosition.h"
 #include "Target.h"
 #include "SharedTclProxy.h"
 #include "ActUnitListMutexWrapper.h"
 #include "AtaInformation.h"
+#include "Assert.h"
+#include <algorithm>
 #include <string>
 #include <list>
+#include <map>
+#include <sstream>
+#include <strings.h>
+#include <vector>
 
 void TestMisc::setUp ()
 {
@@ -60,9 +69,448 @@ void TestMisc::tearDown()
 
 }
 
+// load synthetic science data records
+static void setBaseline(BaselineHeader &hdr, float values[], int nValues,
+			int halfFrame)
+{
+    hdr.rfCenterFreq = 1420.0 + halfFrame;
+    hdr.bandwidth = 0.5;
+    hdr.halfFrameNumber = halfFrame;
+    hdr.numberOfSubchannels = nValues;
+    hdr.pol = (halfFrame % 2) ? POL_RIGHTCIRCULAR : POL_LEFTCIRCULAR;
+    hdr.activityId = 1234;
+    for (int i=0; i<nValues; ++i)
+    {
+	values[i] = halfFrame + 0.25 * i;
+    }
+}
+
+static void setCompAmps(ComplexAmplitudes &compamps, int halfFrame)
+{
+    compamps.header.rfCenterFreq = 1420.0 + halfFrame;
+    compamps.header.halfFrameNumber = halfFrame;
+    compamps.header.activityId = 1234;
+    compamps.header.hzPerSubchannel = 533.0;
+    compamps.header.startSubchannelId = halfFrame % 7;
+    compamps.header.numberOfSubchannels = 1;
+    compamps.header.overSampling = 0.25;
+    compamps.header.pol = POL_LEFTCIRCULAR;
+    for (int i=0; i<MAX_SUBCHANNEL_BINS_PER_1KHZ_HALF_FRAME; ++i)
+    {
+	compamps.compamp.coef[i].pair = (halfFrame + i) & 0xff;
+    }
+}
+
+// Write the same records through the unbuffered and buffered
+// science data writers, and make sure the files are identical.
+
 void TestMisc::testScienceDataArchive()
 {
+    cout << "testScienceDataArchive" << endl;
+
+    string oldBaselineFile("/tmp/testScienceDataOld.baseline");
+    string newBaselineFile("/tmp/testScienceDataNew.baseline");
+    string oldCompampFile("/tmp/testScienceDataOld.compamp");
+    string newCompampFile("/tmp/testScienceDataNew.compamp");
+
+    remove(oldBaselineFile.c_str());
+    remove(oldCompampFile.c_str());
+
+    const int maxValues = 1000;
+    float values[maxValues];
+    BaselineHeader hdr;
+    ComplexAmplitudes compamps;
+
+    const int nRecords = 50;
+    {
+	// deliberately small, unaligned buffer so that records
+	// are split across buffer writes
+	ScienceDataFile baselineFile(newBaselineFile, 1000);
+	ScienceDataFile compampFile(newCompampFile, 3333);
+	baselineFile.truncate();
+	compampFile.truncate();
+
+	for (int frame=0; frame<nRecords; ++frame)
+	{
+	    int nValues = (frame * 37) % maxValues;
+	    setBaseline(hdr, values, nValues, frame);
+	    writeVariableLengthBaselineToNssFile(hdr, values, nValues,
+						 oldBaselineFile);
+	    writeVariableLengthBaselineToNssFile(hdr, values, nValues,
+						 baselineFile);
+
+	    setCompAmps(compamps, frame);
+	    writeCompAmpsToNssFile(compamps, oldCompampFile);
+	    writeCompAmpsToNssFile(compamps, compampFile);
+	}
+
+	// nothing is lost when the files are closed
+    }
+
+    cu_assert(SseUtil::getFileSize(newBaselineFile) > 0);
+    cu_assert(SseUtil::readFileIntoString(oldBaselineFile) ==
+	      SseUtil::readFileIntoString(newBaselineFile));
+    cu_assert(SseUtil::getFileSize(newCompampFile) ==
+	      nRecords * static_cast<int>(sizeof(ComplexAmplitudes)));
+    cu_assert(SseUtil::readFileIntoString(oldCompampFile) ==
+	      SseUtil::readFileIntoString(newCompampFile));
+
+    // data is held until the buffer fills or is flushed,
+    // and truncation discards it
+    {
+	ScienceDataFile compampFile(newCompampFile);
+	compampFile.truncate();
+	setCompAmps(compamps, 1);
+	writeCompAmpsToNssFile(compamps, compampFile);
+	cu_assert(SseUtil::getFileSize(newCompampFile) == 0);
+
+	compampFile.flush();
+	cu_assert(SseUtil::getFileSize(newCompampFile) ==
+		  static_cast<int>(sizeof(ComplexAmplitudes)));
+
+	writeCompAmpsToNssFile(compamps, compampFile);
+	compampFile.truncate();
+	cu_assert(SseUtil::getFileSize(newCompampFile) == 0);
+    }
+    cu_assert(SseUtil::getFileSize(newCompampFile) == 0);
+
+    // a zero flush interval writes each record as it arrives
+    {
+	ScienceDataFile compampFile(newCompampFile,
+				    ScienceDataFile::DefaultBufferSize, 0);
+	writeCompAmpsToNssFile(compamps, compampFile);
+	cu_assert(SseUtil::getFileSize(newCompampFile) ==
+		  static_cast<int>(sizeof(ComplexAmplitudes)));
+    }
+
+    remove(oldBaselineFile.c_str());
+    remove(newBaselineFile.c_str());
+    remove(oldCompampFile.c_str());
+    remove(newCompampFile.c_str());
+}
+
+// Split a list at the separators which are not inside
+// quotes or parentheses, trimming blanks.
+static vector<string> splitSqlList(const string &text, char separator)
+{
+    vector<string> items;
+    string item;
+    bool quoted(false);
+    int depth(0);
+    for (string::size_type i=0; i<=text.size(); ++i)
+    {
+	char c = (i < text.size()) ? text[i] : separator;
+	if (quoted && c == '\\' && i + 1 < text.size())
+	{
+	    // escaped character
+	    item += c;
+	    item += text[++i];
+	    continue;
+	}
+	if (c == '\'')
+	{
+	    quoted = !quoted;
+	}
+	else if (!quoted && c == '(')
+	{
+	    ++depth;
+	}
+	else if (!quoted && c == ')')
+	{
+	    --depth;
+	}
+	if (!quoted && depth == 0 && c == separator)
+	{
+	    string::size_type first = item.find_first_not_of(" ");
+	    string::size_type last = item.find_last_not_of(" ");
+	    items.push_back(first == string::npos ? "" :
+			    item.substr(first, last - first + 1));
+	    item = "";
+	}
+	else
+	{
+	    item += c;
+	}
+    }
+    return items;
+}
+
+static string stripParens(const string &text)
+{
+    return text.substr(1, text.size() - 2);
+}
+
+// Signal database which keeps the rows inserted into each table.
+
+class SignalDbStub : public SignalDb
+{
+public:
+    typedef map<string, string> Row;  // column name -> value
+
+    SignalDbStub() : statements(0), lastId_(0) {}
+
+    void submit(const string &sqlStmt)
+    {
+	++statements;
+
+	// statements containing the rejected value fail as a whole
+	if (!rejectValue.empty() && sqlStmt.find(rejectValue) != string::npos)
+	{
+	    throw SseException("SignalDbStub: rejected " + rejectValue + "\n",
+			       __FILE__, __LINE__,
+			       SSE_MSG_DBERR, SEVERITY_ERROR);
+	}
+
+	const string insert("INSERT INTO ");
+	Assert(strncasecmp(sqlStmt.c_str(), insert.c_str(),
+			   insert.size()) == 0);
+	string::size_type tableEnd = sqlStmt.find(' ', insert.size());
+	string table = sqlStmt.substr(insert.size(),
+				      tableEnd - insert.size());
+	string rest = sqlStmt.substr(tableEnd + 1);
+
+	const string set("SET ");
+	if (rest.find(set) == 0)
+	{
+	    // single row: col = value, ...
+	    vector<string> assignments = splitSqlList(rest.substr(set.size()),
+						      ',');
+	    Row row;
+	    for (unsigned int i=0; i<assignments.size(); ++i)
+	    {
+		vector<string> colValue = splitSqlList(assignments[i], '=');
+		Assert(colValue.size() == 2);
+		row[colValue[0]] = colValue[1];
+	    }
+	    addRow(table, row);
+	}
+	else
+	{
+	    // multiple rows: (cols) VALUES (values), ...
+	    const string values(" VALUES ");
+	    string::size_type valuesStart = rest.find(values);
+	    Assert(valuesStart != string::npos);
+	    vector<string> columns = splitSqlList(
+		stripParens(rest.substr(0, valuesStart)), ',');
+	    vector<string> rows = splitSqlList(
+		rest.substr(valuesStart + values.size()), ',');
+	    for (unsigned int i=0; i<rows.size(); ++i)
+	    {
+		vector<string> rowValues = splitSqlList(stripParens(rows[i]),
+							',');
+		Assert(rowValues.size() == columns.size());
+		Row row;
+		for (unsigned int col=0; col<columns.size(); ++col)
+		{
+		    row[columns[col]] = rowValues[col];
+		}
+		addRow(table, row);
+	    }
+	}
+    }
+
+    DbTableKeyId getInsertId()
+    {
+	return lastId_;
+    }
+
+    map<string, vector<Row> > tables;
+    int statements;
+    string rejectValue;
+
+private:
+    void addRow(const string &table, Row &row)
+    {
+	vector<Row> &rows = tables[table];
+	lastId_ = rows.size() + 1;
+	row["id"] = SseUtil::intToStr(lastId_);
+	rows.push_back(row);
+    }
+
+    DbTableKeyId lastId_;
+};
+
+// Rows of a table, with references to signals replaced by the
+// referenced signal number, and the row ids removed, so that
+// tables written in a different order can be compared.
+
+static vector<SignalDbStub::Row> comparableRows(SignalDbStub &db,
+						const string &table)
+{
+    vector<SignalDbStub::Row> rows = db.tables[table];
+    for (unsigned int i=0; i<rows.size(); ++i)
+    {
+	SignalDbStub::Row &row = rows[i];
+	if (row.count("signalTableId"))
+	{
+	    int id = SseUtil::strToInt(row["signalTableId"]);
+	    row["signalTableId"] = db.tables["Signals"][id-1]["signalIdNumber"];
+	}
+	row.erase("id");
+    }
+    sort(rows.begin(), rows.end());
+    return rows;
+}
+
+// Rows in the form written by ActivityUnitImp
+static void cwSignalRow(SignalDbRow &row, int number,
+			const string &type = "CwP")
+{
+    row.stream().precision(9);
+    row.stream().setf(std::ios::fixed);
+    row.set("activityId") << 1234;
+    row.set("dbActivityUnitId") << 77;
+    row.set("location") << "'Hat Creek, CA \\'ATA\\''";
+    row.set("targetId") << 5;
+    row.set("beamNumber") << 2;
+    row.set("type") << "'" << type << "'";
+    row.set("rfFreq") << 1420.0 + number * 0.001;
+    row.set("drift") << -0.25 * number;
+    row.set("pol") << "'" << ((number % 2) ? "R" : "L") << "'";
+    row.set("reason") << "'RecentRfi=" << number << "'";
+    row.set("signalIdNumber") << number;
+}
+
+static void pulseSignalRow(SignalDbRow &row, int number)
+{
+    cwSignalRow(row, number, "Pul");
+    row.set("pfa") << -21.5;
+    row.set("snr") << 10.2;
+    row.set("pulsePeriod") << number * 0.5;
+    row.set("numberOfPulses") << 3;
+    row.set("res") << "'1 Hz'";
+}
+
+static void pulseRow(SignalDbRow &row, DbTableKeyId signalTableId, int pulse)
+{
+    row.set("signalTableId") << signalTableId;
+    row.set("rfFreq") << 1420.5 + pulse;
+    row.set("power") << 100 + pulse;
+    row.set("spectrumNumber") << 3 * pulse;
+    row.set("binNumber") << 7 * pulse;
+    row.set("pol") << "'L'";
+}
+
+static void badBandRow(SignalDbRow &row, int number)
+{
+    row.set("actId") << 1234;
+    row.set("dxNumber") << 3;
+    row.set("centerFreq") << 1421.0 + number;
+    row.set("bandwidth") << 0.001;
+    row.set("pol") << "'both'";
+    row.set("paths") << number;
+}
+
+// Record a synthetic signal set one row per INSERT, as ActivityUnitImp
+// used to, and through a recorder, and make sure the same rows
+// end up in each table.
+
+void TestMisc::testSignalDbRecorder()
+{
+    cout << "testSignalDbRecorder" << endl;
+
+    const int nSignals = 60;
+    const int nPulses = 3;
+    const int maxRowsPerInsert = 7;
+
+    SignalDbStub singleDb;
+    SignalDbStub batchDb;
+    SignalDbRecorder recorder(&batchDb, maxRowsPerInsert);
+
+    for (int sig=0; sig<nSignals; ++sig)
+    {
+	if (sig % 4 == 0)
+	{
+	    SignalDbRow signal;
+	    pulseSignalRow(signal, sig);
+	    singleDb.submit("INSERT INTO Signals SET "
+			    + signal.getSetClause());
+	    DbTableKeyId singleId = singleDb.getInsertId();
+	    DbTableKeyId batchId = recorder.insert("Signals", signal);
+	    for (int pulse=0; pulse<nPulses; ++pulse)
+	    {
+		SignalDbRow singlePulse;
+		pulseRow(singlePulse, singleId, pulse);
+		singleDb.submit("INSERT into PulseTrains SET "
+				+ singlePulse.getSetClause());
+		SignalDbRow batchPulse;
+		pulseRow(batchPulse, batchId, pulse);
+		recorder.add("PulseTrains", batchPulse);
+	    }
+	}
+	else
+	{
+	    SignalDbRow signal;
+	    cwSignalRow(signal, sig);
+	    singleDb.submit("INSERT INTO Signals SET "
+			    + signal.getSetClause());
+	    recorder.add("Signals", signal);
+	}
+    }
+    for (int band=0; band<nSignals/2; ++band)
+    {
+	SignalDbRow badBand;
+	badBandRow(badBand, band);
+	singleDb.submit("INSERT INTO CwBadBands SET "
+			+ badBand.getSetClause());
+	recorder.add("CwBadBands", badBand);
+    }
+
+    // nothing is added until the recorder is flushed
+    cu_assert(batchDb.tables["Signals"].size() == nSignals / 4);
+    cu_assert(batchDb.tables["PulseTrains"].empty());
+    cu_assert(recorder.getPendingRows() ==
+	      nSignals * 3/4 + nSignals/4 * nPulses + nSignals/2);
+
+    recorder.flush();
+    cu_assert(recorder.getPendingRows() == 0);
+
+    const char *tables[] = { "Signals", "PulseTrains", "CwBadBands" };
+    for (unsigned int i=0; i<sizeof(tables)/sizeof(tables[0]); ++i)
+    {
+	cu_assert(singleDb.tables[tables[i]].size() > 0);
+	cu_assert(comparableRows(singleDb, tables[i]) ==
+		  comparableRows(batchDb, tables[i]));
+    }
+
+    // values with quoted separators and escaped quotes survive
+    cu_assert(batchDb.tables["Signals"][nSignals-1]["location"] ==
+	      "'Hat Creek, CA \\'ATA\\''");
+
+    // signals: 15 single inserts + 7 for 45 cw rows;
+    // pulses: 7 for 45 rows; bad bands: 5 for 30 rows
+    cu_assert(batchDb.statements == 15 + 7 + 7 + 5);
+
+    // a flush with nothing pending does nothing
+    recorder.flush();
+    cu_assert(batchDb.statements == 15 + 7 + 7 + 5);
+
+    // a bad row loses only itself: its INSERT is retried one row
+    // at a time, and the rest of the table is still written
+    SignalDbStub failDb;
+    failDb.rejectValue = "1424";  // centerFreq of band 3
+    SignalDbRecorder failRecorder(&failDb, maxRowsPerInsert);
+    for (int band=0; band<nSignals/2; ++band)
+    {
+	SignalDbRow badBand;
+	badBandRow(badBand, band);
+	failRecorder.add("CwBadBands", badBand);
+    }
+    bool caught(false);
+    try
+    {
+	failRecorder.flush();
+    }
+    catch (SseException &except)
+    {
+	caught = true;
+    }
+    cu_assert(caught);
+    cu_assert(failRecorder.getPendingRows() == 0);
+    cu_assert(failDb.tables["CwBadBands"].size() == nSignals/2 - 1);
 
+    // 5 chunks, the first of which fails and is retried as 7 rows
+    cu_assert(failDb.statements == 5 + 7);
 }
 
 void TestMisc::testObsSummary()
@@ -822,6 +1270,7 @@ Test *TestMisc::suite ()
 	TestSuite *testSuite = new TestSuite("TestMisc");
 
 	testSuite->addTest (new TestCaller <TestMisc> ("testScienceDataArchive", &TestMisc::testScienceDataArchive));
+	testSuite->addTest (new TestCaller <TestMisc> ("testSignalDbRecorder", &TestMisc::testSignalDbRecorder));
 	testSuite->addTest (new TestCaller <TestMisc> ("testObsSummary", &TestMisc::testObsSummary));
 	testSuite->addTest (new TestCaller <TestMisc> ("testParamPrint", &TestMisc::testParamPrint));
 	testSuite->addTest (new TestCaller <TestMisc> ("testLogging", &TestMisc::testLogging));
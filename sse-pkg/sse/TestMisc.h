@@ -50,6 +50,7 @@ class TestMisc : public TestCase
     void testLogging();
     void testObserveActivityStatus();
     void testScienceDataArchive();
+    void testSignalDbRecorder();
     void testObsSummary();
     void testParamPrint();
     void testExpectedNssComponentsTree();
@@ -32,9 +32,17 @@
 #include "WriteScienceData.h"
 #include "sseDxInterface.h"
 #include "SseException.h"
+#include "SseUtil.h"
+#include "Assert.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <unistd.h>
 
 using namespace std;
 
@@ -82,3 +90,198 @@ void writeCompAmpsToNssFile(const ComplexAmplitudes &compamps,
     fout.write((const char *)&compamps, sizeof(compamps));
     fout.close();
 }
+
+
+// append variable length baseline to a buffered file.
+// assumes data is already marshalled
+
+void writeVariableLengthBaselineToNssFile(
+    const BaselineHeader &hdr,
+    float baselineValues[],
+    int numberOfBaselineValues,
+    ScienceDataFile &file)
+{
+    file.write(&hdr, sizeof(hdr),
+	       baselineValues, sizeof(float) * numberOfBaselineValues);
+}
+
+// append complex amps to a buffered file
+void writeCompAmpsToNssFile(const ComplexAmplitudes &compamps,
+			    ScienceDataFile &file)
+{
+    file.write(&compamps, sizeof(compamps));
+}
+
+
+// ---- ScienceDataFile ----
+
+static const size_t BufferAlignment = 4096;
+
+ScienceDataFile::ScienceDataFile(const string &filename,
+				 size_t bufferSize,
+				 int flushIntervalSecs)
+    : filename_(filename),
+      fd_(-1),
+      buffer_(0),
+      bufferSize_(bufferSize),
+      bufferUsed_(0),
+      flushIntervalSecs_(flushIntervalSecs),
+      firstBufferedTime_(0)
+{
+    Assert(bufferSize_ > 0);
+
+    void *buffer;
+    if (posix_memalign(&buffer, BufferAlignment, bufferSize_) != 0)
+    {
+	throw SseException("Buffer allocation failed for " + filename_,
+			   __FILE__, __LINE__,
+			   SSE_MSG_FILE_ERROR, SEVERITY_ERROR);
+    }
+    buffer_ = static_cast<char *>(buffer);
+}
+
+ScienceDataFile::~ScienceDataFile()
+{
+    try
+    {
+	close();
+    }
+    catch (SseException &except)
+    {
+	cerr << except << endl;
+    }
+    free(buffer_);
+}
+
+const string &ScienceDataFile::getFilename() const
+{
+    return filename_;
+}
+
+// Add data to the buffer, writing out the buffer each time it fills.
+
+void ScienceDataFile::append(const void *data, size_t length)
+{
+    const char *src = static_cast<const char *>(data);
+    while (length > 0)
+    {
+	if (bufferUsed_ == 0)
+	{
+	    firstBufferedTime_ = time(NULL);
+	}
+
+	size_t nBytes = min(length, bufferSize_ - bufferUsed_);
+	memcpy(buffer_ + bufferUsed_, src, nBytes);
+	bufferUsed_ += nBytes;
+	src += nBytes;
+	length -= nBytes;
+
+	if (bufferUsed_ == bufferSize_)
+	{
+	    flush();
+	}
+    }
+}
+
+// Write out the buffer if the oldest data in it has been
+// waiting for longer than the flush interval.
+
+void ScienceDataFile::flushIfStale()
+{
+    if (bufferUsed_ > 0 &&
+	time(NULL) - firstBufferedTime_ >= flushIntervalSecs_)
+    {
+	flush();
+    }
+}
+
+void ScienceDataFile::write(const void *data, size_t length)
+{
+    append(data, length);
+    flushIfStale();
+}
+
+// Write a record made up of a header and a data array.
+// The record is only considered for a timed flush once
+// it is complete.
+
+void ScienceDataFile::write(const void *hdr, size_t hdrLength,
+			    const void *data, size_t dataLength)
+{
+    append(hdr, hdrLength);
+    append(data, dataLength);
+    flushIfStale();
+}
+
+void ScienceDataFile::flush()
+{
+    if (bufferUsed_ > 0)
+    {
+	// empty the buffer first, so that a failed write
+	// is not retried on every subsequent call
+	size_t length = bufferUsed_;
+	bufferUsed_ = 0;
+	writeToFile(buffer_, length);
+    }
+}
+
+void ScienceDataFile::close()
+{
+    flush();
+    if (fd_ >= 0)
+    {
+	::close(fd_);
+	fd_ = -1;
+    }
+}
+
+// Discard any buffered data and truncate the file.
+// The file is reopened on the next write.
+
+void ScienceDataFile::truncate()
+{
+    bufferUsed_ = 0;
+    if (fd_ >= 0)
+    {
+	::close(fd_);
+	fd_ = -1;
+    }
+    SseUtil::truncateFile(filename_);
+}
+
+void ScienceDataFile::open()
+{
+    fd_ = ::open(filename_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0666);
+    if (fd_ < 0)
+    {
+	throw SseException("File Open failed on " + filename_,
+			   __FILE__, __LINE__,
+			   SSE_MSG_FILE_ERROR, SEVERITY_ERROR);
+    }
+}
+
+void ScienceDataFile::writeToFile(const char *data, size_t length)
+{
+    if (fd_ < 0)
+    {
+	open();
+    }
+
+    while (length > 0)
+    {
+	ssize_t nBytes = ::write(fd_, data, length);
+	if (nBytes < 0)
+	{
+	    if (errno == EINTR)
+	    {
+		continue;
+	    }
+	    throw SseException("File write failed on " + filename_
+			       + ": " + strerror(errno),
+			       __FILE__, __LINE__,
+			       SSE_MSG_FILE_ERROR, SEVERITY_ERROR);
+	}
+	data += nBytes;
+	length -= nBytes;
+    }
+}
@@ -32,13 +32,64 @@
 #ifndef WRITE_SCIENCE_DATA_H
 #define WRITE_SCIENCE_DATA_H
 
+#include <ctime>
 #include <string>
+#include <sys/types.h>
 using std::string;
 
 struct Baseline;
 struct BaselineHeader;
 struct ComplexAmplitudes;
 
+// Buffered science data output file.
+// The file is opened (in append mode) on the first write and kept
+// open until it is closed or the object is destroyed.  Records are
+// collected in a page aligned buffer and written out a full buffer
+// at a time, or when the data in the buffer is older than the flush
+// interval, so that a monitor can follow the file while it is
+// being written.  The bytes written are identical to those written
+// by the unbuffered routines below.
+
+class ScienceDataFile
+{
+ public:
+    static const size_t DefaultBufferSize = 64 * 1024;
+    static const int DefaultFlushIntervalSecs = 1;
+
+    ScienceDataFile(const string &filename,
+		    size_t bufferSize = DefaultBufferSize,
+		    int flushIntervalSecs = DefaultFlushIntervalSecs);
+    virtual ~ScienceDataFile();
+
+    void write(const void *data, size_t length);
+    void write(const void *hdr, size_t hdrLength,
+	       const void *data, size_t dataLength);
+    void flush();
+    void close();
+    void truncate();
+
+    const string &getFilename() const;
+
+ private:
+    // Disable copy construction & assignment.
+    // Don't define these.
+    ScienceDataFile(const ScienceDataFile& rhs);
+    ScienceDataFile& operator=(const ScienceDataFile& rhs);
+
+    void open();
+    void append(const void *data, size_t length);
+    void flushIfStale();
+    void writeToFile(const char *data, size_t length);
+
+    string filename_;
+    int fd_;
+    char *buffer_;
+    size_t bufferSize_;
+    size_t bufferUsed_;
+    int flushIntervalSecs_;
+    time_t firstBufferedTime_;
+};
+
 void writeVariableLengthBaselineToNssFile(
     const BaselineHeader &hdr,
     float baselineValues[],
@@ -48,5 +99,14 @@ void writeVariableLengthBaselineToNssFile(
 void writeCompAmpsToNssFile(const ComplexAmplitudes &compamps,
 			    const string& filename);
 
+void writeVariableLengthBaselineToNssFile(
+    const BaselineHeader &hdr,
+    float baselineValues[],
+    int numberOfBaselineValues,
+    ScienceDataFile &file);
+
+void writeCompAmpsToNssFile(const ComplexAmplitudes &compamps,
+			    ScienceDataFile &file);
+
 
 #endif // WRITE_SCIENCE_DATA_H
\ No newline at end of file
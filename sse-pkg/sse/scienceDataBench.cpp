@@ -0,0 +1,184 @@
+/*******************************************************************************
+
+ File:    scienceDataBench.cpp
+ Project: OpenSonATA
+ Authors: The OpenSonATA code is the result of many programmers
+          over many years
+
+ Copyright 2011 The SETI Institute
+
+ OpenSonATA is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ OpenSonATA is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with OpenSonATA.  If not, see<http://www.gnu.org/licenses/>.
+ 
+ Implementers of this code are requested to include the caption
+ "Licensed through SETI" with a link to setiQuest.org.
+ 
+ For alternate licensing arrangements, please contact
+ The SETI Institute at www.seti.org or setiquest.org. 
+
+*******************************************************************************/
+
+
+// Science data archive benchmark.
+// Writes synthetic complex amplitude and baseline records for a
+// number of DXs, each record going to a main and a monitor file
+// for its polarization as in ScienceDataArchive, first with the
+// unbuffered writers (which open and close the file for every
+// record) and then with buffered ScienceDataFiles.
+//
+// usage: scienceDataBench [nDxs [nHalfFrames [outputDir]]]
+
+#include "WriteScienceData.h"
+#include "sseDxInterface.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/time.h>
+#include <vector>
+
+using namespace std;
+
+static const int FilesPerDx = 8;  // (main, monitor) x (L, R) x (baseline, compamp)
+static const int SubchannelsPerHalfFrame = 16;
+static const int BaselineValues = 1024;
+
+static double seconds()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static string filename(const string &dir, int dx, int file)
+{
+    stringstream strm;
+    strm << dir << "/dx" << dx << "-" << file
+	 << ((file & 2) ? ".baseline" : ".compamp");
+    return strm.str();
+}
+
+static void removeFiles(const string &dir, int nDxs)
+{
+    for (int dx = 0; dx < nDxs; ++dx)
+    {
+	for (int file = 0; file < FilesPerDx; ++file)
+	{
+	    remove(filename(dir, dx, file).c_str());
+	}
+    }
+}
+
+static void report(const string &name, int records, double bytes, double t)
+{
+    cout << setw(12) << name
+	 << setw(12) << fixed << setprecision(0) << records / t
+	 << setw(12) << setprecision(1) << bytes / t / 1e6
+	 << setw(12) << setprecision(3) << t << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int nDxs = (argc > 1) ? atoi(argv[1]) : 16;
+    int nHalfFrames = (argc > 2) ? atoi(argv[2]) : 100;
+    string dir = (argc > 3) ? argv[3] : "/tmp";
+
+    ComplexAmplitudes compamps;
+    BaselineHeader hdr;
+    hdr.numberOfSubchannels = BaselineValues;
+    vector<float> values(BaselineValues, 1.0);
+
+    // each half frame, every DX writes a baseline and a set of
+    // subchannels for each pol, each to a main and a monitor file
+    int records = nDxs * nHalfFrames * 2 * 2 * (SubchannelsPerHalfFrame + 1);
+    double bytes = nDxs * nHalfFrames * 2 * 2 *
+	(SubchannelsPerHalfFrame * sizeof(compamps) +
+	 sizeof(hdr) + BaselineValues * sizeof(float));
+
+    cout << nDxs << " DXs, " << nHalfFrames << " half frames, "
+	 << records << " records, " << bytes / 1e6 << " MB" << endl;
+    cout << "      writer   records/s        MB/s     seconds" << endl;
+
+    // unbuffered: open & close per record
+    removeFiles(dir, nDxs);
+    vector<string> names;
+    for (int dx = 0; dx < nDxs; ++dx)
+    {
+	for (int file = 0; file < FilesPerDx; ++file)
+	{
+	    names.push_back(filename(dir, dx, file));
+	}
+    }
+    double start = seconds();
+    for (int frame = 0; frame < nHalfFrames; ++frame)
+    {
+	for (int dx = 0; dx < nDxs; ++dx)
+	{
+	    for (int pol = 0; pol < 2; ++pol)
+	    {
+		const string *f = &names[dx * FilesPerDx + pol * 4];
+		for (int sub = 0; sub < SubchannelsPerHalfFrame; ++sub)
+		{
+		    writeCompAmpsToNssFile(compamps, f[0]);
+		    writeCompAmpsToNssFile(compamps, f[1]);
+		}
+		writeVariableLengthBaselineToNssFile(hdr, &values[0],
+						     BaselineValues, f[2]);
+		writeVariableLengthBaselineToNssFile(hdr, &values[0],
+						     BaselineValues, f[3]);
+	    }
+	}
+    }
+    report("unbuffered", records, bytes, seconds() - start);
+
+    // buffered: one handle per file for the whole run
+    removeFiles(dir, nDxs);
+    start = seconds();
+    {
+	vector<ScienceDataFile *> files;
+	for (unsigned int i = 0; i < names.size(); ++i)
+	{
+	    files.push_back(new ScienceDataFile(names[i]));
+	}
+	for (int frame = 0; frame < nHalfFrames; ++frame)
+	{
+	    for (int dx = 0; dx < nDxs; ++dx)
+	    {
+		for (int pol = 0; pol < 2; ++pol)
+		{
+		    ScienceDataFile **f = &files[dx * FilesPerDx + pol * 4];
+		    for (int sub = 0; sub < SubchannelsPerHalfFrame; ++sub)
+		    {
+			writeCompAmpsToNssFile(compamps, *f[0]);
+			writeCompAmpsToNssFile(compamps, *f[1]);
+		    }
+		    writeVariableLengthBaselineToNssFile(hdr, &values[0],
+							 BaselineValues, *f[2]);
+		    writeVariableLengthBaselineToNssFile(hdr, &values[0],
+							 BaselineValues, *f[3]);
+		}
+	    }
+	}
+	for (unsigned int i = 0; i < files.size(); ++i)
+	{
+	    delete files[i];
+	}
+    }
+    report("buffered", records, bytes, seconds() - start);
+
+    removeFiles(dir, nDxs);
+
+    return 0;
+}